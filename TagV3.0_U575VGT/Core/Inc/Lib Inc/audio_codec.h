@@ -0,0 +1,95 @@
+/*
+ * audio_codec.h
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Lossless block codec for the hydrophone data (FLAC style fixed linear prediction + Rice coding).
+ *
+ *    A block is a run of interleaved frames exactly as the SAI writes them into the temp buffer: every frame holds
+ *    one slot group per enabled channel, each made of an optional header byte followed by a big-endian 16 or 24-bit sample.
+ *    Every channel of a block is encoded on its own with whichever fixed predictor (order 0-4) fits it best, and the
+ *    residuals are Rice coded in partitions of AUDIO_CODEC_PARTITION_LEN with their own parameter. Channels that
+ *    don't compress are stored verbatim, so an encoded block is never more than AUDIO_CODEC_MAX_OVERHEAD bytes larger
+ *    than the raw block.
+ *
+ ***** encoded block layout ***************************
+ *
+ *  u16  frame count (little-endian)
+ *  u8   channel count
+ *  u8   sample bytes (bits 0-3) | header bytes (bits 4-7)
+ *  per channel:
+ *    u8   mode: predictor order (bits 0-2), headers constant (bit 6), verbatim (bit 7)
+ *    headers: 1 byte if constant, else one byte per frame (only present if header bytes != 0)
+ *    verbatim: one big-endian sample per frame
+ *    else: <order> big-endian warm-up samples, then a bitstream (MSB first, padded to a byte) of partitions:
+ *      5-bit Rice parameter k, then k-coded zigzag residuals
+ *      k == AUDIO_CODEC_RICE_ESCAPE: 5-bit width w, then residuals stored as raw w-bit zigzag values
+ *
+ **************************************************************/
+
+#ifndef INC_LIB_INC_AUDIO_CODEC_H_
+#define INC_LIB_INC_AUDIO_CODEC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+//Highest fixed predictor order
+#define AUDIO_CODEC_MAX_ORDER 4
+
+//Residuals per Rice partition
+#define AUDIO_CODEC_PARTITION_LEN 256
+
+//Rice parameter value marking an escaped (raw) partition
+#define AUDIO_CODEC_RICE_ESCAPE 31
+
+//Size of the block header
+#define AUDIO_CODEC_BLOCK_HEADER_SIZE 4
+
+//Most channels a block can hold (matches the ADC)
+#define AUDIO_CODEC_MAX_CHANNELS 4
+
+//Largest amount an encoded block can exceed its raw size by (block header + a mode byte per channel)
+#define AUDIO_CODEC_MAX_OVERHEAD (AUDIO_CODEC_BLOCK_HEADER_SIZE + AUDIO_CODEC_MAX_CHANNELS)
+
+typedef struct {
+    uint8_t channel_count; //channels interleaved in each frame
+    uint8_t sample_bytes;  //2 (16-bit) or 3 (24-bit)
+    uint8_t header_bytes;  //0 or 1, ADC header byte in front of each sample
+} AudioCodecFormat;
+
+/* bytes in one frame of the given format */
+static inline size_t audio_codec_frame_bytes(const AudioCodecFormat *fmt){
+    return (size_t)fmt->channel_count * (fmt->header_bytes + fmt->sample_bytes);
+}
+
+/* one big-endian 16 or 24-bit sample as Q31, for the stages that scan raw blocks */
+static inline int32_t audio_codec_sample_q31(const uint8_t *p, uint8_t sample_bytes){
+    if(sample_bytes == 2){
+        return (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16));
+    }
+    return (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8));
+}
+
+/*
+ * Desc: encode one block of raw frames (src_len must be a whole number of frames, at most UINT16_MAX of them).
+ *       Returns the encoded length, or 0 if the format is invalid or the block doesn't fit in dst_capacity.
+ *       Not reentrant, the encoder keeps its partition scratch in a static buffer.
+ */
+size_t audio_codec_encode(const AudioCodecFormat *fmt, const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_capacity);
+
+/*
+ * Desc: read the format and frame count of an encoded block without decoding it.
+ *       Returns false if src doesn't start with a valid block header.
+ */
+bool audio_codec_peek(const uint8_t *src, size_t src_len, AudioCodecFormat *fmt, uint16_t *frame_count);
+
+/*
+ * Desc: decode one encoded block back into raw frames.
+ *       Returns the number of encoded bytes consumed (so blocks can be walked back to back), or 0 if the block is
+ *       corrupt/truncated or doesn't fit in dst_capacity. The raw length is written to dst_len.
+ */
+size_t audio_codec_decode(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_capacity, size_t *dst_len);
+
+#endif /* INC_LIB_INC_AUDIO_CODEC_H_ */
@@ -0,0 +1,63 @@
+/*
+ * audio_crc.h
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Checks the AD7768 data interface CRC in raw audio blocks.
+ *
+ *    With CRC_SELECT set, the ADC replaces the status header of every 4th or 16th sample of a channel with a CRC-8
+ *    (x^8 + x^2 + x + 1, seed AUDIO_CRC_SEED) of the 24-bit data of that sample and the ones before it in its group.
+ *    The checker keeps a running CRC per channel, table driven a byte at a time, and counts groups whose CRC
+ *    doesn't match.
+ *
+ *    The ADC counts groups from its last sync, which the SAI doesn't see, so the checker first finds where the groups
+ *    start by trying every offset on one channel and locking to the one that matches. Blocks always hold a whole
+ *    number of groups (see AUDIO_BLOCK_ALIGN in audio.h), so once locked every block starts at the same offset, even
+ *    after dropped blocks. A group split over two blocks is only checked if the second block directly follows the first.
+ *
+ *    Needs the header byte and the full 24 bits of every sample.
+ */
+
+#ifndef INC_LIB_INC_AUDIO_CRC_H_
+#define INC_LIB_INC_AUDIO_CRC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "Lib Inc/audio_codec.h"
+
+//CRC register value at the start of each group
+#define AUDIO_CRC_SEED 0xFF
+
+//Largest CRC group (AD7768_CRC_16)
+#define AUDIO_CRC_INTERVAL_MAX 16
+
+//Returned for blocks checked before the group offset was found
+#define AUDIO_CRC_UNLOCKED UINT16_MAX
+
+typedef struct {
+    uint8_t crc;    //running CRC of the current group
+    bool valid;     //the running CRC covers the whole group so far
+} AudioCrcChannel;
+
+typedef struct {
+    AudioCodecFormat format;
+    uint8_t interval;       //samples per CRC, 4 or 16
+    bool locked;
+    uint8_t phase;          //position within its group of the first frame of every block
+    uint32_t next_sequence; //block that continues the running CRCs
+    AudioCrcChannel ch[AUDIO_CODEC_MAX_CHANNELS];
+    uint32_t errors;        //mismatched groups since init
+} AudioCrc;
+
+/* set up a checker for a block layout, returns false if the layout doesn't carry CRCs (no headers, or 16-bit samples) */
+bool audio_crc_init(AudioCrc *self, const AudioCodecFormat *format, uint8_t interval);
+
+/*
+ * Desc: check every CRC in a block of whole frames. Returns the number of groups (over all channels) that didn't match,
+ *       or AUDIO_CRC_UNLOCKED if the group offset hasn't been found yet.
+ */
+uint16_t audio_crc_check(AudioCrc *self, const uint8_t *block, size_t len, uint32_t sequence);
+
+#endif /* INC_LIB_INC_AUDIO_CRC_H_ */
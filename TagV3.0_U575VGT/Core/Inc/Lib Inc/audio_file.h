@@ -0,0 +1,134 @@
+/*
+ * audio_file.h
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Container format for the audio files. Every write the audio thread makes is a record: a one sector header
+ *    describing the blocks in it, followed by the payload (raw temp buffer blocks, or audio_codec blocks back to back).
+ *
+ *    Each header carries the audio settings, a sequence number and capture tick per block, and the RTC time, so
+ *    post-processing can find gaps (sequence jumps) and seek record to record without touching the payload.
+ *    All fields are little-endian and the header ends in a CRC-32 (IEEE 802.3) of everything in front of it.
+ *
+ ***** record header layout ***************************
+ *
+ *  0    u32  magic (AUDIO_FILE_MAGIC)
+ *  4    u16  version
+ *  6    u16  header size (AUDIO_FILE_HEADER_SIZE)
+ *  8    u32  payload length
+ *  12   u32  raw bytes per block
+ *  16   u32  sample rate (Hz)
+ *  20   u8   channel mask (bit n = ADC channel n recorded)
+ *  21   u8   sample bytes
+ *  22   u8   channel header bytes
+ *  23   u8   flags (AUDIO_FILE_FLAG_*)
+ *  24   u32  blocks dropped since recording started
+ *  28   u32  tick the RTC was read at
+ *  32   u8   RTC year (since 2000), month, day, hours, minutes, seconds, 2 reserved
+ *  40   u16  block count
+ *  42   u16  reserved
+ *  44   u32  tick rate (Hz)
+ *  48   block entries: u32 sequence, u32 capture tick, u16 payload bytes, u16 ADC CRC errors (block count of them)
+ *  508  u32  CRC-32 of bytes 0-507
+ *
+ **************************************************************/
+
+#ifndef INC_LIB_INC_AUDIO_FILE_H_
+#define INC_LIB_INC_AUDIO_FILE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define AUDIO_FILE_MAGIC        0x42445541 //"AUDB"
+#define AUDIO_FILE_VERSION      2
+#define AUDIO_FILE_HEADER_SIZE  512
+
+//Most blocks one record can describe
+#define AUDIO_FILE_MAX_BLOCKS   36
+
+//Payload holds audio_codec blocks instead of raw blocks
+#define AUDIO_FILE_FLAG_COMPRESSED 0x01
+
+//Payload carries no audio and has no block entries (e.g. the SD card warm-up write), skip it
+#define AUDIO_FILE_FLAG_PADDING    0x02
+
+//Recorded in triggered mode, sequence jumps between records are (mostly) skipped quiet periods rather than drops. The dropped block count tells them apart.
+#define AUDIO_FILE_FLAG_TRIGGERED  0x04
+
+//16-bit samples were rounded from 24 bits with TPDF dither rather than truncated
+#define AUDIO_FILE_FLAG_DITHERED   0x08
+
+//Headers carry ADC interface CRCs (see audio_crc.h) instead of status bits, the block entries' CRC error counts are valid
+#define AUDIO_FILE_FLAG_ADC_CRC    0x10
+
+typedef struct {
+    uint32_t sequence; //free running block number, a jump means blocks were dropped
+    uint32_t tick;     //tick the DMA finished the block at
+    uint32_t length;   //bytes of payload belonging to the block (stored as 16 bits)
+    uint16_t crc_errors; //ADC CRC groups that didn't match, AUDIO_CRC_UNLOCKED if they weren't checked
+} AudioFileBlockEntry;
+
+typedef struct {
+    uint32_t payload_len;
+    uint32_t block_size;
+    uint32_t sample_rate;
+    uint8_t channel_mask;
+    uint8_t sample_bytes;
+    uint8_t header_bytes;
+    uint8_t flags;
+    uint32_t dropped_blocks;
+
+    uint32_t rtc_tick;
+    uint8_t rtc_year;
+    uint8_t rtc_month;
+    uint8_t rtc_day;
+    uint8_t rtc_hours;
+    uint8_t rtc_minutes;
+    uint8_t rtc_seconds;
+
+    uint32_t tick_rate;
+    uint16_t block_count;
+    AudioFileBlockEntry blocks[AUDIO_FILE_MAX_BLOCKS];
+} AudioFileHeader;
+
+typedef enum {
+    AUDIO_FILE_OK,
+    AUDIO_FILE_END,         //no more data
+    AUDIO_FILE_TRUNCATED,   //header or payload runs past the end of the data
+    AUDIO_FILE_BAD_MAGIC,
+    AUDIO_FILE_BAD_VERSION,
+    AUDIO_FILE_BAD_CRC,
+    AUDIO_FILE_BAD_HEADER,  //fields out of range
+} AudioFileStatus;
+
+//Iterates over the records of a file that is already in memory
+typedef struct {
+    const uint8_t *data;
+    size_t len;
+    size_t offset; //offset of the next record
+} AudioFileReader;
+
+/* CRC-32 (IEEE 802.3), pass 0 as crc to start */
+uint32_t audio_file_crc32(uint32_t crc, const uint8_t *data, size_t len);
+
+/* serialize a header into one AUDIO_FILE_HEADER_SIZE sector (including the CRC) */
+void audio_file_header_pack(const AudioFileHeader *header, uint8_t *sector);
+
+/* parse and check a header sector */
+AudioFileStatus audio_file_header_unpack(const uint8_t *sector, size_t len, AudioFileHeader *header);
+
+/* start reading records from a memory span */
+void audio_file_reader_init(AudioFileReader *self, const uint8_t *data, size_t len);
+
+/*
+ * Desc: read the next record. On AUDIO_FILE_OK the payload points into the reader's data.
+ *       After an error the reader doesn't move, use audio_file_reader_resync to skip to the next valid header.
+ */
+AudioFileStatus audio_file_reader_next(AudioFileReader *self, AudioFileHeader *header, const uint8_t **payload);
+
+/* scan forward from the current record for the next header with a valid CRC, returns false if there is none */
+bool audio_file_reader_resync(AudioFileReader *self);
+
+#endif /* INC_LIB_INC_AUDIO_FILE_H_ */
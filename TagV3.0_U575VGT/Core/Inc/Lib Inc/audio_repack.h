@@ -0,0 +1,52 @@
+/*
+ * audio_repack.h
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Repacks raw audio blocks from the layout the SAI captured into the layout that gets stored. Both are interleaved
+ *    frames of big-endian samples as described in audio_codec.h, with the same channels. Header bytes can be dropped
+ *    and 24-bit samples rounded to 16 bits, optionally with TPDF dither (+-1 LSB) instead of plain rounding.
+ *
+ *    Dropping headers or the low byte can also be done for free by masking SAI slots, repacking is for the cases the
+ *    SAI can't do: rounding/dithering instead of truncating.
+ *
+ *    On cores with the DSP extension (__ARM_FEATURE_DSP) the 24 to 16-bit conversion uses the saturating add and the
+ *    halfword pack/byte reverse instructions to store two samples at a time. The plain C version (also used if
+ *    AUDIO_REPACK_NO_DSP is defined) does the same arithmetic, so both give bit-exact identical output for the same seed.
+ */
+
+#ifndef INC_LIB_INC_AUDIO_REPACK_H_
+#define INC_LIB_INC_AUDIO_REPACK_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "Lib Inc/audio_codec.h"
+
+//Dither generator seed used by audio_repack_init
+#define AUDIO_REPACK_SEED 0x2545F491UL
+
+typedef struct {
+    AudioCodecFormat in;    //captured layout
+    AudioCodecFormat out;   //stored layout
+    bool dither;            //add TPDF dither before rounding 24 to 16 bits
+    uint32_t seed;          //xorshift32 state of the dither generator, carries over between blocks
+} AudioRepack;
+
+/*
+ * Desc: set up a repacker. Returns false if out can't be made from in (different channels, or more header/sample bytes
+ *       than in has).
+ */
+bool audio_repack_init(AudioRepack *self, const AudioCodecFormat *in, const AudioCodecFormat *out, bool dither);
+
+/* bytes a block of src_len captured bytes takes once repacked */
+size_t audio_repack_len(const AudioRepack *self, size_t src_len);
+
+/*
+ * Desc: repack a block of whole frames. dst needs audio_repack_len(src_len) bytes and may be the same buffer as src.
+ *       Returns the number of bytes written.
+ */
+size_t audio_repack(AudioRepack *self, const uint8_t *src, size_t src_len, uint8_t *dst);
+
+#endif /* INC_LIB_INC_AUDIO_REPACK_H_ */
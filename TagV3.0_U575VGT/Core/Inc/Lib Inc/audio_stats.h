@@ -0,0 +1,61 @@
+/*
+ * audio_stats.h
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Counters for the audio write path, so buffer sizes and SD cards can be picked from what a tag actually saw.
+ *
+ *    Write durations go in a log2 histogram: bin 0 is anything under 256 us, bin n covers [2^(n+7), 2^(n+8)) us and the
+ *    last bin everything from there up. Everything counts from the start of the recording; rows are dumped as CSV so the
+ *    change over an interval is the difference of two rows.
+ *
+ *    The caller does the timing.
+ */
+
+#ifndef INC_LIB_INC_AUDIO_STATS_H_
+#define INC_LIB_INC_AUDIO_STATS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+//Write duration histogram
+#define AUDIO_STATS_WRITE_BINS      16
+#define AUDIO_STATS_WRITE_BIN_SHIFT 8   //bin 0 is under 2^AUDIO_STATS_WRITE_BIN_SHIFT us
+
+//Longest CSV row (or header), with every counter at its maximum
+#define AUDIO_STATS_CSV_LINE_MAX    512
+
+typedef struct {
+    uint32_t writes;
+    uint64_t write_bytes;
+    uint64_t write_us;                              //total time spent writing
+    uint32_t write_max_us;
+    uint32_t write_hist[AUDIO_STATS_WRITE_BINS];
+    uint32_t latency_max_us;                        //longest from a block being completed to its write finishing
+    uint32_t queue_peak;                            //deepest the block queue has been
+    uint32_t stage_peak_bytes;                      //fullest the staging buffer has been
+    uint32_t dropped_blocks;
+    uint32_t crc_errors;
+} AudioStats;
+
+/* clear every counter */
+void audio_stats_reset(AudioStats *self);
+
+/* count one write of len bytes that took us microseconds */
+void audio_stats_write(AudioStats *self, uint32_t len, uint32_t us);
+
+/* keep the largest value seen */
+static inline void audio_stats_peak(uint32_t *peak, uint32_t val){
+    if(val > *peak){
+        *peak = val;
+    }
+}
+
+/* CSV column names (newline terminated), returns the length written */
+size_t audio_stats_csv_header(char *buf, size_t len);
+
+/* one CSV row (newline terminated) of every counter, led by the time it was taken at, returns the length written */
+size_t audio_stats_csv_row(const AudioStats *self, uint32_t time_ms, char *buf, size_t len);
+
+#endif /* INC_LIB_INC_AUDIO_STATS_H_ */
@@ -0,0 +1,89 @@
+/*
+ * click_detector.h
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Streaming sperm whale click detector that runs on the raw audio blocks.
+ *
+ *    Every channel goes through:
+ *      - a 2 kHz high-pass and a 24 kHz (or 0.45 fs) low-pass biquad, Q31 samples with Q30 coefficients (direct form I, 64-bit accumulator)
+ *      - a Teager-Kaiser energy operator, smoothed into an envelope (float, the M33 has an FPU)
+ *      - an adaptive threshold: a slow noise floor estimate (frozen during clicks) times a configurable factor
+ *    A click starts when the envelope crosses the threshold, ends once it falls under half the threshold (or after
+ *    CLICK_MAX_MS), and is followed by a CLICK_REFRACTORY_MS dead time so the multi-pulse structure of a click
+ *    is reported once.
+ *
+ *    The band-pass stage is written out in plain C instead of CMSIS-DSP (which isn't part of this tree).
+ */
+
+#ifndef INC_LIB_INC_CLICK_DETECTOR_H_
+#define INC_LIB_INC_CLICK_DETECTOR_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "Lib Inc/audio_codec.h"
+
+//Band edges
+#define CLICK_HIGHPASS_HZ 2000
+#define CLICK_LOWPASS_HZ 24000
+
+//Click timing
+#define CLICK_MAX_MS 5
+#define CLICK_REFRACTORY_MS 10
+
+//Noise floor time constant, and how long the floor settles before detection starts
+#define CLICK_FLOOR_MS 500
+#define CLICK_WARMUP_MS 100
+
+typedef struct {
+    uint32_t sequence;  //block the click started in
+    uint16_t frame;     //frame within that block
+    uint8_t channel;    //index into the enabled channels
+    uint32_t amplitude; //peak |band-passed sample|, Q31 full scale
+} ClickEvent;
+
+typedef struct {
+    int32_t b[3]; //Q30
+    int32_t a[2]; //Q30, a0 normalized out
+} ClickBiquad;
+
+typedef struct {
+    int32_t x[2][2]; //per stage input history (Q31)
+    int32_t y[2][2]; //per stage output history (Q31)
+    float tkeo_history[2];
+    float envelope;
+    float floor;
+
+    bool in_click;
+    uint32_t click_len;
+    uint32_t refractory;
+    uint32_t peak;
+    uint32_t start_sequence;
+    uint16_t start_frame;
+} ClickChannelState;
+
+typedef struct {
+    AudioCodecFormat format;
+    uint32_t sample_rate;
+    ClickBiquad stage[2];
+    float threshold_factor;
+    float floor_alpha;
+    uint32_t warmup;
+    uint32_t max_len;
+    uint32_t refractory_len;
+    uint32_t missed_events; //events that didn't fit in the caller's array
+    ClickChannelState ch[AUDIO_CODEC_MAX_CHANNELS];
+} ClickDetector;
+
+/* set up the filters and thresholds for a block layout & sample rate, threshold_db is how far above the noise floor a click has to be */
+void click_detector_init(ClickDetector *self, const AudioCodecFormat *format, uint32_t sample_rate, uint8_t threshold_db);
+
+/*
+ * Desc: run one block of raw frames (same layout as the temp buffer) through the detector.
+ *       Finished clicks are written to events (up to max_events), returns how many were written.
+ */
+size_t click_detector_process(ClickDetector *self, const uint8_t *block, size_t len, uint32_t sequence, ClickEvent *events, size_t max_events);
+
+#endif /* INC_LIB_INC_CLICK_DETECTOR_H_ */
@@ -0,0 +1,72 @@
+/*
+ * extent_file.h
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Raw sequential writes into a file's preallocated extent.
+ *
+ *    With the fault tolerant options this tree builds FileX with, every fx_file_write flushes the sector cache and
+ *    rewrites the file's directory entry, and writing past the allocated size walks and updates the FAT as well. For a
+ *    log that only ever appends, none of that is needed per write: as long as the file's clusters are one contiguous run,
+ *    the sector any byte lands in is known up front.
+ *
+ *    An extent file tracks how much of the file, from its start, sits in one run of sectors (the extent). Allocations go
+ *    through extent_file_allocate, which keeps the extent up to date. Writes that fit in the extent go straight to the
+ *    media driver as multi-sector writes at the computed sectors. A partial last sector is held back in carry until the
+ *    next write fills it. The directory entry (file size) is only written at checkpoints, so the steady state touches no
+ *    metadata at all.
+ *
+ *    Whole sectors that don't start on an FX_SD_BUFFER_ALIGN boundary (a record following a partial sector) are copied
+ *    through a bounce buffer of EXTENT_FILE_BOUNCE_SECTORS first, so the driver still gets multi-sector DMA writes rather
+ *    than falling back to its one sector scratch copy.
+ *
+ *    Once a write doesn't fit in the extent (the file outgrew its contiguous preallocation), the file is checkpointed and
+ *    switches to plain fx_file_write for good.
+ *
+ *    The file must be empty, opened for writing, and only written through here.
+ */
+
+#ifndef INC_LIB_INC_EXTENT_FILE_H_
+#define INC_LIB_INC_EXTENT_FILE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "app_filex.h"
+
+//Only media with this sector size are written raw
+#define EXTENT_FILE_SECTOR_SIZE 512
+
+//Sectors copied at a time for writes from unaligned buffers
+#define EXTENT_FILE_BOUNCE_SECTORS 8
+
+typedef struct {
+    FX_MEDIA *media;
+    FX_FILE *file;
+    bool raw;                   //still writing straight to the extent
+    ULONG64 extent_bytes;       //bytes from the start of the file that sit in one run of sectors
+    ULONG64 offset;             //bytes written, including carry (the file's real size)
+    ULONG sector;               //media sector the carry belongs in
+    ULONG carry_len;
+    uint8_t carry[EXTENT_FILE_SECTOR_SIZE] __attribute__((aligned(FX_SD_BUFFER_ALIGN)));   //last, partial sector
+} ExtentFile;
+
+/*
+ * Desc: check that every cluster of an open file sits in one run of sectors, and set first_sector to where it starts.
+ *       Returns false for a file with no clusters or one that is split up.
+ */
+bool extent_file_contiguous(FX_MEDIA *media, FX_FILE *file, ULONG *first_sector);
+
+/* start tracking a file that was just created & opened for writing */
+void extent_file_attach(ExtentFile *self, FX_MEDIA *media, FX_FILE *file);
+
+/* fx_file_extended_best_effort_allocate, keeping the extent up to date. Returns the FileX status. */
+UINT extent_file_allocate(ExtentFile *self, ULONG64 size, ULONG64 *allocated);
+
+/* append to the file, raw while it fits in the extent. Returns the FileX status. */
+UINT extent_file_write(ExtentFile *self, const void *data, ULONG len);
+
+/* put the carry on the media and the file size in the directory entry. Returns the FileX status. */
+UINT extent_file_checkpoint(ExtentFile *self);
+
+#endif /* INC_LIB_INC_EXTENT_FILE_H_ */
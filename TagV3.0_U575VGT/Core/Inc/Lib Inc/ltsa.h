@@ -0,0 +1,60 @@
+/*
+ * ltsa.h
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Long-term spectral average (LTSA) of the raw audio blocks.
+ *
+ *    Each channel is cut into LTSA_FFT_SIZE sample segments (non-overlapping, leftover frames at the end of a block
+ *    are skipped), Hann windowed and run through a radix-2 FFT. The one-sided power spectra are summed per channel
+ *    until the average is taken, which returns it in 0.01 dB relative to a full scale sine.
+ *
+ *    Loading a segment and transforming it are separate calls so a caller reading from a buffer that can be
+ *    overwritten under it (the DMA ring) can check the data was still valid after the copy, before it is used.
+ *
+ *    The FFT is plain C in single precision (the M33 has an FPU) instead of CMSIS-DSP, which isn't part of this tree.
+ */
+
+#ifndef INC_LIB_INC_LTSA_H_
+#define INC_LIB_INC_LTSA_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Lib Inc/audio_codec.h"
+
+//FFT length, must be a power of 2
+#define LTSA_FFT_SIZE 512
+
+//One-sided spectrum, DC to Nyquist
+#define LTSA_BINS ((LTSA_FFT_SIZE / 2) + 1)
+
+//Reported for empty bins/averages (0.01 dB)
+#define LTSA_DB_FLOOR (-30000)
+
+typedef struct {
+    AudioCodecFormat format;
+    float window[LTSA_FFT_SIZE];
+    float power_scale;                      //full scale sine = 1.0
+    float twiddle[LTSA_FFT_SIZE / 2][2];
+    float work[LTSA_FFT_SIZE][2];           //segment being transformed (real, imaginary)
+    float power[AUDIO_CODEC_MAX_CHANNELS][LTSA_BINS];
+    uint32_t segments[AUDIO_CODEC_MAX_CHANNELS];
+} Ltsa;
+
+/* set up the window & twiddle tables for a block layout */
+void ltsa_init(Ltsa *self, const AudioCodecFormat *format);
+
+/* copy LTSA_FFT_SIZE frames of one channel, starting at frame, from a raw block into the work buffer */
+void ltsa_segment_load(Ltsa *self, const uint8_t *block, size_t frame, uint8_t channel);
+
+/* transform the loaded segment and add its power spectrum to the channel's average */
+void ltsa_segment_accumulate(Ltsa *self, uint8_t channel);
+
+/*
+ * Desc: write a channel's average power spectrum (LTSA_BINS values, 0.01 dB re full scale) into bins and start a new average.
+ *       Returns the number of segments that went into the average.
+ */
+uint32_t ltsa_average_take(Ltsa *self, uint8_t channel, int16_t *bins);
+
+#endif /* INC_LIB_INC_LTSA_H_ */
@@ -0,0 +1,61 @@
+/*
+ * lz_block.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    General purpose LZ compression of one block of bytes, in the LZ4 block format so any LZ4 library on the host can
+ *    decompress it (e.g. lz4.block.decompress(data, uncompressed_size=n) in Python).
+ *
+ *    The compressor is the greedy single probe kind: one hash table of recent positions, no match search. It is meant for
+ *    the sensor logs (IMU, ECG, CSV side files), whose fixed size records repeat a lot of bytes from one record to the
+ *    next, and is cheap enough to keep up with USB. Audio is already compressed by its own codec (audio_codec.h).
+ *
+ ***** LZ4 block format ********************************
+ *
+ *  sequences, back to back:
+ *    u8   token: literal count (bits 4-7), match length - 4 (bits 0-3), 15 = more follows
+ *    literal count - 15, as 255 bytes and a final byte < 255 (only if the token says 15)
+ *    literals
+ *    u16  match offset back from the current position (little-endian, 1-65535)
+ *    match length - 19, as 255 bytes and a final byte < 255 (only if the token says 15)
+ *  the last sequence is only literals (no offset), and holds at least the last LZ_BLOCK_LAST_LITERALS bytes
+ *
+ **************************************************************/
+
+#ifndef INC_LIB_INC_LZ_BLOCK_H_
+#define INC_LIB_INC_LZ_BLOCK_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+//Hash table size (log2), positions are 16 bits so blocks are limited to LZ_BLOCK_MAX_INPUT
+#define LZ_BLOCK_HASH_BITS 12
+#define LZ_BLOCK_MAX_INPUT 65536
+
+//Format limits: shortest match, bytes at the end that are always literals, and how close to the end a match can start
+#define LZ_BLOCK_MIN_MATCH 4
+#define LZ_BLOCK_LAST_LITERALS 5
+#define LZ_BLOCK_MATCH_START_LIMIT 12
+
+//Largest output for n input bytes (nothing matched at all)
+#define LZ_BLOCK_BOUND(n) ((n) + ((n) / 255) + 16)
+
+//Compressor scratch, kept by the caller so nothing big goes on the stack
+typedef struct {
+    uint16_t table[1 << LZ_BLOCK_HASH_BITS];
+} LzBlockTable;
+
+/*
+ * Desc: compress len bytes (at most LZ_BLOCK_MAX_INPUT) into dst.
+ *       Returns the compressed length, or 0 if it doesn't fit in dst_capacity (store the block raw instead).
+ */
+size_t lz_block_compress(LzBlockTable *table, const uint8_t *src, size_t len, uint8_t *dst, size_t dst_capacity);
+
+/*
+ * Desc: decompress one block into dst.
+ *       Returns the decompressed length, or 0 if the block is corrupt or doesn't fit in dst_capacity.
+ */
+size_t lz_block_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_capacity);
+
+#endif /* INC_LIB_INC_LZ_BLOCK_H_ */
@@ -0,0 +1,146 @@
+/*
+ * offload.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Bulk offload protocol: an alternative to USB mass storage that streams whole log files front to back in large chunks,
+ *    optionally LZ compressed on the tag (Lib Inc/lz_block.h), instead of leaving the host to walk the FAT one sector read
+ *    at a time.
+ *
+ *    The host sends one request at a time and reads frames back until an END or ERROR frame. Every transfer is keyed by
+ *    file name and offset, so an interrupted one is resumed by asking for the same file again from the last offset whose
+ *    DATA frame checked out. DATA frames carry the CRC-32 of their raw (decompressed) bytes.
+ *
+ *    The engine only sees a byte stream transport and a file source (both sets of callbacks). The FileX file source is
+ *    in offload_fx.h. Requests and frames are packed/unpacked here for both ends.
+ *
+ *    Nothing on the tag serves it yet. It is meant for a USB CDC ACM interface next to mass storage while docked, which
+ *    needs the USBX CDC ACM class sources and descriptors generated into the project first (only the storage class is).
+ *
+ ***** request (host -> tag, OFFLOAD_REQUEST_SIZE bytes, little-endian) ***************
+ *
+ *  u32  magic (OFFLOAD_MAGIC)
+ *  u8   command (OffloadCommand)
+ *  u8   flags (OFFLOAD_FLAG_COMPRESS: compress DATA frames where it helps)
+ *  u16  reserved (0)
+ *  u64  offset to start reading from (READ)
+ *  char name[OFFLOAD_NAME_LEN], NUL padded (READ)
+ *  u32  CRC-32 of everything above
+ *
+ ***** frame (tag -> host, OFFLOAD_FRAME_HEADER_SIZE byte header + payload, little-endian) ***
+ *
+ *  u32  magic (OFFLOAD_MAGIC)
+ *  u8   type (OffloadFrameType)
+ *  u8   flags (OFFLOAD_FLAG_COMPRESSED: the payload is one LZ4 block)
+ *  u16  reserved (0)
+ *  u64  ENTRY/END: file size, DATA: file offset of the first byte, ERROR: 0
+ *  u32  DATA: raw byte count, ERROR: OffloadError, else 0
+ *  u32  payload length
+ *  u32  DATA: CRC-32 of the raw bytes, ENTRY: CRC-32 of the name
+ *  payload: ENTRY: the file name (no NUL), DATA: the (compressed) bytes
+ *
+ *  LIST answers one ENTRY per file in the root directory, then an END whose offset is the file count.
+ *  READ answers DATA frames up to the end of the file, then an END.
+ *
+ **************************************************************/
+
+#ifndef INC_LIB_INC_OFFLOAD_H_
+#define INC_LIB_INC_OFFLOAD_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "Lib Inc/lz_block.h"
+
+#define OFFLOAD_MAGIC 0x444C464FUL //"OFLD"
+#define OFFLOAD_NAME_LEN 64
+#define OFFLOAD_REQUEST_SIZE (20 + OFFLOAD_NAME_LEN)
+#define OFFLOAD_FRAME_HEADER_SIZE 28
+
+//Raw bytes per DATA frame
+#define OFFLOAD_CHUNK_SIZE (8 * 1024)
+
+//Request flags
+#define OFFLOAD_FLAG_COMPRESS 0x01
+
+//Frame flags
+#define OFFLOAD_FLAG_COMPRESSED 0x01
+
+typedef enum {
+    OFFLOAD_COMMAND_LIST = 1,
+    OFFLOAD_COMMAND_READ = 2,
+} OffloadCommand;
+
+typedef enum {
+    OFFLOAD_FRAME_ENTRY = 1,
+    OFFLOAD_FRAME_DATA = 2,
+    OFFLOAD_FRAME_END = 3,
+    OFFLOAD_FRAME_ERROR = 4,
+} OffloadFrameType;
+
+typedef enum {
+    OFFLOAD_ERROR_REQUEST = 1,  //bad magic/CRC or unknown command
+    OFFLOAD_ERROR_NOT_FOUND,    //no such file
+    OFFLOAD_ERROR_OFFSET,       //offset past the end of the file
+    OFFLOAD_ERROR_READ,         //the file couldn't be read
+} OffloadError;
+
+typedef struct {
+    uint8_t command;
+    uint8_t flags;
+    uint64_t offset;
+    char name[OFFLOAD_NAME_LEN + 1];    //always NUL terminated
+} OffloadRequest;
+
+typedef struct {
+    uint8_t type;
+    uint8_t flags;
+    uint64_t offset;
+    uint32_t raw_length;
+    uint32_t length;
+    uint32_t crc;
+} OffloadFrame;
+
+//Byte stream to the host. Both block until all len bytes have moved, and return false once the link is gone.
+typedef struct {
+    void *context;
+    bool (*receive)(void *context, uint8_t *data, uint32_t len);
+    bool (*send)(void *context, const uint8_t *data, uint32_t len);
+} OffloadTransport;
+
+//Files to offload
+typedef struct {
+    void *context;
+    bool (*next_entry)(void *context, bool first, char *name, size_t name_len, uint64_t *size); //false after the last file
+    bool (*open)(void *context, const char *name, uint64_t *size);
+    int32_t (*read)(void *context, uint64_t offset, uint8_t *data, uint32_t len);   //bytes read, < 0 on error
+    void (*close)(void *context);
+} OffloadFiles;
+
+typedef struct {
+    const OffloadTransport *transport;
+    const OffloadFiles *files;
+    LzBlockTable lz_table;
+    uint8_t header[OFFLOAD_FRAME_HEADER_SIZE];
+    uint8_t raw[OFFLOAD_CHUNK_SIZE];
+    uint8_t packed[LZ_BLOCK_BOUND(OFFLOAD_CHUNK_SIZE)];
+} OffloadSession;
+
+/* pack/unpack a request, unpack returns false if the magic or CRC is wrong */
+void offload_request_pack(const OffloadRequest *request, uint8_t *buf);
+bool offload_request_unpack(OffloadRequest *request, const uint8_t *buf);
+
+/* pack/unpack a frame header, unpack returns false if the magic is wrong */
+void offload_frame_pack(const OffloadFrame *frame, uint8_t *buf);
+bool offload_frame_unpack(OffloadFrame *frame, const uint8_t *buf);
+
+void offload_init(OffloadSession *self, const OffloadTransport *transport, const OffloadFiles *files);
+
+/*
+ * Desc: wait for one request and answer it.
+ *       Returns false once the transport fails, the caller should drop the session.
+ */
+bool offload_serve(OffloadSession *self);
+
+#endif /* INC_LIB_INC_OFFLOAD_H_ */
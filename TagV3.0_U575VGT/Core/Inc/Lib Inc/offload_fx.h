@@ -0,0 +1,25 @@
+/*
+ * offload_fx.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    FileX file source for the bulk offload protocol (offload.h): the files in the root directory of a media.
+ */
+
+#ifndef INC_LIB_INC_OFFLOAD_FX_H_
+#define INC_LIB_INC_OFFLOAD_FX_H_
+
+#include "app_filex.h"
+#include "Lib Inc/offload.h"
+
+typedef struct {
+    OffloadFiles files;     //hand this to offload_init
+    FX_MEDIA *media;
+    FX_FILE file;
+    CHAR name[FX_MAX_LONG_NAME_LEN];
+} OffloadFxFiles;
+
+void offload_fx_files_init(OffloadFxFiles *self, FX_MEDIA *media);
+
+#endif /* INC_LIB_INC_OFFLOAD_FX_H_ */
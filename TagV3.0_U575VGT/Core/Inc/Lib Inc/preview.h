@@ -0,0 +1,68 @@
+/*
+ * preview.h
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Low rate preview of one audio channel, for listening through a deployment without offloading the full rate data.
+ *
+ *    One channel of the raw blocks is low-pass filtered and decimated down to PREVIEW_RATE_HZ by a polyphase FIR
+ *    decimator: only every decimation-th output of the filter is computed, so each output costs
+ *    PREVIEW_TAPS_PER_PHASE taps per decimation step (windowed sinc, Blackman window) and the skipped outputs cost
+ *    nothing. The input history is kept twice back to back so every filter window is one contiguous run.
+ *    The output is 16-bit PCM, written after a PREVIEW_WAV_HEADER_SIZE WAV header so the files play as they are.
+ *
+ *    Single precision float, the M33 has an FPU.
+ */
+
+#ifndef INC_LIB_INC_PREVIEW_H_
+#define INC_LIB_INC_PREVIEW_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "Lib Inc/audio_codec.h"
+
+//Output rate, every supported recording rate is a whole multiple of it
+#define PREVIEW_RATE_HZ 12000
+
+//Filter length per decimation step, and the largest decimation (192 kHz)
+#define PREVIEW_TAPS_PER_PHASE 16
+#define PREVIEW_DECIMATION_MAX 16
+#define PREVIEW_TAPS_MAX ((PREVIEW_TAPS_PER_PHASE) * (PREVIEW_DECIMATION_MAX))
+
+//Low-pass cutoff as a fraction of the output rate
+#define PREVIEW_CUTOFF 0.42f
+
+//WAV header in front of the samples: RIFF, fmt and a JUNK chunk padding the samples out to start on a sector
+#define PREVIEW_WAV_HEADER_SIZE 512
+
+typedef struct {
+    AudioCodecFormat format;
+    uint8_t channel;                        //index into the channels of a frame
+    uint32_t decimation;
+    uint32_t tap_count;
+    float taps[PREVIEW_TAPS_MAX];           //taps[tap_count - 1] applies to the newest sample
+    float history[2 * PREVIEW_TAPS_MAX];    //last tap_count samples, twice
+    uint32_t pos;                           //oldest sample in the history
+    uint32_t countdown;                     //input samples until the next output
+} PreviewDecimator;
+
+/* set up the filter for a block layout & sample rate, returns false if the rate isn't a supported multiple of PREVIEW_RATE_HZ */
+bool preview_init(PreviewDecimator *self, const AudioCodecFormat *format, uint8_t channel, uint32_t sample_rate);
+
+/* most samples preview_process can output for frame_count input frames */
+static inline size_t preview_output_max(const PreviewDecimator *self, size_t frame_count){
+    return (frame_count / self->decimation) + 1;
+}
+
+/*
+ * Desc: run frame_count raw frames (same layout as the temp buffer) through the decimator, writing the preview samples to out.
+ *       Returns the number of samples written.
+ */
+size_t preview_process(PreviewDecimator *self, const uint8_t *frames, size_t frame_count, int16_t *out);
+
+/* fill in a PREVIEW_WAV_HEADER_SIZE byte header for data_bytes of mono 16-bit samples at PREVIEW_RATE_HZ */
+void preview_wav_header(uint8_t *header, uint32_t data_bytes);
+
+#endif /* INC_LIB_INC_PREVIEW_H_ */
@@ -0,0 +1,69 @@
+/*
+ * sd_bench.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    SD card storage benchmark, for qualifying cards and catching storage regressions between firmware versions.
+ *
+ *    Every test moves SD_BENCH_TEST_BYTES through a temporary file, one call per block, for each power of two block size
+ *    from SD_BENCH_BLOCK_MIN to SD_BENCH_BLOCK_MAX (or the caller's buffer size, if smaller):
+ *      - write, filex: fx_file_write into a preallocated file (the path every sensor log takes)
+ *      - write, raw:   extent_file_write into a preallocated extent (the path audio takes, see extent_file.h). When the
+ *                      card has no contiguous run that big the writes fall back to fx_file_write, and the row says raw_fallback.
+ *      - read,  filex: fx_file_read back from a file written beforehand
+ *    The time to the data being on the card (the last checkpoint/flush) counts towards the throughput, and every call's
+ *    duration goes in a histogram (the audio_stats.h bins) so the worst case latency and how often it happens are both
+ *    there.
+ *
+ *    One CSV row per test is appended to SD_BENCH_REPORT_NAME, tagged with the caller's run name and the SD bus divider
+ *    (sd_bus.h) it ran at, followed by the audio_stats columns (time_ms since the run started, writes are the calls).
+ *    Needs about SD_BENCH_TEST_BYTES free on the card.
+ *
+ *    The writes go straight to FileX, not through the storage thread (storage.h), and the numbers are only worth anything with
+ *    nothing else on the bus. sd_bench_boot runs it at boot from the FileX thread, after sd_bus_init and before the state
+ *    machine starts any capture thread, when config.txt has "sd_benchmark: enabled".
+ */
+
+#ifndef INC_LIB_INC_SD_BENCH_H_
+#define INC_LIB_INC_SD_BENCH_H_
+
+#include <stdint.h>
+#include "app_filex.h"
+#include "Lib Inc/audio_stats.h"
+
+//Block sizes tested, powers of two
+#define SD_BENCH_BLOCK_MIN 512
+#define SD_BENCH_BLOCK_MAX (512 * 1024)
+
+//Bytes moved per test (a multiple of SD_BENCH_BLOCK_MAX)
+#define SD_BENCH_TEST_BYTES (4 * 1024 * 1024)
+
+//Longest CSV row (or header), the test columns ahead of the audio_stats ones
+#define SD_BENCH_CSV_LINE_MAX ((AUDIO_STATS_CSV_LINE_MAX) + 128)
+
+#define SD_BENCH_FILE_NAME "sd_bench.tmp"
+#define SD_BENCH_REPORT_NAME "sd_bench.csv"
+
+//The benchmark gets its own thread for the length of the run, FileX calls plus newlib's snprintf need more than the FileX thread's 2kB
+#define SD_BENCH_THREAD_STACK_SIZE 4096
+#define SD_BENCH_THREAD_PRIO 2
+
+//Run names are the RTC time, "YYYYMMDD_HHMMSS"
+#define SD_BENCH_RUN_NAME_LEN 16
+
+/*
+ * Desc: run every test and append the results to the report.
+ *       buffer is the source/destination of every block, it must be FX_SD_BUFFER_ALIGN aligned and is overwritten.
+ *       Returns the FileX status of the first test that failed (the rest still run).
+ */
+UINT sd_bench_run(FX_MEDIA *media, uint8_t *buffer, ULONG buffer_len, const char *run);
+
+/*
+ * Desc: run the benchmark on its own thread if config.txt asks for it, and wait for it to finish. Call from the FileX thread
+ *       while nothing else is using the card. buffer is borrowed as in sd_bench_run.
+ *       Returns the result of the run (FX_SUCCESS if there was none).
+ */
+UINT sd_bench_boot(FX_MEDIA *media, uint8_t *buffer, ULONG buffer_len);
+
+#endif /* INC_LIB_INC_SD_BENCH_H_ */
@@ -0,0 +1,95 @@
+/*
+ * sd_bus.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    SD bus speed, per card: high speed negotiation and a clock divider for each tag state picked by measurement.
+ *
+ *    SDMMC1 runs from the 48 MHz CLK48 kernel clock, SDMMC_CK = 48 MHz / (2 * divider), or the full 48 MHz at divider 0.
+ *    Anything over 25 MHz needs the card switched to high speed timing first (CMD6), which every SDHC/SDXC card supports
+ *    but not every card (or every board) is stable at.
+ *
+ *    Once the media is open, sd_bus_init looks for a profile of the inserted card (keyed by its CID) in SD_BUS_PROFILE_NAME.
+ *    Without one, it switches the card to high speed, then tries each divider from the fastest down in a scratch file:
+ *      - capture: write a pattern at the divider, read it back at SD_BUS_REFERENCE_CLK_DIV and compare (the log writes)
+ *      - offload: write a pattern at SD_BUS_REFERENCE_CLK_DIV, read it back at the divider and compare (the host reads)
+ *    A divider passes with SD_BUS_TEST_ROUNDS clean rounds. Each state keeps the divider one step slower than the fastest
+ *    that passed (it has to pass too), the profile is saved, and every divider tried is appended to SD_BUS_LOG_NAME (with
+ *    the KB/s it did) so cards can be compared across the fleet.
+ *
+ *    A saved profile is checked on every mount with SD_BUS_CHECK_ROUNDS of each test at its dividers, and the card is
+ *    calibrated again if that fails. Delete the profile to calibrate regardless.
+ *
+ *    If the media didn't open, there's no room for the scratch file, or no divider passes, the tag keeps
+ *    SD_BUS_DEFAULT_*_CLK_DIV in default speed.
+ *
+ *    Switching dividers only touches the SDMMC clock register (the card stays in whatever timing it was switched to), with
+ *    the media protection held so it never lands in the middle of a transfer.
+ */
+
+#ifndef INC_LIB_INC_SD_BUS_H_
+#define INC_LIB_INC_SD_BUS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "app_filex.h"
+
+//Dividers used without a profile (what the tag always ran at before)
+#define SD_BUS_DEFAULT_CAPTURE_CLK_DIV 2
+#define SD_BUS_DEFAULT_OFFLOAD_CLK_DIV 6
+
+//Known good divider the other half of each test runs at
+#define SD_BUS_REFERENCE_CLK_DIV 6
+
+//Test transfers: rounds per divider, each of SD_BUS_TEST_BURSTS bursts of SD_BUS_TEST_BLOCKS blocks
+#define SD_BUS_TEST_ROUNDS 4
+#define SD_BUS_TEST_BURSTS 8
+#define SD_BUS_TEST_BLOCKS 16
+
+//Rounds of the check a saved profile gets on mount
+#define SD_BUS_CHECK_ROUNDS 1
+
+//Longest a test transfer may take before the divider counts as failed
+#define SD_BUS_TEST_TIMEOUT_MS 500
+
+//Calibration gets its own thread while it runs, FileX calls plus newlib's snprintf need more than the FileX thread's 2kB
+#define SD_BUS_THREAD_STACK_SIZE 4096
+#define SD_BUS_THREAD_PRIO 2
+
+#define SD_BUS_PROFILE_NAME "sd_bus.bin"
+#define SD_BUS_LOG_NAME "sd_bus.csv"
+#define SD_BUS_SCRATCH_NAME "sd_bus_test.bin"
+
+typedef enum {
+    SD_BUS_CAPTURE = 0,
+    SD_BUS_OFFLOAD,
+    SD_BUS_NUM_MODES
+} SdBusMode;
+
+//What's saved per card
+typedef struct {
+    uint32_t magic;
+    uint32_t cid[4];
+    uint32_t kernel_hz;                         //a clock tree change invalidates the profile
+    uint8_t high_speed;
+    uint8_t clock_div[SD_BUS_NUM_MODES];
+    uint8_t reserved;
+    uint32_t kbps[SD_BUS_NUM_MODES];            //throughput measured at the picked divider, KB/s
+    uint32_t crc;
+} SdBusProfile;
+
+/*
+ * Desc: pick the bus speed for the inserted card (from its profile, or by calibrating) and switch to the capture divider.
+ *       Call once from the FileX thread after the media is opened, before anything else uses the card. The work runs on
+ *       a thread of its own, and this returns once it's done.
+ */
+void sd_bus_init(FX_MEDIA *media);
+
+/* switch the bus to the divider picked for a tag state */
+void sd_bus_apply(SdBusMode mode);
+
+/* the profile in use (the defaults until sd_bus_init has run) */
+const SdBusProfile *sd_bus_profile(void);
+
+#endif /* INC_LIB_INC_SD_BUS_H_ */
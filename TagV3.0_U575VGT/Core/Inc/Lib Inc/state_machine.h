@@ -22,9 +22,6 @@
 #define STATE_USB_DISCONNECTED_FLAG 0x10
 #define STATE_TAG_RELEASED 0x20
 
-#define DATA_OFFLOADING_SD_CLK_DIV 6
-#define NORMAL_SD_CLK_DIV 2
-
 
 #define ALL_STATE_FLAGS (STATE_TIMEOUT_FLAG | STATE_GPS_FLAG | STATE_LOW_BATT_FLAG | STATE_USB_CONNECTED_FLAG | STATE_USB_DISCONNECTED_FLAG | STATE_TAG_RELEASED)
 
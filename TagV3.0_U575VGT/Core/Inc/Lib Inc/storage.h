@@ -0,0 +1,92 @@
+/*
+ * storage.h
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Storage service thread: the one thread that writes to the SD card, on behalf of every data stream (audio, IMU, ECG).
+ *
+ *    Each stream submits one request at a time through a shared ThreadX queue and sleeps on its own semaphore until the
+ *    request is done, so writes never interleave and no writer has to poll. Urgent streams (audio) go to the front of the
+ *    queue, ahead of anything already waiting; the write in progress always finishes first.
+ *
+ *    Streams can have a batch buffer. Their writes are copied into it and only go to the card as whole batches (a multiple
+ *    of STORAGE_SECTOR_SIZE), so small, oddly sized sensor writes become a few large sector-aligned ones. A write that
+ *    doesn't fill the batch completes as soon as it has been copied. Whatever is left in a batch has to be flushed
+ *    before its file is closed. A batch is only emptied once it has been written, so after a failed write it's tried again
+ *    by the stream's next write or flush, and the error goes back to the stream that submitted the request.
+ *
+ *    Writes can also go to an extent file (Lib Inc/extent_file.h), which the storage thread writes raw into its preallocated
+ *    sectors, and so can extent checkpoints.
+ *
+ *    Other FileX calls (open, close, seek, allocate) are still made by the streams themselves, FileX serializes them.
+ *
+ *    Call storage_init() once before the storage thread or any stream starts.
+ */
+
+#ifndef INC_LIB_INC_STORAGE_H_
+#define INC_LIB_INC_STORAGE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tx_api.h"
+#include "app_filex.h"
+#include "Lib Inc/extent_file.h"
+
+//Requests that can wait at once, one per stream is enough
+#define STORAGE_QUEUE_DEPTH 8
+
+//Batches are a whole number of these
+#define STORAGE_SECTOR_SIZE 512
+
+typedef enum {
+    STORAGE_OP_WRITE,
+    STORAGE_OP_FLUSH,
+    STORAGE_OP_EXTENT_WRITE,
+    STORAGE_OP_EXTENT_CHECKPOINT,
+} StorageOp;
+
+typedef struct storage_stream_s {
+    bool urgent;                //requests go in front of everything queued
+    uint8_t *batch;             //NULL to write straight through
+    ULONG batch_size;
+    ULONG batch_len;            //bytes waiting in the batch
+
+    //The request in flight, only touched by the storage thread until done is given
+    StorageOp op;
+    FX_FILE *file;
+    ExtentFile *extent;
+    const uint8_t *data;
+    ULONG len;
+    UINT status;
+    TX_SEMAPHORE done;
+} StorageStream;
+
+/* create the request queue, before anything else here is used */
+void storage_init(void);
+
+/* set up a stream, batch_size has to be a multiple of STORAGE_SECTOR_SIZE (ignored without a batch) */
+void storage_stream_init(StorageStream *self, CHAR *name, uint8_t *batch, ULONG batch_size, bool urgent);
+
+/* free a stream's semaphore, once nothing is in flight */
+void storage_stream_delete(StorageStream *self);
+
+/*
+ * Desc: write len bytes to a file and wait until they are written (or batched). A batched stream always writes to the same file.
+ *       Returns the FileX status.
+ */
+UINT storage_write(StorageStream *self, FX_FILE *file, const void *data, ULONG len);
+
+/* write out whatever is left in a stream's batch, returns the FileX status */
+UINT storage_flush(StorageStream *self, FX_FILE *file);
+
+/* write len bytes to an extent file (never batched) and wait until they are written, returns the FileX status */
+UINT storage_extent_write(StorageStream *self, ExtentFile *extent, const void *data, ULONG len);
+
+/* checkpoint an extent file and wait until it's done, returns the FileX status */
+UINT storage_extent_checkpoint(StorageStream *self, ExtentFile *extent);
+
+/* the storage thread */
+void storage_thread_entry(ULONG thread_input);
+
+#endif /* INC_LIB_INC_STORAGE_H_ */
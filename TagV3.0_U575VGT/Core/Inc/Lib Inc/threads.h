@@ -25,6 +25,7 @@
 #include "Sensor Inc/GpsGeofencing.h"
 #include "Sensor Inc/ECG_SD.h"
 #include "Lib Inc/state_machine.h"
+#include "Lib Inc/storage.h"
 #include "Recovery Inc/Aprs.h"
 #include "Recovery Inc/Burnwire.h"
 
@@ -40,6 +41,8 @@ typedef enum __TX_THREAD_LIST {
 	GPS_THREAD,
 	APRS_THREAD,
 	BURNWIRE_THREAD,
+	AUDIO_LTSA_THREAD,
+	STORAGE_THREAD,
 	NUM_THREADS //DO NOT ADD THREAD ENUMS BELOW THIS
 }Thread;
 
@@ -173,6 +176,30 @@ static Thread_ConfigTypeDef threadConfigList[NUM_THREADS] = {
 				.preempt_threshold = 10,
 				.timeslice = TX_NO_TIME_SLICE,
 				.start = TX_DONT_START
+		},
+		[AUDIO_LTSA_THREAD] = {
+				//Audio LTSA Thread (background analysis, must stay below every thread that writes data)
+				.thread_name = "Audio LTSA Thread",
+				.thread_entry_function = audio_ltsa_thread_entry,
+				.thread_input = 0x1234,
+				.thread_stack_size = 1024,
+				.priority = 13,
+				.preempt_threshold = 13,
+				.timeslice = TX_NO_TIME_SLICE,
+				.start = TX_DONT_START
+		},
+		[STORAGE_THREAD] = {
+				//Storage Thread (does every SD card write, above the sensors it writes for). Level with audio on purpose: audio
+				//sleeps while its writes are in flight, and a sensor's write waits for audio's block in progress instead of
+				//preempting it. The queue still puts audio's writes ahead of theirs.
+				.thread_name = "Storage Thread",
+				.thread_entry_function = storage_thread_entry,
+				.thread_input = 0x1234,
+				.thread_stack_size = 2048,
+				.priority = 3,
+				.preempt_threshold = 3,
+				.timeslice = TX_NO_TIME_SLICE,
+				.start = TX_DONT_START
 		}
 };
 
@@ -11,6 +11,7 @@
 #define INC_LIB_INC_TIMING_H_
 
 #include "tx_user.h"
+#include "stm32u5xx_hal.h"
 
 //A macro for converting seconds to threadX ticks. This can be used to feed into software timers, task sleeps, etc.
 #define tx_s_to_ticks(S) ((S) * (TX_TIMER_TICKS_PER_SECOND))
@@ -21,4 +22,17 @@
 //A macro for converting microseconds to threadX ticks. This can be used to feed into software timers, task sleeps, etc.
 #define tx_us_to_ticks(US) ((US) * (TX_TIMER_TICKS_PER_SECOND) / 1000000)
 
+//Start the DWT cycle counter, for timing anything shorter than a tick. Called from main() before the kernel starts: the
+//ThreadX port only sets CYCCNTENA, which does nothing until the trace block (TRCENA) is on, and only a debugger does that.
+static inline void cycle_counter_init(void){
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+//Microseconds since a cycle counter reading. The counter wraps every ~25s at full clock, far longer than anything timed with it.
+static inline uint32_t cycle_counter_us_since(uint32_t start){
+    return (DWT->CYCCNT - start) / (SystemCoreClock / 1000000);
+}
+
 #endif /* INC_LIB_INC_TIMING_H_ */
@@ -15,6 +15,9 @@
  *  This process is continuously repeated through a circular buffer.
  *
  *  Essentially, this tries to "mock" a circular DMA buffer using RTOS threads and a mutex
+ *
+ *  The writes go through the storage thread (storage.h), batched into IMU_SD_BATCH_SIZE chunks so the SD card sees a few
+ *  large sector-aligned writes instead of one small one per half buffer.
  */
 
 #ifndef INC_SENSOR_INC_BNO08X_SD_H_
@@ -23,6 +26,9 @@
 #include "Sensor Inc/BNO08x.h"
 #include "tx_api.h"
 
+//Bytes collected before they are written to the SD card, a whole number of sectors
+#define IMU_SD_BATCH_SIZE (8 * 1024)
+
 void imu_sd_thread_entry(ULONG thread_input);
 
 #endif /* INC_SENSOR_INC_BNO08X_SD_H_ */
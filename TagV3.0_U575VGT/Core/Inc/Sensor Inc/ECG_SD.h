@@ -15,6 +15,9 @@
  *  This process is continuously repeated through a circular buffer.
  *
  *  Essentially, this tries to "mock" a circular DMA buffer using RTOS threads and a mutex
+ *
+ *  The writes go through the storage thread (storage.h), batched into ECG_SD_BATCH_SIZE chunks so the SD card sees a few
+ *  large sector-aligned writes instead of one small one per half buffer.
  */
 #ifndef INC_SENSOR_INC_ECG_SD_H_
 #define INC_SENSOR_INC_ECG_SD_H_
@@ -22,6 +25,9 @@
 #include "Sensor Inc/ECG.h"
 #include "tx_api.h"
 
+//Bytes collected before they are written to the SD card, a whole number of sectors
+#define ECG_SD_BATCH_SIZE (8 * 1024)
+
 //Our thread entry for the ECG sd card writing thread
 void ecg_sd_thread_entry(ULONG thread_input);
 
@@ -118,6 +118,16 @@
 
 #define AD7768_CLK_MAX_HZ	34000000
 
+//MCLK fitted on the tag (192 kHz = MCLK / 4 / 32)
+#define AD7768_MCLK_HZ		24576000
+
+//Minimum CS high time between SPI frames (ns)
+#define AD7768_CS_GAP_NS	100
+
+//Writable configuration registers kept in the shadow (CH_STANDBY .. INTERFACE_CFG)
+#define AD7768_SHADOW_REG_FIRST		AD7768_REG_CH_STANDBY
+#define AD7768_SHADOW_REG_LAST		AD7768_REG_INTERFACE_CFG
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -293,6 +303,11 @@ typedef struct {
 	ad7768_Reg_DataControl  data_control;
 	ad7768_Reg_InterfaceCfg interface_config;
 
+	// The register structs above are the shadow of the device's configuration registers.
+	// Setters only update the shadow and mark the register dirty; outside of a batch the dirty register is written straight away,
+	// inside one (ad7768_batch_begin) every change is held back and written in one go by ad7768_batch_apply.
+	uint16_t dirty;	// bit n = register n differs from the device
+	bool batch;
 
 } ad7768_dev;
 
@@ -369,6 +384,10 @@ HAL_StatusTypeDef ad7768_set_ch_mode(ad7768_dev *dev,
 HAL_StatusTypeDef ad7768_get_ch_mode(ad7768_dev *dev,
 			   ad7768_ch ch,
 			   ad7768_ch_mode *mode);
+/* Hold back register writes until ad7768_batch_apply. */
+void ad7768_batch_begin(ad7768_dev *dev);
+/* Write every changed register, back to back. */
+HAL_StatusTypeDef ad7768_batch_apply(ad7768_dev *dev);
 /* Initialize the device. */
 HAL_StatusTypeDef ad7768_setup(ad7768_dev *dev);
 
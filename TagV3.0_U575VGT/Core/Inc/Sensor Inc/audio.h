@@ -6,9 +6,51 @@
  *
  * This file is responsible for getting the Audio data from the ADC (ad7768) and writing to the SD card
  *
- * The audio data comes in through the SAI (Serial-Audio Interface) through DMA, and then is written to a temporary buffer. Once the temporary buffer fills, we write to the SD card
+ * The audio data comes in through the SAI (Serial-Audio Interface) through DMA, and is written directly into a temporary buffer. Each filled block is pushed onto a
+ * single-producer/single-consumer queue, and the audio thread writes queued blocks to the SD card in batches.
  *
- * Due to limitations by STM32, the DMA buffer is not large enough (They only allow 16-bit length values). This is why we introduced the larger temporary buffer, which is about 10x the size of the DMA buffer.
+ * Due to limitations by STM32, a single DMA transfer is not large enough (They only allow 16-bit length values). Instead of copying out of a small DMA buffer,
+ * the GPDMA runs a circular linked-list with one node per temporary buffer block, so each block is filled in place and the SAI callback only advances an index.
+ *
+ * Optionally, each block is losslessly compressed (Lib Inc/audio_codec.h) into a staging buffer as it is taken off the queue, and the staging buffer is written out
+ * once the next block might not fit. Compressed blocks are self-describing and written back to back.
+ *
+ * With dithering enabled for 16-bit audio, the SAI captures 24-bit samples and each block is repacked (Lib Inc/audio_repack.h) to dithered 16-bit on its
+ * way into the staging buffer (before compression, if that is on too). Everything reading the temp buffer directly (click detector, LTSA) sees the captured layout.
+ *
+ * With ADC CRCs enabled, the ADC sends a CRC in place of every 4th/16th header. Each block is checked (Lib Inc/audio_crc.h) as it is added to a record,
+ * and its mismatch count goes in its block entry.
+ *
+ * The SD card writes themselves are done by the storage thread (Lib Inc/storage.h), audio requests go ahead of the other sensors' writes.
+ *
+ * Every write goes out as a record (Lib Inc/audio_file.h): a one sector header with the audio settings, RTC time, and the sequence number and capture tick of
+ * each block in it, followed by the blocks themselves. Gaps in the sequence numbers mark dropped blocks.
+ *
+ * Audio is split over multiple files, a new one is started once the current one reaches the configured duration or size. The next file is always created ahead of
+ * time and both files are preallocated a chunk at a time while the writer is idle, so a rollover in the middle of a write is only a pointer swap. The finished
+ * file is checkpointed, closed and renamed, and the file after the new one created, the next time the writer is idle.
+ * Files are written as "audio_<session start>_<sequence>.tmp" and renamed to "audio_<file start>_<sequence>.bin" when they are closed.
+ * While a file's preallocation is one contiguous run, records are written raw into it (Lib Inc/extent_file.h): whole sector runs straight to the card, with no FAT
+ * or directory updates. The file size is only checkpointed every AUDIO_FILE_CHECKPOINT_S and when the file is closed, a reader of a file cut short in between
+ * can still find the records past its size since every record describes itself.
+ *
+ * When enabled, the writer also runs each block through the click detector (Lib Inc/click_detector.h) before writing it, and logs every detected click to a
+ * "clicks_<session start>.bin" index file: back to back AudioClickIndexEntry records, so clicks can be found in the audio files by block sequence number.
+ *
+ * In triggered mode the writer only writes while a trigger (a detected click) is active, plus a hold time after the last one.
+ * While idle it still takes every block off the queue to run the detector, but only keeps the newest few queued as the pre-trigger window. The queue slack
+ * in temp_buffer is the pre-trigger ring, so no extra memory is needed; the window is capped so a trigger still leaves a full write batch of headroom.
+ *
+ * Optionally, a low priority LTSA thread averages the spectrum of each channel (Lib Inc/ltsa.h) into a "ltsa_<session start>_ch<n>.bin" file per channel.
+ * It reads the temp buffer blocks in place without holding them: it never delays the writer handing blocks back, it just skips data the DMA has
+ * already started to overwrite. Its rows are handed to the audio thread to write, so it never holds the SD card either.
+ *
+ * Optionally, the first recorded channel is also decimated to 12 kHz (Lib Inc/preview.h) as the writer scans each block, and written to a
+ * "preview_<file start>_<sequence>.wav" file alongside each audio file, small enough to listen through a whole deployment right after recovery.
+ * In triggered mode the preview keeps running between triggers, so it covers the untriggered time as well.
+ *
+ * Every write is timed with the DWT cycle counter into a histogram (Lib Inc/audio_stats.h), alongside the worst block-to-disk latency, queue
+ * and staging peaks and lost blocks. The counters are appended as a CSV row to "stats_<session start>.csv" every AUDIO_STATS_INTERVAL_S.
  *
  * SD card writes can take some time to setup, so limiting the number of writes (and increasing the quantity of each write) can help reduce the time servicing the audio task.
  *
@@ -16,34 +58,163 @@
  * ADC Datasheet: https://www.analog.com/media/en/technical-documentation/data-sheets/ad7768-7768-4.pdf
  */
 #include <stdint.h>
+#include <stddef.h>
 #include "main.h"
 #include "ad7768.h"
 #include "config.h"
 #include "app_filex.h"
+#include "Lib Inc/audio_codec.h"
+#include "Lib Inc/audio_crc.h"
+#include "Lib Inc/audio_file.h"
+#include "Lib Inc/audio_repack.h"
+#include "Lib Inc/audio_stats.h"
+#include "Lib Inc/click_detector.h"
+#include "Lib Inc/extent_file.h"
+#include "Lib Inc/ltsa.h"
+#include "Lib Inc/preview.h"
+#include "Lib Inc/storage.h"
 
 #define AUDIO_CIRCULAR_BUFFER_SIZE_MAX (UINT16_MAX/2)
 #define AUDIO_CIRCULAR_BUFFER_SIZE  (32256)
 
-//ThreadX flag bits to show when the buffer is half full or completely full
-#define AUDIO_BUFFER_HALF_FULL_FLAG 0x1
-#define AUDIO_BUFFER_FULL_FLAG 0x2
+//Every block has to be a whole number of SD sectors and of frames, for every layout the tag config can pick
+//(1-4 channels of 2-3 sample bytes, with or without the 1 byte header: 2 to 16 byte frames), so dropping
+//channels or headers only shrinks the frames and never changes the block geometry.
+//lcm(512, 144) = 4608 covers all of them (144 being the lcm of the frame sizes). It also keeps whole ADC CRC groups in every block.
+#define AUDIO_SECTOR_SIZE 512
+#define AUDIO_BLOCK_ALIGN (4608)
+_Static_assert((AUDIO_CIRCULAR_BUFFER_SIZE % AUDIO_BLOCK_ALIGN) == 0, "audio blocks must hold whole sectors and whole frames of every layout");
+_Static_assert((AUDIO_BLOCK_ALIGN % AUDIO_SECTOR_SIZE) == 0, "audio block alignment must be a whole number of sectors");
+_Static_assert(((AUDIO_BLOCK_ALIGN / 16) % AUDIO_CRC_INTERVAL_MAX) == 0, "audio blocks must hold whole ADC CRC groups");
+
+//ThreadX flag bit to show the block queue has reached the write batch size
+#define AUDIO_BLOCKS_READY_FLAG 0x1
 
 //ThreadX flag to stop the audio sensor (exit data collection)
 #define AUDIO_STOP_THREAD_FLAG 0x4
 
-//Do not change
-#define DMA_BUF_BLOCK_LENGTH 2
+//ThreadX flag bit for the LTSA thread, set for every completed block
+#define AUDIO_LTSA_BLOCK_FLAG 0x1
 
 //Number of blocks the temp buffer should use. This MUST be an even number.
 #define TEMP_BUF_BLOCK_LENGTH 18
 
 #define TEMP_BUF_HALF_BLOCK_LENGTH ((TEMP_BUF_BLOCK_LENGTH) / 2)
 
-typedef enum {
-    AUDIO_BUF_STATE_EMPTY,
-    AUDIO_BUF_STATE_HALF_FULL,
-    AUDIO_BUF_STATE_FULL,
-} AudioBufferState;
+//Number of queued blocks that wakes the writer. Anything beyond this is slack for absorbing SD card latency spikes.
+#define AUDIO_WRITE_BATCH_BLOCKS (TEMP_BUF_HALF_BLOCK_LENGTH)
+
+//The DMA is always filling the block after the newest one, so one slot of the ring can never be handed to the writer
+#define AUDIO_QUEUE_MAX_DEPTH ((TEMP_BUF_BLOCK_LENGTH) - 1)
+
+//Audio file names & preallocation
+#define AUDIO_FILE_NAME_LEN 40
+#define AUDIO_FILE_STAMP_LEN 16 //"YYYYMMDD_HHMMSS"
+#define AUDIO_FILE_ALLOCATE_CHUNK (4UL * 1024 * 1024)
+#define AUDIO_FILE_SIZE_MAX ((ULONG64)CFG_AUDIO_FILE_MEGABYTES_MAX * 1024 * 1024)
+#define AUDIO_FILE_CHECKPOINT_S 10
+
+//Click index (one sector of entries is buffered before it is written out)
+#define AUDIO_CLICK_FILE_NAME_LEN 32
+#define AUDIO_CLICK_INDEX_ENTRIES ((AUDIO_FILE_HEADER_SIZE) / sizeof(AudioClickIndexEntry))
+#define AUDIO_CLICK_EVENTS_PER_BLOCK 32
+
+//LTSA file names
+#define AUDIO_LTSA_FILE_NAME_LEN 32
+
+//Preview file names & the samples buffered before they are written out (8 sectors)
+#define AUDIO_PREVIEW_FILE_NAME_LEN 40
+#define AUDIO_PREVIEW_BUFFER_SAMPLES 2048
+
+//Write path statistics file name & how often a row is added
+#define AUDIO_STATS_FILE_NAME_LEN 32
+#define AUDIO_STATS_INTERVAL_S 60
+
+//Triggered recording: the pre-trigger window has to leave the same headroom as a normal write batch
+#define AUDIO_TRIGGER_PRE_BLOCKS_MAX ((AUDIO_QUEUE_MAX_DEPTH) - (AUDIO_WRITE_BATCH_BLOCKS))
+
+//Bits the ADC sends per sample period: 4 channel slots of 32 bits, standby channels included
+#define AUDIO_ADC_FRAME_BITS 128
+
+//Compression staging buffer, always holds at least one worst case (incompressible) block
+#define AUDIO_COMPRESS_BUFFER_SIZE ((AUDIO_CIRCULAR_BUFFER_SIZE) + (AUDIO_CODEC_MAX_OVERHEAD))
+_Static_assert(AUDIO_COMPRESS_BUFFER_SIZE <= UINT16_MAX, "audio file block entries store block lengths in 16 bits");
+
+//Repacked block ahead of compression, the largest one is 24-bit with headers to 16-bit with headers (4 to 3 bytes per sample)
+#define AUDIO_REPACK_BUFFER_SIZE (((AUDIO_CIRCULAR_BUFFER_SIZE) / 4) * 3)
+
+//One way of running the ADC: a power mode with its MCLK divider, and the decimation that gives rate_hz from it
+typedef struct {
+    uint32_t rate_hz;
+    ad7768_power_mode power_mode;
+    ad7768_mclk_div mclk_div;
+    ad7768_dec_rate dec_rate;
+} AudioRateSetting;
+
+//Single-producer/single-consumer ring over the temp buffer blocks.
+//Indices are free running (block = index % TEMP_BUF_BLOCK_LENGTH), so head - tail is the queue depth even across wrap-around.
+typedef struct audio_block_queue_s {
+    volatile uint32_t head; //blocks completed by the DMA, only written by the SAI callback
+    volatile uint32_t tail; //blocks consumed by the writer, only written by the audio thread
+
+    uint32_t dropped_blocks; //blocks overwritten before (or while) they were written out, only written by the audio thread
+    uint32_t peak_depth;     //deepest the queue has been, only written by the SAI callback
+
+    uint32_t block_ticks[TEMP_BUF_BLOCK_LENGTH]; //ThreadX tick each block was completed at, only written by the SAI callback
+} AudioBlockQueue;
+
+//Click index file entry (little-endian)
+typedef struct __attribute__((packed)) audio_click_index_entry_s {
+    uint32_t tick;      //ThreadX tick the click started at
+    uint32_t sequence;  //audio block the click starts in, matches the block entries of the audio records
+    uint16_t frame;     //frame within that block
+    uint8_t channel;    //index into the recorded channels
+    uint8_t reserved;
+    uint32_t amplitude; //peak band-passed amplitude, Q31 full scale
+} AudioClickIndexEntry;
+
+//Triggered recording state
+typedef struct audio_trigger_s {
+    bool enabled;
+    bool clicks;            //detected clicks start/extend a trigger
+    uint32_t pre_blocks;    //blocks kept from before a trigger
+    ULONG hold_ticks;       //keep recording this long after the last trigger
+    bool active;
+    ULONG hold_until;       //tick the current trigger runs out at
+} AudioTrigger;
+
+//LTSA file row (little-endian), one per averaging interval. Naturally aligned, AUDIO_LTSA_ROW_SIZE bytes of it go to the file.
+typedef struct audio_ltsa_row_s {
+    uint32_t tick;          //ThreadX tick at the end of the interval
+    uint32_t sequence;      //first block of the interval
+    uint16_t segments;      //FFT segments averaged, fewer than the interval holds if the LTSA thread fell behind
+    uint16_t bin_count;     //LTSA_BINS
+    uint32_t sample_rate;
+    int16_t bins[LTSA_BINS]; //power, 0.01 dB re full scale, DC to Nyquist
+} AudioLtsaRow;
+
+#define AUDIO_LTSA_ROW_SIZE (offsetof(AudioLtsaRow, bins) + sizeof(((AudioLtsaRow *)0)->bins))
+_Static_assert(offsetof(AudioLtsaRow, bins) == 16, "LTSA row header must stay 16 bytes without padding");
+
+//Audio file rollover state
+typedef struct audio_file_rotation_s {
+    FX_MEDIA *media;
+    uint32_t sequence;              //sequence number of the current file
+    uint32_t next_sequence;         //sequence number of the next file
+    ULONG start_tick;               //ThreadX tick the current file started at
+    ULONG checkpoint_tick;          //ThreadX tick the current file's size was last checkpointed at
+    ULONG duration_ticks;           //start a new file after this long, 0 = no time limit
+    ULONG64 size_limit;             //start a new file before the current one grows past this
+    ULONG64 prealloc_size;          //bytes to preallocate for every file
+    bool prealloc_stalled;          //stop preallocating once the card can't give us any more clusters
+    bool retire_pending;            //the file before the current one is still open in the next file's place, waiting to be finished
+    uint32_t retired_sequence;      //sequence number of that file
+    char session_stamp[AUDIO_FILE_STAMP_LEN];   //time recording started, keeps temporary names unique
+    char start_stamp[AUDIO_FILE_STAMP_LEN];     //time the current file started
+    char retired_stamp[AUDIO_FILE_STAMP_LEN];   //time the file waiting to be finished started
+    char name[AUDIO_FILE_NAME_LEN];             //temporary name of the current file
+    char next_name[AUDIO_FILE_NAME_LEN];        //temporary name of the next file (or the one waiting to be finished)
+} AudioFileRotation;
 
 typedef struct audio_manager_s {
     /*Analog to Digital Converter*/
@@ -51,22 +222,79 @@ typedef struct audio_manager_s {
     SAI_HandleTypeDef *sai;
 
     /*Memory DMA Transfer Variables*/
-    AudioBufferState buffer_state;
     size_t sample_size;
     size_t channel_count;
+    size_t frames_per_block;    //frames in one temp buffer block for the captured layout
+
+    //Temp buffer (DMA destination, one linked-list node per block) & the queue handing its blocks to the writer
+    uint8_t temp_buffer[TEMP_BUF_BLOCK_LENGTH][AUDIO_CIRCULAR_BUFFER_SIZE] __attribute__((aligned(FX_SD_BUFFER_ALIGN)));
+    AudioBlockQueue queue;
 
-    //DMA buffer
-    uint8_t audio_buffer[DMA_BUF_BLOCK_LENGTH][AUDIO_CIRCULAR_BUFFER_SIZE];
+    //Lossless compression (only used if enabled in the tag config). The staging buffer also collects repacked blocks when not compressing.
+    bool compress;
+    AudioCodecFormat codec_format;      //stored layout
+    uint8_t compress_buffer[AUDIO_COMPRESS_BUFFER_SIZE] __attribute__((aligned(FX_SD_BUFFER_ALIGN)));
 
-    //Temp buffer & its index tracker
-    uint8_t temp_buffer[TEMP_BUF_BLOCK_LENGTH][AUDIO_CIRCULAR_BUFFER_SIZE];
-    uint8_t temp_counter;
+    //Dithered 16-bit (only used if enabled in the tag config), blocks are captured as capture_format and repacked to codec_format
+    bool repack;
+    AudioCodecFormat capture_format;    //layout in temp_buffer
+    AudioRepack repacker;
+    uint8_t repack_buffer[AUDIO_REPACK_BUFFER_SIZE];
 
-    //Flag to show SD card has been written to
-    bool sd_write_complete;
+    //ADC interface CRC checks (only used if enabled in the tag config), every recorded block is checked as it is added to a record
+    bool check_crc;
+    AudioCrc adc_crc;
+
+    //Every block is scanned (click detector, preview) once, as the writer takes it off the queue
+    uint32_t block_scanned; //sequence of the next block that hasn't been scanned
+
+    //Click detection (runs if the click index or click triggers are enabled in the tag config)
+    bool detect_clicks;
+    bool log_clicks;
+    ClickDetector click_detector;
+    ClickEvent click_events[AUDIO_CLICK_EVENTS_PER_BLOCK];
+    AudioClickIndexEntry click_index[AUDIO_CLICK_INDEX_ENTRIES] __attribute__((aligned(4)));
+    uint32_t click_index_count;
+
+    //Triggered recording (only used if enabled in the tag config)
+    AudioTrigger trigger;
+
+    //LTSA summary (only used if enabled in the tag config). Computed by the LTSA thread, written by the audio thread.
+    bool ltsa_enabled;
+    Ltsa ltsa;
+    uint32_t ltsa_next;             //next block the LTSA thread reads
+    uint32_t ltsa_interval_start;   //first block of the current interval
+    uint32_t ltsa_interval_blocks;
+    AudioLtsaRow ltsa_rows[AUDIO_CODEC_MAX_CHANNELS];
+    volatile bool ltsa_rows_ready;  //set by the LTSA thread, cleared by the audio thread once written
+
+    //Decimated preview (only used if enabled in the tag config), one file per audio file
+    bool preview_enabled;
+    PreviewDecimator preview;
+    int16_t preview_buffer[AUDIO_PREVIEW_BUFFER_SAMPLES] __attribute__((aligned(4)));
+    uint32_t preview_count;     //samples in preview_buffer
+    uint32_t preview_bytes;     //samples written to the current preview file, in bytes
+    uint8_t preview_header[PREVIEW_WAV_HEADER_SIZE] __attribute__((aligned(4)));
+
+    //Write path statistics, dumped to the stats file by the audio thread
+    AudioStats stats;
+    ULONG stats_tick;   //tick of the last stats row
+    char stats_line[AUDIO_STATS_CSV_LINE_MAX];
+
+    //Header of the record being built & the sector it gets packed into
+    AudioFileHeader record;
+    uint8_t record_sector[AUDIO_FILE_HEADER_SIZE] __attribute__((aligned(FX_SD_BUFFER_ALIGN))); //aligned for the SD DMA, skips the driver's scratch copy
 
     /*FS/SD Card writing variables*/
-    FX_FILE *file;
+    ExtentFile extents[2];      //the audio file & the next one, written raw while they fit in their preallocation
+    ExtentFile *extent;         //file being written
+    ExtentFile *next_extent;    //already created & being preallocated, takes over from extent on the next rollover
+    FX_FILE *click_file; //click index, one per recording
+    FX_FILE *ltsa_files; //LTSA summaries, one per recorded channel (AUDIO_CODEC_MAX_CHANNELS of them)
+    FX_FILE *preview_file; //preview of the current audio file
+    FX_FILE *stats_file; //write path statistics, one per recording
+    AudioFileRotation rotation;
+    StorageStream storage; //every audio write goes through the storage thread
 
 } AudioManager;
 
@@ -76,11 +304,14 @@ typedef struct audio_manager_s {
 // audio_configure()
 //setup file_x
 */
-HAL_StatusTypeDef audio_init(AudioManager *self, ad7768_dev *adc, SAI_HandleTypeDef *hsai, TagConfig *config, FX_FILE *file);
+HAL_StatusTypeDef audio_init(AudioManager *self, ad7768_dev *adc, SAI_HandleTypeDef *hsai, TagConfig *config, FX_MEDIA *media, FX_FILE *file, FX_FILE *next_file, FX_FILE *click_file, FX_FILE *ltsa_files, FX_FILE *preview_file, FX_FILE *stats_file);
 
 /* Desc: set the audio sample rate */
 HAL_StatusTypeDef audio_set_sample_rate(AudioManager *self, TagConfigAudioSampleRate audio_rate);
 
+/* lowest power ADC setting for a sample rate, NULL if the ADC can't run at exactly that rate */
+const AudioRateSetting *audio_rate_setting_find(uint32_t rate_hz);
+
 HAL_StatusTypeDef audio_configure(AudioManager *self, TagConfig *config);
 
 /* audio_configure()
@@ -95,6 +326,9 @@ HAL_StatusTypeDef audio_record(AudioManager *self);
 
 
 void audio_thread_entry(ULONG thread_input);
+
+/* Desc: background LTSA analysis, started by the audio thread */
+void audio_ltsa_thread_entry(ULONG thread_input);
 /* audio_halt()
 // stop circular buffer
 // write SRAM_ext to SD_Card
@@ -103,6 +337,4 @@ void audio_thread_entry(ULONG thread_input);
 /* audio_unit_test()
 */
 
-HAL_StatusTypeDef audio_tick(AudioManager *self);
-
 #endif /*__AUDIO_INC_H__*/
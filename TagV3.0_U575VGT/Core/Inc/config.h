@@ -60,9 +60,88 @@
  * desc: stores the audio channel headers at the start of each sample.
  * 
  * key: audio_sample_rate
- * values: 96_khz, 192_khz
+ * values: 12_khz, 24_khz, 48_khz, 96_khz, 192_khz
  * default: 96_khz
- * desc: sets the audio sample rate.
+ * desc: sets the audio sample rate. The ADC runs in the lowest power mode that reaches it, so lower rates save power as well as storage.
+ * 
+ * key: audio_compression
+ * values: enabled, disabled
+ * default: disabled
+ * desc: losslessly compresses audio blocks before they are written to the SD card (see audio_codec.h).
+ * 
+ * key: audio_dither
+ * values: enabled, disabled
+ * default: disabled
+ * desc: with a 16_bit audio_depth, captures 24 bits and rounds them to 16 with TPDF dither (see audio_repack.h)
+ *       instead of dropping the low byte in the SAI. Costs some CPU, the SD card still sees 16-bit samples.
+ * 
+ * key: audio_crc
+ * values: {int: 0, 4, 16}
+ * default: 0
+ * desc: has the ADC send a CRC of every 4 or 16 samples (per channel) in place of a status header, which is checked as the
+ *       audio is written and counted per block in the audio file (see audio_crc.h), 0 = off. Needs audio_ch_headers and a
+ *       24_bit audio_depth (or audio_dither), otherwise it is ignored.
+ * 
+ * key: audio_file_minutes
+ * values: {int: [0..1440]}
+ * default: 60
+ * desc: starts a new audio file after this many minutes of recording, 0 = no time limit.
+ * 
+ * key: audio_file_megabytes
+ * values: {int: [0..3072]}
+ * default: 0
+ * desc: starts a new audio file before it grows past this size, 0 = largest size the tag allows (3072).
+ * 
+ * key: audio_click_detector
+ * values: enabled, disabled
+ * default: disabled
+ * desc: runs the click detector on the audio and logs detected clicks to a "clicks_*.bin" index file (see click_detector.h).
+ * 
+ * key: audio_click_threshold
+ * values: {int: [3..40]}
+ * default: 12
+ * desc: how far (in dB) a click's energy has to rise above the background noise to be detected.
+ * 
+ * key: audio_trigger
+ * values: enabled, disabled
+ * default: disabled
+ * desc: triggered recording, audio is only written to the SD card while a trigger (below) is active.
+ * 
+ * key: audio_trigger_clicks
+ * values: enabled, disabled
+ * default: enabled
+ * desc: detected clicks start (or extend) a trigger.
+ * 
+ * key: audio_trigger_pre_ms
+ * values: {int: [0..1000]}
+ * default: 200
+ * desc: milliseconds of audio kept from before a trigger, limited to what the audio buffer can hold.
+ * 
+ * key: audio_trigger_hold_s
+ * values: {int: [1..3600]}
+ * default: 30
+ * desc: seconds to keep recording after the last trigger.
+ * 
+ * key: audio_ltsa
+ * values: enabled, disabled
+ * default: disabled
+ * desc: writes a long-term spectral average of each channel to "ltsa_*_ch<n>.bin" files (see ltsa.h).
+ * 
+ * key: audio_ltsa_interval_s
+ * values: {int: [1..3600]}
+ * default: 10
+ * desc: seconds of audio averaged into each LTSA row.
+ * 
+ * key: audio_preview
+ * values: enabled, disabled
+ * default: disabled
+ * desc: writes a 12 kHz mono preview of the first recorded channel next to each audio file, as "preview_*.wav" (see preview.h).
+ * 
+ * key: sd_benchmark
+ * values: enabled, disabled
+ * default: disabled
+ * desc: benchmarks the SD card at boot before recording starts (about SD_BENCH_TEST_BYTES free is needed) and appends
+ *       the results to "sd_bench.csv" (see sd_bench.h). Takes a few minutes, turn it off again after qualifying a card.
  * 
  * key: sensor_light_rate
  * values: {int: [0..30]} ??? is this range good
@@ -93,9 +172,33 @@
 #include "stdbool.h"
 #include <stdint.h>
 
+//Name of the configuration file in the SD card's root directory
+#define TAG_CONFIG_FILE_NAME "config.txt"
+
+//upper limits of the integer audio file settings
+#define CFG_AUDIO_FILE_MINUTES_MAX      1440
+#define CFG_AUDIO_FILE_MEGABYTES_MAX    3072
+
+//click detector threshold limits (dB)
+#define CFG_AUDIO_CLICK_THRESHOLD_MIN   3
+#define CFG_AUDIO_CLICK_THRESHOLD_MAX   40
+
+//triggered recording limits
+#define CFG_AUDIO_TRIGGER_PRE_MS_MAX    1000
+#define CFG_AUDIO_TRIGGER_HOLD_S_MIN    1
+#define CFG_AUDIO_TRIGGER_HOLD_S_MAX    3600
+
+//LTSA averaging interval limits
+#define CFG_AUDIO_LTSA_INTERVAL_S_MIN   1
+#define CFG_AUDIO_LTSA_INTERVAL_S_MAX   3600
+
 typedef enum {
     CFG_AUDIO_RATE_96_KHZ,
     CFG_AUDIO_RATE_192_KHZ,
+    CFG_AUDIO_RATE_12_KHZ,
+    CFG_AUDIO_RATE_24_KHZ,
+    CFG_AUDIO_RATE_48_KHZ,
+    CFG_AUDIO_RATE_COUNT,
 }TagConfigAudioSampleRate;
 
 typedef enum {
@@ -108,11 +211,29 @@ typedef struct tag_config_s{
     uint8_t                     audio_ch_headers;
     TagConfigAudioSampleRate    audio_rate;
     TagConfigAudioSampleDepth   audio_depth;
+    uint8_t                     audio_compression;
+    uint8_t                     audio_dither;
+    uint8_t                     audio_crc;
+    uint16_t                    audio_file_minutes;
+    uint16_t                    audio_file_megabytes;
+    uint8_t                     audio_click_detector;
+    uint8_t                     audio_click_threshold;
+    uint8_t                     audio_trigger;
+    uint8_t                     audio_trigger_clicks;
+    uint16_t                    audio_trigger_pre_ms;
+    uint16_t                    audio_trigger_hold_s;
+    uint8_t                     audio_ltsa;
+    uint16_t                    audio_ltsa_interval_s;
+    uint8_t                     audio_preview;
+    uint8_t                     sd_benchmark;
 } TagConfig;
 
 /* Set tag configuration to default settings */
 void TagConfig_default(TagConfig *cfg);
 
+/* Sample rate setting in Hz (0 if invalid) */
+uint32_t TagConfig_audio_rate_hz(TagConfigAudioSampleRate audio_rate);
+
 /* Read tag configuration from file */
 void TagConfig_read(TagConfig *cfg, FX_FILE *cfg_file);
 
@@ -54,7 +54,6 @@ void Error_Handler(void);
 
 /* USER CODE BEGIN EFP */
 void MX_TIM2_Fake_Init(uint8_t newPeriod);
-void MX_SDMMC1_SD_Fake_Init(uint8_t newClockDiv);
 /* USER CODE END EFP */
 
 /* Private defines -----------------------------------------------------------*/
@@ -20,6 +20,40 @@
 
 #define HZ_TO_MILLISECONDS(f) (1000/(f))
 
+/* smaller/larger of two values (arguments are evaluated twice) */
+#define _MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define _MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+/* little-endian fields of the on-card and offload formats, at any alignment */
+static inline void util_put_u16(uint8_t *p, uint16_t val){
+    p[0] = (uint8_t)val;
+    p[1] = (uint8_t)(val >> 8);
+}
+
+static inline void util_put_u32(uint8_t *p, uint32_t val){
+    p[0] = (uint8_t)val;
+    p[1] = (uint8_t)(val >> 8);
+    p[2] = (uint8_t)(val >> 16);
+    p[3] = (uint8_t)(val >> 24);
+}
+
+static inline void util_put_u64(uint8_t *p, uint64_t val){
+    util_put_u32(&p[0], (uint32_t)val);
+    util_put_u32(&p[4], (uint32_t)(val >> 32));
+}
+
+static inline uint16_t util_get_u16(const uint8_t *p){
+    return p[0] | ((uint16_t)p[1] << 8);
+}
+
+static inline uint32_t util_get_u32(const uint8_t *p){
+    return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t util_get_u64(const uint8_t *p){
+    return util_get_u32(&p[0]) | ((uint64_t)util_get_u32(&p[4]) << 32);
+}
+
 
 /*************************
  * Result<T>
@@ -0,0 +1,487 @@
+/*
+ * audio_codec.c
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Lossless block codec for the hydrophone data, see audio_codec.h for the block layout.
+ */
+
+#include "Lib Inc/audio_codec.h"
+
+/******************
+ * PRIVATE MACROS *
+ ******************/
+
+#define MODE_ORDER_MASK       0x07
+#define MODE_HEADERS_CONSTANT 0x40
+#define MODE_VERBATIM         0x80
+
+//width of the Rice parameter / escape width fields
+#define RICE_PARAM_BITS 5
+
+/********************
+ * PRIVATE TYPEDEFS *
+ ********************/
+
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t pos;
+    uint32_t acc;
+    uint8_t bits; //pending bits in acc, always < 8 between calls
+    bool overflow;
+} BitWriter;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+    uint32_t acc;
+    uint8_t bits; //unread bits in acc
+    bool overrun;
+} BitReader;
+
+/*********************
+ * PRIVATE VARIABLES *
+ *********************/
+
+//zigzag residuals of the partition being encoded
+static uint32_t __partition_scratch[AUDIO_CODEC_PARTITION_LEN];
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static bool __format_is_valid(const AudioCodecFormat *fmt){
+    return (fmt->channel_count >= 1) && (fmt->channel_count <= AUDIO_CODEC_MAX_CHANNELS)
+        && ((fmt->sample_bytes == 2) || (fmt->sample_bytes == 3))
+        && (fmt->header_bytes <= 1);
+}
+
+/* sign extended big-endian sample */
+static inline int32_t __sample_read(const uint8_t *p, uint8_t sample_bytes){
+    if(sample_bytes == 2){
+        return (int16_t)(((uint16_t)p[0] << 8) | p[1]);
+    }
+    return (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8)) >> 8;
+}
+
+static inline void __sample_write(uint8_t *p, int32_t sample, uint8_t sample_bytes){
+    for(int_fast8_t i = sample_bytes - 1; i >= 0; i--){
+        p[i] = (uint8_t)sample;
+        sample >>= 8;
+    }
+}
+
+/* history[0] is the previous sample, history[1] the one before that, ... */
+static inline int32_t __fixed_predict(const int32_t *history, uint8_t order){
+    switch(order){
+        case 1:  return history[0];
+        case 2:  return 2*history[0] - history[1];
+        case 3:  return 3*history[0] - 3*history[1] + history[2];
+        case 4:  return 4*history[0] - 6*history[1] + 4*history[2] - history[3];
+        default: return 0;
+    }
+}
+
+static inline void __history_push(int32_t *history, int32_t sample){
+    history[3] = history[2];
+    history[2] = history[1];
+    history[1] = history[0];
+    history[0] = sample;
+}
+
+static inline uint32_t __zigzag(int32_t val){
+    return ((uint32_t)val << 1) ^ (uint32_t)(val >> 31);
+}
+
+static inline int32_t __unzigzag(uint32_t val){
+    return (int32_t)(val >> 1) ^ -(int32_t)(val & 1);
+}
+
+static inline uint8_t __bit_width(uint32_t val){
+    uint8_t width = 0;
+    while(val){
+        width++;
+        val >>= 1;
+    }
+    return width;
+}
+
+/* n <= 24 */
+static void __bitWriter_put(BitWriter *self, uint32_t val, uint8_t n){
+    self->acc = (self->acc << n) | (val & ((1UL << n) - 1));
+    self->bits += n;
+    while(self->bits >= 8){
+        self->bits -= 8;
+        if(self->pos < self->cap){
+            self->buf[self->pos++] = (uint8_t)(self->acc >> self->bits);
+        }
+        else{
+            self->overflow = true;
+        }
+    }
+}
+
+/* n <= 32 */
+static void __bitWriter_put_long(BitWriter *self, uint32_t val, uint8_t n){
+    if(n > 16){
+        __bitWriter_put(self, val >> 16, n - 16);
+        n = 16;
+    }
+    __bitWriter_put(self, val, n);
+}
+
+static void __bitWriter_put_rice(BitWriter *self, uint32_t val, uint8_t k){
+    uint32_t q = val >> k;
+    while(q >= 24){
+        __bitWriter_put(self, 0, 24);
+        q -= 24;
+    }
+    __bitWriter_put(self, 1, q + 1);
+    __bitWriter_put_long(self, val, k);
+}
+
+static void __bitWriter_align(BitWriter *self){
+    if(self->bits){
+        __bitWriter_put(self, 0, 8 - self->bits);
+    }
+}
+
+/* n <= 24 */
+static uint32_t __bitReader_get(BitReader *self, uint8_t n){
+    while(self->bits < n){
+        uint8_t byte = 0;
+        if(self->pos < self->len){
+            byte = self->buf[self->pos++];
+        }
+        else{
+            self->overrun = true;
+        }
+        self->acc = (self->acc << 8) | byte;
+        self->bits += 8;
+    }
+    self->bits -= n;
+    return (self->acc >> self->bits) & ((1UL << n) - 1);
+}
+
+/* n <= 32 */
+static uint32_t __bitReader_get_long(BitReader *self, uint8_t n){
+    uint32_t val = 0;
+    if(n > 16){
+        val = __bitReader_get(self, n - 16) << 16;
+        n = 16;
+    }
+    return val | __bitReader_get(self, n);
+}
+
+static bool __bitReader_get_rice(BitReader *self, uint8_t k, uint32_t *val){
+    uint32_t q = 0;
+    while(!__bitReader_get(self, 1)){
+        //a valid stream never has a quotient that overflows the residual range
+        if(self->overrun || (++q > (UINT32_MAX >> k))){
+            return false;
+        }
+    }
+    *val = (q << k) | __bitReader_get_long(self, k);
+    return !self->overrun;
+}
+
+static inline void __bitReader_align(BitReader *self){
+    self->bits = 0;
+}
+
+/*
+ * picks the fixed predictor order with the smallest sum of absolute residuals (FLAC style, all orders in one pass)
+ */
+static uint8_t __select_order(const uint8_t *base, size_t stride, uint8_t sample_bytes, uint16_t frame_count){
+    uint64_t error[AUDIO_CODEC_MAX_ORDER + 1] = {0};
+    int32_t last[AUDIO_CODEC_MAX_ORDER] = {0}; //last value of each difference order
+
+    if(frame_count <= AUDIO_CODEC_MAX_ORDER){
+        return 0;
+    }
+
+    for(uint32_t i = 0; i < frame_count; i++){
+        int32_t diff[AUDIO_CODEC_MAX_ORDER + 1];
+        diff[0] = __sample_read(&base[i * stride], sample_bytes);
+        for(uint_fast8_t order = 1; order <= AUDIO_CODEC_MAX_ORDER; order++){
+            diff[order] = diff[order - 1] - last[order - 1];
+        }
+        for(uint_fast8_t order = 0; order < AUDIO_CODEC_MAX_ORDER; order++){
+            last[order] = diff[order];
+        }
+
+        //only score once every order has a full history
+        if(i >= AUDIO_CODEC_MAX_ORDER){
+            for(uint_fast8_t order = 0; order <= AUDIO_CODEC_MAX_ORDER; order++){
+                error[order] += (diff[order] < 0) ? -(int64_t)diff[order] : diff[order];
+            }
+        }
+    }
+
+    uint8_t best = 0;
+    for(uint_fast8_t order = 1; order <= AUDIO_CODEC_MAX_ORDER; order++){
+        if(error[order] < error[best]){
+            best = order;
+        }
+    }
+    return best;
+}
+
+/*
+ * writes one partition worth of residuals in scratch, picking Rice coding or an escape depending on which is smaller
+ */
+static void __encode_partition(BitWriter *writer, const uint32_t *residuals, uint32_t len){
+    uint64_t sum = 0;
+    uint32_t max = 0;
+    for(uint32_t i = 0; i < len; i++){
+        sum += residuals[i];
+        max = (residuals[i] > max) ? residuals[i] : max;
+    }
+
+    //Rice parameter from the mean residual
+    uint8_t k = 0;
+    while((k < (AUDIO_CODEC_RICE_ESCAPE - 1)) && (((uint64_t)len << (k + 1)) <= sum)){
+        k++;
+    }
+
+    uint64_t rice_bits = (uint64_t)len * (k + 1);
+    for(uint32_t i = 0; i < len; i++){
+        rice_bits += residuals[i] >> k;
+    }
+
+    uint8_t width = __bit_width(max);
+    uint64_t escape_bits = RICE_PARAM_BITS + (uint64_t)len * width;
+
+    if(escape_bits < rice_bits){
+        __bitWriter_put(writer, AUDIO_CODEC_RICE_ESCAPE, RICE_PARAM_BITS);
+        __bitWriter_put(writer, width, RICE_PARAM_BITS);
+        for(uint32_t i = 0; i < len; i++){
+            __bitWriter_put_long(writer, residuals[i], width);
+        }
+    }
+    else{
+        __bitWriter_put(writer, k, RICE_PARAM_BITS);
+        for(uint32_t i = 0; i < len; i++){
+            __bitWriter_put_rice(writer, residuals[i], k);
+        }
+    }
+}
+
+static void __encode_headers(BitWriter *writer, const uint8_t *base, size_t stride, uint16_t frame_count, bool constant){
+    if(constant){
+        __bitWriter_put(writer, base[0], 8);
+        return;
+    }
+    for(uint32_t i = 0; i < frame_count; i++){
+        __bitWriter_put(writer, base[i * stride], 8);
+    }
+}
+
+static void __encode_channel_verbatim(BitWriter *writer, const uint8_t *base, size_t stride, const AudioCodecFormat *fmt, uint16_t frame_count, uint8_t mode){
+    __bitWriter_put(writer, mode | MODE_VERBATIM, 8);
+    if(fmt->header_bytes){
+        __encode_headers(writer, base, stride, frame_count, mode & MODE_HEADERS_CONSTANT);
+    }
+    for(uint32_t i = 0; i < frame_count; i++){
+        for(uint_fast8_t byte = 0; byte < fmt->sample_bytes; byte++){
+            __bitWriter_put(writer, base[i * stride + fmt->header_bytes + byte], 8);
+        }
+    }
+}
+
+static void __encode_channel(BitWriter *writer, const uint8_t *base, size_t stride, const AudioCodecFormat *fmt, uint16_t frame_count, uint8_t mode){
+    const uint8_t *samples = base + fmt->header_bytes;
+    uint8_t order = __select_order(samples, stride, fmt->sample_bytes, frame_count);
+    int32_t history[AUDIO_CODEC_MAX_ORDER] = {0};
+
+    __bitWriter_put(writer, mode | order, 8);
+    if(fmt->header_bytes){
+        __encode_headers(writer, base, stride, frame_count, mode & MODE_HEADERS_CONSTANT);
+    }
+
+    //warm-up samples go out as they are
+    for(uint32_t i = 0; i < order; i++){
+        for(uint_fast8_t byte = 0; byte < fmt->sample_bytes; byte++){
+            __bitWriter_put(writer, samples[i * stride + byte], 8);
+        }
+        __history_push(history, __sample_read(&samples[i * stride], fmt->sample_bytes));
+    }
+
+    for(uint32_t start = order; start < frame_count; start += AUDIO_CODEC_PARTITION_LEN){
+        uint32_t len = frame_count - start;
+        len = (len > AUDIO_CODEC_PARTITION_LEN) ? AUDIO_CODEC_PARTITION_LEN : len;
+
+        for(uint32_t i = 0; i < len; i++){
+            int32_t sample = __sample_read(&samples[(start + i) * stride], fmt->sample_bytes);
+            __partition_scratch[i] = __zigzag(sample - __fixed_predict(history, order));
+            __history_push(history, sample);
+        }
+        __encode_partition(writer, __partition_scratch, len);
+    }
+    __bitWriter_align(writer);
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+size_t audio_codec_encode(const AudioCodecFormat *fmt, const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_capacity){
+    if(!__format_is_valid(fmt)){
+        return 0;
+    }
+
+    size_t frame_bytes = audio_codec_frame_bytes(fmt);
+    size_t slot_bytes = fmt->header_bytes + fmt->sample_bytes;
+    if((src_len == 0) || (src_len % frame_bytes) || ((src_len / frame_bytes) > UINT16_MAX)){
+        return 0;
+    }
+    uint16_t frame_count = src_len / frame_bytes;
+
+    BitWriter writer = {
+        .buf = dst,
+        .cap = dst_capacity,
+    };
+
+    __bitWriter_put(&writer, frame_count & 0xFF, 8);
+    __bitWriter_put(&writer, frame_count >> 8, 8);
+    __bitWriter_put(&writer, fmt->channel_count, 8);
+    __bitWriter_put(&writer, fmt->sample_bytes | (fmt->header_bytes << 4), 8);
+
+    for(uint_fast8_t ch = 0; ch < fmt->channel_count; ch++){
+        const uint8_t *base = &src[ch * slot_bytes];
+        uint8_t mode = 0;
+
+        if(fmt->header_bytes){
+            mode |= MODE_HEADERS_CONSTANT;
+            for(uint32_t i = 1; i < frame_count; i++){
+                if(base[i * frame_bytes] != base[0]){
+                    mode &= ~MODE_HEADERS_CONSTANT;
+                    break;
+                }
+            }
+        }
+
+        size_t channel_start = writer.pos;
+        size_t verbatim_len = 1 + (size_t)frame_count * fmt->sample_bytes;
+        if(fmt->header_bytes){
+            verbatim_len += (mode & MODE_HEADERS_CONSTANT) ? 1 : frame_count;
+        }
+
+        __encode_channel(&writer, base, frame_bytes, fmt, frame_count, mode);
+
+        //Noise doesn't compress, fall back to storing the channel as is
+        if(writer.overflow || ((writer.pos - channel_start) > verbatim_len)){
+            writer.pos = channel_start;
+            writer.overflow = false;
+            __encode_channel_verbatim(&writer, base, frame_bytes, fmt, frame_count, mode);
+        }
+
+        if(writer.overflow){
+            return 0;
+        }
+    }
+    return writer.pos;
+}
+
+bool audio_codec_peek(const uint8_t *src, size_t src_len, AudioCodecFormat *fmt, uint16_t *frame_count){
+    if(src_len < AUDIO_CODEC_BLOCK_HEADER_SIZE){
+        return false;
+    }
+
+    *frame_count = src[0] | ((uint16_t)src[1] << 8);
+    *fmt = (AudioCodecFormat){
+        .channel_count = src[2],
+        .sample_bytes = src[3] & 0x0F,
+        .header_bytes = src[3] >> 4,
+    };
+    return (*frame_count != 0) && __format_is_valid(fmt);
+}
+
+size_t audio_codec_decode(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_capacity, size_t *dst_len){
+    AudioCodecFormat fmt;
+    uint16_t frame_count;
+
+    if(!audio_codec_peek(src, src_len, &fmt, &frame_count)){
+        return 0;
+    }
+
+    size_t frame_bytes = audio_codec_frame_bytes(&fmt);
+    size_t slot_bytes = fmt.header_bytes + fmt.sample_bytes;
+    if(((size_t)frame_count * frame_bytes) > dst_capacity){
+        return 0;
+    }
+
+    BitReader reader = {
+        .buf = src,
+        .len = src_len,
+        .pos = AUDIO_CODEC_BLOCK_HEADER_SIZE,
+    };
+
+    for(uint_fast8_t ch = 0; ch < fmt.channel_count; ch++){
+        uint8_t *base = &dst[ch * slot_bytes];
+        uint8_t *samples = base + fmt.header_bytes;
+        uint8_t mode = __bitReader_get(&reader, 8);
+        uint8_t order = mode & MODE_ORDER_MASK;
+
+        if((order > AUDIO_CODEC_MAX_ORDER) || (order > frame_count)){
+            return 0;
+        }
+
+        if(fmt.header_bytes){
+            if(mode & MODE_HEADERS_CONSTANT){
+                uint8_t header = __bitReader_get(&reader, 8);
+                for(uint32_t i = 0; i < frame_count; i++){
+                    base[i * frame_bytes] = header;
+                }
+            }
+            else{
+                for(uint32_t i = 0; i < frame_count; i++){
+                    base[i * frame_bytes] = __bitReader_get(&reader, 8);
+                }
+            }
+        }
+
+        //verbatim channels are just the warm-up with every sample
+        uint32_t warmup = (mode & MODE_VERBATIM) ? frame_count : order;
+        int32_t history[AUDIO_CODEC_MAX_ORDER] = {0};
+        for(uint32_t i = 0; i < warmup; i++){
+            for(uint_fast8_t byte = 0; byte < fmt.sample_bytes; byte++){
+                samples[i * frame_bytes + byte] = __bitReader_get(&reader, 8);
+            }
+            __history_push(history, __sample_read(&samples[i * frame_bytes], fmt.sample_bytes));
+        }
+
+        for(uint32_t start = warmup; start < frame_count; start += AUDIO_CODEC_PARTITION_LEN){
+            uint32_t len = frame_count - start;
+            len = (len > AUDIO_CODEC_PARTITION_LEN) ? AUDIO_CODEC_PARTITION_LEN : len;
+
+            uint8_t k = __bitReader_get(&reader, RICE_PARAM_BITS);
+            uint8_t width = (k == AUDIO_CODEC_RICE_ESCAPE) ? __bitReader_get(&reader, RICE_PARAM_BITS) : 0;
+
+            for(uint32_t i = start; i < (start + len); i++){
+                uint32_t residual;
+                if(k == AUDIO_CODEC_RICE_ESCAPE){
+                    residual = __bitReader_get_long(&reader, width);
+                }
+                else if(!__bitReader_get_rice(&reader, k, &residual)){
+                    return 0;
+                }
+
+                int32_t sample = __unzigzag(residual) + __fixed_predict(history, order);
+                __sample_write(&samples[i * frame_bytes], sample, fmt.sample_bytes);
+                __history_push(history, sample);
+            }
+        }
+        __bitReader_align(&reader);
+
+        if(reader.overrun){
+            return 0;
+        }
+    }
+
+    *dst_len = (size_t)frame_count * frame_bytes;
+    return reader.pos;
+}
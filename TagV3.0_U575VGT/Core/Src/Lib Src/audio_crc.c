@@ -0,0 +1,159 @@
+/*
+ * audio_crc.c
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    AD7768 data interface CRC checker, see audio_crc.h
+ */
+
+#include "Lib Inc/audio_crc.h"
+#include <string.h>
+
+/*********************
+ * PRIVATE VARIABLES *
+ *********************/
+
+//CRC-8, polynomial 0x07 (MSB first)
+static const uint8_t __crc8_table[256] = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+    0x70, 0x77, 0x7E, 0x79, 0x6C, 0x6B, 0x62, 0x65, 0x48, 0x4F, 0x46, 0x41, 0x54, 0x53, 0x5A, 0x5D,
+    0xE0, 0xE7, 0xEE, 0xE9, 0xFC, 0xFB, 0xF2, 0xF5, 0xD8, 0xDF, 0xD6, 0xD1, 0xC4, 0xC3, 0xCA, 0xCD,
+    0x90, 0x97, 0x9E, 0x99, 0x8C, 0x8B, 0x82, 0x85, 0xA8, 0xAF, 0xA6, 0xA1, 0xB4, 0xB3, 0xBA, 0xBD,
+    0xC7, 0xC0, 0xC9, 0xCE, 0xDB, 0xDC, 0xD5, 0xD2, 0xFF, 0xF8, 0xF1, 0xF6, 0xE3, 0xE4, 0xED, 0xEA,
+    0xB7, 0xB0, 0xB9, 0xBE, 0xAB, 0xAC, 0xA5, 0xA2, 0x8F, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9D, 0x9A,
+    0x27, 0x20, 0x29, 0x2E, 0x3B, 0x3C, 0x35, 0x32, 0x1F, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0D, 0x0A,
+    0x57, 0x50, 0x59, 0x5E, 0x4B, 0x4C, 0x45, 0x42, 0x6F, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7D, 0x7A,
+    0x89, 0x8E, 0x87, 0x80, 0x95, 0x92, 0x9B, 0x9C, 0xB1, 0xB6, 0xBF, 0xB8, 0xAD, 0xAA, 0xA3, 0xA4,
+    0xF9, 0xFE, 0xF7, 0xF0, 0xE5, 0xE2, 0xEB, 0xEC, 0xC1, 0xC6, 0xCF, 0xC8, 0xDD, 0xDA, 0xD3, 0xD4,
+    0x69, 0x6E, 0x67, 0x60, 0x75, 0x72, 0x7B, 0x7C, 0x51, 0x56, 0x5F, 0x58, 0x4D, 0x4A, 0x43, 0x44,
+    0x19, 0x1E, 0x17, 0x10, 0x05, 0x02, 0x0B, 0x0C, 0x21, 0x26, 0x2F, 0x28, 0x3D, 0x3A, 0x33, 0x34,
+    0x4E, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5C, 0x5B, 0x76, 0x71, 0x78, 0x7F, 0x6A, 0x6D, 0x64, 0x63,
+    0x3E, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2C, 0x2B, 0x06, 0x01, 0x08, 0x0F, 0x1A, 0x1D, 0x14, 0x13,
+    0xAE, 0xA9, 0xA0, 0xA7, 0xB2, 0xB5, 0xBC, 0xBB, 0x96, 0x91, 0x98, 0x9F, 0x8A, 0x8D, 0x84, 0x83,
+    0xDE, 0xD9, 0xD0, 0xD7, 0xC2, 0xC5, 0xCC, 0xCB, 0xE6, 0xE1, 0xE8, 0xEF, 0xFA, 0xFD, 0xF4, 0xF3,
+};
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/*
+ * run one channel of a block through its running CRC, starting at the given group position. Returns the groups that didn't match,
+ * checked is incremented for every group that was compared.
+ */
+static uint32_t __check_channel(const AudioCrc *self, const uint8_t *block, size_t frame_count, uint8_t channel, uint8_t phase,
+        AudioCrcChannel *state, uint32_t *checked){
+    size_t frame_bytes = audio_codec_frame_bytes(&self->format);
+    const uint8_t *slot = &block[channel * (self->format.header_bytes + self->format.sample_bytes)];
+    uint_fast8_t last = self->interval - 1;
+    uint_fast8_t pos = phase;
+    uint_fast8_t crc = state->crc;
+    bool valid = state->valid;
+    uint32_t errors = 0;
+
+    for(size_t frame = 0; frame < frame_count; frame++, slot += frame_bytes){
+        if(pos == 0){
+            crc = AUDIO_CRC_SEED;
+            valid = true;
+        }
+        crc = __crc8_table[crc ^ slot[1]];
+        crc = __crc8_table[crc ^ slot[2]];
+        crc = __crc8_table[crc ^ slot[3]];
+
+        if(pos == last){
+            if(valid){
+                errors += (crc != slot[0]);
+                (*checked)++;
+            }
+            pos = 0;
+        }
+        else{
+            pos++;
+        }
+    }
+    state->crc = crc;
+    state->valid = valid;
+    return errors;
+}
+
+/*
+ * find the group offset on the first channel: the one with the fewest mismatches, if under half of its groups failed
+ */
+static bool __lock(AudioCrc *self, const uint8_t *block, size_t frame_count){
+    uint32_t best_errors = UINT32_MAX;
+    uint32_t best_checked = 0;
+    uint8_t best_phase = 0;
+
+    for(uint_fast8_t phase = 0; phase < self->interval; phase++){
+        AudioCrcChannel state = {};
+        uint32_t checked = 0;
+        uint32_t errors = __check_channel(self, block, frame_count, 0, phase, &state, &checked);
+
+        if(errors < best_errors){
+            best_errors = errors;
+            best_checked = checked;
+            best_phase = phase;
+        }
+    }
+
+    if((best_checked == 0) || ((best_errors * 2) >= best_checked)){
+        return false;
+    }
+    self->phase = best_phase;
+    self->locked = true;
+
+    //Any running CRCs were kept at the old offset
+    for(uint_fast8_t ch = 0; ch < self->format.channel_count; ch++){
+        self->ch[ch].valid = false;
+    }
+    return true;
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+bool audio_crc_init(AudioCrc *self, const AudioCodecFormat *format, uint8_t interval){
+    memset(self, 0, sizeof(*self));
+    if((format->header_bytes != 1) || (format->sample_bytes != 3) || (format->channel_count == 0) || (format->channel_count > AUDIO_CODEC_MAX_CHANNELS)){
+        return false;
+    }
+    if((interval != 4) && (interval != AUDIO_CRC_INTERVAL_MAX)){
+        return false;
+    }
+
+    self->format = *format;
+    self->interval = interval;
+    return true;
+}
+
+uint16_t audio_crc_check(AudioCrc *self, const uint8_t *block, size_t len, uint32_t sequence){
+    size_t frame_count = len / audio_codec_frame_bytes(&self->format);
+    uint32_t errors = 0;
+    uint32_t checked = 0;
+
+    //Groups can only carry over from the block right before this one
+    if(sequence != self->next_sequence){
+        for(uint_fast8_t ch = 0; ch < self->format.channel_count; ch++){
+            self->ch[ch].valid = false;
+        }
+    }
+    self->next_sequence = sequence + 1;
+
+    if(!self->locked && !__lock(self, block, frame_count)){
+        return AUDIO_CRC_UNLOCKED;
+    }
+
+    for(uint_fast8_t ch = 0; ch < self->format.channel_count; ch++){
+        errors += __check_channel(self, block, frame_count, ch, self->phase, &self->ch[ch], &checked);
+    }
+    self->errors += errors;
+
+    //Half the groups failing (the bar __lock takes) means the ADC restarted or the link is gone, look for the groups again.
+    //Not all of them: at the wrong offset one in 256 still matches by chance.
+    if((checked != 0) && ((errors * 2) >= checked)){
+        self->locked = false;
+    }
+    return (errors > (AUDIO_CRC_UNLOCKED - 1)) ? (AUDIO_CRC_UNLOCKED - 1) : (uint16_t)errors;
+}
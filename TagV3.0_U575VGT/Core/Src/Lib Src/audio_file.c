@@ -0,0 +1,192 @@
+/*
+ * audio_file.c
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Audio file record headers and reader, see audio_file.h for the layout.
+ */
+
+#include "Lib Inc/audio_file.h"
+#include "util.h"
+#include <string.h>
+
+/******************
+ * PRIVATE MACROS *
+ ******************/
+
+#define CRC_OFFSET       (AUDIO_FILE_HEADER_SIZE - 4)
+#define ENTRIES_OFFSET   48
+#define ENTRY_SIZE       12
+
+_Static_assert(ENTRIES_OFFSET + (AUDIO_FILE_MAX_BLOCKS * ENTRY_SIZE) <= CRC_OFFSET, "audio file block entries overlap the CRC");
+
+/*********************
+ * PRIVATE VARIABLES *
+ *********************/
+
+//CRC-32 (reflected 0xEDB88320) a nibble at a time, keeps the table small on the tag
+static const uint32_t __crc32_nibble_table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+uint32_t audio_file_crc32(uint32_t crc, const uint8_t *data, size_t len){
+    crc = ~crc;
+    for(size_t i = 0; i < len; i++){
+        crc ^= data[i];
+        crc = (crc >> 4) ^ __crc32_nibble_table[crc & 0x0F];
+        crc = (crc >> 4) ^ __crc32_nibble_table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+void audio_file_header_pack(const AudioFileHeader *header, uint8_t *sector){
+    memset(sector, 0, AUDIO_FILE_HEADER_SIZE);
+
+    util_put_u32(&sector[0], AUDIO_FILE_MAGIC);
+    util_put_u16(&sector[4], AUDIO_FILE_VERSION);
+    util_put_u16(&sector[6], AUDIO_FILE_HEADER_SIZE);
+    util_put_u32(&sector[8], header->payload_len);
+    util_put_u32(&sector[12], header->block_size);
+    util_put_u32(&sector[16], header->sample_rate);
+    sector[20] = header->channel_mask;
+    sector[21] = header->sample_bytes;
+    sector[22] = header->header_bytes;
+    sector[23] = header->flags;
+    util_put_u32(&sector[24], header->dropped_blocks);
+    util_put_u32(&sector[28], header->rtc_tick);
+    sector[32] = header->rtc_year;
+    sector[33] = header->rtc_month;
+    sector[34] = header->rtc_day;
+    sector[35] = header->rtc_hours;
+    sector[36] = header->rtc_minutes;
+    sector[37] = header->rtc_seconds;
+    util_put_u16(&sector[40], header->block_count);
+    util_put_u32(&sector[44], header->tick_rate);
+
+    for(uint_fast16_t i = 0; (i < header->block_count) && (i < AUDIO_FILE_MAX_BLOCKS); i++){
+        uint8_t *entry = &sector[ENTRIES_OFFSET + i * ENTRY_SIZE];
+        util_put_u32(&entry[0], header->blocks[i].sequence);
+        util_put_u32(&entry[4], header->blocks[i].tick);
+        util_put_u16(&entry[8], (uint16_t)header->blocks[i].length);
+        util_put_u16(&entry[10], header->blocks[i].crc_errors);
+    }
+
+    util_put_u32(&sector[CRC_OFFSET], audio_file_crc32(0, sector, CRC_OFFSET));
+}
+
+AudioFileStatus audio_file_header_unpack(const uint8_t *sector, size_t len, AudioFileHeader *header){
+    if(len < AUDIO_FILE_HEADER_SIZE){
+        return AUDIO_FILE_TRUNCATED;
+    }
+    if(util_get_u32(&sector[0]) != AUDIO_FILE_MAGIC){
+        return AUDIO_FILE_BAD_MAGIC;
+    }
+    if(util_get_u32(&sector[CRC_OFFSET]) != audio_file_crc32(0, sector, CRC_OFFSET)){
+        return AUDIO_FILE_BAD_CRC;
+    }
+    if(util_get_u16(&sector[4]) != AUDIO_FILE_VERSION){
+        return AUDIO_FILE_BAD_VERSION;
+    }
+    if((util_get_u16(&sector[6]) != AUDIO_FILE_HEADER_SIZE) || (util_get_u16(&sector[40]) > AUDIO_FILE_MAX_BLOCKS)){
+        return AUDIO_FILE_BAD_HEADER;
+    }
+
+    *header = (AudioFileHeader){
+        .payload_len = util_get_u32(&sector[8]),
+        .block_size = util_get_u32(&sector[12]),
+        .sample_rate = util_get_u32(&sector[16]),
+        .channel_mask = sector[20],
+        .sample_bytes = sector[21],
+        .header_bytes = sector[22],
+        .flags = sector[23],
+        .dropped_blocks = util_get_u32(&sector[24]),
+        .rtc_tick = util_get_u32(&sector[28]),
+        .rtc_year = sector[32],
+        .rtc_month = sector[33],
+        .rtc_day = sector[34],
+        .rtc_hours = sector[35],
+        .rtc_minutes = sector[36],
+        .rtc_seconds = sector[37],
+        .block_count = util_get_u16(&sector[40]),
+        .tick_rate = util_get_u32(&sector[44]),
+    };
+
+    uint64_t block_bytes = 0;
+    for(uint_fast16_t i = 0; i < header->block_count; i++){
+        const uint8_t *entry = &sector[ENTRIES_OFFSET + i * ENTRY_SIZE];
+        header->blocks[i] = (AudioFileBlockEntry){
+            .sequence = util_get_u32(&entry[0]),
+            .tick = util_get_u32(&entry[4]),
+            .length = util_get_u16(&entry[8]),
+            .crc_errors = util_get_u16(&entry[10]),
+        };
+        block_bytes += header->blocks[i].length;
+    }
+
+    //the block entries have to account for the whole payload
+    if(!(header->flags & AUDIO_FILE_FLAG_PADDING) && (block_bytes != header->payload_len)){
+        return AUDIO_FILE_BAD_HEADER;
+    }
+    return AUDIO_FILE_OK;
+}
+
+void audio_file_reader_init(AudioFileReader *self, const uint8_t *data, size_t len){
+    *self = (AudioFileReader){
+        .data = data,
+        .len = len,
+    };
+}
+
+AudioFileStatus audio_file_reader_next(AudioFileReader *self, AudioFileHeader *header, const uint8_t **payload){
+    if(self->offset >= self->len){
+        return AUDIO_FILE_END;
+    }
+
+    size_t remaining = self->len - self->offset;
+    AudioFileStatus status = audio_file_header_unpack(&self->data[self->offset], remaining, header);
+    if(status != AUDIO_FILE_OK){
+        return status;
+    }
+
+    if(header->payload_len > (remaining - AUDIO_FILE_HEADER_SIZE)){
+        return AUDIO_FILE_TRUNCATED;
+    }
+
+    *payload = &self->data[self->offset + AUDIO_FILE_HEADER_SIZE];
+    self->offset += AUDIO_FILE_HEADER_SIZE + header->payload_len;
+    return AUDIO_FILE_OK;
+}
+
+bool audio_file_reader_resync(AudioFileReader *self){
+    uint8_t magic[4];
+    AudioFileHeader header;
+
+    util_put_u32(magic, AUDIO_FILE_MAGIC);
+
+    //Compressed payloads aren't sector aligned, so this has to go byte by byte. The magic check keeps it cheap.
+    for(size_t offset = self->offset + 1; (offset + AUDIO_FILE_HEADER_SIZE) <= self->len; offset++){
+        const uint8_t *candidate = memchr(&self->data[offset], magic[0], self->len - offset);
+        if(candidate == NULL){
+            break;
+        }
+        offset = candidate - self->data;
+        if((offset + AUDIO_FILE_HEADER_SIZE) > self->len){
+            break;
+        }
+        if(memcmp(candidate, magic, sizeof(magic))){
+            continue;
+        }
+        if(audio_file_header_unpack(candidate, self->len - offset, &header) == AUDIO_FILE_OK){
+            self->offset = offset;
+            return true;
+        }
+    }
+    self->offset = self->len;
+    return false;
+}
@@ -0,0 +1,146 @@
+/*
+ * audio_repack.c
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Audio block repacking, see audio_repack.h
+ */
+
+#include "Lib Inc/audio_repack.h"
+#include <string.h>
+
+/******************
+ * PRIVATE MACROS *
+ ******************/
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1) && !defined(AUDIO_REPACK_NO_DSP)
+#define AUDIO_REPACK_DSP 1
+#include "cmsis_compiler.h"
+#else
+#define AUDIO_REPACK_DSP 0
+#endif
+
+//Rounding offset for a Q31 value cut to its top 16 bits
+#define ROUND_16 (1L << 15)
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/*
+ * TPDF dither in Q31 for a 16-bit output: the sum of two uniform 16-bit values, centered, spans +-1 output LSB
+ */
+static inline int32_t __dither_next(uint32_t *seed){
+    uint32_t x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *seed = x;
+    return (int32_t)(x & 0xFFFF) + (int32_t)(x >> 16) - 0xFFFF;
+}
+
+/* round a Q31 sample (plus dither) to 16 bits, saturating at full scale */
+static inline int32_t __round_16(int32_t x, int32_t dither){
+#if AUDIO_REPACK_DSP
+    return __QADD(x, dither + ROUND_16) >> 16;
+#else
+    int64_t sum = (int64_t)x + dither + ROUND_16;
+    sum = (sum > INT32_MAX) ? INT32_MAX : ((sum < INT32_MIN) ? INT32_MIN : sum);
+    return (int32_t)sum >> 16;
+#endif
+}
+
+/* store two 16-bit samples big-endian, back to back */
+static inline void __store_16_pair(uint8_t *dst, int32_t y0, int32_t y1){
+#if AUDIO_REPACK_DSP
+    uint32_t word = __REV16(__PKHBT(y0, y1, 16));
+    memcpy(dst, &word, sizeof(word));
+#else
+    dst[0] = (uint8_t)(y0 >> 8);
+    dst[1] = (uint8_t)y0;
+    dst[2] = (uint8_t)(y1 >> 8);
+    dst[3] = (uint8_t)y1;
+#endif
+}
+
+/*
+ * 24-bit to headerless 16-bit, two samples per step. Both samples are read before anything is written so it works in place.
+ */
+static void __repack_24_to_16(AudioRepack *self, const uint8_t *src, size_t in_slot, uint8_t *dst, size_t slots){
+    size_t s = 0;
+
+    for(; (s + 2) <= slots; s += 2){
+        int32_t x0 = audio_codec_sample_q31(&src[s * in_slot], 3);
+        int32_t x1 = audio_codec_sample_q31(&src[(s + 1) * in_slot], 3);
+        int32_t d0 = self->dither ? __dither_next(&self->seed) : 0;
+        int32_t d1 = self->dither ? __dither_next(&self->seed) : 0;
+
+        __store_16_pair(&dst[s * 2], __round_16(x0, d0), __round_16(x1, d1));
+    }
+    if(s < slots){
+        int32_t y = __round_16(audio_codec_sample_q31(&src[s * in_slot], 3), self->dither ? __dither_next(&self->seed) : 0);
+        dst[s * 2] = (uint8_t)(y >> 8);
+        dst[s * 2 + 1] = (uint8_t)y;
+    }
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+bool audio_repack_init(AudioRepack *self, const AudioCodecFormat *in, const AudioCodecFormat *out, bool dither){
+    if((in->channel_count != out->channel_count) || (in->channel_count == 0) || (in->channel_count > AUDIO_CODEC_MAX_CHANNELS)){
+        return false;
+    }
+    if((in->sample_bytes < 2) || (in->sample_bytes > 3) || (out->sample_bytes < 2) || (out->sample_bytes > in->sample_bytes)){
+        return false;
+    }
+    if((in->header_bytes > 1) || (out->header_bytes > in->header_bytes)){
+        return false;
+    }
+
+    *self = (AudioRepack){
+        .in = *in,
+        .out = *out,
+        .dither = dither && (out->sample_bytes < in->sample_bytes),
+        .seed = AUDIO_REPACK_SEED,
+    };
+    return true;
+}
+
+size_t audio_repack_len(const AudioRepack *self, size_t src_len){
+    return (src_len / audio_codec_frame_bytes(&self->in)) * audio_codec_frame_bytes(&self->out);
+}
+
+size_t audio_repack(AudioRepack *self, const uint8_t *src, size_t src_len, uint8_t *dst){
+    size_t in_slot = self->in.header_bytes + self->in.sample_bytes;
+    size_t out_slot = self->out.header_bytes + self->out.sample_bytes;
+    size_t slots = (src_len / audio_codec_frame_bytes(&self->in)) * self->in.channel_count;
+
+    //Every slot is handled on its own, so channels don't matter past this point
+    if((self->out.sample_bytes < self->in.sample_bytes) && (self->out.header_bytes == 0)){
+        __repack_24_to_16(self, &src[self->in.header_bytes], in_slot, dst, slots);
+    }
+    else if(self->out.sample_bytes < self->in.sample_bytes){
+        for(size_t s = 0; s < slots; s++){
+            const uint8_t *p = &src[s * in_slot];
+            uint8_t header = p[0];
+            int32_t y = __round_16(audio_codec_sample_q31(&p[1], 3), self->dither ? __dither_next(&self->seed) : 0);
+
+            dst[s * out_slot] = header;
+            dst[s * out_slot + 1] = (uint8_t)(y >> 8);
+            dst[s * out_slot + 2] = (uint8_t)y;
+        }
+    }
+    else{
+        //Same sample size, only headers are dropped (or it is a plain copy)
+        for(size_t s = 0; s < slots; s++){
+            const uint8_t *p = &src[s * in_slot + (self->in.header_bytes - self->out.header_bytes)];
+            for(size_t i = 0; i < out_slot; i++){
+                dst[s * out_slot + i] = p[i];
+            }
+        }
+    }
+    return slots * out_slot;
+}
@@ -0,0 +1,79 @@
+/*
+ * audio_stats.c
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Audio write path counters, see audio_stats.h
+ */
+
+#include "Lib Inc/audio_stats.h"
+#include <stdio.h>
+#include <string.h>
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/* histogram bin of a write duration */
+static inline uint_fast8_t __write_bin(uint32_t us){
+    uint32_t scaled = us >> AUDIO_STATS_WRITE_BIN_SHIFT;
+    uint_fast8_t bin = (scaled == 0) ? 0 : (uint_fast8_t)(32 - __builtin_clz(scaled));
+
+    return (bin < AUDIO_STATS_WRITE_BINS) ? bin : (AUDIO_STATS_WRITE_BINS - 1);
+}
+
+/* snprintf onto the end of a line, never past its end */
+static size_t __append(char *buf, size_t len, size_t pos, const char *fmt, unsigned long val){
+    if(pos >= len){
+        return pos;
+    }
+    int n = snprintf(&buf[pos], len - pos, fmt, val);
+    return (n < 0) ? pos : ((pos + n < len) ? (pos + n) : (len - 1));
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+void audio_stats_reset(AudioStats *self){
+    memset(self, 0, sizeof(*self));
+}
+
+void audio_stats_write(AudioStats *self, uint32_t len, uint32_t us){
+    self->writes++;
+    self->write_bytes += len;
+    self->write_us += us;
+    self->write_hist[__write_bin(us)]++;
+    audio_stats_peak(&self->write_max_us, us);
+}
+
+size_t audio_stats_csv_header(char *buf, size_t len){
+    size_t pos = 0;
+
+    pos = __append(buf, len, pos, "time_ms,writes,write_kbytes,write_ms,write_max_us,latency_max_us,queue_peak,stage_peak_bytes,dropped_blocks,crc_errors", 0);
+    for(uint_fast8_t bin = 0; bin < (AUDIO_STATS_WRITE_BINS - 1); bin++){
+        pos = __append(buf, len, pos, ",write_lt_%luus", 1UL << (AUDIO_STATS_WRITE_BIN_SHIFT + bin));
+    }
+    pos = __append(buf, len, pos, ",write_ge_%luus", 1UL << (AUDIO_STATS_WRITE_BIN_SHIFT + AUDIO_STATS_WRITE_BINS - 2));
+    return __append(buf, len, pos, "\n", 0);
+}
+
+size_t audio_stats_csv_row(const AudioStats *self, uint32_t time_ms, char *buf, size_t len){
+    size_t pos = 0;
+
+    pos = __append(buf, len, pos, "%lu", time_ms);
+    pos = __append(buf, len, pos, ",%lu", self->writes);
+    pos = __append(buf, len, pos, ",%lu", (unsigned long)(self->write_bytes / 1024));
+    pos = __append(buf, len, pos, ",%lu", (unsigned long)(self->write_us / 1000));
+    pos = __append(buf, len, pos, ",%lu", self->write_max_us);
+    pos = __append(buf, len, pos, ",%lu", self->latency_max_us);
+    pos = __append(buf, len, pos, ",%lu", self->queue_peak);
+    pos = __append(buf, len, pos, ",%lu", self->stage_peak_bytes);
+    pos = __append(buf, len, pos, ",%lu", self->dropped_blocks);
+    pos = __append(buf, len, pos, ",%lu", self->crc_errors);
+    for(uint_fast8_t bin = 0; bin < AUDIO_STATS_WRITE_BINS; bin++){
+        pos = __append(buf, len, pos, ",%lu", self->write_hist[bin]);
+    }
+    return __append(buf, len, pos, "\n", 0);
+}
@@ -0,0 +1,169 @@
+/*
+ * click_detector.c
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Streaming click detector, see click_detector.h
+ */
+
+#include "Lib Inc/click_detector.h"
+#include <math.h>
+#include <string.h>
+
+/******************
+ * PRIVATE MACROS *
+ ******************/
+
+#define Q30_ONE (1L << 30)
+
+//envelope smoothing (per sample)
+#define ENVELOPE_ALPHA 0.125f
+
+//faster floor tracking while warming up
+#define WARMUP_FLOOR_ALPHA (1.0f / 256.0f)
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static inline int32_t __to_q30(float coeff){
+    return (int32_t)lrintf(coeff * (float)Q30_ONE);
+}
+
+/*
+ * RBJ cookbook high/low-pass, Q = 1/sqrt(2)
+ */
+static ClickBiquad __biquad_design(float cutoff_hz, uint32_t sample_rate, bool highpass){
+    float w0 = 2.0f * 3.14159265f * cutoff_hz / (float)sample_rate;
+    float cos_w0 = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * 0.70710678f);
+    float a0 = 1.0f + alpha;
+    float b0 = (highpass ? (1.0f + cos_w0) : (1.0f - cos_w0)) / 2.0f;
+    float b1 = highpass ? -(1.0f + cos_w0) : (1.0f - cos_w0);
+
+    return (ClickBiquad){
+        .b = {__to_q30(b0 / a0), __to_q30(b1 / a0), __to_q30(b0 / a0)},
+        .a = {__to_q30(-2.0f * cos_w0 / a0), __to_q30((1.0f - alpha) / a0)},
+    };
+}
+
+/* one direct form I biquad step, Q31 in/out */
+static inline int32_t __biquad_step(const ClickBiquad *coeffs, int32_t *x, int32_t *y, int32_t in){
+    int64_t acc = (int64_t)coeffs->b[0] * in
+                + (int64_t)coeffs->b[1] * x[0]
+                + (int64_t)coeffs->b[2] * x[1]
+                - (int64_t)coeffs->a[0] * y[0]
+                - (int64_t)coeffs->a[1] * y[1];
+    acc >>= 30;
+    int32_t out = (acc > INT32_MAX) ? INT32_MAX : ((acc < INT32_MIN) ? INT32_MIN : (int32_t)acc);
+
+    x[1] = x[0];
+    x[0] = in;
+    y[1] = y[0];
+    y[0] = out;
+    return out;
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+void click_detector_init(ClickDetector *self, const AudioCodecFormat *format, uint32_t sample_rate, uint8_t threshold_db){
+    float lowpass_hz = (float)CLICK_LOWPASS_HZ;
+    if(lowpass_hz > (0.45f * sample_rate)){
+        lowpass_hz = 0.45f * sample_rate;
+    }
+
+    memset(self, 0, sizeof(*self));
+    self->format = *format;
+    self->sample_rate = sample_rate;
+    self->stage[0] = __biquad_design(CLICK_HIGHPASS_HZ, sample_rate, true);
+    self->stage[1] = __biquad_design(lowpass_hz, sample_rate, false);
+
+    //Teager-Kaiser output is an energy, so the factor is in power dB
+    self->threshold_factor = powf(10.0f, threshold_db / 10.0f);
+    self->floor_alpha = 1000.0f / ((float)CLICK_FLOOR_MS * sample_rate);
+    self->warmup = (uint32_t)((uint64_t)sample_rate * CLICK_WARMUP_MS / 1000);
+    self->max_len = (uint32_t)((uint64_t)sample_rate * CLICK_MAX_MS / 1000);
+    self->refractory_len = (uint32_t)((uint64_t)sample_rate * CLICK_REFRACTORY_MS / 1000);
+}
+
+size_t click_detector_process(ClickDetector *self, const uint8_t *block, size_t len, uint32_t sequence, ClickEvent *events, size_t max_events){
+    size_t frame_bytes = audio_codec_frame_bytes(&self->format);
+    size_t slot_bytes = self->format.header_bytes + self->format.sample_bytes;
+    size_t frame_count = len / frame_bytes;
+    size_t event_count = 0;
+
+    for(uint_fast8_t ch = 0; ch < self->format.channel_count; ch++){
+        ClickChannelState *state = &self->ch[ch];
+        const uint8_t *samples = &block[ch * slot_bytes + self->format.header_bytes];
+        uint32_t warmup = self->warmup;
+
+        for(size_t frame = 0; frame < frame_count; frame++){
+            int32_t x = audio_codec_sample_q31(&samples[frame * frame_bytes], self->format.sample_bytes);
+            int32_t y = __biquad_step(&self->stage[0], state->x[0], state->y[0], x);
+            y = __biquad_step(&self->stage[1], state->x[1], state->y[1], y);
+
+            //Teager-Kaiser energy of the band-passed signal
+            float s = (float)y;
+            float tkeo = state->tkeo_history[0] * state->tkeo_history[0] - s * state->tkeo_history[1];
+            state->tkeo_history[1] = state->tkeo_history[0];
+            state->tkeo_history[0] = s;
+            tkeo = (tkeo > 0.0f) ? tkeo : 0.0f;
+            state->envelope += (tkeo - state->envelope) * ENVELOPE_ALPHA;
+
+            float threshold = state->floor * self->threshold_factor;
+
+            if(warmup){
+                warmup--;
+                state->floor += (state->envelope - state->floor) * WARMUP_FLOOR_ALPHA;
+                continue;
+            }
+
+            if(state->in_click){
+                uint32_t magnitude = (y < 0) ? (uint32_t)-(int64_t)y : (uint32_t)y;
+                state->peak = (magnitude > state->peak) ? magnitude : state->peak;
+                state->click_len++;
+
+                if((state->envelope < (threshold * 0.5f)) || (state->click_len >= self->max_len)){
+                    state->in_click = false;
+                    state->refractory = self->refractory_len;
+
+                    if(event_count < max_events){
+                        events[event_count++] = (ClickEvent){
+                            .sequence = state->start_sequence,
+                            .frame = state->start_frame,
+                            .channel = ch,
+                            .amplitude = state->peak,
+                        };
+                    }
+                    else{
+                        self->missed_events++;
+                    }
+                }
+                continue;
+            }
+
+            //Only let the floor follow the background, never the clicks themselves
+            state->floor += (state->envelope - state->floor) * self->floor_alpha;
+
+            if(state->refractory){
+                state->refractory--;
+            }
+            else if(state->envelope > threshold){
+                state->in_click = true;
+                state->click_len = 0;
+                state->peak = 0;
+                state->start_sequence = sequence;
+                state->start_frame = frame;
+            }
+        }
+
+        //warm-up is counted in samples per channel, only burn it once every channel has seen this block
+        if(ch == (self->format.channel_count - 1)){
+            self->warmup = warmup;
+        }
+    }
+    return event_count;
+}
@@ -0,0 +1,186 @@
+/*
+ * extent_file.c
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Raw sequential writes into a preallocated extent, see extent_file.h
+ */
+
+#include "Lib Inc/extent_file.h"
+#include "fx_utility.h"
+#include <stdint.h>
+#include <string.h>
+
+/*********************
+ * PRIVATE VARIABLES *
+ *********************/
+
+//Aligned copy of unaligned sectors, only used with the media protection held
+static uint8_t extent_bounce[EXTENT_FILE_BOUNCE_SECTORS * EXTENT_FILE_SECTOR_SIZE] __attribute__((aligned(FX_SD_BUFFER_ALIGN)));
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/* write whole sectors at the current sector, straight to the driver (FileX drops any cached copies of them first) */
+static UINT __sectors_write(ExtentFile *self, const uint8_t *data, ULONG sectors){
+    FX_MEDIA *media = self->media;
+    ULONG sector = self->sector;
+    UINT fx_result = FX_SUCCESS;
+
+    tx_mutex_get(&media->fx_media_protect, TX_WAIT_FOREVER);
+    if(((uintptr_t)data & (FX_SD_BUFFER_ALIGN - 1)) == 0){
+        fx_result = _fx_utility_logical_sector_write(media, sector, (VOID *)data, sectors, FX_DATA_SECTOR);
+    }
+    else{
+        while((sectors > 0) && (fx_result == FX_SUCCESS)){
+            ULONG chunk = (sectors < EXTENT_FILE_BOUNCE_SECTORS) ? sectors : EXTENT_FILE_BOUNCE_SECTORS;
+            memcpy(extent_bounce, data, chunk * EXTENT_FILE_SECTOR_SIZE);
+            fx_result = _fx_utility_logical_sector_write(media, sector, extent_bounce, chunk, FX_DATA_SECTOR);
+            data += chunk * EXTENT_FILE_SECTOR_SIZE;
+            sector += chunk;
+            sectors -= chunk;
+        }
+    }
+    tx_mutex_put(&media->fx_media_protect);
+    return fx_result;
+}
+
+/* checkpoint, then move FileX's own file position up to where the raw writes got to */
+static UINT __leave_raw(ExtentFile *self){
+    UINT fx_result = extent_file_checkpoint(self);
+
+    self->raw = false;
+    if(fx_result != FX_SUCCESS){
+        return fx_result;
+    }
+    return fx_file_extended_seek(self->file, self->offset);
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+bool extent_file_contiguous(FX_MEDIA *media, FX_FILE *file, ULONG *first_sector){
+    if((file->fx_file_total_clusters == 0)
+            || ((file->fx_file_last_physical_cluster - file->fx_file_first_physical_cluster + 1) != file->fx_file_total_clusters)){
+        return false;
+    }
+    *first_sector = (ULONG)(media->fx_media_data_sector_start
+            + (ULONG64)(file->fx_file_first_physical_cluster - FX_FAT_ENTRY_START) * media->fx_media_sectors_per_cluster);
+    return true;
+}
+
+void extent_file_attach(ExtentFile *self, FX_MEDIA *media, FX_FILE *file){
+    self->media = media;
+    self->file = file;
+    self->raw = (media->fx_media_bytes_per_sector == EXTENT_FILE_SECTOR_SIZE) && (file->fx_file_current_file_size == 0);
+    self->extent_bytes = 0;
+    self->offset = 0;
+    self->sector = 0;
+    self->carry_len = 0;
+}
+
+UINT extent_file_allocate(ExtentFile *self, ULONG64 size, ULONG64 *allocated){
+    FX_FILE *file = self->file;
+    ULONG64 available = file->fx_file_current_available_size;
+    UINT fx_result = fx_file_extended_best_effort_allocate(file, size, allocated);
+
+    //The extent only grows while every cluster of the file is still in one run
+    ULONG first_sector;
+    if((fx_result == FX_SUCCESS) && self->raw && (self->extent_bytes == available)
+            && extent_file_contiguous(self->media, file, &first_sector)){
+        if(self->extent_bytes == 0){
+            self->sector = first_sector;
+        }
+        self->extent_bytes = file->fx_file_current_available_size;
+    }
+    return fx_result;
+}
+
+UINT extent_file_write(ExtentFile *self, const void *data, ULONG len){
+    const uint8_t *src = data;
+    ULONG64 end = self->offset + len;
+    UINT fx_result = FX_SUCCESS;
+
+    if(self->raw && ((((end + EXTENT_FILE_SECTOR_SIZE - 1) / EXTENT_FILE_SECTOR_SIZE) * EXTENT_FILE_SECTOR_SIZE) > self->extent_bytes)){
+        fx_result = __leave_raw(self);
+        if(fx_result != FX_SUCCESS){
+            return fx_result;
+        }
+    }
+    if(!self->raw){
+        fx_result = fx_file_write(self->file, (VOID *)data, len);
+        if(fx_result == FX_SUCCESS){
+            self->offset = end;
+        }
+        return fx_result;
+    }
+
+    //Top up the partial sector from last time
+    if(self->carry_len > 0){
+        ULONG fill = EXTENT_FILE_SECTOR_SIZE - self->carry_len;
+        if(fill > len){
+            fill = len;
+        }
+        memcpy(&self->carry[self->carry_len], src, fill);
+        self->carry_len += fill;
+        src += fill;
+        len -= fill;
+
+        if(self->carry_len == EXTENT_FILE_SECTOR_SIZE){
+            fx_result = __sectors_write(self, self->carry, 1);
+            if(fx_result != FX_SUCCESS){
+                return fx_result;
+            }
+            self->sector++;
+            self->carry_len = 0;
+        }
+    }
+
+    //Whole sectors go straight from the caller's buffer, in one driver request
+    ULONG sectors = len / EXTENT_FILE_SECTOR_SIZE;
+    if(sectors > 0){
+        fx_result = __sectors_write(self, src, sectors);
+        if(fx_result != FX_SUCCESS){
+            return fx_result;
+        }
+        self->sector += sectors;
+        src += sectors * EXTENT_FILE_SECTOR_SIZE;
+        len -= sectors * EXTENT_FILE_SECTOR_SIZE;
+    }
+
+    //Start a new partial sector with what is left
+    if(len > 0){
+        memcpy(&self->carry[self->carry_len], src, len);
+        self->carry_len += len;
+    }
+
+    //Only whole sectors are on the media, that's the size anyone reading the file (or a media flush) gets to see
+    self->offset = end;
+    self->file->fx_file_current_file_size = end - self->carry_len;
+    return FX_SUCCESS;
+}
+
+UINT extent_file_checkpoint(ExtentFile *self){
+    FX_FILE *file = self->file;
+
+    //fx_file_write keeps the directory entry up to date by itself
+    if(!self->raw){
+        return FX_SUCCESS;
+    }
+
+    //The carry stays where it is, the next write rewrites its sector once it's full
+    if(self->carry_len > 0){
+        memset(&self->carry[self->carry_len], 0, EXTENT_FILE_SECTOR_SIZE - self->carry_len);
+        UINT fx_result = __sectors_write(self, self->carry, 1);
+        if(fx_result != FX_SUCCESS){
+            return fx_result;
+        }
+    }
+
+    file->fx_file_current_file_size = self->offset;
+    file->fx_file_modified = FX_TRUE;
+    return fx_media_flush(self->media);
+}
@@ -0,0 +1,130 @@
+/*
+ * ltsa.c
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Long-term spectral average, see ltsa.h
+ */
+
+#include "Lib Inc/ltsa.h"
+#include <math.h>
+#include <string.h>
+
+/******************
+ * PRIVATE MACROS *
+ ******************/
+
+#define TWO_PI 6.28318531f
+
+//Q31 to [-1, 1)
+#define Q31_SCALE (1.0f / 2147483648.0f)
+
+_Static_assert((LTSA_FFT_SIZE & (LTSA_FFT_SIZE - 1)) == 0, "LTSA FFT size must be a power of 2");
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/*
+ * in place iterative radix-2 decimation in time FFT
+ */
+static void __fft(float (*x)[2], const float (*twiddle)[2]){
+    //bit reversed reorder
+    for(size_t i = 1, j = 0; i < LTSA_FFT_SIZE; i++){
+        size_t bit = LTSA_FFT_SIZE >> 1;
+        for(; j & bit; bit >>= 1){
+            j ^= bit;
+        }
+        j ^= bit;
+
+        if(i < j){
+            float re = x[i][0];
+            float im = x[i][1];
+            x[i][0] = x[j][0];
+            x[i][1] = x[j][1];
+            x[j][0] = re;
+            x[j][1] = im;
+        }
+    }
+
+    for(size_t len = 2; len <= LTSA_FFT_SIZE; len <<= 1){
+        size_t half = len / 2;
+        size_t step = LTSA_FFT_SIZE / len;
+
+        for(size_t i = 0; i < LTSA_FFT_SIZE; i += len){
+            for(size_t k = 0; k < half; k++){
+                float *a = x[i + k];
+                float *b = x[i + k + half];
+                float w_re = twiddle[k * step][0];
+                float w_im = twiddle[k * step][1];
+                float t_re = b[0] * w_re - b[1] * w_im;
+                float t_im = b[0] * w_im + b[1] * w_re;
+
+                b[0] = a[0] - t_re;
+                b[1] = a[1] - t_im;
+                a[0] += t_re;
+                a[1] += t_im;
+            }
+        }
+    }
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+void ltsa_init(Ltsa *self, const AudioCodecFormat *format){
+    float window_sum = 0.0f;
+
+    memset(self, 0, sizeof(*self));
+    self->format = *format;
+
+    for(size_t i = 0; i < LTSA_FFT_SIZE; i++){
+        self->window[i] = 0.5f - 0.5f * cosf(TWO_PI * i / LTSA_FFT_SIZE);
+        window_sum += self->window[i];
+    }
+    for(size_t k = 0; k < (LTSA_FFT_SIZE / 2); k++){
+        self->twiddle[k][0] = cosf(TWO_PI * k / LTSA_FFT_SIZE);
+        self->twiddle[k][1] = -sinf(TWO_PI * k / LTSA_FFT_SIZE);
+    }
+
+    //a full scale sine peaks at |X| = sum(w) / 2
+    self->power_scale = 4.0f / (window_sum * window_sum);
+}
+
+void ltsa_segment_load(Ltsa *self, const uint8_t *block, size_t frame, uint8_t channel){
+    size_t frame_bytes = audio_codec_frame_bytes(&self->format);
+    size_t slot_bytes = self->format.header_bytes + self->format.sample_bytes;
+    const uint8_t *samples = &block[frame * frame_bytes + channel * slot_bytes + self->format.header_bytes];
+
+    for(size_t i = 0; i < LTSA_FFT_SIZE; i++){
+        float sample = (float)audio_codec_sample_q31(&samples[i * frame_bytes], self->format.sample_bytes) * Q31_SCALE;
+        self->work[i][0] = sample * self->window[i];
+        self->work[i][1] = 0.0f;
+    }
+}
+
+void ltsa_segment_accumulate(Ltsa *self, uint8_t channel){
+    __fft(self->work, (const float (*)[2])self->twiddle);
+
+    for(size_t k = 0; k < LTSA_BINS; k++){
+        self->power[channel][k] += self->work[k][0] * self->work[k][0] + self->work[k][1] * self->work[k][1];
+    }
+    self->segments[channel]++;
+}
+
+uint32_t ltsa_average_take(Ltsa *self, uint8_t channel, int16_t *bins){
+    uint32_t segments = self->segments[channel];
+    float scale = (segments != 0) ? (self->power_scale / segments) : 0.0f;
+
+    for(size_t k = 0; k < LTSA_BINS; k++){
+        float power = self->power[channel][k] * scale;
+        float centi_db = (power > 0.0f) ? (1000.0f * log10f(power)) : (float)LTSA_DB_FLOOR;
+
+        bins[k] = (centi_db < LTSA_DB_FLOOR) ? LTSA_DB_FLOOR : ((centi_db > INT16_MAX) ? INT16_MAX : (int16_t)lrintf(centi_db));
+        self->power[channel][k] = 0.0f;
+    }
+    self->segments[channel] = 0;
+    return segments;
+}
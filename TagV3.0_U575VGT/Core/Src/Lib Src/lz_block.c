@@ -0,0 +1,196 @@
+/*
+ * lz_block.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    LZ4 block format compressor/decompressor, see lz_block.h
+ */
+
+#include "Lib Inc/lz_block.h"
+#include <stdbool.h>
+#include <string.h>
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static inline uint32_t __read_u32(const uint8_t *src){
+    uint32_t value;
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+static inline uint32_t __hash(uint32_t value){
+    return (value * 2654435761u) >> (32 - LZ_BLOCK_HASH_BITS);
+}
+
+/* write a length that didn't fit in its token nibble, returns the new output position or NULL if it doesn't fit */
+static uint8_t *__put_length(uint8_t *dst, const uint8_t *dst_end, size_t len){
+    while(len >= 255){
+        if(dst >= dst_end){
+            return NULL;
+        }
+        *dst++ = 255;
+        len -= 255;
+    }
+    if(dst >= dst_end){
+        return NULL;
+    }
+    *dst++ = (uint8_t)len;
+    return dst;
+}
+
+/* write one sequence (a match_len of 0 writes the closing, literals only sequence), returns NULL if it doesn't fit */
+static uint8_t *__put_sequence(uint8_t *dst, const uint8_t *dst_end, const uint8_t *literals, size_t literal_len, uint16_t offset, size_t match_len){
+    size_t match_code = (match_len != 0) ? (match_len - LZ_BLOCK_MIN_MATCH) : 0;
+    uint8_t *token = dst;
+
+    if(dst >= dst_end){
+        return NULL;
+    }
+    *token = (uint8_t)(((literal_len < 15) ? literal_len : 15) << 4) | (uint8_t)((match_code < 15) ? match_code : 15);
+    dst++;
+
+    if((literal_len >= 15) && ((dst = __put_length(dst, dst_end, literal_len - 15)) == NULL)){
+        return NULL;
+    }
+    if((size_t)(dst_end - dst) < literal_len){
+        return NULL;
+    }
+    memcpy(dst, literals, literal_len);
+    dst += literal_len;
+
+    if(match_len == 0){
+        return dst;
+    }
+    if((dst_end - dst) < 2){
+        return NULL;
+    }
+    *dst++ = (uint8_t)offset;
+    *dst++ = (uint8_t)(offset >> 8);
+    if(match_code >= 15){
+        dst = __put_length(dst, dst_end, match_code - 15);
+    }
+    return dst;
+}
+
+/* read a length continued past its token nibble, returns false if the block ends first */
+static bool __get_length(const uint8_t **src, const uint8_t *src_end, size_t *len){
+    uint8_t byte;
+
+    do{
+        if(*src >= src_end){
+            return false;
+        }
+        byte = *(*src)++;
+        *len += byte;
+    }while(byte == 255);
+    return true;
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+size_t lz_block_compress(LzBlockTable *table, const uint8_t *src, size_t len, uint8_t *dst, size_t dst_capacity){
+    const uint8_t *dst_end = dst + dst_capacity;
+    uint8_t *out = dst;
+    size_t anchor = 0;
+    size_t pos = 0;
+
+    if(len > LZ_BLOCK_MAX_INPUT){
+        return 0;
+    }
+
+    //Too short to hold a match, everything is the closing literals
+    if(len > LZ_BLOCK_MATCH_START_LIMIT){
+        size_t match_start_limit = len - LZ_BLOCK_MATCH_START_LIMIT;
+        size_t match_end_limit = len - LZ_BLOCK_LAST_LITERALS;
+
+        //Position 0 is a fine default, every candidate is checked against the data anyway
+        memset(table->table, 0, sizeof(table->table));
+
+        while(pos < match_start_limit){
+            uint32_t value = __read_u32(&src[pos]);
+            uint32_t hash = __hash(value);
+            size_t candidate = table->table[hash];
+            table->table[hash] = (uint16_t)pos;
+
+            if((candidate >= pos) || ((pos - candidate) > UINT16_MAX) || (__read_u32(&src[candidate]) != value)){
+                pos++;
+                continue;
+            }
+
+            //Stretch the match back over literals it also covers, then forward as far as the format allows
+            while((pos > anchor) && (candidate > 0) && (src[pos - 1] == src[candidate - 1])){
+                pos--;
+                candidate--;
+            }
+            size_t match_len = LZ_BLOCK_MIN_MATCH;
+            while(((pos + match_len) < match_end_limit) && (src[candidate + match_len] == src[pos + match_len])){
+                match_len++;
+            }
+
+            out = __put_sequence(out, dst_end, &src[anchor], pos - anchor, (uint16_t)(pos - candidate), match_len);
+            if(out == NULL){
+                return 0;
+            }
+            pos += match_len;
+            anchor = pos;
+
+            //Remember a position inside the match too, runs of records line up with it
+            if(pos < match_start_limit){
+                table->table[__hash(__read_u32(&src[pos - 2]))] = (uint16_t)(pos - 2);
+            }
+        }
+    }
+
+    out = __put_sequence(out, dst_end, &src[anchor], len - anchor, 0, 0);
+    return (out == NULL) ? 0 : (size_t)(out - dst);
+}
+
+size_t lz_block_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_capacity){
+    const uint8_t *src_end = src + len;
+    size_t out = 0;
+
+    while(src < src_end){
+        uint8_t token = *src++;
+        size_t literal_len = token >> 4;
+        size_t match_len = token & 0x0F;
+
+        if((literal_len == 15) && !__get_length(&src, src_end, &literal_len)){
+            return 0;
+        }
+        if(((size_t)(src_end - src) < literal_len) || ((dst_capacity - out) < literal_len)){
+            return 0;
+        }
+        memcpy(&dst[out], src, literal_len);
+        src += literal_len;
+        out += literal_len;
+
+        //The closing sequence has no match
+        if(src == src_end){
+            return out;
+        }
+
+        if((src_end - src) < 2){
+            return 0;
+        }
+        size_t offset = src[0] | ((size_t)src[1] << 8);
+        src += 2;
+        if((match_len == 15) && !__get_length(&src, src_end, &match_len)){
+            return 0;
+        }
+        match_len += LZ_BLOCK_MIN_MATCH;
+        if((offset == 0) || (offset > out) || ((dst_capacity - out) < match_len)){
+            return 0;
+        }
+
+        //Byte by byte, matches can overlap their own output
+        for(size_t i = 0; i < match_len; i++, out++){
+            dst[out] = dst[out - offset];
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * offload.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Bulk offload protocol engine, see offload.h for the wire format.
+ */
+
+#include "Lib Inc/offload.h"
+#include "Lib Inc/audio_file.h"
+#include "util.h"
+#include <string.h>
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/* send one frame header and its payload */
+static bool __send_frame(OffloadSession *self, const OffloadFrame *frame, const uint8_t *payload){
+    const OffloadTransport *transport = self->transport;
+
+    offload_frame_pack(frame, self->header);
+    if(!transport->send(transport->context, self->header, OFFLOAD_FRAME_HEADER_SIZE)){
+        return false;
+    }
+    return (frame->length == 0) || transport->send(transport->context, payload, frame->length);
+}
+
+static bool __send_error(OffloadSession *self, OffloadError error){
+    OffloadFrame frame = {.type = OFFLOAD_FRAME_ERROR, .raw_length = error};
+    return __send_frame(self, &frame, NULL);
+}
+
+/* one ENTRY per file, then END with the count */
+static bool __serve_list(OffloadSession *self){
+    const OffloadFiles *files = self->files;
+    char *name = (char *)self->raw;
+    uint64_t size = 0;
+    uint64_t count = 0;
+
+    for(bool first = true; files->next_entry(files->context, first, name, sizeof(self->raw), &size); first = false){
+        size_t name_len = strnlen(name, sizeof(self->raw));
+        OffloadFrame frame = {
+            .type = OFFLOAD_FRAME_ENTRY,
+            .offset = size,
+            .length = name_len,
+            .crc = audio_file_crc32(0, (const uint8_t *)name, name_len),
+        };
+        if(!__send_frame(self, &frame, (const uint8_t *)name)){
+            return false;
+        }
+        count++;
+    }
+
+    OffloadFrame end = {.type = OFFLOAD_FRAME_END, .offset = count};
+    return __send_frame(self, &end, NULL);
+}
+
+/* DATA frames from the requested offset to the end of the file, then END */
+static bool __serve_read(OffloadSession *self, const OffloadRequest *request){
+    const OffloadFiles *files = self->files;
+    uint64_t size = 0;
+    uint64_t offset = request->offset;
+    bool link_ok = true;
+
+    if(!files->open(files->context, request->name, &size)){
+        return __send_error(self, OFFLOAD_ERROR_NOT_FOUND);
+    }
+    if(offset > size){
+        files->close(files->context);
+        return __send_error(self, OFFLOAD_ERROR_OFFSET);
+    }
+
+    while(link_ok && (offset < size)){
+        uint32_t chunk = ((size - offset) < OFFLOAD_CHUNK_SIZE) ? (uint32_t)(size - offset) : OFFLOAD_CHUNK_SIZE;
+        int32_t read = files->read(files->context, offset, self->raw, chunk);
+        if(read != (int32_t)chunk){
+            files->close(files->context);
+            return __send_error(self, OFFLOAD_ERROR_READ);
+        }
+
+        OffloadFrame frame = {
+            .type = OFFLOAD_FRAME_DATA,
+            .offset = offset,
+            .raw_length = chunk,
+            .length = chunk,
+            .crc = audio_file_crc32(0, self->raw, chunk),
+        };
+        const uint8_t *payload = self->raw;
+
+        //Only sent compressed if it's actually smaller
+        if(request->flags & OFFLOAD_FLAG_COMPRESS){
+            size_t packed = lz_block_compress(&self->lz_table, self->raw, chunk, self->packed, chunk - 1);
+            if(packed != 0){
+                frame.flags = OFFLOAD_FLAG_COMPRESSED;
+                frame.length = packed;
+                payload = self->packed;
+            }
+        }
+
+        link_ok = __send_frame(self, &frame, payload);
+        offset += chunk;
+    }
+    files->close(files->context);
+
+    OffloadFrame end = {.type = OFFLOAD_FRAME_END, .offset = size};
+    return link_ok && __send_frame(self, &end, NULL);
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+void offload_request_pack(const OffloadRequest *request, uint8_t *buf){
+    memset(buf, 0, OFFLOAD_REQUEST_SIZE);
+    util_put_u32(&buf[0], OFFLOAD_MAGIC);
+    buf[4] = request->command;
+    buf[5] = request->flags;
+    util_put_u16(&buf[6], 0);
+    util_put_u64(&buf[8], request->offset);
+    memcpy(&buf[16], request->name, strnlen(request->name, OFFLOAD_NAME_LEN));
+    util_put_u32(&buf[16 + OFFLOAD_NAME_LEN], audio_file_crc32(0, buf, 16 + OFFLOAD_NAME_LEN));
+}
+
+bool offload_request_unpack(OffloadRequest *request, const uint8_t *buf){
+    if((util_get_u32(&buf[0]) != OFFLOAD_MAGIC)
+            || (util_get_u32(&buf[16 + OFFLOAD_NAME_LEN]) != audio_file_crc32(0, buf, 16 + OFFLOAD_NAME_LEN))){
+        return false;
+    }
+    request->command = buf[4];
+    request->flags = buf[5];
+    request->offset = util_get_u64(&buf[8]);
+    memcpy(request->name, &buf[16], OFFLOAD_NAME_LEN);
+    request->name[OFFLOAD_NAME_LEN] = '\0';
+    return true;
+}
+
+void offload_frame_pack(const OffloadFrame *frame, uint8_t *buf){
+    util_put_u32(&buf[0], OFFLOAD_MAGIC);
+    buf[4] = frame->type;
+    buf[5] = frame->flags;
+    util_put_u16(&buf[6], 0);
+    util_put_u64(&buf[8], frame->offset);
+    util_put_u32(&buf[16], frame->raw_length);
+    util_put_u32(&buf[20], frame->length);
+    util_put_u32(&buf[24], frame->crc);
+}
+
+bool offload_frame_unpack(OffloadFrame *frame, const uint8_t *buf){
+    if(util_get_u32(&buf[0]) != OFFLOAD_MAGIC){
+        return false;
+    }
+    frame->type = buf[4];
+    frame->flags = buf[5];
+    frame->offset = util_get_u64(&buf[8]);
+    frame->raw_length = util_get_u32(&buf[16]);
+    frame->length = util_get_u32(&buf[20]);
+    frame->crc = util_get_u32(&buf[24]);
+    return true;
+}
+
+void offload_init(OffloadSession *self, const OffloadTransport *transport, const OffloadFiles *files){
+    self->transport = transport;
+    self->files = files;
+}
+
+bool offload_serve(OffloadSession *self){
+    const OffloadTransport *transport = self->transport;
+    OffloadRequest request;
+
+    //The request is read into the chunk buffer, it's free between requests
+    if(!transport->receive(transport->context, self->raw, OFFLOAD_REQUEST_SIZE)){
+        return false;
+    }
+    if(!offload_request_unpack(&request, self->raw)){
+        return __send_error(self, OFFLOAD_ERROR_REQUEST);
+    }
+
+    switch(request.command){
+        case OFFLOAD_COMMAND_LIST:
+            return __serve_list(self);
+        case OFFLOAD_COMMAND_READ:
+            return __serve_read(self, &request);
+        default:
+            return __send_error(self, OFFLOAD_ERROR_REQUEST);
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * offload_fx.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    FileX file source for the bulk offload protocol, see offload_fx.h
+ */
+
+#include "Lib Inc/offload_fx.h"
+#include <string.h>
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/* the next plain file of the root directory (directories and the volume label are skipped) */
+static bool __next_entry(void *context, bool first, char *name, size_t name_len, uint64_t *size){
+    OffloadFxFiles *self = context;
+    UINT attributes = 0;
+    ULONG file_size = 0;
+    UINT fx_result;
+
+    if(first){
+        fx_result = fx_directory_first_full_entry_find(self->media, self->name, &attributes, &file_size, NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+    else{
+        fx_result = fx_directory_next_full_entry_find(self->media, self->name, &attributes, &file_size, NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+    while((fx_result == FX_SUCCESS) && (attributes & (FX_DIRECTORY | FX_VOLUME))){
+        fx_result = fx_directory_next_full_entry_find(self->media, self->name, &attributes, &file_size, NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+    if(fx_result != FX_SUCCESS){
+        return false;
+    }
+
+    strncpy(name, self->name, name_len - 1);
+    name[name_len - 1] = '\0';
+    *size = file_size;
+    return true;
+}
+
+static bool __open(void *context, const char *name, uint64_t *size){
+    OffloadFxFiles *self = context;
+
+    if(fx_file_open(self->media, &self->file, (CHAR *)name, FX_OPEN_FOR_READ) != FX_SUCCESS){
+        return false;
+    }
+    *size = self->file.fx_file_current_file_size;
+    return true;
+}
+
+static int32_t __read(void *context, uint64_t offset, uint8_t *data, uint32_t len){
+    OffloadFxFiles *self = context;
+    ULONG actual = 0;
+
+    if(fx_file_extended_seek(&self->file, offset) != FX_SUCCESS){
+        return -1;
+    }
+    if((fx_file_read(&self->file, data, len, &actual) != FX_SUCCESS) && (actual == 0)){
+        return -1;
+    }
+    return (int32_t)actual;
+}
+
+static void __close(void *context){
+    OffloadFxFiles *self = context;
+
+    fx_file_close(&self->file);
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+void offload_fx_files_init(OffloadFxFiles *self, FX_MEDIA *media){
+    *self = (OffloadFxFiles){
+        .files = {
+            .context = self,
+            .next_entry = __next_entry,
+            .open = __open,
+            .read = __read,
+            .close = __close,
+        },
+        .media = media,
+    };
+}
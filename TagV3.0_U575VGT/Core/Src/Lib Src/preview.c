@@ -0,0 +1,121 @@
+/*
+ * preview.c
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Decimated preview stream, see preview.h
+ */
+
+#include "Lib Inc/preview.h"
+#include "util.h"
+#include <math.h>
+#include <string.h>
+
+/******************
+ * PRIVATE MACROS *
+ ******************/
+
+#define PI 3.14159265f
+
+//Q31 sample to 16-bit full scale
+#define Q31_TO_16 (1.0f / 65536.0f)
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+bool preview_init(PreviewDecimator *self, const AudioCodecFormat *format, uint8_t channel, uint32_t sample_rate){
+    memset(self, 0, sizeof(*self));
+    if((channel >= format->channel_count) || (sample_rate < PREVIEW_RATE_HZ) || ((sample_rate % PREVIEW_RATE_HZ) != 0)){
+        return false;
+    }
+    if((sample_rate / PREVIEW_RATE_HZ) > PREVIEW_DECIMATION_MAX){
+        return false;
+    }
+
+    self->format = *format;
+    self->channel = channel;
+    self->decimation = sample_rate / PREVIEW_RATE_HZ;
+    self->tap_count = PREVIEW_TAPS_PER_PHASE * self->decimation;
+    self->countdown = self->decimation;
+
+    //Windowed sinc low-pass, normalized to unity gain at DC
+    float cutoff = PREVIEW_CUTOFF * PREVIEW_RATE_HZ / (float)sample_rate;
+    float center = (self->tap_count - 1) / 2.0f;
+    float sum = 0.0f;
+
+    for(uint32_t n = 0; n < self->tap_count; n++){
+        float t = n - center;
+        float sinc = (t == 0.0f) ? (2.0f * cutoff) : (sinf(2.0f * PI * cutoff * t) / (PI * t));
+        float phase = 2.0f * PI * n / (self->tap_count - 1);
+        float window = (self->tap_count > 1) ? (0.42f - 0.5f * cosf(phase) + 0.08f * cosf(2.0f * phase)) : 1.0f;
+
+        self->taps[n] = sinc * window;
+        sum += self->taps[n];
+    }
+    for(uint32_t n = 0; n < self->tap_count; n++){
+        self->taps[n] /= sum;
+    }
+    return true;
+}
+
+size_t preview_process(PreviewDecimator *self, const uint8_t *frames, size_t frame_count, int16_t *out){
+    size_t frame_bytes = audio_codec_frame_bytes(&self->format);
+    const uint8_t *sample = &frames[self->channel * (self->format.header_bytes + self->format.sample_bytes) + self->format.header_bytes];
+    uint32_t tap_count = self->tap_count;
+    uint32_t pos = self->pos;
+    uint32_t countdown = self->countdown;
+    size_t out_count = 0;
+
+    for(size_t frame = 0; frame < frame_count; frame++, sample += frame_bytes){
+        float x = (float)audio_codec_sample_q31(sample, self->format.sample_bytes) * Q31_TO_16;
+
+        //The newest sample replaces the oldest one, in both copies
+        self->history[pos] = x;
+        self->history[pos + tap_count] = x;
+        pos = (pos + 1 == tap_count) ? 0 : (pos + 1);
+
+        if(--countdown != 0){
+            continue;
+        }
+        countdown = self->decimation;
+
+        const float *window = &self->history[pos];
+        float acc = 0.0f;
+        for(uint32_t n = 0; n < tap_count; n++){
+            acc += window[n] * self->taps[n];
+        }
+
+        long y = lrintf(acc);
+        out[out_count++] = (y > INT16_MAX) ? INT16_MAX : ((y < INT16_MIN) ? INT16_MIN : (int16_t)y);
+    }
+
+    self->pos = pos;
+    self->countdown = countdown;
+    return out_count;
+}
+
+void preview_wav_header(uint8_t *header, uint32_t data_bytes){
+    memset(header, 0, PREVIEW_WAV_HEADER_SIZE);
+
+    memcpy(&header[0], "RIFF", 4);
+    util_put_u32(&header[4], PREVIEW_WAV_HEADER_SIZE - 8 + data_bytes);
+    memcpy(&header[8], "WAVE", 4);
+
+    memcpy(&header[12], "fmt ", 4);
+    util_put_u32(&header[16], 16);
+    util_put_u16(&header[20], 1);                          //PCM
+    util_put_u16(&header[22], 1);                          //mono
+    util_put_u32(&header[24], PREVIEW_RATE_HZ);
+    util_put_u32(&header[28], PREVIEW_RATE_HZ * sizeof(int16_t));
+    util_put_u16(&header[32], sizeof(int16_t));
+    util_put_u16(&header[34], 16);
+
+    //Padding up to the data chunk, which ends the header
+    memcpy(&header[36], "JUNK", 4);
+    util_put_u32(&header[40], PREVIEW_WAV_HEADER_SIZE - 8 - 36 - 8);
+
+    memcpy(&header[PREVIEW_WAV_HEADER_SIZE - 8], "data", 4);
+    util_put_u32(&header[PREVIEW_WAV_HEADER_SIZE - 4], data_bytes);
+}
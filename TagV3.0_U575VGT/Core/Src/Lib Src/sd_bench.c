@@ -0,0 +1,310 @@
+/*
+ * sd_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    SD card storage benchmark, see sd_bench.h
+ */
+
+#include "Lib Inc/sd_bench.h"
+#include "Lib Inc/audio_stats.h"
+#include "Lib Inc/extent_file.h"
+#include "Lib Inc/sd_bus.h"
+#include "Lib Inc/timing.h"
+#include "config.h"
+#include "main.h"
+#include "util.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern RTC_HandleTypeDef hrtc;
+
+/********************
+ * PRIVATE TYPEDEFS *
+ ********************/
+
+typedef enum {
+    SD_BENCH_FILEX = 0,
+    SD_BENCH_RAW,
+    SD_BENCH_RAW_FALLBACK,  //a raw test whose extent wasn't contiguous, so it went through fx_file_write after all
+} SdBenchPath;
+
+/*********************
+ * PRIVATE VARIABLES *
+ *********************/
+
+static FX_FILE sd_bench_file;
+static FX_FILE sd_bench_report;
+static ExtentFile sd_bench_extent;
+static AudioStats sd_bench_stats;
+static char sd_bench_line[SD_BENCH_CSV_LINE_MAX];
+
+//The benchmark thread and what it was asked to do
+static TX_THREAD sd_bench_thread;
+static TX_SEMAPHORE sd_bench_done;
+static FX_FILE sd_bench_config_file;
+static struct {
+    FX_MEDIA *media;
+    uint8_t *buffer;
+    ULONG buffer_len;
+    UINT result;
+} sd_bench_job;
+
+static const char *sd_bench_path_names[] = {
+    [SD_BENCH_FILEX] = "filex",
+    [SD_BENCH_RAW] = "raw",
+    [SD_BENCH_RAW_FALLBACK] = "raw_fallback",
+};
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/* milliseconds since a tick count, the time column of the report rows */
+static inline uint32_t __ms_since(ULONG start){
+    return (uint32_t)(((uint64_t)(tx_time_get() - start) * 1000) / TX_TIMER_TICKS_PER_SECOND);
+}
+
+/* a new, empty benchmark file opened for writing, with SD_BENCH_TEST_BYTES preallocated */
+static UINT __file_create(FX_MEDIA *media, SdBenchPath path){
+    ULONG64 allocated = 0;
+    UINT fx_result;
+
+    fx_file_delete(media, SD_BENCH_FILE_NAME);
+    fx_result = fx_file_create(media, SD_BENCH_FILE_NAME);
+    if(fx_result != FX_SUCCESS){
+        return fx_result;
+    }
+    fx_result = fx_file_open(media, &sd_bench_file, SD_BENCH_FILE_NAME, FX_OPEN_FOR_WRITE);
+    if(fx_result != FX_SUCCESS){
+        return fx_result;
+    }
+
+    if(path == SD_BENCH_RAW){
+        extent_file_attach(&sd_bench_extent, media, &sd_bench_file);
+        fx_result = extent_file_allocate(&sd_bench_extent, SD_BENCH_TEST_BYTES, &allocated);
+    }
+    else{
+        fx_result = fx_file_extended_best_effort_allocate(&sd_bench_file, SD_BENCH_TEST_BYTES, &allocated);
+    }
+    if((fx_result == FX_SUCCESS) && (allocated < SD_BENCH_TEST_BYTES)){
+        fx_result = FX_NO_MORE_SPACE;
+    }
+    if(fx_result != FX_SUCCESS){
+        fx_file_close(&sd_bench_file);
+    }
+    return fx_result;
+}
+
+/*
+ * Desc: write the benchmark file one block at a time, the file is left closed on the card.
+ *       The final checkpoint/flush counts towards the total time but not as a call.
+ *       A raw test that couldn't stay raw comes back as SD_BENCH_RAW_FALLBACK in path.
+ */
+static UINT __write_test(FX_MEDIA *media, SdBenchPath *path, uint8_t *buffer, ULONG block, AudioStats *stats){
+    UINT fx_result = __file_create(media, *path);
+
+    audio_stats_reset(stats);
+    if(fx_result != FX_SUCCESS){
+        return fx_result;
+    }
+    if((*path == SD_BENCH_RAW) && (!sd_bench_extent.raw || (sd_bench_extent.extent_bytes < SD_BENCH_TEST_BYTES))){
+        *path = SD_BENCH_RAW_FALLBACK;
+    }
+
+    for(ULONG offset = 0; (offset < SD_BENCH_TEST_BYTES) && (fx_result == FX_SUCCESS); offset += block){
+        uint32_t start = DWT->CYCCNT;
+        fx_result = (*path != SD_BENCH_FILEX) ? extent_file_write(&sd_bench_extent, buffer, block)
+                                              : fx_file_write(&sd_bench_file, buffer, block);
+        audio_stats_write(stats, block, cycle_counter_us_since(start));
+    }
+
+    uint32_t start = DWT->CYCCNT;
+    if(fx_result == FX_SUCCESS){
+        fx_result = (*path != SD_BENCH_FILEX) ? extent_file_checkpoint(&sd_bench_extent) : fx_media_flush(media);
+    }
+    stats->write_us += cycle_counter_us_since(start);
+
+    fx_file_close(&sd_bench_file);
+    return fx_result;
+}
+
+/* read the benchmark file back one block at a time */
+static UINT __read_test(FX_MEDIA *media, uint8_t *buffer, ULONG block, AudioStats *stats){
+    UINT fx_result = fx_file_open(media, &sd_bench_file, SD_BENCH_FILE_NAME, FX_OPEN_FOR_READ);
+
+    audio_stats_reset(stats);
+    if(fx_result != FX_SUCCESS){
+        return fx_result;
+    }
+
+    for(ULONG offset = 0; (offset < SD_BENCH_TEST_BYTES) && (fx_result == FX_SUCCESS); offset += block){
+        ULONG actual = 0;
+        uint32_t start = DWT->CYCCNT;
+        fx_result = fx_file_read(&sd_bench_file, buffer, block, &actual);
+        audio_stats_write(stats, actual, cycle_counter_us_since(start));
+        if((fx_result == FX_SUCCESS) && (actual != block)){
+            fx_result = FX_END_OF_FILE;
+        }
+    }
+
+    fx_file_close(&sd_bench_file);
+    return fx_result;
+}
+
+/* open the report for appending, with the column names if it's new */
+static UINT __report_open(FX_MEDIA *media){
+    UINT fx_result;
+
+    fx_file_create(media, SD_BENCH_REPORT_NAME);
+    fx_result = fx_file_open(media, &sd_bench_report, SD_BENCH_REPORT_NAME, FX_OPEN_FOR_WRITE);
+    if(fx_result != FX_SUCCESS){
+        return fx_result;
+    }
+    fx_result = fx_file_relative_seek(&sd_bench_report, 0, FX_SEEK_END);
+    if((fx_result == FX_SUCCESS) && (sd_bench_report.fx_file_current_file_size == 0)){
+        int len = snprintf(sd_bench_line, sizeof(sd_bench_line), "run,test,path,block_bytes,clock_div,high_speed,result,kbps,");
+        size_t pos = (len < 0) ? 0 : (size_t)len;
+
+        pos += audio_stats_csv_header(&sd_bench_line[pos], sizeof(sd_bench_line) - pos);
+        fx_result = fx_file_write(&sd_bench_report, sd_bench_line, pos);
+    }
+    if(fx_result != FX_SUCCESS){
+        fx_file_close(&sd_bench_report);
+    }
+    return fx_result;
+}
+
+/* one row of results: what was run, then the audio_stats columns (writes are the calls, whichever way they went) */
+static UINT __report_row(const char *run, const char *test, SdBenchPath path, ULONG block, UINT result, const AudioStats *stats,
+                         uint32_t time_ms){
+    const SdBusProfile *bus = sd_bus_profile();
+    uint64_t us = (stats->write_us == 0) ? 1 : stats->write_us;
+    int len = snprintf(sd_bench_line, sizeof(sd_bench_line), "%s,%s,%s,%lu,%lu,%lu,%lu,%lu,", run, test, sd_bench_path_names[path],
+                       (unsigned long)block, (unsigned long)bus->clock_div[SD_BUS_CAPTURE], (unsigned long)bus->high_speed,
+                       (unsigned long)result, (unsigned long)((stats->write_bytes * 1000000) / (us * 1024)));
+    size_t pos = (len < 0) ? 0 : _MIN((size_t)len, sizeof(sd_bench_line) - 1);
+
+    pos += audio_stats_csv_row(stats, time_ms, &sd_bench_line[pos], sizeof(sd_bench_line) - pos);
+    return fx_file_write(&sd_bench_report, sd_bench_line, pos);
+}
+
+/* the RTC time as "YYYYMMDD_HHMMSS", to tell runs apart in the report */
+static void __run_stamp(char *stamp, size_t len){
+    RTC_TimeTypeDef time = {};
+    RTC_DateTypeDef date = {};
+
+    //The date has to be read after the time to unlock the RTC shadow registers
+    HAL_RTC_GetTime(&hrtc, &time, RTC_FORMAT_BIN);
+    HAL_RTC_GetDate(&hrtc, &date, RTC_FORMAT_BIN);
+    snprintf(stamp, len, "%04u%02u%02u_%02u%02u%02u", 2000 + date.Year, date.Month, date.Date, time.Hours, time.Minutes, time.Seconds);
+}
+
+/* read config.txt and run the benchmark if it asks for it */
+static void __thread_entry(ULONG thread_input){
+    TagConfig config;
+    char run[SD_BENCH_RUN_NAME_LEN];
+
+    if(fx_file_open(sd_bench_job.media, &sd_bench_config_file, TAG_CONFIG_FILE_NAME, FX_OPEN_FOR_READ) == FX_SUCCESS){
+        TagConfig_read(&config, &sd_bench_config_file);
+        fx_file_close(&sd_bench_config_file);
+    }
+    else{
+        TagConfig_read(&config, NULL);
+    }
+
+    sd_bench_job.result = FX_SUCCESS;
+    if(config.sd_benchmark){
+        __run_stamp(run, sizeof(run));
+        sd_bench_job.result = sd_bench_run(sd_bench_job.media, sd_bench_job.buffer, sd_bench_job.buffer_len, run);
+    }
+    tx_semaphore_put(&sd_bench_done);
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+UINT sd_bench_boot(FX_MEDIA *media, uint8_t *buffer, ULONG buffer_len){
+    VOID *stack = NULL;
+
+    if(media->fx_media_id != FX_MEDIA_ID){
+        return FX_MEDIA_NOT_OPEN;
+    }
+    stack = malloc(SD_BENCH_THREAD_STACK_SIZE);
+    if(stack == NULL){
+        return FX_NOT_ENOUGH_MEMORY;
+    }
+
+    sd_bench_job.media = media;
+    sd_bench_job.buffer = buffer;
+    sd_bench_job.buffer_len = buffer_len;
+    sd_bench_job.result = FX_SUCCESS;
+
+    tx_semaphore_create(&sd_bench_done, "SD Benchmark Done", 0);
+    if(tx_thread_create(&sd_bench_thread, "SD Benchmark", __thread_entry, 0, stack, SD_BENCH_THREAD_STACK_SIZE,
+            SD_BENCH_THREAD_PRIO, SD_BENCH_THREAD_PRIO, TX_NO_TIME_SLICE, TX_AUTO_START) == TX_SUCCESS){
+        tx_semaphore_get(&sd_bench_done, TX_WAIT_FOREVER);
+        tx_thread_terminate(&sd_bench_thread);
+        tx_thread_delete(&sd_bench_thread);
+    }
+    else{
+        sd_bench_job.result = FX_NOT_ENOUGH_MEMORY;
+    }
+    tx_semaphore_delete(&sd_bench_done);
+    free(stack);
+    return sd_bench_job.result;
+}
+
+UINT sd_bench_run(FX_MEDIA *media, uint8_t *buffer, ULONG buffer_len, const char *run){
+    ULONG block_max = SD_BENCH_BLOCK_MAX;
+    AudioStats *stats = &sd_bench_stats;
+    ULONG run_start = tx_time_get();
+    UINT first_error = FX_SUCCESS;
+    UINT fx_result;
+
+    while(block_max > buffer_len){
+        block_max /= 2;
+    }
+    if(block_max < SD_BENCH_BLOCK_MIN){
+        return FX_PTR_ERROR;
+    }
+
+    fx_result = __report_open(media);
+    if(fx_result != FX_SUCCESS){
+        return fx_result;
+    }
+
+    //Something other than zeros, in case a card treats those differently
+    for(ULONG i = 0; i < block_max; i++){
+        buffer[i] = (uint8_t)(i ^ (i >> 8) ^ (i >> 16));
+    }
+
+    for(SdBenchPath test_path = SD_BENCH_FILEX; test_path <= SD_BENCH_RAW; test_path++){
+        for(ULONG block = SD_BENCH_BLOCK_MIN; block <= block_max; block *= 2){
+            SdBenchPath path = test_path;
+            fx_result = __write_test(media, &path, buffer, block, stats);
+            __report_row(run, "write", path, block, fx_result, stats, __ms_since(run_start));
+            if(first_error == FX_SUCCESS){
+                first_error = fx_result;
+            }
+        }
+    }
+
+    //The raw test at the largest block left a full file behind to read
+    for(ULONG block = SD_BENCH_BLOCK_MIN; block <= block_max; block *= 2){
+        fx_result = __read_test(media, buffer, block, stats);
+        __report_row(run, "read", SD_BENCH_FILEX, block, fx_result, stats, __ms_since(run_start));
+        if(first_error == FX_SUCCESS){
+            first_error = fx_result;
+        }
+    }
+
+    fx_file_delete(media, SD_BENCH_FILE_NAME);
+    fx_file_close(&sd_bench_report);
+    fx_media_flush(media);
+    return first_error;
+}
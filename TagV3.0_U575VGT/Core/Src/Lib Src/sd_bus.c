@@ -0,0 +1,425 @@
+/*
+ * sd_bus.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    SD bus speed negotiation and calibration, see sd_bus.h
+ */
+
+#include "Lib Inc/sd_bus.h"
+#include "Lib Inc/audio_file.h"
+#include "Lib Inc/extent_file.h"
+#include "Lib Inc/timing.h"
+#include "main.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern SD_HandleTypeDef hsd1;
+
+/******************
+ * PRIVATE MACROS *
+ ******************/
+
+#define SD_BUS_PROFILE_MAGIC 0x53554253UL //"SBUS"
+
+#define SD_BUS_BLOCK_SIZE 512
+#define SD_BUS_BURST_BYTES (SD_BUS_TEST_BLOCKS * SD_BUS_BLOCK_SIZE)
+#define SD_BUS_SCRATCH_BYTES (SD_BUS_TEST_BURSTS * SD_BUS_BURST_BYTES)
+
+//Fastest clock a card takes in default speed timing
+#define SD_BUS_DEFAULT_SPEED_HZ 25000000UL
+
+//Dividers tried, fastest first
+#define SD_BUS_NUM_DIVS (SD_BUS_REFERENCE_CLK_DIV + 1)
+
+#define SD_BUS_LOG_LINE_MAX 128
+
+/*********************
+ * PRIVATE VARIABLES *
+ *********************/
+
+static SdBusProfile sd_bus = {
+    .magic = SD_BUS_PROFILE_MAGIC,
+    .clock_div = {
+        [SD_BUS_CAPTURE] = SD_BUS_DEFAULT_CAPTURE_CLK_DIV,
+        [SD_BUS_OFFLOAD] = SD_BUS_DEFAULT_OFFLOAD_CLK_DIV,
+    },
+};
+
+static FX_MEDIA *sd_bus_media;
+static FX_FILE sd_bus_file;
+
+static TX_THREAD sd_bus_thread;
+static TX_SEMAPHORE sd_bus_done;
+
+//One burst of test data, straight to the SDMMC DMA
+static uint8_t sd_bus_buffer[SD_BUS_BURST_BYTES] __attribute__((aligned(FX_SD_BUFFER_ALIGN)));
+
+//What calibration saw at each divider, for the log
+typedef struct {
+    bool tested;
+    bool passed;
+    uint32_t kbps;
+} SdBusResult;
+
+static SdBusResult sd_bus_results[SD_BUS_NUM_MODES][SD_BUS_NUM_DIVS];
+
+static const char *sd_bus_mode_names[SD_BUS_NUM_MODES] = {
+    [SD_BUS_CAPTURE] = "capture",
+    [SD_BUS_OFFLOAD] = "offload",
+};
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static inline uint32_t __clock_hz(uint32_t kernel_hz, uint8_t div){
+    return (div == 0) ? kernel_hz : (kernel_hz / (2 * (uint32_t)div));
+}
+
+static inline bool __media_open(void){
+    return (sd_bus_media != NULL) && (sd_bus_media->fx_media_id == FX_MEDIA_ID);
+}
+
+/* change only the SDMMC clock divider, no transfer may be in progress */
+static void __set_div(uint8_t div){
+    hsd1.Init.ClockDiv = div;
+    MODIFY_REG(hsd1.Instance->CLKCR, SDMMC_CLKCR_CLKDIV, div);
+}
+
+static bool __wait_ready(void){
+    ULONG start = tx_time_get();
+
+    while(HAL_SD_GetCardState(&hsd1) != HAL_SD_CARD_TRANSFER){
+        if((tx_time_get() - start) >= tx_ms_to_ticks(SD_BUS_TEST_TIMEOUT_MS)){
+            return false;
+        }
+        tx_thread_sleep(1);
+    }
+    return true;
+}
+
+/*
+ * Desc: one burst by DMA on the FileX driver's completion semaphores, including the card's busy time after a write.
+ *       A transfer that fails (bus CRC error, timeout) is aborted, so a bad divider can't leave the driver waiting.
+ */
+static bool __transfer(ULONG sector, bool write){
+    ULONG lba = sector + sd_bus_media->fx_media_hidden_sectors;
+    TX_SEMAPHORE *done = write ? &sd_tx_semaphore : &sd_rx_semaphore;
+    HAL_StatusTypeDef hal_result;
+
+    if(!__wait_ready()){
+        return false;
+    }
+    hal_result = write ? HAL_SD_WriteBlocks_DMA(&hsd1, sd_bus_buffer, lba, SD_BUS_TEST_BLOCKS)
+                       : HAL_SD_ReadBlocks_DMA(&hsd1, sd_bus_buffer, lba, SD_BUS_TEST_BLOCKS);
+    if((hal_result != HAL_OK) || (tx_semaphore_get(done, tx_ms_to_ticks(SD_BUS_TEST_TIMEOUT_MS)) != TX_SUCCESS)){
+        HAL_SD_Abort(&hsd1);
+        while(tx_semaphore_get(done, TX_NO_WAIT) == TX_SUCCESS);
+        return false;
+    }
+    return __wait_ready();
+}
+
+/* xorshift pattern, different for every burst of every round */
+static void __pattern_fill(uint32_t seed){
+    uint32_t *words = (uint32_t *)sd_bus_buffer;
+    uint32_t state = seed | 1;
+
+    for(size_t i = 0; i < (SD_BUS_BURST_BYTES / sizeof(uint32_t)); i++){
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        words[i] = state;
+    }
+}
+
+static bool __pattern_check(uint32_t seed){
+    const uint32_t *words = (const uint32_t *)sd_bus_buffer;
+    uint32_t state = seed | 1;
+
+    for(size_t i = 0; i < (SD_BUS_BURST_BYTES / sizeof(uint32_t)); i++){
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        if(words[i] != state){
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Desc: run rounds of the test for a state at a divider, the other direction runs at the reference divider.
+ *       Returns whether every burst came back intact, with the throughput of the timed direction in kbps.
+ */
+static bool __test(SdBusMode mode, uint8_t div, ULONG first_sector, uint32_t rounds, uint32_t *kbps){
+    bool timed_write = (mode == SD_BUS_CAPTURE);
+    uint8_t write_div = timed_write ? div : SD_BUS_REFERENCE_CLK_DIV;
+    uint8_t read_div = timed_write ? SD_BUS_REFERENCE_CLK_DIV : div;
+    ULONG ticks = 0;
+
+    for(uint32_t round = 0; round < rounds; round++){
+        for(uint32_t burst = 0; burst < SD_BUS_TEST_BURSTS; burst++){
+            ULONG sector = first_sector + (burst * SD_BUS_TEST_BLOCKS);
+            uint32_t seed = (div << 24) ^ (mode << 16) ^ (round << 8) ^ burst ^ 0x9E3779B9UL;
+            ULONG start;
+
+            __pattern_fill(seed);
+            __set_div(write_div);
+            start = tx_time_get();
+            if(!__transfer(sector, true)){
+                return false;
+            }
+            if(timed_write){
+                ticks += tx_time_get() - start;
+            }
+
+            memset(sd_bus_buffer, 0, sizeof(sd_bus_buffer));
+            __set_div(read_div);
+            start = tx_time_get();
+            if(!__transfer(sector, false)){
+                return false;
+            }
+            if(!timed_write){
+                ticks += tx_time_get() - start;
+            }
+            if(!__pattern_check(seed)){
+                return false;
+            }
+        }
+    }
+
+    uint64_t bytes = (uint64_t)rounds * SD_BUS_SCRATCH_BYTES;
+    *kbps = (uint32_t)((bytes * TX_TIMER_TICKS_PER_SECOND) / (((ticks == 0) ? 1 : ticks) * 1024));
+    return true;
+}
+
+/* a fresh scratch file, returns false unless its clusters are one contiguous run (sets the first sector) */
+static bool __scratch_create(ULONG *first_sector){
+    FX_MEDIA *media = sd_bus_media;
+    FX_FILE *file = &sd_bus_file;
+
+    fx_file_delete(media, SD_BUS_SCRATCH_NAME);
+    if((fx_file_create(media, SD_BUS_SCRATCH_NAME) != FX_SUCCESS)
+            || (fx_file_open(media, file, SD_BUS_SCRATCH_NAME, FX_OPEN_FOR_WRITE) != FX_SUCCESS)){
+        return false;
+    }
+    bool contiguous = (fx_file_allocate(file, SD_BUS_SCRATCH_BYTES) == FX_SUCCESS)
+            && extent_file_contiguous(media, file, first_sector);
+    fx_file_close(file);
+    return contiguous;
+}
+
+static uint32_t __profile_crc(const SdBusProfile *profile){
+    return audio_file_crc32(0, (const uint8_t *)profile, offsetof(SdBusProfile, crc));
+}
+
+/* the saved profile, if it belongs to this card on this clock tree */
+static bool __profile_load(SdBusProfile *profile){
+    ULONG actual = 0;
+
+    if(fx_file_open(sd_bus_media, &sd_bus_file, SD_BUS_PROFILE_NAME, FX_OPEN_FOR_READ) != FX_SUCCESS){
+        return false;
+    }
+    UINT fx_result = fx_file_read(&sd_bus_file, profile, sizeof(*profile), &actual);
+    fx_file_close(&sd_bus_file);
+
+    return (fx_result == FX_SUCCESS) && (actual == sizeof(*profile))
+            && (profile->magic == SD_BUS_PROFILE_MAGIC) && (profile->crc == __profile_crc(profile))
+            && (memcmp(profile->cid, hsd1.CID, sizeof(profile->cid)) == 0)
+            && (profile->kernel_hz == HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_SDMMC))
+            && (profile->clock_div[SD_BUS_CAPTURE] <= SD_BUS_REFERENCE_CLK_DIV)
+            && (profile->clock_div[SD_BUS_OFFLOAD] <= SD_BUS_REFERENCE_CLK_DIV);
+}
+
+static void __profile_save(SdBusProfile *profile){
+    profile->crc = __profile_crc(profile);
+
+    fx_file_delete(sd_bus_media, SD_BUS_PROFILE_NAME);
+    if((fx_file_create(sd_bus_media, SD_BUS_PROFILE_NAME) != FX_SUCCESS)
+            || (fx_file_open(sd_bus_media, &sd_bus_file, SD_BUS_PROFILE_NAME, FX_OPEN_FOR_WRITE) != FX_SUCCESS)){
+        return;
+    }
+    fx_file_write(&sd_bus_file, profile, sizeof(*profile));
+    fx_file_close(&sd_bus_file);
+}
+
+/* append every divider calibration tried to the log, with the column names if it's new */
+static void __log_results(const SdBusProfile *profile){
+    char line[SD_BUS_LOG_LINE_MAX];
+    char cid[sizeof(profile->cid) * 2 + 1];
+    FX_FILE *file = &sd_bus_file;
+    int len;
+
+    fx_file_create(sd_bus_media, SD_BUS_LOG_NAME);
+    if(fx_file_open(sd_bus_media, file, SD_BUS_LOG_NAME, FX_OPEN_FOR_WRITE) != FX_SUCCESS){
+        return;
+    }
+    fx_file_relative_seek(file, 0, FX_SEEK_END);
+    if(file->fx_file_current_file_size == 0){
+        len = snprintf(line, sizeof(line), "cid,kernel_hz,high_speed,mode,clock_div,clock_khz,result,kbps\n");
+        fx_file_write(file, line, len);
+    }
+
+    for(size_t i = 0; i < 4; i++){
+        snprintf(&cid[i * 8], 9, "%08lX", (unsigned long)profile->cid[i]);
+    }
+    for(int mode = 0; mode < SD_BUS_NUM_MODES; mode++){
+        for(uint8_t div = 0; div < SD_BUS_NUM_DIVS; div++){
+            const SdBusResult *result = &sd_bus_results[mode][div];
+            if(!result->tested){
+                continue;
+            }
+            len = snprintf(line, sizeof(line), "%s,%lu,%u,%s,%u,%lu,%s,%lu\n", cid, (unsigned long)profile->kernel_hz,
+                    profile->high_speed, sd_bus_mode_names[mode], div, (unsigned long)(__clock_hz(profile->kernel_hz, div) / 1000),
+                    result->passed ? "pass" : "fail", (unsigned long)result->kbps);
+            fx_file_write(file, line, len);
+        }
+    }
+    fx_file_close(file);
+}
+
+/* switch the card to high speed timing, at the reference divider */
+static bool __high_speed_enable(void){
+    __set_div(SD_BUS_REFERENCE_CLK_DIV);
+    return HAL_SD_ConfigSpeedBusOperation(&hsd1, SDMMC_SPEED_MODE_HIGH) == HAL_OK;
+}
+
+/* a short run of both tests at the saved dividers, so a card that has drifted since calibration is caught on mount */
+static bool __check(const SdBusProfile *profile, ULONG first_sector){
+    uint32_t kbps;
+    bool ok = true;
+
+    for(int mode = 0; (mode < SD_BUS_NUM_MODES) && ok; mode++){
+        ok = __test(mode, profile->clock_div[mode], first_sector, SD_BUS_CHECK_ROUNDS, &kbps);
+    }
+    __set_div(SD_BUS_REFERENCE_CLK_DIV);
+    return ok;
+}
+
+/*
+ * Desc: negotiate high speed and pick a divider for each state, leaves the bus at the reference divider.
+ *       A state gets the divider one step slower than the fastest clean one (which has to pass as well), so a card that
+ *       only just makes it at some clock isn't left running there. The reference divider is known good and needs no margin.
+ *       Returns false (and leaves the card in default speed) if some state has no divider that works.
+ */
+static bool __calibrate(SdBusProfile *profile, ULONG first_sector){
+    memset(sd_bus_results, 0, sizeof(sd_bus_results));
+    profile->high_speed = __high_speed_enable();
+
+    bool ok = true;
+    for(int mode = 0; mode < SD_BUS_NUM_MODES; mode++){
+        bool found = false;
+        bool faster_passed = false;
+
+        for(uint8_t div = 0; (div < SD_BUS_NUM_DIVS) && !found; div++){
+            SdBusResult *result = &sd_bus_results[mode][div];
+
+            //Over 25 MHz is out of spec in default speed timing
+            if(!profile->high_speed && (__clock_hz(profile->kernel_hz, div) > SD_BUS_DEFAULT_SPEED_HZ)){
+                continue;
+            }
+            result->tested = true;
+            result->passed = __test(mode, div, first_sector, SD_BUS_TEST_ROUNDS, &result->kbps);
+            if(result->passed && (faster_passed || (div == SD_BUS_REFERENCE_CLK_DIV))){
+                profile->clock_div[mode] = div;
+                profile->kbps[mode] = result->kbps;
+                found = true;
+            }
+            faster_passed = result->passed;
+        }
+        ok = ok && found;
+    }
+
+    __set_div(SD_BUS_REFERENCE_CLK_DIV);
+    if(!ok && profile->high_speed){
+        HAL_SD_ConfigSpeedBusOperation(&hsd1, SDMMC_SPEED_MODE_DEFAULT);
+        profile->high_speed = false;
+    }
+    return ok;
+}
+
+/* load and check the card's profile, or calibrate it, all with the media held */
+static void __thread_entry(ULONG thread_input){
+    FX_MEDIA *media = sd_bus_media;
+    SdBusProfile profile = {0};
+    ULONG first_sector = 0;
+
+    tx_mutex_get(&media->fx_media_protect, TX_WAIT_FOREVER);
+
+    //Without a contiguous scratch file a saved profile can't be checked, so neither it nor calibration is used
+    bool scratch = __scratch_create(&first_sector);
+
+    //A saved profile needs the card switched back to high speed and a clean check at its dividers, or it's calibrated again
+    bool loaded = scratch && __profile_load(&profile) && (!profile.high_speed || __high_speed_enable())
+            && __check(&profile, first_sector);
+
+    if(scratch && !loaded){
+        memset(&profile, 0, sizeof(profile));
+        profile.magic = SD_BUS_PROFILE_MAGIC;
+        memcpy(profile.cid, hsd1.CID, sizeof(profile.cid));
+        profile.kernel_hz = HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_SDMMC);
+
+        loaded = __calibrate(&profile, first_sector);
+        __log_results(&profile);
+        if(loaded){
+            __profile_save(&profile);
+        }
+    }
+    fx_file_delete(media, SD_BUS_SCRATCH_NAME);
+    fx_media_flush(media);
+    if(loaded){
+        sd_bus = profile;
+    }
+
+    tx_mutex_put(&media->fx_media_protect);
+    tx_semaphore_put(&sd_bus_done);
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+void sd_bus_init(FX_MEDIA *media){
+    VOID *stack = NULL;
+
+    sd_bus_media = media;
+    if(!__media_open()){
+        return;
+    }
+
+    //Without the stack the tag keeps the defaults
+    stack = malloc(SD_BUS_THREAD_STACK_SIZE);
+    if(stack != NULL){
+        tx_semaphore_create(&sd_bus_done, "SD Bus Done", 0);
+        if(tx_thread_create(&sd_bus_thread, "SD Bus", __thread_entry, 0, stack, SD_BUS_THREAD_STACK_SIZE,
+                SD_BUS_THREAD_PRIO, SD_BUS_THREAD_PRIO, TX_NO_TIME_SLICE, TX_AUTO_START) == TX_SUCCESS){
+            tx_semaphore_get(&sd_bus_done, TX_WAIT_FOREVER);
+            tx_thread_terminate(&sd_bus_thread);
+            tx_thread_delete(&sd_bus_thread);
+        }
+        tx_semaphore_delete(&sd_bus_done);
+        free(stack);
+    }
+    sd_bus_apply(SD_BUS_CAPTURE);
+}
+
+void sd_bus_apply(SdBusMode mode){
+    bool protect = __media_open();
+
+    if(protect){
+        tx_mutex_get(&sd_bus_media->fx_media_protect, TX_WAIT_FOREVER);
+    }
+    __set_div(sd_bus.clock_div[mode]);
+    if(protect){
+        tx_mutex_put(&sd_bus_media->fx_media_protect);
+    }
+}
+
+const SdBusProfile *sd_bus_profile(void){
+    return &sd_bus;
+}
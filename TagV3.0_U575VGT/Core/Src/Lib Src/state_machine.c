@@ -11,6 +11,7 @@
 #include "Sensor Inc/BNO08x.h"
 #include "Sensor Inc/ECG.h"
 #include "Lib Inc/threads.h"
+#include "Lib Inc/sd_bus.h"
 #include "app_usbx_device.h"
 #include "main.h"
 
@@ -95,6 +96,9 @@ void state_machine_thread_entry(ULONG thread_input){
 
 void enter_data_capture(){
 
+	//Resume the storage thread first, every data capture thread writes through it
+	tx_thread_resume(&threads[STORAGE_THREAD].thread);
+
 	//Resume data capture threads (they will no longer be in a suspended state)
 	tx_thread_resume(&threads[AUDIO_THREAD].thread);
 	tx_thread_resume(&threads[IMU_THREAD].thread);
@@ -136,11 +140,11 @@ void exit_recovery(){
 
 
 void enter_data_offload(){
-	//Data offloading is always running, so we dont need to stop or start any threads, just adjust our SD card clock divison to be a little slower
-	MX_SDMMC1_SD_Fake_Init(DATA_OFFLOADING_SD_CLK_DIV);
+	//Data offloading is always running, so we dont need to stop or start any threads, just switch the SD card to the clock divison calibrated for offloading
+	sd_bus_apply(SD_BUS_OFFLOAD);
 }
 
 void exit_data_offload(){
-	//Data offloading is always running, so we dont need to stop or start any threads, just adjust our SD card back to the original clock divider
-	MX_SDMMC1_SD_Fake_Init(NORMAL_SD_CLK_DIV);
+	//Data offloading is always running, so we dont need to stop or start any threads, just switch the SD card back to the capture clock divider
+	sd_bus_apply(SD_BUS_CAPTURE);
 }
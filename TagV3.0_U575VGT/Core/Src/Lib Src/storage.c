@@ -0,0 +1,165 @@
+/*
+ * storage.c
+ *
+ *  Created on: Oct 16, 2026
+ *
+ *  Description:
+ *    Storage service thread, see storage.h
+ */
+
+#include "Lib Inc/storage.h"
+#include <string.h>
+
+/*********************
+ * PRIVATE VARIABLES *
+ *********************/
+
+//Queue of stream pointers waiting on the storage thread
+static TX_QUEUE storage_queue;
+static ULONG storage_queue_memory[STORAGE_QUEUE_DEPTH];
+_Static_assert(sizeof(StorageStream *) == sizeof(ULONG), "storage queue messages are one stream pointer");
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/* hand a request to the storage thread and sleep until it's done */
+static UINT __submit(StorageStream *self){
+    StorageStream *message = self;
+    UINT tx_result = self->urgent ? tx_queue_front_send(&storage_queue, &message, TX_WAIT_FOREVER)
+                                  : tx_queue_send(&storage_queue, &message, TX_WAIT_FOREVER);
+
+    if(tx_result != TX_SUCCESS){
+        return FX_IO_ERROR;
+    }
+    tx_semaphore_get(&self->done, TX_WAIT_FOREVER);
+    return self->status;
+}
+
+/* write out a full batch. It's only emptied once written, so a failed write is tried again by the next request */
+static UINT __batch_write_full(StorageStream *self){
+    if(self->batch_len < self->batch_size){
+        return FX_SUCCESS;
+    }
+
+    UINT fx_result = fx_file_write(self->file, self->batch, self->batch_size);
+    if(fx_result == FX_SUCCESS){
+        self->batch_len = 0;
+    }
+    return fx_result;
+}
+
+/* copy a write into the batch, writing out every batch it fills. On an error the rest of the write is dropped */
+static UINT __batch_write(StorageStream *self){
+    const uint8_t *data = self->data;
+    ULONG len = self->len;
+
+    while(len > 0){
+        //A batch a failed write left full goes first, there's no room for anything else
+        UINT fx_result = __batch_write_full(self);
+        if(fx_result != FX_SUCCESS){
+            return fx_result;
+        }
+
+        ULONG chunk = self->batch_size - self->batch_len;
+        if(chunk > len){
+            chunk = len;
+        }
+        memcpy(&self->batch[self->batch_len], data, chunk);
+        self->batch_len += chunk;
+        data += chunk;
+        len -= chunk;
+    }
+    return __batch_write_full(self);
+}
+
+/* write out a partly filled batch, it's only emptied once written */
+static UINT __batch_flush(StorageStream *self){
+    if((self->batch == NULL) || (self->batch_len == 0)){
+        return FX_SUCCESS;
+    }
+
+    UINT fx_result = fx_file_write(self->file, self->batch, self->batch_len);
+    if(fx_result == FX_SUCCESS){
+        self->batch_len = 0;
+    }
+    return fx_result;
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+void storage_init(void){
+    tx_queue_create(&storage_queue, "Storage Queue", TX_1_ULONG, storage_queue_memory, sizeof(storage_queue_memory));
+}
+
+void storage_stream_init(StorageStream *self, CHAR *name, uint8_t *batch, ULONG batch_size, bool urgent){
+    *self = (StorageStream){
+        .urgent = urgent,
+        .batch = batch,
+        .batch_size = (batch != NULL) ? batch_size : 0,
+    };
+    tx_semaphore_create(&self->done, name, 0);
+}
+
+void storage_stream_delete(StorageStream *self){
+    tx_semaphore_delete(&self->done);
+}
+
+UINT storage_write(StorageStream *self, FX_FILE *file, const void *data, ULONG len){
+    self->op = STORAGE_OP_WRITE;
+    self->file = file;
+    self->data = data;
+    self->len = len;
+    return __submit(self);
+}
+
+UINT storage_flush(StorageStream *self, FX_FILE *file){
+    self->op = STORAGE_OP_FLUSH;
+    self->file = file;
+    self->data = NULL;
+    self->len = 0;
+    return __submit(self);
+}
+
+UINT storage_extent_write(StorageStream *self, ExtentFile *extent, const void *data, ULONG len){
+    self->op = STORAGE_OP_EXTENT_WRITE;
+    self->extent = extent;
+    self->data = data;
+    self->len = len;
+    return __submit(self);
+}
+
+UINT storage_extent_checkpoint(StorageStream *self, ExtentFile *extent){
+    self->op = STORAGE_OP_EXTENT_CHECKPOINT;
+    self->extent = extent;
+    self->data = NULL;
+    self->len = 0;
+    return __submit(self);
+}
+
+void storage_thread_entry(ULONG thread_input){
+    StorageStream *stream = NULL;
+
+    while(1){
+        tx_queue_receive(&storage_queue, &stream, TX_WAIT_FOREVER);
+
+        if(stream->op == STORAGE_OP_FLUSH){
+            stream->status = __batch_flush(stream);
+        }
+        else if(stream->op == STORAGE_OP_EXTENT_WRITE){
+            stream->status = extent_file_write(stream->extent, stream->data, stream->len);
+        }
+        else if(stream->op == STORAGE_OP_EXTENT_CHECKPOINT){
+            stream->status = extent_file_checkpoint(stream->extent);
+        }
+        else if(stream->batch != NULL){
+            stream->status = __batch_write(stream);
+        }
+        else{
+            stream->status = fx_file_write(stream->file, (VOID *)stream->data, stream->len);
+        }
+        tx_semaphore_put(&stream->done);
+    }
+}
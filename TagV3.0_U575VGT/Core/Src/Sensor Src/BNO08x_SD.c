@@ -16,7 +16,6 @@ extern Thread_HandleTypeDef threads[NUM_THREADS];
 
 //FileX variables
 extern FX_MEDIA        sdio_disk;
-extern ALIGN_32BYTES (uint32_t fx_sd_media_memory[FX_STM32_SD_DEFAULT_SECTOR_SIZE / sizeof(uint32_t)]);
 
 //ThreadX useful variables (external because theyre shared with the data collection thread)
 extern TX_EVENT_FLAGS_GROUP imu_event_flags_group;
@@ -26,15 +25,28 @@ extern TX_MUTEX imu_second_half_mutex;
 //Array for holding IMU data. The buffer is split in half and shared with the IMU thread.
 extern IMU_Data imu_data[2][IMU_HALF_BUFFER_SIZE];
 
-uint8_t imu_writing = 0;
+//Our storage stream and the batch the half buffers are collected in (a write only goes to the SD card once the batch is full)
+static StorageStream imu_storage;
+static uint8_t imu_batch[IMU_SD_BATCH_SIZE] __attribute__((aligned(FX_SD_BUFFER_ALIGN)));
+_Static_assert((IMU_SD_BATCH_SIZE % STORAGE_SECTOR_SIZE) == 0, "IMU batches must be whole sectors to skip the SD driver's scratch copy");
 
-//Callback for completed SD card write
-void imu_SDWriteComplete(FX_FILE *file){
+//Failed writes (the data in them is lost). A write error only costs this stream data, it never stops the tag.
+uint32_t imu_sd_write_errors = 0;
 
-	//Set polling flag to indicate a completed SD card write
-	imu_writing = 0;
-}
+//Set once the card is full, the IMU stops logging instead of failing every half buffer
+static bool imu_sd_full = false;
+
+static void imu_sd_write(FX_FILE *file, const void *data, ULONG len){
+	if (imu_sd_full){
+		return;
+	}
 
+	UINT fx_result = storage_write(&imu_storage, file, data, len);
+	if (fx_result != FX_SUCCESS){
+		imu_sd_write_errors++;
+		imu_sd_full = (fx_result == FX_NO_MORE_SPACE);
+	}
+}
 
 void imu_sd_thread_entry(ULONG thread_input){
 
@@ -53,28 +65,17 @@ void imu_sd_thread_entry(ULONG thread_input){
 	  Error_Handler();
 	}
 
-	//Set our "write complete" callback function
-	fx_result = fx_file_write_notify_set(&imu_file, imu_SDWriteComplete);
-	if(fx_result != FX_SUCCESS){
-	  Error_Handler();
-	}
-
-	//Dummy write at the beggining (first write is usually slow)
-	imu_writing = 125; //DEBUG TO BE MORE VISIBLE ON CUBE MONITOR
-	fx_file_write(&imu_file, imu_data[0], sizeof(IMU_Data) * IMU_HALF_BUFFER_SIZE);
-	while (imu_writing);
+	//Writes go through the storage thread, batched
+	storage_stream_init(&imu_storage, "IMU Storage", imu_batch, sizeof(imu_batch), false);
+	imu_sd_full = false;
 
 	while (1){
 
 		//Wait for the Data collection thread to be done filling the first half of the buffer
 		tx_mutex_get(&imu_first_half_mutex, TX_WAIT_FOREVER);
 
-		//Write the first half to the SD card
-		imu_writing = 125; //DEBUG TO BE MORE VISIBLE ON CUBE MONITOR
-		fx_file_write(&imu_file, imu_data[0], sizeof(IMU_Data) * IMU_HALF_BUFFER_SIZE);
-
-		//Wait for the writing to complete before continuing
-		while (imu_writing);
+		//Hand the first half to the storage thread, it's free again once it has been copied into the batch (or written)
+		imu_sd_write(&imu_file, imu_data[0], sizeof(IMU_Data) * IMU_HALF_BUFFER_SIZE);
 
 		//Release mutex (allow for data thread to write to buffer)
 		tx_mutex_put(&imu_first_half_mutex);
@@ -82,12 +83,8 @@ void imu_sd_thread_entry(ULONG thread_input){
 		//Wait for second half buffer
 		tx_mutex_get(&imu_second_half_mutex, TX_WAIT_FOREVER);
 
-		//Write second half to the SD card
-		imu_writing = 125; //DEBUG TO BE MORE VISIBLE ON CUBE MONITOR
-		fx_file_write(&imu_file, imu_data[1], sizeof(IMU_Data) * IMU_HALF_BUFFER_SIZE);
-
-		//Wait for the writing to complete before continuing
-		while (imu_writing);
+		//Hand the second half to the storage thread
+		imu_sd_write(&imu_file, imu_data[1], sizeof(IMU_Data) * IMU_HALF_BUFFER_SIZE);
 
 		//Release second half mutex
 		tx_mutex_put(&imu_second_half_mutex);
@@ -100,8 +97,12 @@ void imu_sd_thread_entry(ULONG thread_input){
 		//If the stop flag was raised
 		if (actual_flags & IMU_STOP_SD_THREAD_FLAG){
 
-			//close the file
+			//Write out the partial batch (or what a failed write left in it) and close the file
+			if (storage_flush(&imu_storage, &imu_file) != FX_SUCCESS){
+				imu_sd_write_errors++;
+			}
 			fx_file_close(&imu_file);
+			storage_stream_delete(&imu_storage);
 
 			//Delete the event flag group
 			tx_event_flags_delete(&imu_event_flags_group);
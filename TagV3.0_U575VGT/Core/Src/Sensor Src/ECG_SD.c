@@ -17,7 +17,6 @@ extern Thread_HandleTypeDef threads[NUM_THREADS];
 
 //FileX variables
 extern FX_MEDIA        sdio_disk;
-extern ALIGN_32BYTES (uint32_t fx_sd_media_memory[FX_STM32_SD_DEFAULT_SECTOR_SIZE / sizeof(uint32_t)]);
 
 //External variables to share with the ECG data thread
 extern TX_EVENT_FLAGS_GROUP ecg_event_flags_group;
@@ -27,12 +26,27 @@ extern TX_MUTEX ecg_second_half_mutex;
 //Array for holding ECG data. The buffer is split in half and shared with the ECG thread.
 extern ECG_Data ecg_data[2][ECG_HALF_BUFFER_SIZE];
 
-//DEBUG
-uint8_t ecg_writing = 0;
+//Our storage stream and the batch the half buffers are collected in (a write only goes to the SD card once the batch is full)
+static StorageStream ecg_storage;
+static uint8_t ecg_batch[ECG_SD_BATCH_SIZE] __attribute__((aligned(FX_SD_BUFFER_ALIGN)));
+_Static_assert((ECG_SD_BATCH_SIZE % STORAGE_SECTOR_SIZE) == 0, "ECG batches must be whole sectors to skip the SD driver's scratch copy");
 
-void ecg_SDWriteComplete(FX_FILE *file){
-	//Indicate that we are no longer writing to the SD card
-	ecg_writing = 0;
+//Failed writes (the data in them is lost). A write error only costs this stream data, it never stops the tag.
+uint32_t ecg_sd_write_errors = 0;
+
+//Set once the card is full, the ECG stops logging instead of failing every half buffer
+static bool ecg_sd_full = false;
+
+static void ecg_sd_write(FX_FILE *file, const void *data, ULONG len){
+	if (ecg_sd_full){
+		return;
+	}
+
+	UINT fx_result = storage_write(&ecg_storage, file, data, len);
+	if (fx_result != FX_SUCCESS){
+		ecg_sd_write_errors++;
+		ecg_sd_full = (fx_result == FX_NO_MORE_SPACE);
+	}
 }
 
 void ecg_sd_thread_entry(ULONG thread_input){
@@ -52,28 +66,17 @@ void ecg_sd_thread_entry(ULONG thread_input){
 	  Error_Handler();
 	}
 
-	//Set our "write complete" callback function
-	fx_result = fx_file_write_notify_set(&ecg_file, ecg_SDWriteComplete);
-	if(fx_result != FX_SUCCESS){
-	  Error_Handler();
-	}
-
-	//Do a dummy write for the beginning of the file
-	ecg_writing = 250; //Set to 250 for easier validation in cube monitor (eventually make this true and false)
-	fx_file_write(&ecg_file, ecg_data, sizeof(float) * ECG_BUFFER_SIZE);
-	while (ecg_writing);
+	//Writes go through the storage thread, batched
+	storage_stream_init(&ecg_storage, "ECG Storage", ecg_batch, sizeof(ecg_batch), false);
+	ecg_sd_full = false;
 
 	while (1){
 
 		//Wait for first half buffer to fill up
 		tx_mutex_get(&ecg_first_half_mutex, TX_WAIT_FOREVER);
 
-		//First half buffer is full, write to the SD card
-		ecg_writing = 250; //Set to 250 for easier validation in cube monitor (eventually make this true and false)
-		fx_file_write(&ecg_file, ecg_data[0], sizeof(ECG_Data) * ECG_HALF_BUFFER_SIZE);
-
-		//Poll for completion (other threads will still run)
-		while (ecg_writing);
+		//First half buffer is full, hand it to the storage thread. It's free again once it has been copied into the batch (or written).
+		ecg_sd_write(&ecg_file, ecg_data[0], sizeof(ECG_Data) * ECG_HALF_BUFFER_SIZE);
 
 		//Release first half mutex (done writing)
 		tx_mutex_put(&ecg_first_half_mutex);
@@ -81,12 +84,8 @@ void ecg_sd_thread_entry(ULONG thread_input){
 		//Wait for second half buffer to fill up
 		tx_mutex_get(&ecg_second_half_mutex, TX_WAIT_FOREVER);
 
-		//Second half of the buffer is full, write to SD card
-		ecg_writing = 250; //Set to 250 for easier validation in cube monitor (eventually make this true and false)
-		fx_file_write(&ecg_file, ecg_data[1], sizeof(ECG_Data) * ECG_HALF_BUFFER_SIZE);
-
-		//Poll for completion
-		while (ecg_writing);
+		//Second half of the buffer is full, hand it to the storage thread
+		ecg_sd_write(&ecg_file, ecg_data[1], sizeof(ECG_Data) * ECG_HALF_BUFFER_SIZE);
 
 		//Release first half mutex (done writing)
 		tx_mutex_put(&ecg_second_half_mutex);
@@ -98,8 +97,12 @@ void ecg_sd_thread_entry(ULONG thread_input){
 		//If there was something set cleanup the thread
 		if (actual_flags & ECG_STOP_SD_THREAD_FLAG){
 
-			//Close the file
+			//Write out the partial batch (or what a failed write left in it) and close the file
+			if (storage_flush(&ecg_storage, &ecg_file) != FX_SUCCESS){
+				ecg_sd_write_errors++;
+			}
 			fx_file_close(&ecg_file);
+			storage_stream_delete(&ecg_storage);
 
 			//Delete event flags (since data collection and now this thread are deleted) and terminate the thread.
 			tx_event_flags_delete(&ecg_event_flags_group);
@@ -88,7 +88,7 @@ static inline const ad7768_Reg_ChMode __reg_channelMode_fromRaw(const uint8_t ra
 
 static inline const uint8_t __reg_channelMode_intoRaw(const ad7768_Reg_ChMode *reg) {
 	return _LSHIFT(reg->filter_type, 3, 1) 
-		| _LSHIFT(reg->filter_type, 0, 3);
+		| _LSHIFT(reg->dec_rate, 0, 3);
 }
 
 static inline const ad7768_Reg_ChModeSelect __reg_channelModeSelect_fromRaw(const uint8_t raw) {
@@ -194,6 +194,44 @@ static inline void prv_ad7768_spi_deselect(ad7768_dev *dev){
 	HAL_GPIO_WritePin(dev->spi_cs_port, dev->spi_cs_pin, GPIO_PIN_SET);
 }
 
+/*
+ * hold CS high for at least AD7768_CS_GAP_NS between frames. Every loop pass takes more than one core clock, so this always errs long.
+ */
+static inline void prv_ad7768_cs_gap(void){
+	uint32_t cycles = (uint32_t)(((uint64_t)SystemCoreClock * AD7768_CS_GAP_NS) / 1000000000U) + 1;
+	while (cycles--){
+		__NOP();
+	}
+}
+
+/*
+ * raw value of a shadowed register
+ */
+static uint8_t prv_ad7768_shadow_intoRaw(ad7768_dev *dev, uint8_t reg){
+	switch (reg){
+		case AD7768_REG_CH_STANDBY:		return __reg_channelStandby_intoRaw(&dev->channel_standby);
+		case AD7768_REG_CH_MODE_A:		return __reg_channelMode_intoRaw(&dev->channel_mode[AD7768_MODE_A]);
+		case AD7768_REG_CH_MODE_B:		return __reg_channelMode_intoRaw(&dev->channel_mode[AD7768_MODE_B]);
+		case AD7768_REG_CH_MODE_SEL:	return __reg_channelModeSelect_intoRaw(&dev->channel_mode_select);
+		case AD7768_REG_PWR_MODE:		return __reg_powerMode_intoRaw(&dev->power_mode);
+		case AD7768_REG_GENERAL_CFG:	return __reg_generalCfg_intoRaw(&dev->general_config);
+		case AD7768_REG_DATA_CTRL:		return __reg_dataControl_intoRaw(&dev->data_control);
+		case AD7768_REG_INTERFACE_CFG:	return __reg_interfaceCfg_intoRaw(&dev->interface_config);
+		default:						return 0;
+	}
+}
+
+/*
+ * a shadowed register was changed, write it now unless a batch is open
+ */
+static HAL_StatusTypeDef prv_ad7768_shadow_changed(ad7768_dev *dev, uint8_t reg){
+	dev->dirty |= (1U << reg);
+	if (dev->batch){
+		return HAL_OK;
+	}
+	return ad7768_batch_apply(dev);
+}
+
 /********************
  * Public Functions *
  ********************/
@@ -216,10 +254,11 @@ HAL_StatusTypeDef ad7768_spi_read(ad7768_dev *dev,
 	prv_ad7768_spi_select(dev);
 	ret = HAL_SPI_Transmit(dev->spi_handler, (uint8_t*)tx_buf, 2, ADC_TIMEOUT);
     prv_ad7768_spi_deselect(dev);
-    HAL_Delay(1); //guarentee > needs 100 ns wait
+    prv_ad7768_cs_gap();
     prv_ad7768_spi_select(dev);
     ret |= HAL_SPI_TransmitReceive(dev->spi_handler, (uint8_t*)&tx_buf, (uint8_t*)&rx_buf, 2, ADC_TIMEOUT);
     prv_ad7768_spi_deselect(dev);
+    prv_ad7768_cs_gap();
 
 	*reg_data = rx_buf[1];
 
@@ -242,6 +281,7 @@ HAL_StatusTypeDef ad7768_spi_write(ad7768_dev *dev,
 	prv_ad7768_spi_select(dev);
 	ret = HAL_SPI_Transmit(dev->spi_handler, (uint8_t *)&buf, 2, ADC_TIMEOUT);
 	prv_ad7768_spi_deselect(dev);
+	prv_ad7768_cs_gap();
 	return ret;
 }
 
@@ -254,17 +294,11 @@ HAL_StatusTypeDef ad7768_spi_write(ad7768_dev *dev,
  * @return 0 in case of success, negative error code otherwise.
  */
 HAL_StatusTypeDef ad7768_set_sleep_mode(ad7768_dev *dev, ad7768_sleep_mode mode){
-	HAL_StatusTypeDef ret = HAL_OK;
-	uint8_t reg_data;
-
-    ret |= ad7768_spi_read(dev, AD7768_REG_PWR_MODE, &reg_data);
-    dev->power_mode = __reg_powerMode_fromRaw(reg_data);
-    if(dev->power_mode.sleep_mode != mode){
-	    dev->power_mode.sleep_mode = mode;
-	    ret |= ad7768_spi_write(dev, AD7768_REG_PWR_MODE, __reg_powerMode_intoRaw(&dev->power_mode));
-    }
-
-	return ret;
+	if (dev->power_mode.sleep_mode == mode){
+		return HAL_OK;
+	}
+	dev->power_mode.sleep_mode = mode;
+	return prv_ad7768_shadow_changed(dev, AD7768_REG_PWR_MODE);
 }
 
 /**
@@ -294,13 +328,14 @@ HAL_StatusTypeDef ad7768_get_sleep_mode(ad7768_dev *dev,
 HAL_StatusTypeDef ad7768_set_power_mode(ad7768_dev *dev,
 			      ad7768_power_mode mode)
 {
-	HAL_StatusTypeDef ret = HAL_ERROR;
-
-	if (dev->pin_spi_ctrl == AD7768_SPI_CTRL) {
-		dev->power_mode.power_mode = mode;
-		ret = ad7768_spi_write(dev, AD7768_REG_PWR_MODE, __reg_powerMode_intoRaw(&dev->power_mode));
+	if (dev->pin_spi_ctrl != AD7768_SPI_CTRL) {
+		return HAL_ERROR;
 	}
-	return ret;
+	if (dev->power_mode.power_mode == mode){
+		return HAL_OK;
+	}
+	dev->power_mode.power_mode = mode;
+	return prv_ad7768_shadow_changed(dev, AD7768_REG_PWR_MODE);
 }
 
 /**
@@ -327,17 +362,11 @@ HAL_StatusTypeDef ad7768_get_power_mode(ad7768_dev *dev,
  * @return 0 in case of success, negative error code otherwise.
  */
 HAL_StatusTypeDef ad7768_set_mclk_div(ad7768_dev *dev, ad7768_mclk_div clk_div){
-	HAL_StatusTypeDef ret = HAL_OK;
-    uint8_t raw;
-
-    ret |= ad7768_spi_read(dev, AD7768_REG_PWR_MODE, &raw);
-    dev->power_mode = __reg_powerMode_fromRaw(raw);
-    if(dev->power_mode.mclk_div != clk_div){
-        dev->power_mode.mclk_div = clk_div;
-        ret |= ad7768_spi_write(dev, AD7768_REG_PWR_MODE, __reg_powerMode_intoRaw(&dev->power_mode));
-    }
-
-	return ret;
+	if (dev->power_mode.mclk_div == clk_div){
+		return HAL_OK;
+	}
+	dev->power_mode.mclk_div = clk_div;
+	return prv_ad7768_shadow_changed(dev, AD7768_REG_PWR_MODE);
 }
 
 /**
@@ -367,21 +396,14 @@ HAL_StatusTypeDef ad7768_get_mclk_div(ad7768_dev *dev,
 HAL_StatusTypeDef ad7768_set_dclk_div(ad7768_dev *dev,
 			    ad7768_dclk_div clk_div)
 {
-	HAL_StatusTypeDef ret = HAL_OK;
-    uint8_t raw;
-
 	if (dev->pin_spi_ctrl != AD7768_SPI_CTRL) {
         return HAL_ERROR;
     }
-		
-    ret |= ad7768_spi_read(dev, AD7768_REG_INTERFACE_CFG, &raw);
-    dev->interface_config = __reg_interfaceCfg_fromRaw(raw);
-    if(dev->interface_config.dclk_div != clk_div){
-        dev->interface_config.dclk_div = clk_div;
-        ret |= ad7768_spi_write(dev, AD7768_REG_INTERFACE_CFG, __reg_interfaceCfg_intoRaw(&dev->interface_config));
-    }
-
-	return ret;
+	if (dev->interface_config.dclk_div == clk_div){
+		return HAL_OK;
+	}
+	dev->interface_config.dclk_div = clk_div;
+	return prv_ad7768_shadow_changed(dev, AD7768_REG_INTERFACE_CFG);
 }
 
 /**
@@ -408,20 +430,14 @@ HAL_StatusTypeDef ad7768_get_dclk_div(ad7768_dev *dev,
  * @return 0 in case of success, negative error code otherwise.
  */
 HAL_StatusTypeDef ad7768_set_conv_op(ad7768_dev *dev, ad7768_conv_op conv_op){
-	HAL_StatusTypeDef ret = HAL_OK;
-    uint8_t raw;
-
 	if (dev->pin_spi_ctrl != AD7768_SPI_CTRL) {
         return HAL_ERROR;
     }
-
-    ret |= ad7768_spi_read(dev, AD7768_REG_DATA_CTRL, &raw);
-    dev->data_control = __reg_dataControl_fromRaw(raw);
-    if(dev->data_control.single_shot_en != conv_op){
-        dev->data_control.single_shot_en = conv_op;
-        ret |= ad7768_spi_write(dev, AD7768_REG_DATA_CTRL, __reg_dataControl_intoRaw(&dev->data_control));
-    }
-    return ret;
+	if (dev->data_control.single_shot_en == conv_op){
+		return HAL_OK;
+	}
+	dev->data_control.single_shot_en = conv_op;
+	return prv_ad7768_shadow_changed(dev, AD7768_REG_DATA_CTRL);
 }
 
 /**
@@ -450,18 +466,11 @@ HAL_StatusTypeDef ad7768_get_conv_op(ad7768_dev *dev,
 HAL_StatusTypeDef ad7768_set_crc_sel(ad7768_dev *dev,
 			   ad7768_crc_sel crc_sel)
 {
-	HAL_StatusTypeDef ret = HAL_OK;
-    uint8_t raw;
-
-    ret |= ad7768_spi_read(dev, AD7768_REG_INTERFACE_CFG, &raw);
-    dev->interface_config = __reg_interfaceCfg_fromRaw(raw);
-    
-    if(dev->interface_config.crc_select != crc_sel){
-        dev->interface_config.crc_select = crc_sel;
-        ret |= ad7768_spi_write(dev, AD7768_REG_INTERFACE_CFG, __reg_interfaceCfg_intoRaw(&dev->interface_config));
-    }
-
-	return ret;
+	if (dev->interface_config.crc_select == crc_sel){
+		return HAL_OK;
+	}
+	dev->interface_config.crc_select = crc_sel;
+	return prv_ad7768_shadow_changed(dev, AD7768_REG_INTERFACE_CFG);
 }
 
 /**
@@ -495,17 +504,11 @@ HAL_StatusTypeDef ad7768_set_ch_state(ad7768_dev *dev,
 			    ad7768_ch ch,
 			    ad7768_ch_state state)
 {
-	HAL_StatusTypeDef ret = HAL_OK;
-    uint8_t raw;
-
-    ret |= ad7768_spi_read(dev, AD7768_REG_CH_STANDBY, &raw);
-    dev->channel_standby = __reg_channelStandby_fromRaw(raw);
-    if(dev->channel_standby.ch[ch] != state){
-        dev->channel_standby.ch[ch] = state;
-        ret |= ad7768_spi_write(dev, AD7768_REG_CH_STANDBY, __reg_channelStandby_intoRaw(&dev->channel_standby));
-    }
-
-	return ret;
+	if (dev->channel_standby.ch[ch] == state){
+		return HAL_OK;
+	}
+	dev->channel_standby.ch[ch] = state;
+	return prv_ad7768_shadow_changed(dev, AD7768_REG_CH_STANDBY);
 }
 
 /**
@@ -556,7 +559,7 @@ HAL_StatusTypeDef ad7768_set_mode_config(ad7768_dev *dev,
 		.dec_rate = dec_rate
 	};
 
-	return ad7768_spi_write(dev, (mode == AD7768_MODE_A) ? AD7768_REG_CH_MODE_A : AD7768_REG_CH_MODE_B, __reg_channelMode_intoRaw(&dev->channel_mode[mode]));
+	return prv_ad7768_shadow_changed(dev, (mode == AD7768_MODE_A) ? AD7768_REG_CH_MODE_A : AD7768_REG_CH_MODE_B);
 }
 
 /**
@@ -595,17 +598,11 @@ HAL_StatusTypeDef ad7768_set_ch_mode(ad7768_dev *dev,
 			   ad7768_ch ch,
 			   ad7768_ch_mode mode)
 {
-	HAL_StatusTypeDef ret = HAL_OK;
-    uint8_t raw;
-
-    ret = ad7768_spi_read(dev, AD7768_REG_CH_MODE_SEL, &raw);
-    dev->channel_mode_select = __reg_channelModeSelect_fromRaw(raw);
-    if(dev->channel_mode_select.ch[ch] != mode){
-        dev->channel_mode_select.ch[ch] = mode;
-        ret = ad7768_spi_write(dev, AD7768_REG_CH_MODE_SEL, __reg_channelModeSelect_intoRaw(&dev->channel_mode_select));
-    }
-
-	return ret;
+	if (dev->channel_mode_select.ch[ch] == mode){
+		return HAL_OK;
+	}
+	dev->channel_mode_select.ch[ch] = mode;
+	return prv_ad7768_shadow_changed(dev, AD7768_REG_CH_MODE_SEL);
 }
 
 /**
@@ -628,6 +625,34 @@ HAL_StatusTypeDef ad7768_get_ch_mode(ad7768_dev *dev,
 	return HAL_OK;
 }
 
+/**
+ * Start a batch: register changes only update the shadow until ad7768_batch_apply.
+ * @param dev - The device structure.
+ */
+void ad7768_batch_begin(ad7768_dev *dev)
+{
+	dev->batch = true;
+}
+
+/**
+ * Write every register that changed since the last write, back to back in address order, and close the batch.
+ * @param dev - The device structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+HAL_StatusTypeDef ad7768_batch_apply(ad7768_dev *dev)
+{
+	HAL_StatusTypeDef ret = HAL_OK;
+
+	for (uint8_t reg = AD7768_SHADOW_REG_FIRST; reg <= AD7768_SHADOW_REG_LAST; reg++){
+		if (dev->dirty & (1U << reg)){
+			ret |= ad7768_spi_write(dev, reg, prv_ad7768_shadow_intoRaw(dev, reg));
+		}
+	}
+	dev->dirty = 0;
+	dev->batch = false;
+	return ret;
+}
+
 /*
  * perform soft reset on the device
  * @param device - the device structure
@@ -666,12 +691,11 @@ HAL_StatusTypeDef ad7768_setup(ad7768_dev *dev){
         return HAL_ERROR;
     }
 
-	ret |= ad7768_spi_write(dev, AD7768_REG_CH_STANDBY,    __reg_channelStandby_intoRaw(&dev->channel_standby));
-	ret |= ad7768_spi_write(dev, AD7768_REG_CH_MODE_A,     __reg_channelMode_intoRaw(&dev->channel_mode[AD7768_MODE_A]));
-	ret |= ad7768_spi_write(dev, AD7768_REG_CH_MODE_B,     __reg_channelMode_intoRaw(&dev->channel_mode[AD7768_MODE_B]));
-	ret |= ad7768_spi_write(dev, AD7768_REG_CH_MODE_SEL,   __reg_channelModeSelect_intoRaw(&dev->channel_mode_select));
-	ret |= ad7768_spi_write(dev, AD7768_REG_PWR_MODE,      __reg_powerMode_intoRaw(&dev->power_mode));
-	ret |= ad7768_spi_write(dev, AD7768_REG_INTERFACE_CFG, __reg_interfaceCfg_intoRaw(&dev->interface_config));
+	// After the reset the device is at its defaults, bring it in line with the whole shadow (the soft reset leaves DATA_CTRL alone, sync owns it)
+	dev->batch = true;
+	dev->dirty = (1U << AD7768_REG_CH_STANDBY) | (1U << AD7768_REG_CH_MODE_A) | (1U << AD7768_REG_CH_MODE_B)
+			| (1U << AD7768_REG_CH_MODE_SEL) | (1U << AD7768_REG_PWR_MODE) | (1U << AD7768_REG_INTERFACE_CFG);
+	ret |= ad7768_batch_apply(dev);
 	ret |= ad7768_spi_write(dev, AD7768_REG_GPIO_CTRL, 	   0x00);
 	ret |= ad7768_sync(dev);
 
@@ -686,8 +710,11 @@ HAL_StatusTypeDef ad7768_sync(ad7768_dev *dev){
 
 	HAL_StatusTypeDef ret = HAL_OK;
 
-    ret |= ad7768_spi_write(dev, AD7768_REG_DATA_CTRL, __reg_dataControl_intoRaw(&(ad7768_Reg_DataControl){.spi_sync = 0}));
-    ret |= ad7768_spi_write(dev, AD7768_REG_DATA_CTRL, __reg_dataControl_intoRaw(&(ad7768_Reg_DataControl){.spi_sync = 1}));
+    // Pulse SPI_SYNC low then high, keeping the rest of the shadowed DATA_CTRL (the sync bit stays high in between syncs)
+    dev->data_control.spi_sync = 0;
+    ret |= ad7768_spi_write(dev, AD7768_REG_DATA_CTRL, __reg_dataControl_intoRaw(&dev->data_control));
+    dev->data_control.spi_sync = 1;
+    ret |= ad7768_spi_write(dev, AD7768_REG_DATA_CTRL, __reg_dataControl_intoRaw(&dev->data_control));
 
 	return ret;
 }
@@ -30,7 +30,10 @@
 #include "app_filex.h"
 #include "app_threadx.h"
 #include "Lib Inc/threads.h"
+#include "Lib Inc/timing.h"
 #include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
 
 /*******************************
  * PUBLIC FUNCTION DEFINITIONS *
@@ -76,165 +79,954 @@ ad7768_dev audio_adc = {
 //Use the audio manager declared in Main since it uses too much memory for a ThreadX thread (nearly 700kB)
 extern AudioManager audio;
 
-//FileX variables
+//FileX variables (the audio manager swaps between the two files on every rollover)
 FX_FILE         audio_file = {};
+FX_FILE         audio_next_file = {};
+FX_FILE         audio_click_file = {};
+FX_FILE         audio_ltsa_files[AUDIO_CODEC_MAX_CHANNELS] = {};
+FX_FILE         audio_preview_file = {};
+FX_FILE         audio_stats_file = {};
+FX_FILE         audio_config_file = {};
 extern FX_MEDIA        sdio_disk;
-extern ALIGN_32BYTES (uint32_t fx_sd_media_memory[FX_STM32_SD_DEFAULT_SECTOR_SIZE / sizeof(uint32_t)]);
 
 //Threads array
 extern Thread_HandleTypeDef threads[NUM_THREADS];
 
+//RTC for the record timestamps
+extern RTC_HandleTypeDef hrtc;
+
 //Event flags for signaling data ready
 TX_EVENT_FLAGS_GROUP audio_event_flags_group;
 
-//Testing variables (Remove once happy with firmware)
-uint8_t counter = 0;
-bool sd_writing = 0;
-bool yielding = 0;
+//Event flags waking the LTSA thread
+TX_EVENT_FLAGS_GROUP audio_ltsa_event_flags_group;
+
+//GPDMA linked-list nodes, one per temp buffer block. The GPDMA only stores the lower 16 bits of the next node address,
+//so every node has to live in the same 64kB page. Aligning the (< 1kB) array to 1kB guarantees that.
+static DMA_NodeTypeDef audio_dma_nodes[TEMP_BUF_BLOCK_LENGTH] __attribute__((aligned(1024)));
+static DMA_QListTypeDef audio_dma_queue;
+_Static_assert(sizeof(audio_dma_nodes) <= 1024, "audio DMA nodes must fit in one 1kB aligned window");
+
+//A full run of raw blocks has to fit in one record
+_Static_assert(TEMP_BUF_BLOCK_LENGTH <= AUDIO_FILE_MAX_BLOCKS, "audio file records can't describe a full temp buffer");
 
 void audio_SAI_RxCpltCallback (SAI_HandleTypeDef * hsai){
 
-	//Our DMA buffer is completely filled, move the upper half into the temporary buffer
-	counter += 2;
-	memcpy(audio.temp_buffer[audio.temp_counter], audio.audio_buffer[1], AUDIO_CIRCULAR_BUFFER_SIZE);
-	counter -= 2;
+	//The DMA just finished filling the block at head in place and has already moved on to the next linked-list node.
+	//Nothing to copy, just timestamp and publish the block. The barrier makes sure the block is visible before the new head is.
+	uint32_t head = audio.queue.head;
+	audio.queue.block_ticks[head % TEMP_BUF_BLOCK_LENGTH] = tx_time_get();
+	head++;
+	__DMB();
+	audio.queue.head = head;
 
-	audio.temp_counter++;
+	uint32_t depth = head - audio.queue.tail;
+	if (depth > audio.queue.peak_depth){
+		audio.queue.peak_depth = depth;
+	}
 
-	//Once the temporary buffer is half full, set the flag for the thread execution loop
-	if (audio.temp_counter == TEMP_BUF_HALF_BLOCK_LENGTH){
-		tx_event_flags_set(&audio_event_flags_group, AUDIO_BUFFER_HALF_FULL_FLAG, TX_OR);
+	//Wake the writer once a full batch is waiting (and keep poking it while it is behind)
+	if (depth >= AUDIO_WRITE_BATCH_BLOCKS){
+		tx_event_flags_set(&audio_event_flags_group, AUDIO_BLOCKS_READY_FLAG, TX_OR);
 	}
 
-	//Same as above, but when it is full & reset our temp buffer index tracker
-	if (audio.temp_counter == TEMP_BUF_BLOCK_LENGTH){
-		tx_event_flags_set(&audio_event_flags_group, AUDIO_BUFFER_FULL_FLAG, TX_OR);
-		audio.temp_counter = 0;
+	if (audio.ltsa_enabled){
+		tx_event_flags_set(&audio_ltsa_event_flags_group, AUDIO_LTSA_BLOCK_FLAG, TX_OR);
 	}
 }
 
+/*
+ * Desc: claim the oldest contiguous run of queued blocks (a run stops at the end of the ring).
+ *       If the DMA has lapped the writer, the overwritten blocks are skipped and counted as dropped.
+ *       Returns the number of blocks in the run, and the sequence number of the first one through first_seq.
+ */
+static uint32_t audio_queue_claim(AudioBlockQueue *queue, uint32_t *first_seq){
+	uint32_t head = queue->head;
+	__DMB();
+	uint32_t tail = queue->tail;
+	uint32_t depth = head - tail;
 
-void audio_SAI_RxHalfCpltCallback (SAI_HandleTypeDef * hsai){
+	if (depth > AUDIO_QUEUE_MAX_DEPTH){
+		uint32_t lost = depth - AUDIO_QUEUE_MAX_DEPTH;
+		queue->dropped_blocks += lost;
+		tail += lost;
+		depth = AUDIO_QUEUE_MAX_DEPTH;
+		queue->tail = tail;
+	}
 
-	//Our DMA buffer is half full, move the lower half into the temp buffer
-	counter += 1;
-	memcpy(audio.temp_buffer[audio.temp_counter], audio.audio_buffer[0], AUDIO_CIRCULAR_BUFFER_SIZE);
-	counter -= 1;
+	*first_seq = tail;
+	return _MIN(depth, TEMP_BUF_BLOCK_LENGTH - (tail % TEMP_BUF_BLOCK_LENGTH));
+}
 
-	audio.temp_counter++;
+/*
+ * Desc: hand a written run of blocks back to the DMA. Any block the DMA started refilling while
+ *       we were still writing it went out corrupted, so it is counted as dropped as well.
+ */
+static void audio_queue_release(AudioBlockQueue *queue, uint32_t count){
+	uint32_t tail = queue->tail;
+	uint32_t head = queue->head;
 
-	//Half full temp buffer, set flag for thread execution loop
-	if (audio.temp_counter == TEMP_BUF_HALF_BLOCK_LENGTH){
-		tx_event_flags_set(&audio_event_flags_group, AUDIO_BUFFER_HALF_FULL_FLAG, TX_OR);
+	//Block (tail + i) is being overwritten once head reaches (tail + i + TEMP_BUF_BLOCK_LENGTH)
+	if (head - tail > AUDIO_QUEUE_MAX_DEPTH){
+		queue->dropped_blocks += _MIN(count, head - tail - AUDIO_QUEUE_MAX_DEPTH);
 	}
 
-	//Full temp buffer, set flag & reset temp buffer index
-	if (audio.temp_counter == TEMP_BUF_BLOCK_LENGTH){
-		tx_event_flags_set(&audio_event_flags_group, AUDIO_BUFFER_FULL_FLAG, TX_OR);
-		audio.temp_counter = 0;
+	//Finish reading the blocks before the slots are given back
+	__DMB();
+	queue->tail = tail + count;
+}
+
+/*
+ * Desc: write a buffer to the audio file and wait for it to complete
+ */
+static void audio_write(AudioManager *self, const uint8_t *data, uint32_t len){
+	uint32_t start = DWT->CYCCNT;
+
+	//The storage thread does the write, we sleep until it's done. The time includes waiting for a sensor write already in progress.
+	if (storage_extent_write(&self->storage, self->extent, data, len) != FX_SUCCESS){
+		Error_Handler();
 	}
+
+	audio_stats_write(&self->stats, len, cycle_counter_us_since(start));
 }
 
-void audio_SDWriteComplete(FX_FILE *file){
+/*
+ * Desc: format the RTC time as "YYYYMMDD_HHMMSS"
+ */
+static void audio_rtc_stamp(char *stamp){
+	RTC_TimeTypeDef time = {};
+	RTC_DateTypeDef date = {};
 
-	//Set polling flag to indicate a completed SD card write
-	sd_writing = false;
-	audio.sd_write_complete = true;
+	//The date has to be read after the time to unlock the RTC shadow registers
+	HAL_RTC_GetTime(&hrtc, &time, RTC_FORMAT_BIN);
+	HAL_RTC_GetDate(&hrtc, &date, RTC_FORMAT_BIN);
+	snprintf(stamp, AUDIO_FILE_STAMP_LEN, "%04u%02u%02u_%02u%02u%02u",
+			2000 + date.Year, date.Month, date.Date, time.Hours, time.Minutes, time.Seconds);
 }
 
-void audio_thread_entry(ULONG thread_input){
+/*
+ * Desc: create & open a new temporary audio file, skipping sequence numbers whose name is already taken (never overwrite a file from an earlier session)
+ */
+static void audio_file_create(AudioManager *self, ExtentFile *extent, char *name){
+	AudioFileRotation *rotation = &self->rotation;
+	FX_FILE *file = extent->file;
+	UINT fx_result = FX_ALREADY_CREATED;
 
-	//Tag configuration (not implemented yet)
-	TagConfig tag_config = {.audio_ch_enabled[0] = 1,
-	  	  	  	  	  	  	  	  .audio_ch_enabled[1] = 1,
-								  .audio_ch_enabled[2] = 1,
-								  .audio_ch_enabled[3] = 0,
-	  	  	  	  	  	  	  	  .audio_ch_headers = 1,
-								  .audio_rate = CFG_AUDIO_RATE_96_KHZ,
-	  	  	  	  	  	  	  	  .audio_depth = CFG_AUDIO_DEPTH_16_BIT};
-	  ULONG acc_flag_pointer = 0;
+	while (fx_result == FX_ALREADY_CREATED){
+		snprintf(name, AUDIO_FILE_NAME_LEN, "audio_%s_%04lu.tmp", rotation->session_stamp, (unsigned long)rotation->next_sequence);
+		fx_result = fx_file_create(rotation->media, name);
+		if (fx_result == FX_ALREADY_CREATED){
+			rotation->next_sequence++;
+		}
+	}
+	if (fx_result != FX_SUCCESS){
+		Error_Handler();
+	}
 
-	  //Create our binary file for dumping audio data
-	  UINT fx_result = FX_SUCCESS;
-	  fx_result = fx_file_create(&sdio_disk, "audio_test.bin");
-	  if((fx_result != FX_SUCCESS) && (fx_result != FX_ALREADY_CREATED)){
-	      Error_Handler();
-	  }
+	if (fx_file_open(rotation->media, file, name, FX_OPEN_FOR_WRITE) != FX_SUCCESS){
+		Error_Handler();
+	}
+	extent_file_attach(extent, rotation->media, file);
+}
 
-	  //Open the file (put a dummy close in front incase the file is already open)
-	  fx_result = fx_file_open(&sdio_disk, &audio_file, "audio_test.bin", FX_OPEN_FOR_WRITE);
-	  if(fx_result != FX_SUCCESS){
-	      Error_Handler();
-	  }
+/*
+ * Desc: checkpoint the size of the file being written, once every AUDIO_FILE_CHECKPOINT_S unless forced
+ */
+static void audio_file_checkpoint(AudioManager *self, bool force){
+	AudioFileRotation *rotation = &self->rotation;
+	ULONG now = tx_time_get();
 
-	  //Set our "write complete" callback function
-	  fx_result = fx_file_write_notify_set(&audio_file, audio_SDWriteComplete);
-	  if(fx_result != FX_SUCCESS){
-	      Error_Handler();
-	  }
+	if (!force && ((now - rotation->checkpoint_tick) < tx_s_to_ticks(AUDIO_FILE_CHECKPOINT_S))){
+		return;
+	}
+	rotation->checkpoint_tick = now;
+
+	if (storage_extent_checkpoint(&self->storage, self->extent) != FX_SUCCESS){
+		Error_Handler();
+	}
+}
+
+/*
+ * Desc: checkpoint the file, give back the unused preallocation, close it and rename it after its start time
+ */
+static void audio_file_finish(AudioManager *self, ExtentFile *extent, const char *name, const char *stamp, uint32_t sequence){
+	char final_name[AUDIO_FILE_NAME_LEN];
+	FX_FILE *file = extent->file;
+
+	if (storage_extent_checkpoint(&self->storage, extent) != FX_SUCCESS){
+		Error_Handler();
+	}
+	fx_file_extended_truncate_release(file, file->fx_file_current_file_size);
+	fx_file_close(file);
+
+	//If the name is taken the file just keeps its temporary name, the records inside still carry the time
+	snprintf(final_name, sizeof(final_name), "audio_%s_%04lu.bin", stamp, (unsigned long)sequence);
+	fx_file_rename(self->rotation.media, (CHAR *)name, final_name);
+	fx_media_flush(self->rotation.media);
+}
+
+/*
+ * Desc: open one of the small side files (click index, LTSA, stats) of this recording
+ */
+static void audio_side_file_open(AudioManager *self, FX_FILE *file, CHAR *name){
+	UINT fx_result = fx_file_create(self->rotation.media, name);
+
+	if ((fx_result != FX_SUCCESS) && (fx_result != FX_ALREADY_CREATED)){
+		Error_Handler();
+	}
+	if (fx_file_open(self->rotation.media, file, name, FX_OPEN_FOR_WRITE) != FX_SUCCESS){
+		Error_Handler();
+	}
+
+	//A restart within the same second reuses the file, append to it
+	if (fx_file_relative_seek(file, 0, FX_SEEK_END) != FX_SUCCESS){
+		Error_Handler();
+	}
+}
+
+/*
+ * Desc: open the click index for this recording
+ */
+static void audio_click_file_open(AudioManager *self){
+	char name[AUDIO_CLICK_FILE_NAME_LEN];
+
+	snprintf(name, sizeof(name), "clicks_%s.bin", self->rotation.session_stamp);
+	audio_side_file_open(self, self->click_file, name);
+	self->click_index_count = 0;
+}
+
+/*
+ * Desc: open an LTSA file for every recorded channel, named after the ADC channel
+ */
+static void audio_ltsa_files_open(AudioManager *self){
+	char name[AUDIO_LTSA_FILE_NAME_LEN];
+	uint8_t index = 0;
+
+	for (uint_fast8_t ch = 0; ch < 4; ch++){
+		if (self->record.channel_mask & (1 << ch)){
+			snprintf(name, sizeof(name), "ltsa_%s_ch%u.bin", self->rotation.session_stamp, ch);
+			audio_side_file_open(self, &self->ltsa_files[index++], name);
+		}
+	}
+}
+
+/*
+ * Desc: write the rows the LTSA thread finished, if there are any
+ */
+static void audio_ltsa_write(AudioManager *self){
+	if (!self->ltsa_rows_ready){
+		return;
+	}
+	__DMB();
+	for (uint_fast8_t ch = 0; ch < self->channel_count; ch++){
+		if (storage_write(&self->storage, &self->ltsa_files[ch], &self->ltsa_rows[ch], AUDIO_LTSA_ROW_SIZE) != FX_SUCCESS){
+			Error_Handler();
+		}
+	}
+
+	//Done with the rows, the LTSA thread can fill them again
+	__DMB();
+	self->ltsa_rows_ready = false;
+}
+
+/*
+ * Desc: create the preview file for the current audio file, with a placeholder header that gets filled in once its length is known
+ */
+static void audio_preview_file_open(AudioManager *self){
+	AudioFileRotation *rotation = &self->rotation;
+	char name[AUDIO_PREVIEW_FILE_NAME_LEN];
+	UINT fx_result = FX_SUCCESS;
+
+	//The WAV header has to describe the whole file, so a leftover file with the same name is replaced rather than appended to
+	snprintf(name, sizeof(name), "preview_%s_%04lu.wav", rotation->start_stamp, (unsigned long)rotation->sequence);
+	fx_result = fx_file_create(rotation->media, name);
+	if (fx_result == FX_ALREADY_CREATED){
+		fx_file_delete(rotation->media, name);
+		fx_result = fx_file_create(rotation->media, name);
+	}
+	if (fx_result != FX_SUCCESS){
+		Error_Handler();
+	}
+	if (fx_file_open(rotation->media, self->preview_file, name, FX_OPEN_FOR_WRITE) != FX_SUCCESS){
+		Error_Handler();
+	}
+
+	preview_wav_header(self->preview_header, 0);
+	if (storage_write(&self->storage, self->preview_file, self->preview_header, PREVIEW_WAV_HEADER_SIZE) != FX_SUCCESS){
+		Error_Handler();
+	}
+	self->preview_bytes = 0;
+}
+
+/*
+ * Desc: write out the buffered preview samples
+ */
+static void audio_preview_flush(AudioManager *self){
+	if (self->preview_count == 0){
+		return;
+	}
+	if (storage_write(&self->storage, self->preview_file, self->preview_buffer, self->preview_count * sizeof(int16_t)) != FX_SUCCESS){
+		Error_Handler();
+	}
+	self->preview_bytes += self->preview_count * sizeof(int16_t);
+	self->preview_count = 0;
+}
+
+/*
+ * Desc: write out what is buffered, fill in the final header and close the preview file
+ */
+static void audio_preview_file_close(AudioManager *self){
+	audio_preview_flush(self);
+
+	preview_wav_header(self->preview_header, self->preview_bytes);
+	if ((fx_file_seek(self->preview_file, 0) != FX_SUCCESS)
+			|| (storage_write(&self->storage, self->preview_file, self->preview_header, PREVIEW_WAV_HEADER_SIZE) != FX_SUCCESS)){
+		Error_Handler();
+	}
+	fx_file_close(self->preview_file);
+}
+
+/*
+ * Desc: open the statistics file for this recording, with the column names if it's new
+ */
+static void audio_stats_file_open(AudioManager *self){
+	char name[AUDIO_STATS_FILE_NAME_LEN];
+
+	snprintf(name, sizeof(name), "stats_%s.csv", self->rotation.session_stamp);
+	audio_side_file_open(self, self->stats_file, name);
+
+	if (self->stats_file->fx_file_current_file_size == 0){
+		size_t len = audio_stats_csv_header(self->stats_line, sizeof(self->stats_line));
+		if (storage_write(&self->storage, self->stats_file, self->stats_line, len) != FX_SUCCESS){
+			Error_Handler();
+		}
+	}
+	self->stats_tick = tx_time_get();
+}
+
+/*
+ * Desc: append a row of statistics once the interval is up (or right away if forced)
+ */
+static void audio_stats_dump(AudioManager *self, bool force){
+	ULONG now = tx_time_get();
+
+	if (!force && ((now - self->stats_tick) < tx_s_to_ticks(AUDIO_STATS_INTERVAL_S))){
+		return;
+	}
+	self->stats_tick = now;
+
+	//Counters kept elsewhere are copied in as they are
+	self->stats.queue_peak = self->queue.peak_depth;
+	self->stats.dropped_blocks = self->queue.dropped_blocks;
+	self->stats.crc_errors = self->check_crc ? self->adc_crc.errors : 0;
+
+	size_t len = audio_stats_csv_row(&self->stats, (uint32_t)(((uint64_t)now * 1000) / TX_TIMER_TICKS_PER_SECOND), self->stats_line, sizeof(self->stats_line));
+	if (storage_write(&self->storage, self->stats_file, self->stats_line, len) != FX_SUCCESS){
+		Error_Handler();
+	}
+}
+
+/*
+ * Desc: write out the buffered click index entries
+ */
+static void audio_click_file_flush(AudioManager *self){
+	if (self->click_index_count == 0){
+		return;
+	}
+	if (storage_write(&self->storage, self->click_file, self->click_index, self->click_index_count * sizeof(AudioClickIndexEntry)) != FX_SUCCESS){
+		Error_Handler();
+	}
+	self->click_index_count = 0;
+}
+
+/*
+ * Desc: create the first file (and the one after it) at the start of a recording
+ */
+static void audio_file_start(AudioManager *self){
+	AudioFileRotation *rotation = &self->rotation;
+
+	audio_rtc_stamp(rotation->session_stamp);
+	memcpy(rotation->start_stamp, rotation->session_stamp, AUDIO_FILE_STAMP_LEN);
+	rotation->next_sequence = 0;
+
+	audio_file_create(self, self->extent, rotation->name);
+	rotation->sequence = rotation->next_sequence++;
+	audio_file_create(self, self->next_extent, rotation->next_name);
+
+	rotation->start_tick = tx_time_get();
+	rotation->checkpoint_tick = rotation->start_tick;
+
+	if (self->log_clicks){
+		audio_click_file_open(self);
+	}
+	if (self->ltsa_enabled){
+		audio_ltsa_files_open(self);
+	}
+	if (self->preview_enabled){
+		audio_preview_file_open(self);
+	}
+	audio_stats_file_open(self);
+}
+
+/*
+ * Desc: carry on in the (already open and preallocated) next file. This runs in the middle of a drain, so it only swaps the handles:
+ *       the finished file stays open in the next file's place until audio_file_retire closes it from the idle path.
+ */
+static void audio_file_rotate(AudioManager *self){
+	AudioFileRotation *rotation = &self->rotation;
+	ExtentFile *finished = self->extent;
+	char name[AUDIO_FILE_NAME_LEN];
+
+	self->extent = self->next_extent;
+	self->next_extent = finished;
+	memcpy(name, rotation->name, AUDIO_FILE_NAME_LEN);
+	memcpy(rotation->name, rotation->next_name, AUDIO_FILE_NAME_LEN);
+	memcpy(rotation->next_name, name, AUDIO_FILE_NAME_LEN);
+	memcpy(rotation->retired_stamp, rotation->start_stamp, AUDIO_FILE_STAMP_LEN);
+	rotation->retired_sequence = rotation->sequence;
+	rotation->retire_pending = true;
+
+	rotation->sequence = rotation->next_sequence++;
+	rotation->start_tick = tx_time_get();
+	rotation->checkpoint_tick = rotation->start_tick;
+	audio_rtc_stamp(rotation->start_stamp);
+}
+
+/*
+ * Desc: finish the file the last rollover left open and create a new next file in its place
+ */
+static void audio_file_retire(AudioManager *self){
+	AudioFileRotation *rotation = &self->rotation;
+
+	if (!rotation->retire_pending){
+		return;
+	}
+
+	audio_file_finish(self, self->next_extent, rotation->next_name, rotation->retired_stamp, rotation->retired_sequence);
+	audio_file_create(self, self->next_extent, rotation->next_name);
+	rotation->retire_pending = false;
+
+	//The preview follows the audio files, give or take the blocks written between the rollover and now
+	if (self->preview_enabled){
+		audio_preview_file_close(self);
+		audio_preview_file_open(self);
+	}
+}
+
+/*
+ * Desc: stop recording to files, the unused next file is deleted
+ */
+static void audio_file_stop(AudioManager *self){
+	AudioFileRotation *rotation = &self->rotation;
+
+	audio_file_finish(self, self->extent, rotation->name, rotation->start_stamp, rotation->sequence);
+
+	//The next file is either still the one before the current one, or empty
+	if (rotation->retire_pending){
+		audio_file_finish(self, self->next_extent, rotation->next_name, rotation->retired_stamp, rotation->retired_sequence);
+		rotation->retire_pending = false;
+	}
+	else {
+		fx_file_extended_truncate_release(self->next_extent->file, 0);
+		fx_file_close(self->next_extent->file);
+		fx_file_delete(rotation->media, rotation->next_name);
+	}
+
+	if (self->log_clicks){
+		audio_click_file_flush(self);
+		fx_file_close(self->click_file);
+	}
+	if (self->ltsa_enabled){
+		audio_ltsa_write(self);
+		for (uint_fast8_t ch = 0; ch < self->channel_count; ch++){
+			fx_file_close(&self->ltsa_files[ch]);
+		}
+	}
+	if (self->preview_enabled){
+		audio_preview_file_close(self);
+	}
+	audio_stats_dump(self, true);
+	fx_file_close(self->stats_file);
+	fx_media_flush(rotation->media);
+}
+
+/*
+ * Desc: check if a record of payload_len bytes should go in a new file
+ */
+static bool audio_file_needs_rotation(AudioManager *self, uint32_t payload_len){
+	AudioFileRotation *rotation = &self->rotation;
+	ULONG64 size = self->extent->offset;
+
+	//Never rotate an empty file, a record bigger than the limit has to go somewhere.
+	//Nor before the idle path has the next file ready, the current one just runs over a little (the limit is well under FAT's 4GB).
+	if ((size == 0) || rotation->retire_pending){
+		return false;
+	}
+	if ((size + AUDIO_FILE_HEADER_SIZE + payload_len) > rotation->size_limit){
+		return true;
+	}
+	return (rotation->duration_ticks != 0) && ((tx_time_get() - rotation->start_tick) >= rotation->duration_ticks);
+}
+
+/*
+ * Desc: preallocate one chunk for whichever file (current first, then next) is short of its target
+ */
+static void audio_file_preallocate(AudioManager *self){
+	AudioFileRotation *rotation = &self->rotation;
+	ExtentFile *extent = self->extent;
+	ULONG64 allocated = 0;
+
+	if (rotation->prealloc_stalled){
+		return;
+	}
+	if (extent->file->fx_file_current_available_size >= rotation->prealloc_size){
+		//Until it's retired, the next file's place is taken by the previous file
+		if (rotation->retire_pending){
+			return;
+		}
+		extent = self->next_extent;
+		if (extent->file->fx_file_current_available_size >= rotation->prealloc_size){
+			return;
+		}
+	}
+
+	//Best effort, so a fragmented card still hands out what it can. Once it has nothing left, writes fall back to allocating as they go.
+	if ((extent_file_allocate(extent, AUDIO_FILE_ALLOCATE_CHUNK, &allocated) != FX_SUCCESS) || (allocated == 0)){
+		rotation->prealloc_stalled = true;
+	}
+}
+
+/*
+ * Desc: add a block to the record being built
+ */
+static void audio_container_add(AudioManager *self, uint32_t sequence, uint32_t length){
+	self->record.blocks[self->record.block_count++] = (AudioFileBlockEntry){
+		.sequence = sequence,
+		.tick = self->queue.block_ticks[sequence % TEMP_BUF_BLOCK_LENGTH],
+		.length = length,
+		.crc_errors = self->check_crc ? audio_crc_check(&self->adc_crc, self->temp_buffer[sequence % TEMP_BUF_BLOCK_LENGTH], AUDIO_CIRCULAR_BUFFER_SIZE, sequence) : 0,
+	};
+	self->record.payload_len += length;
+}
+
+/*
+ * Desc: write the record header followed by its payload, then start a new record
+ */
+static void audio_container_write(AudioManager *self, const uint8_t *payload){
+	RTC_TimeTypeDef time = {};
+	RTC_DateTypeDef date = {};
+
+	if (audio_file_needs_rotation(self, self->record.payload_len)){
+		audio_file_rotate(self);
+	}
+
+	//The date has to be read after the time to unlock the RTC shadow registers
+	self->record.rtc_tick = tx_time_get();
+	HAL_RTC_GetTime(&hrtc, &time, RTC_FORMAT_BIN);
+	HAL_RTC_GetDate(&hrtc, &date, RTC_FORMAT_BIN);
+	self->record.rtc_year = date.Year;
+	self->record.rtc_month = date.Month;
+	self->record.rtc_day = date.Date;
+	self->record.rtc_hours = time.Hours;
+	self->record.rtc_minutes = time.Minutes;
+	self->record.rtc_seconds = time.Seconds;
+	self->record.dropped_blocks = self->queue.dropped_blocks;
+
+	audio_file_header_pack(&self->record, self->record_sector);
+	audio_write(self, self->record_sector, AUDIO_FILE_HEADER_SIZE);
+	audio_write(self, payload, self->record.payload_len);
+
+	//Block ticks are taken in the SAI callback, the oldest block in the record has waited the longest
+	if (self->record.block_count > 0){
+		audio_stats_peak(&self->stats.latency_max_us,
+				(uint32_t)(((uint64_t)(tx_time_get() - self->record.blocks[0].tick) * 1000000) / TX_TIMER_TICKS_PER_SECOND));
+	}
+
+	self->record.block_count = 0;
+	self->record.payload_len = 0;
+	self->record.flags &= ~AUDIO_FILE_FLAG_PADDING;
+}
+
+/*
+ * Desc: write out whatever is staged
+ */
+static void audio_stage_flush(AudioManager *self){
+	if (self->record.block_count > 0){
+		audio_stats_peak(&self->stats.stage_peak_bytes, self->record.payload_len);
+		audio_container_write(self, self->compress_buffer);
+	}
+}
+
+/*
+ * Desc: repack and/or compress one block onto the end of the staging buffer, writing the staging buffer out first if the block doesn't fit behind it
+ */
+static void audio_stage_block(AudioManager *self, uint32_t sequence){
+	const uint8_t *block = self->temp_buffer[sequence % TEMP_BUF_BLOCK_LENGTH];
+	size_t block_len = AUDIO_CIRCULAR_BUFFER_SIZE;
+	size_t len = 0;
+
+	if (self->repack){
+		//Uncompressed, the repacked block is what gets stored
+		if (!self->compress){
+			len = audio_repack_len(&self->repacker, block_len);
+			if ((self->record.payload_len + len) > sizeof(self->compress_buffer)){
+				audio_stage_flush(self);
+			}
+			audio_repack(&self->repacker, block, block_len, &self->compress_buffer[self->record.payload_len]);
+			audio_container_add(self, sequence, len);
+
+			if (self->record.block_count == AUDIO_FILE_MAX_BLOCKS){
+				audio_stage_flush(self);
+			}
+			return;
+		}
+
+		block_len = audio_repack(&self->repacker, block, block_len, self->repack_buffer);
+		block = self->repack_buffer;
+	}
+
+	len = audio_codec_encode(&self->codec_format, block, block_len,
+			&self->compress_buffer[self->record.payload_len], sizeof(self->compress_buffer) - self->record.payload_len);
+	if (len == 0){
+		//An empty staging buffer always fits a worst case block
+		audio_stage_flush(self);
+		len = audio_codec_encode(&self->codec_format, block, block_len, self->compress_buffer, sizeof(self->compress_buffer));
+		if (len == 0){
+			Error_Handler();
+		}
+	}
+	audio_container_add(self, sequence, len);
+
+	if (self->record.block_count == AUDIO_FILE_MAX_BLOCKS){
+		audio_stage_flush(self);
+	}
+}
+
+/*
+ * Desc: add a detected click to the index
+ */
+static void audio_click_log(AudioManager *self, const ClickEvent *event){
+	//Block ticks mark the end of a block, count back from there to the first frame of the click.
+	//A click never spans more than a block or two, so its block's tick is still in the queue.
+	uint32_t frames_after = self->frames_per_block - event->frame;
+	uint32_t tick = self->queue.block_ticks[event->sequence % TEMP_BUF_BLOCK_LENGTH]
+			- (uint32_t)(((uint64_t)frames_after * TX_TIMER_TICKS_PER_SECOND) / self->record.sample_rate);
+
+	self->click_index[self->click_index_count++] = (AudioClickIndexEntry){
+		.tick = tick,
+		.sequence = event->sequence,
+		.frame = event->frame,
+		.channel = event->channel,
+		.amplitude = event->amplitude,
+	};
+	if (self->click_index_count == AUDIO_CLICK_INDEX_ENTRIES){
+		audio_click_file_flush(self);
+	}
+}
+
+/*
+ * Desc: run a block through the preview decimator, in pieces small enough for what is left of the preview buffer
+ */
+static void audio_preview_block(AudioManager *self, const uint8_t *block){
+	size_t frame_bytes = audio_codec_frame_bytes(&self->capture_format);
+	size_t frame = 0;
+
+	while (frame < self->frames_per_block){
+		size_t space = AUDIO_PREVIEW_BUFFER_SAMPLES - self->preview_count;
+		size_t frames = _MIN(self->frames_per_block - frame, (space - 1) * self->preview.decimation);
+
+		self->preview_count += preview_process(&self->preview, &block[frame * frame_bytes], frames, &self->preview_buffer[self->preview_count]);
+		frame += frames;
+
+		//Always leave room for at least one output
+		if ((AUDIO_PREVIEW_BUFFER_SAMPLES - self->preview_count) < 2){
+			audio_preview_flush(self);
+		}
+	}
+}
+
+/*
+ * Desc: run the click detector and the preview over the queued blocks they haven't seen yet, up to (not including) end.
+ *       Returns the sequence of the block the first click started in, or end if there were none.
+ */
+static uint32_t audio_block_scan(AudioManager *self, uint32_t end){
+	uint32_t first_click = end;
+
+	if (!self->detect_clicks && !self->preview_enabled){
+		return end;
+	}
+
+	//Blocks the DMA lapped (or the trigger skipped) were never seen, pick up from the oldest one still queued
+	if ((int32_t)(self->queue.tail - self->block_scanned) > 0){
+		self->block_scanned = self->queue.tail;
+	}
+
+	for (; (int32_t)(end - self->block_scanned) > 0; self->block_scanned++){
+		uint32_t sequence = self->block_scanned;
+		const uint8_t *block = self->temp_buffer[sequence % TEMP_BUF_BLOCK_LENGTH];
+
+		if (self->preview_enabled){
+			audio_preview_block(self, block);
+		}
+		if (!self->detect_clicks){
+			continue;
+		}
+
+		size_t count = click_detector_process(&self->click_detector, block, AUDIO_CIRCULAR_BUFFER_SIZE,
+				sequence, self->click_events, AUDIO_CLICK_EVENTS_PER_BLOCK);
+
+		for (size_t i = 0; i < count; i++){
+			if ((int32_t)(self->click_events[i].sequence - first_click) < 0){
+				first_click = self->click_events[i].sequence;
+			}
+			if (self->log_clicks){
+				audio_click_log(self, &self->click_events[i]);
+			}
+		}
+	}
+	return first_click;
+}
+
+/*
+ * Desc: in triggered mode, check the triggers against everything queued. Returns true if the queue should be written out.
+ *       While no trigger is active, the queue is trimmed down to the pre-trigger window instead.
+ */
+static bool audio_trigger_update(AudioManager *self){
+	AudioTrigger *trigger = &self->trigger;
+	uint32_t tail = 0;
+	ULONG now = tx_time_get();
+	bool triggered = false;
+
+	//Claim accounts for anything the DMA lapped, everything from tail to head is safe to read
+	audio_queue_claim(&self->queue, &tail);
+	uint32_t head = self->queue.head;
+	uint32_t start = head;
+
+	uint32_t first_click = audio_block_scan(self, head);
+	if (trigger->clicks && (first_click != head)){
+		triggered = true;
+		start = first_click;
+	}
+
+	if (triggered){
+		//Keep the pre-trigger window in front of where the trigger started, everything older goes
+		if (!trigger->active){
+			uint32_t keep_from = start - trigger->pre_blocks;
+			if ((int32_t)(keep_from - tail) > 0){
+				audio_queue_release(&self->queue, keep_from - tail);
+			}
+		}
+		trigger->active = true;
+		trigger->hold_until = now + trigger->hold_ticks;
+		return true;
+	}
+
+	if (trigger->active && ((LONG)(trigger->hold_until - now) > 0)){
+		return true;
+	}
+
+	trigger->active = false;
+	if ((head - tail) > trigger->pre_blocks){
+		audio_queue_release(&self->queue, head - tail - trigger->pre_blocks);
+	}
+	return false;
+}
+
+/*
+ * Desc: write every queued block to the SD card, one contiguous run at a time
+ */
+static void audio_queue_drain(AudioManager *self){
+	uint32_t sequence = 0;
+	uint32_t count = 0;
+
+	if (self->trigger.enabled && !audio_trigger_update(self)){
+		return;
+	}
+
+	count = audio_queue_claim(&self->queue, &sequence);
+	while (count > 0){
+		if (self->compress || self->repack){
+			//Stage one block at a time, so each block goes back to the DMA as soon as it has been encoded/repacked
+			count = 1;
+			audio_block_scan(self, sequence + count);
+			audio_stage_block(self, sequence);
+		}
+		else {
+			audio_block_scan(self, sequence + count);
+			for (uint32_t i = 0; i < count; i++){
+				audio_container_add(self, sequence + i, AUDIO_CIRCULAR_BUFFER_SIZE);
+			}
+			audio_container_write(self, self->temp_buffer[sequence % TEMP_BUF_BLOCK_LENGTH]);
+		}
+
+		audio_queue_release(&self->queue, count);
+		count = audio_queue_claim(&self->queue, &sequence);
+	}
+}
+
+/*
+ * Desc: add every FFT segment of a block to the LTSA. Segments the DMA may have started overwriting are left out.
+ */
+static void audio_ltsa_block(AudioManager *self, uint32_t sequence){
+	const uint8_t *block = self->temp_buffer[sequence % TEMP_BUF_BLOCK_LENGTH];
+	for (size_t frame = 0; (frame + LTSA_FFT_SIZE) <= self->frames_per_block; frame += LTSA_FFT_SIZE){
+		for (uint_fast8_t ch = 0; ch < self->channel_count; ch++){
+			ltsa_segment_load(&self->ltsa, block, frame, ch);
+
+			//The DMA starts refilling this block's slot once head is a full ring ahead of it, anything loaded after that may be torn
+			__DMB();
+			if ((self->queue.head - sequence) > AUDIO_QUEUE_MAX_DEPTH){
+				return;
+			}
+			ltsa_segment_accumulate(&self->ltsa, ch);
+		}
+	}
+}
+
+/*
+ * Desc: finish the interval ending with block last, if the audio thread has written out the previous rows.
+ *       Otherwise keep averaging, the rows record where their interval started.
+ */
+static void audio_ltsa_publish(AudioManager *self, uint32_t last){
+	if (self->ltsa_rows_ready){
+		return;
+	}
+
+	for (uint_fast8_t ch = 0; ch < self->channel_count; ch++){
+		AudioLtsaRow *row = &self->ltsa_rows[ch];
+
+		row->segments = _MIN(ltsa_average_take(&self->ltsa, ch, row->bins), UINT16_MAX);
+		row->tick = self->queue.block_ticks[last % TEMP_BUF_BLOCK_LENGTH];
+		row->sequence = self->ltsa_interval_start;
+		row->bin_count = LTSA_BINS;
+		row->sample_rate = self->record.sample_rate;
+	}
+	self->ltsa_interval_start = last + 1;
+
+	__DMB();
+	self->ltsa_rows_ready = true;
+}
+
+void audio_ltsa_thread_entry(ULONG thread_input){
+	ULONG flags = 0;
+
+	while (1){
+
+		//Wait for the DMA to finish a block. Every other thread comes first, we just catch up whenever we get the CPU.
+		tx_event_flags_get(&audio_ltsa_event_flags_group, AUDIO_LTSA_BLOCK_FLAG, TX_OR_CLEAR, &flags, TX_WAIT_FOREVER);
+
+		uint32_t head = audio.queue.head;
+		__DMB();
+
+		//Fallen a whole ring behind, skip to the newest block. The skipped blocks only make this interval's average a little thinner.
+		if ((head - audio.ltsa_next) > AUDIO_QUEUE_MAX_DEPTH){
+			audio.ltsa_next = head - 1;
+		}
+
+		for (; audio.ltsa_next != head; audio.ltsa_next++){
+			audio_ltsa_block(&audio, audio.ltsa_next);
+
+			if ((audio.ltsa_next + 1 - audio.ltsa_interval_start) >= audio.ltsa_interval_blocks){
+				audio_ltsa_publish(&audio, audio.ltsa_next);
+			}
+		}
+	}
+}
+
+void audio_thread_entry(ULONG thread_input){
 
-	  //Set our DMA buffer callbacks for both half full and full
-	  HAL_SAI_RegisterCallback(&hsai_BlockB1, HAL_SAI_RX_HALFCOMPLETE_CB_ID, audio_SAI_RxHalfCpltCallback);
+	//Tag configuration, from config.txt on the SD card (anything it doesn't set, or all of it if it's missing, is left at the defaults)
+	TagConfig tag_config;
+	if (fx_file_open(&sdio_disk, &audio_config_file, TAG_CONFIG_FILE_NAME, FX_OPEN_FOR_READ) == FX_SUCCESS){
+		TagConfig_read(&tag_config, &audio_config_file);
+		fx_file_close(&audio_config_file);
+	}
+	else{
+		TagConfig_read(&tag_config, NULL);
+	}
+	  ULONG acc_flag_pointer = 0;
+
+	  //Set our DMA block complete callback (fires once per linked-list node, i.e. once per temp buffer block)
 	  HAL_SAI_RegisterCallback(&hsai_BlockB1, HAL_SAI_RX_COMPLETE_CB_ID, audio_SAI_RxCpltCallback);
 
 	  //Create our event flags group
 	  tx_event_flags_create(&audio_event_flags_group, "Audio Event Flags");
 
+	  //Our storage stream, audio writes go ahead of every other stream's
+	  storage_stream_init(&audio.storage, "Audio Storage", NULL, 0, true);
+
+	  //Create the LTSA thread's event flags group
+	  tx_event_flags_create(&audio_ltsa_event_flags_group, "Audio LTSA Event Flags");
+
 	  //Setup the ADC and sync it
 	  ad7768_setup(&audio_adc);
 
-	  //Initialize our audio manager
-	  audio_init(&audio, &audio_adc, &hsai_BlockB1, &tag_config, &audio_file);
+	  //Initialize our audio manager, this applies the channel/depth/header layout to the ADC & SAI. A config it can't use (no channels enabled) falls back to the defaults.
+	  if (audio_init(&audio, &audio_adc, &hsai_BlockB1, &tag_config, &sdio_disk, &audio_file, &audio_next_file, &audio_click_file, audio_ltsa_files, &audio_preview_file, &audio_stats_file) != HAL_OK){
+		  TagConfig_default(&tag_config);
+		  audio_init(&audio, &audio_adc, &hsai_BlockB1, &tag_config, &sdio_disk, &audio_file, &audio_next_file, &audio_click_file, audio_ltsa_files, &audio_preview_file, &audio_stats_file);
+	  }
+
+	  //Create the first audio files and give the first one a head start on its preallocation
+	  audio_file_start(&audio);
+	  audio_file_preallocate(&audio);
 
 	  //Dummy delay
 	  HAL_Delay(1000);
 
-	  //The first write is usually the slowest, add in a dummy write to get it out of the way
-	  audio.sd_write_complete = false;
-	  fx_file_write(audio.file, audio.temp_buffer[0], AUDIO_CIRCULAR_BUFFER_SIZE * 10);
-
-	  //Poll for completion
-	  while (!audio.sd_write_complete);
+	  //The first write is usually the slowest, add in a dummy write to get it out of the way. It goes out as a padding record so the file stays readable.
+	  audio.record.flags |= AUDIO_FILE_FLAG_PADDING;
+	  audio.record.payload_len = AUDIO_CIRCULAR_BUFFER_SIZE * 10;
+	  audio_container_write(&audio, audio.temp_buffer[0]);
 
 	  //Start gathering audio data through the SAI and DMA
 	  audio_record(&audio);
 
+	  //Start the background LTSA analysis (reset first, in case it ran in an earlier recording)
+	  if (audio.ltsa_enabled){
+		  tx_thread_reset(&threads[AUDIO_LTSA_THREAD].thread);
+		  tx_thread_resume(&threads[AUDIO_LTSA_THREAD].thread);
+	  }
+
 	  while (1){
 
-		  //Wait for the temp buffer to be either half of fully full. This suspends the audio task and lets others run.
-		  yielding = true;
-		  tx_event_flags_get(&audio_event_flags_group, AUDIO_BUFFER_FULL_FLAG | AUDIO_BUFFER_HALF_FULL_FLAG | AUDIO_STOP_THREAD_FLAG, TX_OR_CLEAR, &acc_flag_pointer, TX_WAIT_FOREVER);
-		  yielding = false;
+		  //Wait for a batch of blocks to queue up. This suspends the audio task and lets others run.
+		  tx_event_flags_get(&audio_event_flags_group, AUDIO_BLOCKS_READY_FLAG | AUDIO_STOP_THREAD_FLAG, TX_OR_CLEAR, &acc_flag_pointer, TX_WAIT_FOREVER);
 
-		  //If half full, write the bottom half
-		  if (acc_flag_pointer & AUDIO_BUFFER_HALF_FULL_FLAG){
-      		audio.sd_write_complete = false;
-      		sd_writing = true;
-      		fx_file_write(audio.file, audio.temp_buffer[0], AUDIO_CIRCULAR_BUFFER_SIZE * TEMP_BUF_HALF_BLOCK_LENGTH);
-		  }
+		  //Write out everything that is queued, including anything that arrived while we were writing
+		  if (acc_flag_pointer & AUDIO_BLOCKS_READY_FLAG){
+			  audio_queue_drain(&audio);
 
-		  //If full, write the top half
-		  if (acc_flag_pointer & AUDIO_BUFFER_FULL_FLAG){
-      		audio.sd_write_complete = false;
-      		sd_writing = true;
-      		fx_file_write(audio.file, audio.temp_buffer[TEMP_BUF_HALF_BLOCK_LENGTH], AUDIO_CIRCULAR_BUFFER_SIZE * TEMP_BUF_HALF_BLOCK_LENGTH);
+			  //Use the idle time to write the LTSA and get the files ready, unless we are already falling behind
+			  if ((audio.queue.head - audio.queue.tail) < AUDIO_WRITE_BATCH_BLOCKS){
+				  audio_ltsa_write(&audio);
+				  audio_stats_dump(&audio, false);
+				  audio_file_checkpoint(&audio, false);
+				  audio_file_retire(&audio);
+				  audio_file_preallocate(&audio);
+			  }
 		  }
 
-		  //Poll for completion, this blocks out other tasks but is *neccessary*
-		  //We block out the other tasks to prevent unneccessary context switches which would slow down the SD card writes significantly, to the point where we would lose data.
-		  while (!audio.sd_write_complete);
-
 		  //If we need to stop the thread, stop the data collection and suspend the thread
 		  if (acc_flag_pointer & AUDIO_STOP_THREAD_FLAG){
 
-			  //Stop DMA buffer
+			  //Stop DMA buffer and the analysis reading it
 			  HAL_SAI_DMAPause(audio.sai);
+			  if (audio.ltsa_enabled){
+				  tx_thread_terminate(&threads[AUDIO_LTSA_THREAD].thread);
+			  }
 
-			  //Close file
-			  fx_file_close(audio.file);
+			  //Flush the partial batch left in the queue (and anything still staged)
+			  audio_queue_drain(&audio);
+			  audio_stage_flush(&audio);
+
+			  //Close the files
+			  audio_file_stop(&audio);
 
 			  //Terminate thread so it needs to be fully reset to start again
 			  tx_event_flags_delete(&audio_event_flags_group);
+			  storage_stream_delete(&audio.storage);
+			  tx_event_flags_delete(&audio_ltsa_event_flags_group);
 			  tx_thread_terminate(&threads[AUDIO_THREAD].thread);
 		  }
 
@@ -246,47 +1038,238 @@ void audio_thread_entry(ULONG thread_input){
 /* 
  * Desc: initialize and configure audio manager
  */
-HAL_StatusTypeDef audio_init(AudioManager *self, ad7768_dev *adc, SAI_HandleTypeDef *hsai, TagConfig *config, FX_FILE *file){
+HAL_StatusTypeDef audio_init(AudioManager *self, ad7768_dev *adc, SAI_HandleTypeDef *hsai, TagConfig *config, FX_MEDIA *media, FX_FILE *file, FX_FILE *next_file, FX_FILE *click_file, FX_FILE *ltsa_files, FX_FILE *preview_file, FX_FILE *stats_file){
     self->adc = adc;
     self->sai = hsai;
 
-    self->temp_counter = 0;
+    audio_stats_reset(&self->stats);
+
+    self->queue = (AudioBlockQueue){};
+    self->compress = false;
+    self->repack = false;
+    self->check_crc = false;
+    self->detect_clicks = false;
+    self->log_clicks = false;
+    self->block_scanned = 0;
+    self->trigger = (AudioTrigger){};
+    self->ltsa_enabled = false;
+    self->ltsa_rows_ready = false;
+    self->preview_enabled = false;
+    self->preview_count = 0;
+    self->record = (AudioFileHeader){
+        .block_size = AUDIO_CIRCULAR_BUFFER_SIZE,
+        .tick_rate = TX_TIMER_TICKS_PER_SECOND,
+    };
+    self->rotation = (AudioFileRotation){
+        .media = media,
+        .size_limit = AUDIO_FILE_SIZE_MAX,
+    };
     if(config){
-        //audio_configure(self, config);
+        self->channel_count = 0;
+        for(uint_fast8_t ch = 0; ch < 4; ch++){
+            self->channel_count += (config->audio_ch_enabled[ch] != 0);
+        }
+        self->sample_size = (config->audio_depth == CFG_AUDIO_DEPTH_16_BIT) ? 2 : 3;
+
+        self->compress = config->audio_compression;
+        self->codec_format = (AudioCodecFormat){
+            .channel_count = self->channel_count,
+            .sample_bytes = self->sample_size,
+            .header_bytes = config->audio_ch_headers ? 1 : 0,
+        };
+
+        if(self->channel_count == 0){
+            return HAL_ERROR;
+        }
+
+        //Dithered 16-bit is captured as 24-bit and repacked in software, anything else is captured as stored
+        self->capture_format = self->codec_format;
+        if(config->audio_dither && (self->codec_format.sample_bytes == 2)){
+            self->capture_format.sample_bytes = 3;
+            self->repack = audio_repack_init(&self->repacker, &self->capture_format, &self->codec_format, true);
+        }
+
+        //Only the enabled channels' slots are transferred, so fewer channels or no headers means smaller frames in the same (sector aligned) blocks
+        self->frames_per_block = AUDIO_CIRCULAR_BUFFER_SIZE / audio_codec_frame_bytes(&self->capture_format);
+
+        self->record.sample_rate = TagConfig_audio_rate_hz(config->audio_rate);
+        if(audio_rate_setting_find(self->record.sample_rate) == NULL){
+            return HAL_ERROR;
+        }
+        self->record.sample_bytes = self->codec_format.sample_bytes;
+        self->record.header_bytes = self->codec_format.header_bytes;
+        self->record.flags = self->compress ? AUDIO_FILE_FLAG_COMPRESSED : 0;
+        if(self->repack){
+            self->record.block_size = audio_repack_len(&self->repacker, AUDIO_CIRCULAR_BUFFER_SIZE);
+            self->record.flags |= AUDIO_FILE_FLAG_DITHERED;
+        }
+
+        //ADC CRCs ride in the headers and cover all 24 bits, so they're only turned on if those get captured
+        if(config->audio_crc != 0){
+            self->check_crc = audio_crc_init(&self->adc_crc, &self->capture_format, config->audio_crc);
+        }
+        if(self->check_crc){
+            self->record.flags |= AUDIO_FILE_FLAG_ADC_CRC;
+        }
+        for(uint_fast8_t ch = 0; ch < 4; ch++){
+            self->record.channel_mask |= (config->audio_ch_enabled[ch] ? 1 : 0) << ch;
+        }
+
+        //Triggered recording, the pre-trigger window is rounded up to whole blocks
+        if(config->audio_trigger){
+            uint32_t pre_frames = (uint32_t)(((uint64_t)config->audio_trigger_pre_ms * self->record.sample_rate) / 1000);
+
+            self->trigger = (AudioTrigger){
+                .enabled = true,
+                .clicks = config->audio_trigger_clicks,
+                .pre_blocks = _MIN((pre_frames + self->frames_per_block - 1) / self->frames_per_block, AUDIO_TRIGGER_PRE_BLOCKS_MAX),
+                .hold_ticks = tx_s_to_ticks(config->audio_trigger_hold_s),
+            };
+            self->record.flags |= AUDIO_FILE_FLAG_TRIGGERED;
+        }
+
+        //Click detection runs on the raw blocks, so it sees the captured layout
+        self->log_clicks = config->audio_click_detector;
+        self->detect_clicks = self->log_clicks || (self->trigger.enabled && self->trigger.clicks);
+        if(self->detect_clicks){
+            click_detector_init(&self->click_detector, &self->capture_format, self->record.sample_rate, config->audio_click_threshold);
+        }
+
+        //LTSA rows are rounded to whole blocks
+        self->ltsa_enabled = config->audio_ltsa;
+        if(self->ltsa_enabled){
+            ltsa_init(&self->ltsa, &self->capture_format);
+            self->ltsa_next = 0;
+            self->ltsa_interval_start = 0;
+            self->ltsa_interval_blocks = _MAX(1, ((uint64_t)config->audio_ltsa_interval_s * self->record.sample_rate) / self->frames_per_block);
+        }
+
+        //The preview is mono, the first recorded channel
+        if(config->audio_preview){
+            self->preview_enabled = preview_init(&self->preview, &self->capture_format, 0, self->record.sample_rate);
+        }
+
+        //File rollover limits
+        if(config->audio_file_megabytes != 0){
+            self->rotation.size_limit = _MIN((ULONG64)config->audio_file_megabytes * 1024 * 1024, AUDIO_FILE_SIZE_MAX);
+        }
+        self->rotation.duration_ticks = tx_s_to_ticks((ULONG)config->audio_file_minutes * 60);
+
+        //Preallocate about what one file will hold: the raw data rate (plus 1/64 for record headers) over the file duration, roughly half that if compressed
+        self->rotation.prealloc_size = self->rotation.size_limit;
+        if(config->audio_file_minutes != 0){
+            ULONG64 expected = (ULONG64)self->record.sample_rate * audio_codec_frame_bytes(&self->codec_format) * config->audio_file_minutes * 60;
+            expected += expected / 64;
+            if(self->compress){
+                expected /= 2;
+            }
+            self->rotation.prealloc_size = _MIN(expected, self->rotation.size_limit);
+        }
+
+        //Apply the layout to the ADC & SAI
+        HAL_RESULT_PROPAGATE(audio_configure(self, config));
     }
-    self->file = file;
+    self->extents[0].file = file;
+    self->extents[1].file = next_file;
+    self->extent = &self->extents[0];
+    self->next_extent = &self->extents[1];
+    self->click_file = click_file;
+    self->ltsa_files = ltsa_files;
+    self->preview_file = preview_file;
+    self->stats_file = stats_file;
     return HAL_OK;
 }
 
 HAL_StatusTypeDef audio_configure(AudioManager *self, TagConfig *config){
     uint32_t channel_bytemask = 0x0000FFFF;
-    
+    HAL_StatusTypeDef ret = HAL_OK;
+
+    //Each channel takes 4 slots on the wire: [header, MSB, mid, LSB]
     if( !config->audio_ch_headers ){
-        channel_bytemask &= 0x00007777;
+        channel_bytemask &= 0x0000EEEE;
     }
     
-    if( config->audio_depth == CFG_AUDIO_DEPTH_16_BIT ){
-        channel_bytemask &= 0x0000EEEE;
+    if( self->capture_format.sample_bytes == 2 ){
+        channel_bytemask &= 0x00007777;
     }
 
+    //Collect every ADC change and write them back to back, then restart the ADC filters once
+    ad7768_batch_begin(self->adc);
     for(uint_fast8_t ch = 0; ch < 4; ch++){
         if( !config->audio_ch_enabled[ch] ){ //disable channel
             channel_bytemask &= ~(0x0000000F << (4*ch));
             ad7768_set_ch_mode(self->adc, (ad7768_ch)ch, AD7768_MODE_A);
-            ad7768_set_ch_state(self->adc, (ad7768_ch)ch, AD7768_SLEEP);
+            ad7768_set_ch_state(self->adc, (ad7768_ch)ch, AD7768_STANDBY);
         }
         else{ //enable channel
             ad7768_set_ch_mode(self->adc, (ad7768_ch)ch, AD7768_MODE_B);
-            ad7768_set_ch_state(self->adc, (ad7768_ch)ch, AD7768_ACTIVE);
+            ad7768_set_ch_state(self->adc, (ad7768_ch)ch, AD7768_ENABLED);
         }
     }
-    self->sai->SlotInit.SlotActive = channel_bytemask;
-    HAL_RESULT_PROPAGATE(HAL_SAI_Init(self->sai) != HAL_OK)
+    ret = audio_set_sample_rate(self, config->audio_rate);
+    if( self->check_crc ){
+        ad7768_set_crc_sel(self->adc, (self->adc_crc.interval == 4) ? AD7768_CRC_4 : AD7768_CRC_16);
+    }
+    else{
+        ad7768_set_crc_sel(self->adc, AD7768_CRC_NONE);
+    }
+
+    //Always close the batch, even after an error, or every later setter would only ever update the shadow
+    ret |= ad7768_batch_apply(self->adc);
+    HAL_RESULT_PROPAGATE(ret);
+    HAL_RESULT_PROPAGATE(ad7768_sync(self->adc));
 
-    HAL_RESULT_PROPAGATE(audio_set_sample_rate(self, config->audio_rate));
+    self->sai->SlotInit.SlotActive = channel_bytemask;
+    HAL_RESULT_PROPAGATE(HAL_SAI_Init(self->sai));
     return HAL_OK;
 }
 
+//MCLK divider & decimation as numbers
+#define AUDIO_MCLK_DIVISOR(div) (((div) == AD7768_MCLK_DIV_4) ? 4 : (((div) == AD7768_MCLK_DIV_8) ? 8 : 32))
+#define AUDIO_DECIMATION(dec) (32UL << (dec))
+
+#define AUDIO_RATE_SETTING(power, mclk, dec) { \
+    .rate_hz = AD7768_MCLK_HZ / (AUDIO_MCLK_DIVISOR(mclk) * AUDIO_DECIMATION(dec)), \
+    .power_mode = (power), \
+    .mclk_div = (mclk), \
+    .dec_rate = (dec), \
+}
+
+//Every power mode (each with the MCLK divider that keeps its modulator in range) and decimation the wideband filter allows,
+//lowest power first so the first match for a rate is the cheapest way to get it
+static const AudioRateSetting audio_rate_settings[] = {
+    AUDIO_RATE_SETTING(AD7768_ECO, AD7768_MCLK_DIV_32, AD7768_DEC_X32),
+    AUDIO_RATE_SETTING(AD7768_ECO, AD7768_MCLK_DIV_32, AD7768_DEC_X64),
+    AUDIO_RATE_SETTING(AD7768_ECO, AD7768_MCLK_DIV_32, AD7768_DEC_X128),
+    AUDIO_RATE_SETTING(AD7768_ECO, AD7768_MCLK_DIV_32, AD7768_DEC_X256),
+    AUDIO_RATE_SETTING(AD7768_ECO, AD7768_MCLK_DIV_32, AD7768_DEC_X512),
+    AUDIO_RATE_SETTING(AD7768_ECO, AD7768_MCLK_DIV_32, AD7768_DEC_X1024),
+    AUDIO_RATE_SETTING(AD7768_MEDIAN, AD7768_MCLK_DIV_8, AD7768_DEC_X32),
+    AUDIO_RATE_SETTING(AD7768_MEDIAN, AD7768_MCLK_DIV_8, AD7768_DEC_X64),
+    AUDIO_RATE_SETTING(AD7768_MEDIAN, AD7768_MCLK_DIV_8, AD7768_DEC_X128),
+    AUDIO_RATE_SETTING(AD7768_MEDIAN, AD7768_MCLK_DIV_8, AD7768_DEC_X256),
+    AUDIO_RATE_SETTING(AD7768_MEDIAN, AD7768_MCLK_DIV_8, AD7768_DEC_X512),
+    AUDIO_RATE_SETTING(AD7768_MEDIAN, AD7768_MCLK_DIV_8, AD7768_DEC_X1024),
+    AUDIO_RATE_SETTING(AD7768_FAST, AD7768_MCLK_DIV_4, AD7768_DEC_X32),
+    AUDIO_RATE_SETTING(AD7768_FAST, AD7768_MCLK_DIV_4, AD7768_DEC_X64),
+    AUDIO_RATE_SETTING(AD7768_FAST, AD7768_MCLK_DIV_4, AD7768_DEC_X128),
+    AUDIO_RATE_SETTING(AD7768_FAST, AD7768_MCLK_DIV_4, AD7768_DEC_X256),
+    AUDIO_RATE_SETTING(AD7768_FAST, AD7768_MCLK_DIV_4, AD7768_DEC_X512),
+    AUDIO_RATE_SETTING(AD7768_FAST, AD7768_MCLK_DIV_4, AD7768_DEC_X1024),
+};
+
+/*
+ * Desc: find the lowest power ADC setting for a sample rate
+ */
+const AudioRateSetting *audio_rate_setting_find(uint32_t rate_hz){
+    for(size_t i = 0; i < (sizeof(audio_rate_settings) / sizeof(audio_rate_settings[0])); i++){
+        if(audio_rate_settings[i].rate_hz == rate_hz){
+            return &audio_rate_settings[i];
+        }
+    }
+    return NULL;
+}
+
 /* 
  * Desc: set the audio sample rate
  */
@@ -294,43 +1277,88 @@ HAL_StatusTypeDef audio_set_sample_rate(
     AudioManager *self, 
     TagConfigAudioSampleRate audio_rate
 ){
-    if (audio_rate == CFG_AUDIO_RATE_96_KHZ){
-        ad7768_set_mclk_div(self->adc, AD7768_MCLK_DIV_8);
-        ad7768_set_power_mode(self->adc, AD7768_MEDIAN);
-        ad7768_set_dclk_div(self->adc, AD7768_DCLK_DIV_4);
+    const AudioRateSetting *setting = audio_rate_setting_find(TagConfig_audio_rate_hz(audio_rate));
+    ad7768_dclk_div dclk_div = AD7768_DCLK_DIV_8;
 
-    } else if (audio_rate == CFG_AUDIO_RATE_192_KHZ){
-        HAL_RESULT_PROPAGATE(ad7768_set_mclk_div(self->adc, AD7768_MCLK_DIV_4));
-        HAL_RESULT_PROPAGATE(ad7768_set_power_mode(self->adc, AD7768_FAST));
-        HAL_RESULT_PROPAGATE(ad7768_set_dclk_div(self->adc, AD7768_DCLK_DIV_1));
-
-    } else {
+    if (setting == NULL){
         return HAL_ERROR;
     }
+
+    //96 kHz keeps the data clock the tag has always recorded with. Other rates get the slowest one that still gets a whole
+    //frame out every sample period (DCLK_DIV_n is MCLK / 2^(3 - n)), which is the same at 192 kHz.
+    if (audio_rate == CFG_AUDIO_RATE_96_KHZ){
+        dclk_div = AD7768_DCLK_DIV_4;
+    }
+    else{
+        while ((dclk_div != AD7768_DCLK_DIV_1) && ((AD7768_MCLK_HZ >> (3 - dclk_div)) < (setting->rate_hz * AUDIO_ADC_FRAME_BITS))){
+            dclk_div++;
+        }
+    }
+
+    HAL_RESULT_PROPAGATE(ad7768_set_mclk_div(self->adc, setting->mclk_div));
+    HAL_RESULT_PROPAGATE(ad7768_set_power_mode(self->adc, setting->power_mode));
+    HAL_RESULT_PROPAGATE(ad7768_set_dclk_div(self->adc, dclk_div));
+    HAL_RESULT_PROPAGATE(ad7768_set_mode_config(self->adc, AD7768_MODE_A, AD7768_FILTER_SINC, setting->dec_rate));
+    HAL_RESULT_PROPAGATE(ad7768_set_mode_config(self->adc, AD7768_MODE_B, AD7768_FILTER_WIDEBAND, setting->dec_rate));
     return HAL_OK;
 }
 
-HAL_StatusTypeDef audio_record(AudioManager *self){
-    HAL_SAI_Receive_DMA(self->sai, self->audio_buffer[0], AUDIO_CIRCULAR_BUFFER_SIZE * 2);
+/*
+ * Desc: rebuild the SAI GPDMA channel as a circular linked-list with one node per temp buffer block.
+ *       The DMA writes each block in place and raises a transfer complete event at the end of every node.
+ */
+static HAL_StatusTypeDef audio_dma_link(AudioManager *self){
+    DMA_HandleTypeDef *hdma = self->sai->hdmarx;
+    DMA_NodeConfTypeDef node_config = {
+        .NodeType = DMA_GPDMA_LINEAR_NODE,
+        .Init = {
+            .Request = GPDMA1_REQUEST_SAI1_B,
+            .BlkHWRequest = DMA_BREQ_SINGLE_BURST,
+            .Direction = DMA_PERIPH_TO_MEMORY,
+            .SrcInc = DMA_SINC_FIXED,
+            .DestInc = DMA_DINC_INCREMENTED,
+            .SrcDataWidth = DMA_SRC_DATAWIDTH_BYTE,
+            .DestDataWidth = DMA_DEST_DATAWIDTH_BYTE,
+            .SrcBurstLength = 1,
+            .DestBurstLength = 1,
+            .TransferAllocatedPort = DMA_SRC_ALLOCATED_PORT0 | DMA_DEST_ALLOCATED_PORT0,
+            .TransferEventMode = DMA_TCEM_BLOCK_TRANSFER,
+            .Mode = DMA_NORMAL,
+        },
+        .TriggerConfig.TriggerPolarity = DMA_TRIG_POLARITY_MASKED,
+        .DataHandlingConfig = {
+            .DataExchange = DMA_EXCHANGE_NONE,
+            .DataAlignment = DMA_DATA_RIGHTALIGN_ZEROPADDED,
+        },
+        .SrcAddress = (uint32_t)&self->sai->Instance->DR,
+        .DataSize = AUDIO_CIRCULAR_BUFFER_SIZE,
+    };
+
+    //Drop the single node queue built by the MSP init
+    HAL_RESULT_PROPAGATE(HAL_DMAEx_List_UnLinkQ(hdma));
+    HAL_RESULT_PROPAGATE(HAL_DMAEx_List_ResetQ(&audio_dma_queue));
+
+    for (uint_fast8_t block = 0; block < TEMP_BUF_BLOCK_LENGTH; block++){
+        node_config.DstAddress = (uint32_t)self->temp_buffer[block];
+        HAL_RESULT_PROPAGATE(HAL_DMAEx_List_BuildNode(&node_config, &audio_dma_nodes[block]));
+        HAL_RESULT_PROPAGATE(HAL_DMAEx_List_InsertNode_Tail(&audio_dma_queue, &audio_dma_nodes[block]));
+    }
+
+    HAL_RESULT_PROPAGATE(HAL_DMAEx_List_SetCircularMode(&audio_dma_queue));
+    HAL_RESULT_PROPAGATE(HAL_DMAEx_List_LinkQ(hdma, &audio_dma_queue));
     return HAL_OK;
 }
 
-HAL_StatusTypeDef audio_tick(AudioManager *self){
-    switch (self->buffer_state){
-        case AUDIO_BUF_STATE_HALF_FULL:
-        	fx_file_write(self->file, self->temp_buffer[0], AUDIO_CIRCULAR_BUFFER_SIZE * TEMP_BUF_HALF_BLOCK_LENGTH);
+HAL_StatusTypeDef audio_record(AudioManager *self){
+    //Start with an empty queue, the DMA restarts at block 0
+    self->queue.head = 0;
+    self->queue.tail = 0;
+    HAL_RESULT_PROPAGATE(audio_dma_link(self));
 
-            //ToDo: Error Handling
-            break;
-        case AUDIO_BUF_STATE_FULL:
-        	fx_file_write(self->file, self->temp_buffer[10], AUDIO_CIRCULAR_BUFFER_SIZE * TEMP_BUF_HALF_BLOCK_LENGTH);
+    //HAL only (re)writes the head node, which matches node 0 above
+    HAL_RESULT_PROPAGATE(HAL_SAI_Receive_DMA(self->sai, self->temp_buffer[0], AUDIO_CIRCULAR_BUFFER_SIZE));
 
-            //ToDo: Error Handling
-            break;
-        case AUDIO_BUF_STATE_EMPTY:
-            break;
-        default:
-            break;
-    }
+    //We only care about whole blocks, don't take an interrupt halfway through each node
+    __HAL_DMA_DISABLE_IT(self->sai->hdmarx, DMA_IT_HT);
     return HAL_OK;
 }
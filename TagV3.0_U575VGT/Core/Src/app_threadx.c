@@ -93,6 +93,9 @@ UINT App_ThreadX_Init(VOID *memory_ptr)
 			  threads[index].config.timeslice,
 			  threads[index].config.start);
   }
+
+  //Request queue for the storage thread, before any thread can submit to it
+  storage_init();
   /* USER CODE END App_ThreadX_Init */
 
   return ret;
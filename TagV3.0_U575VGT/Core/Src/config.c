@@ -12,6 +12,7 @@
 #include "config.h"
 #include "ctype.h"
 #include "util.h"
+#include <string.h>
 
 /******************
  * PRIVATE MACROS *
@@ -32,6 +33,21 @@ typedef enum {
     CFG_TOK_KEY_AUDIO_DEPTH,
     CFG_TOK_KEY_AUDIO_HEADERS,
     CFG_TOK_KEY_AUDIO_RATE,
+    CFG_TOK_KEY_AUDIO_COMPRESSION,
+    CFG_TOK_KEY_AUDIO_DITHER,
+    CFG_TOK_KEY_AUDIO_CRC,
+    CFG_TOK_KEY_AUDIO_FILE_MINUTES,
+    CFG_TOK_KEY_AUDIO_FILE_MEGABYTES,
+    CFG_TOK_KEY_AUDIO_CLICK_DETECTOR,
+    CFG_TOK_KEY_AUDIO_CLICK_THRESHOLD,
+    CFG_TOK_KEY_AUDIO_TRIGGER,
+    CFG_TOK_KEY_AUDIO_TRIGGER_CLICKS,
+    CFG_TOK_KEY_AUDIO_TRIGGER_PRE_MS,
+    CFG_TOK_KEY_AUDIO_TRIGGER_HOLD_S,
+    CFG_TOK_KEY_AUDIO_LTSA,
+    CFG_TOK_KEY_AUDIO_LTSA_INTERVAL_S,
+    CFG_TOK_KEY_AUDIO_PREVIEW,
+    CFG_TOK_KEY_SD_BENCHMARK,
 }ConfigTokenKey;
 
 /* all possible value keywords */
@@ -42,6 +58,10 @@ typedef enum {
     CFG_TOK_VAL_24_BIT,
     CFG_TOK_VAL_96_KHZ,
     CFG_TOK_VAL_192_KHZ,
+    CFG_TOK_VAL_12_KHZ,
+    CFG_TOK_VAL_24_KHZ,
+    CFG_TOK_VAL_48_KHZ,
+    CFG_TOK_VAL_INTEGER, //not a keyword, the value is in ConfigToken.num
 }ConfigTokenValue;
 
 /*string slice*/
@@ -51,6 +71,7 @@ typedef struct{
 }str;
 
 OPTION_DEFINITION(str);
+OPTION_DEFINITION(uint32_t);
 
 typedef struct file_line_iter_s{
     FX_FILE *file;
@@ -63,6 +84,7 @@ typedef struct file_line_iter_s{
 typedef struct {
     ConfigTokenKey key;
     ConfigTokenValue val;
+    uint32_t num;
 }ConfigToken;
 
 OPTION_DEFINITION(ConfigToken);
@@ -82,6 +104,21 @@ static const str __cfg_tok_key_str[] = {
         [CFG_TOK_KEY_AUDIO_DEPTH]   = REF_STR("audio_depth"),
         [CFG_TOK_KEY_AUDIO_HEADERS] = REF_STR("audio_ch_headers"),
         [CFG_TOK_KEY_AUDIO_RATE]    = REF_STR("audio_sample_rate"),
+        [CFG_TOK_KEY_AUDIO_COMPRESSION] = REF_STR("audio_compression"),
+        [CFG_TOK_KEY_AUDIO_DITHER] = REF_STR("audio_dither"),
+        [CFG_TOK_KEY_AUDIO_CRC] = REF_STR("audio_crc"),
+        [CFG_TOK_KEY_AUDIO_FILE_MINUTES] = REF_STR("audio_file_minutes"),
+        [CFG_TOK_KEY_AUDIO_FILE_MEGABYTES] = REF_STR("audio_file_megabytes"),
+        [CFG_TOK_KEY_AUDIO_CLICK_DETECTOR] = REF_STR("audio_click_detector"),
+        [CFG_TOK_KEY_AUDIO_CLICK_THRESHOLD] = REF_STR("audio_click_threshold"),
+        [CFG_TOK_KEY_AUDIO_TRIGGER] = REF_STR("audio_trigger"),
+        [CFG_TOK_KEY_AUDIO_TRIGGER_CLICKS] = REF_STR("audio_trigger_clicks"),
+        [CFG_TOK_KEY_AUDIO_TRIGGER_PRE_MS] = REF_STR("audio_trigger_pre_ms"),
+        [CFG_TOK_KEY_AUDIO_TRIGGER_HOLD_S] = REF_STR("audio_trigger_hold_s"),
+        [CFG_TOK_KEY_AUDIO_LTSA] = REF_STR("audio_ltsa"),
+        [CFG_TOK_KEY_AUDIO_LTSA_INTERVAL_S] = REF_STR("audio_ltsa_interval_s"),
+        [CFG_TOK_KEY_AUDIO_PREVIEW] = REF_STR("audio_preview"),
+        [CFG_TOK_KEY_SD_BENCHMARK] = REF_STR("sd_benchmark"),
 };
 
 static const str __cfg_tok_val_str[] = {
@@ -91,6 +128,21 @@ static const str __cfg_tok_val_str[] = {
         [CFG_TOK_VAL_24_BIT]    = REF_STR("24_bit"),
         [CFG_TOK_VAL_96_KHZ]    = REF_STR("96_khz"),
         [CFG_TOK_VAL_192_KHZ]   = REF_STR("192_khz"),
+        [CFG_TOK_VAL_12_KHZ]    = REF_STR("12_khz"),
+        [CFG_TOK_VAL_24_KHZ]    = REF_STR("24_khz"),
+        [CFG_TOK_VAL_48_KHZ]    = REF_STR("48_khz"),
+};
+
+/* sample rate settings, their value keywords and rates */
+static const struct {
+    ConfigTokenValue val;
+    uint32_t hz;
+} __cfg_audio_rates[CFG_AUDIO_RATE_COUNT] = {
+        [CFG_AUDIO_RATE_96_KHZ]  = {CFG_TOK_VAL_96_KHZ, 96000},
+        [CFG_AUDIO_RATE_192_KHZ] = {CFG_TOK_VAL_192_KHZ, 192000},
+        [CFG_AUDIO_RATE_12_KHZ]  = {CFG_TOK_VAL_12_KHZ, 12000},
+        [CFG_AUDIO_RATE_24_KHZ]  = {CFG_TOK_VAL_24_KHZ, 24000},
+        [CFG_AUDIO_RATE_48_KHZ]  = {CFG_TOK_VAL_48_KHZ, 48000},
 };
 
 /*********************
@@ -145,6 +197,26 @@ static str __str_slice_identifier(str *in_str){
     return id_str;
 }
 
+/*
+ * tries to read a str as a non-negative decimal integer
+ */
+static Option(uint32_t) __str_parse_uint(str *in_str){
+    uint32_t num = 0;
+
+    //at most 9 digits, so it can't overflow
+    if((in_str->len == 0) || (in_str->len > 9)){
+        return OPTION_NONE(uint32_t);
+    }
+
+    for(size_t i = 0; i < in_str->len; i++){
+        if(!isdigit((unsigned char)in_str->ptr[i])){
+            return OPTION_NONE(uint32_t);
+        }
+        num = (num * 10) + (in_str->ptr[i] - '0');
+    }
+    return OPTION_SOME(uint32_t, num);
+}
+
 //creates a string (char []) from a string slice (str)
 static inline void __str_into_String(str *in_str, char *string){
     memcpy(string, in_str->ptr, in_str->len);
@@ -179,7 +251,7 @@ static Option(str) __fileLineIter_next(FileLineIter *self){
         //read in buffer or less worth of 
 
         if(!self->eof){
-            uint32_t read_in_len;
+            ULONG read_in_len;
             fx_result = fx_file_read(self->file, &self->buffer[self->len], 512 - self->len, &read_in_len);
             self->len += read_in_len;
 
@@ -229,6 +301,7 @@ static Option(ConfigToken) __configToken_tryFrom_str(str *in_str){
     Option(ConfigToken) err_tok = OPTION_NONE(ConfigToken);
     ConfigTokenKey key;
     ConfigTokenValue val;
+    uint32_t num = 0;
 
     __str_splice_whitespace(in_str);
     if(in_str->len == 0) //zero length str
@@ -277,8 +350,14 @@ static Option(ConfigToken) __configToken_tryFrom_str(str *in_str){
             }
         }
     }
-    if(val == (sizeof(__cfg_tok_val_str)/sizeof(__cfg_tok_val_str[0])))
-        return err_tok;
+    if(val == (sizeof(__cfg_tok_val_str)/sizeof(__cfg_tok_val_str[0]))){
+        //not a keyword, see if it is a number
+        Option(uint32_t) maybe_num = __str_parse_uint(&val_str);
+        if(!maybe_num.some)
+            return err_tok;
+        val = CFG_TOK_VAL_INTEGER;
+        num = maybe_num.val;
+    }
 
     //verify val goes to key
     switch(key){
@@ -287,6 +366,14 @@ static Option(ConfigToken) __configToken_tryFrom_str(str *in_str){
         case CFG_TOK_KEY_AUDIO_CH_2: 
         case CFG_TOK_KEY_AUDIO_CH_3:
         case CFG_TOK_KEY_AUDIO_HEADERS:
+        case CFG_TOK_KEY_AUDIO_COMPRESSION:
+        case CFG_TOK_KEY_AUDIO_DITHER:
+        case CFG_TOK_KEY_AUDIO_CLICK_DETECTOR:
+        case CFG_TOK_KEY_AUDIO_TRIGGER:
+        case CFG_TOK_KEY_AUDIO_TRIGGER_CLICKS:
+        case CFG_TOK_KEY_AUDIO_LTSA:
+        case CFG_TOK_KEY_AUDIO_PREVIEW:
+        case CFG_TOK_KEY_SD_BENCHMARK:
             if((val != CFG_TOK_VAL_ENABLED) && (val != CFG_TOK_VAL_DISABLED))
                 return err_tok;
             break;
@@ -297,7 +384,42 @@ static Option(ConfigToken) __configToken_tryFrom_str(str *in_str){
             break;
 
         case CFG_TOK_KEY_AUDIO_RATE: 
-            if((val != CFG_TOK_VAL_96_KHZ) && (val != CFG_TOK_VAL_192_KHZ))
+            if((val < CFG_TOK_VAL_96_KHZ) || (val > CFG_TOK_VAL_48_KHZ))
+                return err_tok;
+            break;
+
+        case CFG_TOK_KEY_AUDIO_CRC:
+            if((val != CFG_TOK_VAL_INTEGER) || ((num != 0) && (num != 4) && (num != 16)))
+                return err_tok;
+            break;
+
+        case CFG_TOK_KEY_AUDIO_FILE_MINUTES:
+            if((val != CFG_TOK_VAL_INTEGER) || (num > CFG_AUDIO_FILE_MINUTES_MAX))
+                return err_tok;
+            break;
+
+        case CFG_TOK_KEY_AUDIO_FILE_MEGABYTES:
+            if((val != CFG_TOK_VAL_INTEGER) || (num > CFG_AUDIO_FILE_MEGABYTES_MAX))
+                return err_tok;
+            break;
+
+        case CFG_TOK_KEY_AUDIO_CLICK_THRESHOLD:
+            if((val != CFG_TOK_VAL_INTEGER) || (num < CFG_AUDIO_CLICK_THRESHOLD_MIN) || (num > CFG_AUDIO_CLICK_THRESHOLD_MAX))
+                return err_tok;
+            break;
+
+        case CFG_TOK_KEY_AUDIO_TRIGGER_PRE_MS:
+            if((val != CFG_TOK_VAL_INTEGER) || (num > CFG_AUDIO_TRIGGER_PRE_MS_MAX))
+                return err_tok;
+            break;
+
+        case CFG_TOK_KEY_AUDIO_TRIGGER_HOLD_S:
+            if((val != CFG_TOK_VAL_INTEGER) || (num < CFG_AUDIO_TRIGGER_HOLD_S_MIN) || (num > CFG_AUDIO_TRIGGER_HOLD_S_MAX))
+                return err_tok;
+            break;
+
+        case CFG_TOK_KEY_AUDIO_LTSA_INTERVAL_S:
+            if((val != CFG_TOK_VAL_INTEGER) || (num < CFG_AUDIO_LTSA_INTERVAL_S_MIN) || (num > CFG_AUDIO_LTSA_INTERVAL_S_MAX))
                 return err_tok;
             break;
 
@@ -310,6 +432,7 @@ static Option(ConfigToken) __configToken_tryFrom_str(str *in_str){
     return OPTION_SOME(ConfigToken, ((ConfigToken){
         .key = key,
         .val = val,
+        .num = num,
     }));
 }
 
@@ -347,9 +470,29 @@ void TagConfig_default(TagConfig *cfg){
         .audio_ch_headers = true,
         .audio_rate = CFG_AUDIO_RATE_96_KHZ,
         .audio_depth = CFG_AUDIO_DEPTH_24_BIT,
+        .audio_compression = false,
+        .audio_dither = false,
+        .audio_crc = 0,
+        .audio_file_minutes = 60,
+        .audio_file_megabytes = 0,
+        .audio_click_detector = false,
+        .audio_click_threshold = 12,
+        .audio_trigger = false,
+        .audio_trigger_clicks = true,
+        .audio_trigger_pre_ms = 200,
+        .audio_trigger_hold_s = 30,
+        .audio_ltsa = false,
+        .audio_ltsa_interval_s = 10,
+        .audio_preview = false,
+        .sd_benchmark = false,
     };
 }
 
+/* Sample rate setting in Hz */
+uint32_t TagConfig_audio_rate_hz(TagConfigAudioSampleRate audio_rate){
+    return (audio_rate < CFG_AUDIO_RATE_COUNT) ? __cfg_audio_rates[audio_rate].hz : 0;
+}
+
 /* Read tag configuration from file */
 void TagConfig_read(TagConfig *cfg, FX_FILE *cfg_file){
     //initialize struct
@@ -403,19 +546,72 @@ void TagConfig_read(TagConfig *cfg, FX_FILE *cfg_file){
                 cfg->audio_ch_headers = (tok.val ==CFG_TOK_VAL_ENABLED);
                 break;
 
-            case CFG_TOK_KEY_AUDIO_RATE:
-                switch(tok.val){
-                    case CFG_TOK_VAL_96_KHZ:
-                        cfg->audio_depth = CFG_AUDIO_RATE_96_KHZ;
-                        break;
+            case CFG_TOK_KEY_AUDIO_COMPRESSION:
+                cfg->audio_compression = (tok.val == CFG_TOK_VAL_ENABLED);
+                break;
 
-                    case CFG_TOK_VAL_192_KHZ:
-                        cfg->audio_depth = CFG_AUDIO_RATE_192_KHZ;
-                        break;
+            case CFG_TOK_KEY_AUDIO_DITHER:
+                cfg->audio_dither = (tok.val == CFG_TOK_VAL_ENABLED);
+                break;
 
-                    default:
-                        /* invalid audio depth value*/
+            case CFG_TOK_KEY_AUDIO_CRC:
+                cfg->audio_crc = tok.num;
+                break;
+
+            case CFG_TOK_KEY_AUDIO_FILE_MINUTES:
+                cfg->audio_file_minutes = tok.num;
+                break;
+
+            case CFG_TOK_KEY_AUDIO_FILE_MEGABYTES:
+                cfg->audio_file_megabytes = tok.num;
+                break;
+
+            case CFG_TOK_KEY_AUDIO_CLICK_DETECTOR:
+                cfg->audio_click_detector = (tok.val == CFG_TOK_VAL_ENABLED);
+                break;
+
+            case CFG_TOK_KEY_AUDIO_CLICK_THRESHOLD:
+                cfg->audio_click_threshold = tok.num;
+                break;
+
+            case CFG_TOK_KEY_AUDIO_TRIGGER:
+                cfg->audio_trigger = (tok.val == CFG_TOK_VAL_ENABLED);
+                break;
+
+            case CFG_TOK_KEY_AUDIO_TRIGGER_CLICKS:
+                cfg->audio_trigger_clicks = (tok.val == CFG_TOK_VAL_ENABLED);
+                break;
+
+            case CFG_TOK_KEY_AUDIO_TRIGGER_PRE_MS:
+                cfg->audio_trigger_pre_ms = tok.num;
+                break;
+
+            case CFG_TOK_KEY_AUDIO_TRIGGER_HOLD_S:
+                cfg->audio_trigger_hold_s = tok.num;
+                break;
+
+            case CFG_TOK_KEY_AUDIO_LTSA:
+                cfg->audio_ltsa = (tok.val == CFG_TOK_VAL_ENABLED);
+                break;
+
+            case CFG_TOK_KEY_AUDIO_LTSA_INTERVAL_S:
+                cfg->audio_ltsa_interval_s = tok.num;
+                break;
+
+            case CFG_TOK_KEY_AUDIO_PREVIEW:
+                cfg->audio_preview = (tok.val == CFG_TOK_VAL_ENABLED);
+                break;
+
+            case CFG_TOK_KEY_SD_BENCHMARK:
+                cfg->sd_benchmark = (tok.val == CFG_TOK_VAL_ENABLED);
+                break;
+
+            case CFG_TOK_KEY_AUDIO_RATE:
+                for(size_t i = 0; i < CFG_AUDIO_RATE_COUNT; i++){
+                    if(__cfg_audio_rates[i].val == tok.val){
+                        cfg->audio_rate = (TagConfigAudioSampleRate)i;
                         break;
+                    }
                 }
                 break;
                  
@@ -464,10 +660,9 @@ uint32_t TagConfig_write(TagConfig *cfg, FX_FILE *cfg_file){
     /* audio_sample_rate */
     fx_file_write(cfg_file, __cfg_tok_val_str[CFG_TOK_KEY_AUDIO_RATE].ptr, sizeof(__cfg_tok_val_str[CFG_TOK_KEY_AUDIO_RATE].len));
     fx_file_write(cfg_file, " : ", 3);
-    if(cfg->audio_rate == CFG_AUDIO_RATE_96_KHZ){
-        fx_file_write(cfg_file, __cfg_tok_val_str[CFG_TOK_VAL_96_KHZ].ptr, sizeof(__cfg_tok_val_str[CFG_TOK_VAL_96_KHZ].len));
-    } else if(cfg->audio_rate == CFG_AUDIO_RATE_192_KHZ){
-        fx_file_write(cfg_file, __cfg_tok_val_str[CFG_TOK_VAL_192_KHZ].ptr, sizeof(__cfg_tok_val_str[CFG_TOK_VAL_192_KHZ].len));
+    if(cfg->audio_rate < CFG_AUDIO_RATE_COUNT){
+        ConfigTokenValue rate_val = __cfg_audio_rates[cfg->audio_rate].val;
+        fx_file_write(cfg_file, __cfg_tok_val_str[rate_val].ptr, sizeof(__cfg_tok_val_str[rate_val].len));
     }
     fx_file_write(cfg_file, "\r\n", 2);
     return FX_SUCCESS;
@@ -29,6 +29,7 @@
 #include "ad7768.h"
 #include "audio.h"
 #include "app_filex.h"
+#include "Lib Inc/timing.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -174,6 +175,9 @@ int main(void)
 
   HAL_NVIC_DisableIRQ(EXTI12_IRQn);
   HAL_NVIC_DisableIRQ(EXTI14_IRQn);
+
+  //The SD benchmark and the audio write stats time with the cycle counter, the benchmark runs as soon as FileX starts
+  cycle_counter_init();
   /* USER CODE END 2 */
 
   MX_ThreadX_Init();
@@ -1076,33 +1080,6 @@ void MX_TIM2_Fake_Init(uint8_t newPeriod){
 	Error_Handler();
   }
 }
-
-//Fake SD card initialization function so we can change the clock divison during runtime
-void MX_SDMMC1_SD_Fake_Init(uint8_t newClockDiv)
-{
-
-  /* USER CODE BEGIN SDMMC1_Init 0 */
-
-  /* USER CODE END SDMMC1_Init 0 */
-
-  /* USER CODE BEGIN SDMMC1_Init 1 */
-
-  /* USER CODE END SDMMC1_Init 1 */
-  hsd1.Instance = SDMMC1;
-  hsd1.Init.ClockEdge = SDMMC_CLOCK_EDGE_RISING;
-  hsd1.Init.ClockPowerSave = SDMMC_CLOCK_POWER_SAVE_DISABLE;
-  hsd1.Init.BusWide = SDMMC_BUS_WIDE_4B;
-  hsd1.Init.HardwareFlowControl = SDMMC_HARDWARE_FLOW_CONTROL_DISABLE;
-  hsd1.Init.ClockDiv = newClockDiv;
-  if (HAL_SD_Init(&hsd1) != HAL_OK)
-  {
-    Error_Handler();
-  }
-  /* USER CODE BEGIN SDMMC1_Init 2 */
-
-  /* USER CODE END SDMMC1_Init 2 */
-
-}
 /* USER CODE END 4 */
 
 /**
@@ -72,7 +72,6 @@ extern TIM_HandleTypeDef htim6;
 
 /* USER CODE BEGIN EV */
 extern DAC_HandleTypeDef hdac1;
-extern uint8_t counter;
 /* USER CODE END EV */
 
 /******************************************************************************/
@@ -25,6 +25,9 @@
 /* USER CODE BEGIN Includes */
 #include "tx_api.h"
 #include "Lib Inc/threads.h"
+#include "Lib Inc/sd_bus.h"
+#include "Lib Inc/sd_bench.h"
+#include "Sensor Inc/audio.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -51,13 +54,14 @@
 TX_THREAD       fx_app_thread;
 
 /* Buffer for FileX FX_MEDIA sector cache. */
-ALIGN_32BYTES (uint32_t fx_sd_media_memory[FX_STM32_SD_DEFAULT_SECTOR_SIZE / sizeof(uint32_t)]);
+ALIGN_32BYTES (uint32_t fx_sd_media_memory[FX_SD_MEDIA_CACHE_SIZE / sizeof(uint32_t)]);
 /* Define FileX global data structures.  */
 FX_MEDIA        sdio_disk;
 
 /* USER CODE BEGIN PV */
 extern SD_HandleTypeDef hsd1;
 extern Thread_HandleTypeDef threads[NUM_THREADS];
+extern AudioManager audio;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -147,6 +151,11 @@ UINT MX_FileX_Init(VOID *memory_ptr)
   }
 
 /* USER CODE BEGIN fx_app_thread_entry 1*/
+  //Bus speed for this card, before anything else starts using it
+  sd_bus_init(&sdio_disk);
+
+  //Benchmark the card if config.txt asks for it, while nothing else is using it. The audio DMA buffer is free to borrow until recording starts.
+  sd_bench_boot(&sdio_disk, (uint8_t *)audio.temp_buffer, sizeof(audio.temp_buffer));
   tx_thread_resume(&threads[STATE_MACHINE_THREAD].thread);
 /* USER CODE END fx_app_thread_entry 1*/
   }
@@ -41,7 +41,14 @@ extern "C" {
 
 /* Exported constants --------------------------------------------------------*/
 /* USER CODE BEGIN EC */
-
+/* Sectors in the FileX media cache. FAT & directory sectors stay cached between writes instead of evicting each other,
+   has to be a power of two (hashed cache from FX_SECTOR_CACHE_HASH_ENABLE sectors up). */
+#define FX_SD_MEDIA_CACHE_SECTORS            16
+#define FX_SD_MEDIA_CACHE_SIZE               ((FX_SD_MEDIA_CACHE_SECTORS) * (FX_STM32_SD_DEFAULT_SECTOR_SIZE))
+
+/* Buffers handed to the SD driver on this alignment (a whole cache line) and a whole number of sectors long go straight
+   to the SDMMC DMA, anything else is copied through the driver's one sector scratch buffer. */
+#define FX_SD_BUFFER_ALIGN                   32
 /* USER CODE END EC */
 
 /* Exported macro ------------------------------------------------------------*/
@@ -24,8 +24,10 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include <stdbool.h>
+#include <string.h>
 #include "main.h"
 #include "stm32u5xx_hal_sd.h"
+#include "app_filex.h"
 #include "fx_stm32_sd_driver.h"
 #include "Lib Inc/state_machine.h"
 /* USER CODE END Includes */
@@ -42,6 +44,20 @@
 #define SD_CARD_TIMEOUT 10000
 #define MEDIA_INSERTED  0;
 #define MEDIA_REMOVED  1;
+
+//The SDMMC DMA needs word aligned buffers, anything else is copied through msc_sd_scratch a block at a time
+#define MSC_SD_DMA_ALIGN 4
+
+//Sequential reads are served from a cache of this many blocks, filled by one multi-block read
+#define MSC_READ_CACHE_BLOCKS 16
+
+//The read cache: a run of blocks read from the card
+typedef struct {
+	ULONG lba;          //first block held
+	ULONG blocks;       //blocks held, 0 = empty
+	ULONG fx_writes;    //FileX's write count when it was read, anything FileX has written since may have made it stale
+	ALIGN_32BYTES (UCHAR data[MSC_READ_CACHE_BLOCKS * STORAGE_BLK_SIZE]);
+} MscReadCache;
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -54,12 +70,19 @@
 bool inserted = false;
 extern SD_HandleTypeDef hsd1;
 extern TX_EVENT_FLAGS_GROUP state_machine_event_flags_group;
+extern FX_MEDIA sdio_disk;
+static ALIGN_32BYTES (UCHAR msc_sd_scratch[STORAGE_BLK_SIZE]);
+static MscReadCache msc_read_cache;
+static ULONG msc_read_next_lba = 0;    //block after the last read, a read starting here is sequential
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN PFP */
 UINT media_status_callback();
 static int32_t check_sd_status();
+static UINT msc_sd_transfer(UCHAR *data_pointer, ULONG number_blocks, ULONG lba, bool write);
+static void msc_read_cache_invalidate(ULONG lba, ULONG number_blocks);
+static UINT msc_read(UCHAR *data_pointer, ULONG number_blocks, ULONG lba);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -130,9 +153,7 @@ UINT USBD_STORAGE_Read(VOID *storage_instance, ULONG lun, UCHAR *data_pointer,
   //UX_PARAMETER_NOT_USED(lba);
   //UX_PARAMETER_NOT_USED(media_status);
 
-  __disable_irq();
-  HAL_SD_ReadBlocks(&hsd1, data_pointer, lba, number_blocks, HAL_MAX_DELAY);
-  __enable_irq();
+  status = msc_read(data_pointer, number_blocks, lba);
 
   /* USER CODE END USBD_STORAGE_Read */
 
@@ -165,9 +186,9 @@ UINT USBD_STORAGE_Write(VOID *storage_instance, ULONG lun, UCHAR *data_pointer,
   //UX_PARAMETER_NOT_USED(lba);
   //UX_PARAMETER_NOT_USED(media_status);
 
-  __disable_irq();
-    HAL_SD_WriteBlocks(&hsd1, data_pointer, lba, number_blocks, HAL_MAX_DELAY);
-  __enable_irq();
+  //Nothing cached may go stale
+  msc_read_cache_invalidate(lba, number_blocks);
+  status = msc_sd_transfer(data_pointer, number_blocks, lba, true);
   /* USER CODE END USBD_STORAGE_Write */
 
   return status;
@@ -290,6 +311,162 @@ ULONG USBD_STORAGE_GetMediaBlocklength(VOID)
 }
 
 /* USER CODE BEGIN 1 */
+
+/*
+ * Desc: wait for the card to finish its last transfer (or programming) and take a new command
+ */
+static UINT msc_sd_wait_ready(void){
+	ULONG start = tx_time_get();
+
+	while (HAL_SD_GetCardState(&hsd1) != HAL_SD_CARD_TRANSFER){
+		if ((tx_time_get() - start) >= FX_STM32_SD_DEFAULT_TIMEOUT){
+			return UX_ERROR;
+		}
+		tx_thread_sleep(1);
+	}
+	return UX_SUCCESS;
+}
+
+/*
+ * Desc: one DMA transfer, the calling (USBX storage) thread sleeps on the FileX driver's completion semaphores until it's done
+ */
+static UINT msc_sd_dma(UCHAR *buffer, ULONG number_blocks, ULONG lba, bool write){
+	HAL_StatusTypeDef hal_result;
+
+	if (msc_sd_wait_ready() != UX_SUCCESS){
+		return UX_ERROR;
+	}
+	hal_result = write ? HAL_SD_WriteBlocks_DMA(&hsd1, buffer, lba, number_blocks)
+	                   : HAL_SD_ReadBlocks_DMA(&hsd1, buffer, lba, number_blocks);
+	if (hal_result != HAL_OK){
+		return UX_ERROR;
+	}
+	//A transfer that doesn't finish is aborted, or hsd1 stays busy and every later transfer fails
+	if (tx_semaphore_get(write ? &sd_tx_semaphore : &sd_rx_semaphore, FX_STM32_SD_DEFAULT_TIMEOUT) != TX_SUCCESS){
+		HAL_SD_Abort(&hsd1);
+		return UX_ERROR;
+	}
+	return UX_SUCCESS;
+}
+
+/*
+ * Desc: move blocks between the card and a USB buffer without masking interrupts.
+ *       While the FileX media is open, transfers go by DMA and hold the media's protection mutex so they never overlap a FileX
+ *       access. Without it (e.g. a card that doesn't mount, for the host to format) the driver's semaphores don't exist, and
+ *       transfers are polled instead, with interrupts masked as before so the SDMMC FIFO can't overrun or underrun.
+ */
+static UINT msc_sd_transfer(UCHAR *data_pointer, ULONG number_blocks, ULONG lba, bool write){
+	UINT status = UX_SUCCESS;
+
+	if (sdio_disk.fx_media_id != FX_MEDIA_ID){
+		if (msc_sd_wait_ready() != UX_SUCCESS){
+			return UX_ERROR;
+		}
+		//The HAL tick stops while masked, a stuck card still ends the transfer through the SDMMC's own data timeout
+		__disable_irq();
+		HAL_StatusTypeDef hal_result = write ? HAL_SD_WriteBlocks(&hsd1, data_pointer, lba, number_blocks, SD_CARD_TIMEOUT)
+		                                     : HAL_SD_ReadBlocks(&hsd1, data_pointer, lba, number_blocks, SD_CARD_TIMEOUT);
+		__enable_irq();
+		return (hal_result == HAL_OK) ? UX_SUCCESS : UX_ERROR;
+	}
+
+	tx_mutex_get(&sdio_disk.fx_media_protect, TX_WAIT_FOREVER);
+	if (((ULONG)data_pointer & (MSC_SD_DMA_ALIGN - 1)) == 0){
+		status = msc_sd_dma(data_pointer, number_blocks, lba, write);
+	}
+	else{
+		for (ULONG block = 0; (block < number_blocks) && (status == UX_SUCCESS); block++){
+			UCHAR *user = &data_pointer[block * STORAGE_BLK_SIZE];
+			if (write){
+				memcpy(msc_sd_scratch, user, STORAGE_BLK_SIZE);
+			}
+			status = msc_sd_dma(msc_sd_scratch, 1, lba + block, write);
+			if (!write && (status == UX_SUCCESS)){
+				memcpy(user, msc_sd_scratch, STORAGE_BLK_SIZE);
+			}
+		}
+	}
+	tx_mutex_put(&sdio_disk.fx_media_protect);
+	return status;
+}
+
+/*
+ * Desc: read the run of blocks from lba on into the read cache. The caller holds the media protection.
+ */
+static UINT msc_read_cache_fill(ULONG lba){
+	ULONG remaining = USBD_STORAGE_GetMediaLastLba() - lba + 1;
+	UINT status;
+
+	msc_read_cache.lba = lba;
+	msc_read_cache.blocks = (remaining < MSC_READ_CACHE_BLOCKS) ? remaining : MSC_READ_CACHE_BLOCKS;
+	msc_read_cache.fx_writes = sdio_disk.fx_media_driver_write_requests;
+	status = msc_sd_dma(msc_read_cache.data, msc_read_cache.blocks, lba, false);
+	if (status != UX_SUCCESS){
+		msc_read_cache.blocks = 0;
+	}
+	return status;
+}
+
+/*
+ * Desc: drop the read cache if it overlaps a run of blocks
+ */
+static void msc_read_cache_invalidate(ULONG lba, ULONG number_blocks){
+	if ((msc_read_cache.blocks != 0) && (msc_read_cache.lba < (lba + number_blocks)) && (lba < (msc_read_cache.lba + msc_read_cache.blocks))){
+		msc_read_cache.blocks = 0;
+	}
+}
+
+/*
+ * Desc: true if the read cache holds a block (and isn't stale)
+ */
+static bool msc_read_cache_holds(ULONG lba){
+	if ((msc_read_cache.blocks != 0) && (msc_read_cache.fx_writes != sdio_disk.fx_media_driver_write_requests)){
+		msc_read_cache.blocks = 0;
+	}
+	return (msc_read_cache.blocks != 0) && (lba >= msc_read_cache.lba) && (lba < (msc_read_cache.lba + msc_read_cache.blocks));
+}
+
+/*
+ * Desc: read blocks for the host. Reads continuing where the last one ended are served from the read cache: a block that isn't in
+ *       it has the whole run from it read in one multi-block transfer, so the single block requests USBX makes turn into one card
+ *       command per MSC_READ_CACHE_BLOCKS. The card and USB don't overlap, the gain is the commands saved.
+ *       Anything else (FAT & directory lookups, or a card that isn't mounted) goes straight to the card, and so does a request of a
+ *       whole run or more, which is one multi-block transfer already.
+ *       The media protection is only held for the length of the request.
+ */
+static UINT msc_read(UCHAR *data_pointer, ULONG number_blocks, ULONG lba){
+	bool sequential = (lba == msc_read_next_lba);
+	UINT status = UX_SUCCESS;
+
+	msc_read_next_lba = lba + number_blocks;
+	if (!sequential || (number_blocks >= MSC_READ_CACHE_BLOCKS) || (sdio_disk.fx_media_id != FX_MEDIA_ID)){
+		return msc_sd_transfer(data_pointer, number_blocks, lba, false);
+	}
+
+	tx_mutex_get(&sdio_disk.fx_media_protect, TX_WAIT_FOREVER);
+	while ((number_blocks > 0) && (status == UX_SUCCESS)){
+		//Not cached (the first read of a run, or past the end of the last one), read the run from here
+		if (!msc_read_cache_holds(lba)){
+			status = msc_read_cache_fill(lba);
+			if (status != UX_SUCCESS){
+				break;
+			}
+		}
+
+		ULONG offset = lba - msc_read_cache.lba;
+		ULONG count = msc_read_cache.blocks - offset;
+		if (count > number_blocks){
+			count = number_blocks;
+		}
+		memcpy(data_pointer, &msc_read_cache.data[offset * STORAGE_BLK_SIZE], count * STORAGE_BLK_SIZE);
+		data_pointer += count * STORAGE_BLK_SIZE;
+		lba += count;
+		number_blocks -= count;
+	}
+	tx_mutex_put(&sdio_disk.fx_media_protect);
+	return status;
+}
+
 UINT media_status_callback(void){
 	if (inserted) {
 		return MEDIA_INSERTED;
@@ -0,0 +1,31 @@
+/*
+ * cmsis_compiler.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Host stand-in for the CMSIS intrinsics the firmware's DSP extension paths use, so those paths can be built and
+ *    checked against their plain C versions on a host. Only on the include path of objects built with
+ *    __ARM_FEATURE_DSP=1 (see the Makefile). Each one follows the Armv8-M ARM's pseudocode for the instruction.
+ */
+
+#ifndef HOST_ARM_CMSIS_COMPILER_H_
+#define HOST_ARM_CMSIS_COMPILER_H_
+
+#include <stdint.h>
+
+/* QADD: signed saturating add */
+static inline int32_t __QADD(int32_t op1, int32_t op2){
+    int64_t sum = (int64_t)op1 + op2;
+    return (sum > INT32_MAX) ? INT32_MAX : ((sum < INT32_MIN) ? INT32_MIN : (int32_t)sum);
+}
+
+/* PKHBT: bottom halfword of op1, top halfword of op2 shifted left */
+#define __PKHBT(op1, op2, shift) ((uint32_t)(((uint32_t)(op1) & 0x0000FFFFUL) | (((uint32_t)(op2) << (shift)) & 0xFFFF0000UL)))
+
+/* REV16: reverse the bytes of each halfword */
+static inline uint32_t __REV16(uint32_t value){
+    return ((value & 0x00FF00FFUL) << 8) | ((value & 0xFF00FF00UL) >> 8);
+}
+
+#endif /* HOST_ARM_CMSIS_COMPILER_H_ */
@@ -0,0 +1,289 @@
+/*
+ * audio_file_test.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Test of the audio file container (Lib Src/audio_file.c): headers are packed and read back field for field, then
+ *    a file of records of every kind (raw, compressed sized, padding) is walked with the reader. The file is then
+ *    damaged the ways a card can damage it, a corrupt header, a corrupt magic, a payload that happens to hold the
+ *    magic, a wrong version and a last record cut short, and the reader has to report it and resync to the next
+ *    intact record without skipping one.
+ *
+ *    usage: audio_file_test
+ */
+
+#include "bench.h"
+#include "Lib Inc/audio_file.h"
+#include <string.h>
+
+#define TEST_RECORDS 8
+#define TEST_MAX_PAYLOAD 4096
+
+static uint8_t file_data[TEST_RECORDS * (AUDIO_FILE_HEADER_SIZE + TEST_MAX_PAYLOAD)];
+static size_t record_offsets[TEST_RECORDS];
+static AudioFileHeader record_headers[TEST_RECORDS];
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/* a header with every field set to something that differs from its neighbours */
+static void __header(AudioFileHeader *header, uint32_t record, uint16_t block_count, uint32_t block_len, uint8_t flags){
+    *header = (AudioFileHeader){
+        .block_size = 32256,
+        .sample_rate = 96000,
+        .channel_mask = 0x0B,
+        .sample_bytes = 3,
+        .header_bytes = 1,
+        .flags = flags,
+        .dropped_blocks = record * 3,
+        .rtc_tick = 0x01020304 + record,
+        .rtc_year = 26,
+        .rtc_month = 10,
+        .rtc_day = 17,
+        .rtc_hours = 12,
+        .rtc_minutes = 34,
+        .rtc_seconds = (uint8_t)record,
+        .tick_rate = 20000,
+        .block_count = block_count,
+    };
+    for(uint16_t i = 0; i < block_count; i++){
+        header->blocks[i] = (AudioFileBlockEntry){
+            .sequence = record * 100 + i,
+            .tick = 5000 * record + i,
+            .length = block_len + i,
+            .crc_errors = i,
+        };
+        header->payload_len += block_len + i;
+    }
+}
+
+static bool __headers_equal(const AudioFileHeader *a, const AudioFileHeader *b){
+    if((a->payload_len != b->payload_len) || (a->block_size != b->block_size) || (a->sample_rate != b->sample_rate)
+            || (a->channel_mask != b->channel_mask) || (a->sample_bytes != b->sample_bytes)
+            || (a->header_bytes != b->header_bytes) || (a->flags != b->flags) || (a->dropped_blocks != b->dropped_blocks)
+            || (a->rtc_tick != b->rtc_tick) || (a->rtc_year != b->rtc_year) || (a->rtc_month != b->rtc_month)
+            || (a->rtc_day != b->rtc_day) || (a->rtc_hours != b->rtc_hours) || (a->rtc_minutes != b->rtc_minutes)
+            || (a->rtc_seconds != b->rtc_seconds) || (a->tick_rate != b->tick_rate) || (a->block_count != b->block_count)){
+        return false;
+    }
+    for(uint16_t i = 0; i < a->block_count; i++){
+        if((a->blocks[i].sequence != b->blocks[i].sequence) || (a->blocks[i].tick != b->blocks[i].tick)
+                || (a->blocks[i].length != b->blocks[i].length) || (a->blocks[i].crc_errors != b->blocks[i].crc_errors)){
+            return false;
+        }
+    }
+    return true;
+}
+
+/* build the test file: raw records, compressed ones with odd block lengths and a padding record. Returns its length */
+static size_t __build_file(void){
+    size_t len = 0;
+
+    for(uint32_t record = 0; record < TEST_RECORDS; record++){
+        AudioFileHeader *header = &record_headers[record];
+
+        if(record == 0){
+            __header(header, record, 0, 0, AUDIO_FILE_FLAG_PADDING);
+            header->payload_len = 1024;
+        }
+        else if(record & 1){
+            __header(header, record, 3, 333, AUDIO_FILE_FLAG_COMPRESSED | AUDIO_FILE_FLAG_ADC_CRC);
+        }
+        else{
+            __header(header, record, (uint16_t)record, 256, 0);
+        }
+
+        record_offsets[record] = len;
+        audio_file_header_pack(header, &file_data[len]);
+        len += AUDIO_FILE_HEADER_SIZE;
+        for(uint32_t i = 0; i < header->payload_len; i++){
+            file_data[len + i] = (uint8_t)rand();
+        }
+        len += header->payload_len;
+    }
+    return len;
+}
+
+/* walk a file, resyncing past every bad record. Returns the number of records read, their indices go in found */
+static uint32_t __walk(size_t len, uint32_t *found, uint32_t *errors){
+    AudioFileReader reader;
+    AudioFileHeader header;
+    const uint8_t *payload;
+    AudioFileStatus status;
+    uint32_t count = 0;
+
+    *errors = 0;
+    audio_file_reader_init(&reader, file_data, len);
+    while((status = audio_file_reader_next(&reader, &header, &payload)) != AUDIO_FILE_END){
+        if(status != AUDIO_FILE_OK){
+            (*errors)++;
+            if(!audio_file_reader_resync(&reader)){
+                break;
+            }
+            continue;
+        }
+        for(uint32_t record = 0; record < TEST_RECORDS; record++){
+            if(payload == &file_data[record_offsets[record] + AUDIO_FILE_HEADER_SIZE]){
+                BENCH_CHECK(__headers_equal(&header, &record_headers[record]));
+                found[count++] = record;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+static void __test_crc(void){
+    //the CRC-32 check value, and a chained CRC has to match a CRC over the whole span
+    BENCH_CHECK(audio_file_crc32(0, (const uint8_t *)"123456789", 9) == 0xCBF43926);
+    BENCH_CHECK(audio_file_crc32(audio_file_crc32(0, (const uint8_t *)"1234", 4), (const uint8_t *)"56789", 5) == 0xCBF43926);
+    BENCH_CHECK(audio_file_crc32(0, NULL, 0) == 0);
+}
+
+static void __test_header(void){
+    uint8_t sector[AUDIO_FILE_HEADER_SIZE];
+    AudioFileHeader header;
+    AudioFileHeader unpacked;
+
+    //a full header, with the largest length a block entry holds
+    __header(&header, 7, AUDIO_FILE_MAX_BLOCKS, UINT16_MAX - AUDIO_FILE_MAX_BLOCKS, AUDIO_FILE_FLAG_TRIGGERED | AUDIO_FILE_FLAG_DITHERED);
+    audio_file_header_pack(&header, sector);
+    BENCH_CHECK(audio_file_header_unpack(sector, sizeof(sector), &unpacked) == AUDIO_FILE_OK);
+    BENCH_CHECK(__headers_equal(&header, &unpacked));
+    BENCH_CHECK(audio_file_header_unpack(sector, sizeof(sector) - 1, &unpacked) == AUDIO_FILE_TRUNCATED);
+
+    //any flipped bit is caught, in the magic first
+    for(size_t bit = 0; bit < (AUDIO_FILE_HEADER_SIZE * 8); bit += 7){
+        sector[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+        AudioFileStatus status = audio_file_header_unpack(sector, sizeof(sector), &unpacked);
+        BENCH_CHECK(status == ((bit < 32) ? AUDIO_FILE_BAD_MAGIC : AUDIO_FILE_BAD_CRC));
+        sector[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+    }
+
+    //fields that are out of range with a good CRC
+    __header(&header, 1, 2, 100, 0);
+    header.payload_len += 1;
+    audio_file_header_pack(&header, sector);
+    BENCH_CHECK(audio_file_header_unpack(sector, sizeof(sector), &unpacked) == AUDIO_FILE_BAD_HEADER);
+
+    //the block count is only caught by the reader, the packer never writes more than the entries hold
+    __header(&header, 1, 2, 100, 0);
+    audio_file_header_pack(&header, sector);
+    sector[40] = AUDIO_FILE_MAX_BLOCKS + 1;
+    uint32_t crc = audio_file_crc32(0, sector, AUDIO_FILE_HEADER_SIZE - 4);
+    memcpy(&sector[AUDIO_FILE_HEADER_SIZE - 4], &crc, sizeof(crc));
+    BENCH_CHECK(audio_file_header_unpack(sector, sizeof(sector), &unpacked) == AUDIO_FILE_BAD_HEADER);
+
+    //any other version is refused
+    audio_file_header_pack(&header, sector);
+    sector[4] = AUDIO_FILE_VERSION + 1;
+    crc = audio_file_crc32(0, sector, AUDIO_FILE_HEADER_SIZE - 4);
+    memcpy(&sector[AUDIO_FILE_HEADER_SIZE - 4], &crc, sizeof(crc));
+    BENCH_CHECK(audio_file_header_unpack(sector, sizeof(sector), &unpacked) == AUDIO_FILE_BAD_VERSION);
+}
+
+static void __test_clean(void){
+    uint32_t found[TEST_RECORDS];
+    uint32_t errors;
+    size_t len = __build_file();
+
+    BENCH_CHECK(__walk(len, found, &errors) == TEST_RECORDS);
+    BENCH_CHECK(errors == 0);
+    for(uint32_t i = 0; i < TEST_RECORDS; i++){
+        BENCH_CHECK(found[i] == i);
+    }
+
+    //an empty file is just the end
+    AudioFileReader reader;
+    AudioFileHeader header;
+    const uint8_t *payload;
+    audio_file_reader_init(&reader, file_data, 0);
+    BENCH_CHECK(audio_file_reader_next(&reader, &header, &payload) == AUDIO_FILE_END);
+}
+
+/* a corrupt header is reported, the reader stays put, and resync lands on the next record */
+static void __test_corrupt(void){
+    uint32_t found[TEST_RECORDS];
+    uint32_t errors;
+    size_t len = __build_file();
+    AudioFileReader reader;
+    AudioFileHeader header;
+    const uint8_t *payload;
+
+    file_data[record_offsets[3] + 100] ^= 0x40;
+    audio_file_reader_init(&reader, file_data, len);
+    for(uint32_t i = 0; i < 3; i++){
+        BENCH_CHECK(audio_file_reader_next(&reader, &header, &payload) == AUDIO_FILE_OK);
+    }
+    BENCH_CHECK(audio_file_reader_next(&reader, &header, &payload) == AUDIO_FILE_BAD_CRC);
+    BENCH_CHECK(reader.offset == record_offsets[3]);
+    BENCH_CHECK(audio_file_reader_resync(&reader));
+    BENCH_CHECK(reader.offset == record_offsets[4]);
+
+    BENCH_CHECK(__walk(len, found, &errors) == TEST_RECORDS - 1);
+    BENCH_CHECK(errors == 1);
+    BENCH_CHECK(found[3] == 4);
+
+    //a corrupt magic, and a payload (a compressed one isn't sector aligned) holding a copy of the magic
+    len = __build_file();
+    file_data[record_offsets[5]] ^= 0x01;
+    memcpy(&file_data[record_offsets[5] + AUDIO_FILE_HEADER_SIZE + 17], &file_data[record_offsets[4]], 4);
+    BENCH_CHECK(__walk(len, found, &errors) == TEST_RECORDS - 1);
+    BENCH_CHECK(errors == 1);
+    BENCH_CHECK(found[5] == 6);
+
+    //headers wiped to a zeroed and an erased sector
+    len = __build_file();
+    memset(&file_data[record_offsets[2]], 0, AUDIO_FILE_HEADER_SIZE);
+    memset(&file_data[record_offsets[6]], 0xFF, AUDIO_FILE_HEADER_SIZE);
+    BENCH_CHECK(__walk(len, found, &errors) == TEST_RECORDS - 2);
+    BENCH_CHECK(errors == 2);
+    BENCH_CHECK((found[1] == 1) && (found[2] == 3) && (found[5] == 7));
+}
+
+/* a file cut short (the tag lost power mid write) still gives every whole record before the cut */
+static void __test_truncated(void){
+    uint32_t found[TEST_RECORDS];
+    uint32_t errors;
+    size_t len = __build_file();
+    size_t last = record_offsets[TEST_RECORDS - 1];
+    AudioFileReader reader;
+    AudioFileHeader header;
+    const uint8_t *payload;
+
+    //cut in the payload, in the header, and right after the header
+    size_t cuts[] = {len - 1, last + AUDIO_FILE_HEADER_SIZE + 1, last + 100, last + AUDIO_FILE_HEADER_SIZE};
+    for(size_t i = 0; i < (sizeof(cuts) / sizeof(cuts[0])); i++){
+        BENCH_CHECK(__walk(cuts[i], found, &errors) == TEST_RECORDS - 1);
+        BENCH_CHECK(errors == 1);
+
+        audio_file_reader_init(&reader, file_data, cuts[i]);
+        reader.offset = last;
+        BENCH_CHECK(audio_file_reader_next(&reader, &header, &payload) == AUDIO_FILE_TRUNCATED);
+        BENCH_CHECK(reader.offset == last);
+        BENCH_CHECK(!audio_file_reader_resync(&reader));
+        BENCH_CHECK(audio_file_reader_next(&reader, &header, &payload) == AUDIO_FILE_END);
+    }
+
+    //cut exactly on a record boundary is a clean end
+    BENCH_CHECK(__walk(last, found, &errors) == TEST_RECORDS - 1);
+    BENCH_CHECK(errors == 0);
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+int main(int argc, char **argv){
+    srand(1);
+    __test_crc();
+    __test_header();
+    __test_clean();
+    __test_corrupt();
+    __test_truncated();
+
+    printf("audio_file_test: %s (%u failed checks)\n", bench_failures ? "FAIL" : "ok", bench_failures);
+    return bench_failures ? 1 : 0;
+}
@@ -0,0 +1,243 @@
+/*
+ * audio_read.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Reads an audio file off the tag's card with the firmware's own reader (Lib Src/audio_file.c) over an mmap of the
+ *    file, and reports what is in it: records, blocks, sequence gaps (drops, or quiet periods in triggered mode), ADC
+ *    CRC errors and any damaged spans the reader had to resync past. A last record cut short (the tag lost power mid
+ *    write) is told apart from damage further in.
+ *
+ *    -v lists every record as CSV on stdout: offset, first sequence, blocks, payload bytes, flags, dropped blocks,
+ *    CRC error groups (-1 where the ADC CRC wasn't locked). -x writes the audio out as raw blocks back to back, in the
+ *    layout the header describes, decoding compressed records on the way (see audio_codec.h).
+ *
+ *    usage: audio_read [-v] [-x out.raw] file
+ */
+
+#include "bench.h"
+#include "Lib Inc/audio_file.h"
+#include "Lib Inc/audio_codec.h"
+#include "Lib Inc/audio_crc.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+typedef struct {
+    uint32_t records;
+    uint32_t padding_records;
+    uint64_t blocks;
+    uint64_t frames;
+    uint64_t audio_bytes;       //payload bytes of audio records, as stored
+    uint64_t raw_bytes;         //the same audio as raw blocks
+    uint32_t gaps;              //sequence jumps between blocks
+    uint64_t missing_blocks;    //blocks in those jumps
+    uint32_t dropped_blocks;    //what the tag counted as dropped, by the last record
+    uint32_t damaged;           //spans the reader resynced past
+    uint64_t damaged_bytes;
+    uint64_t truncated_bytes;   //of a last record cut short
+    uint64_t crc_errors;        //ADC CRC groups that didn't match
+    uint64_t crc_unlocked;      //blocks written before the ADC CRC locked
+    uint64_t decode_errors;     //compressed blocks that didn't decode (-x)
+} ReadSummary;
+
+static uint8_t decoded[1 << 16];
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static void __usage(const char *name){
+    fprintf(stderr, "usage: %s [-v] [-x out.raw] file\n", name);
+    exit(2);
+}
+
+/* write the record's audio as raw blocks, decoding compressed ones */
+static void __extract(FILE *out, const AudioFileHeader *header, const uint8_t *payload, ReadSummary *summary){
+    for(uint16_t i = 0; i < header->block_count; i++){
+        uint32_t len = header->blocks[i].length;
+
+        if(!(header->flags & AUDIO_FILE_FLAG_COMPRESSED)){
+            fwrite(payload, 1, len, out);
+        }
+        else{
+            size_t decoded_len = 0;
+            if(audio_codec_decode(payload, len, decoded, sizeof(decoded), &decoded_len) == len){
+                fwrite(decoded, 1, decoded_len, out);
+            }
+            else{
+                summary->decode_errors++;
+            }
+        }
+        payload += len;
+    }
+}
+
+static void __record(const AudioFileHeader *header, size_t offset, bool verbose, ReadSummary *summary, uint32_t *next_sequence){
+    uint32_t crc_errors = 0;
+    bool crc_unlocked = false;
+
+    summary->records++;
+    if(header->flags & AUDIO_FILE_FLAG_PADDING){
+        summary->padding_records++;
+        return;
+    }
+
+    size_t frame_bytes = (size_t)__builtin_popcount(header->channel_mask) * (header->header_bytes + header->sample_bytes);
+    for(uint16_t i = 0; i < header->block_count; i++){
+        const AudioFileBlockEntry *block = &header->blocks[i];
+
+        if((summary->blocks != 0) && (block->sequence != *next_sequence)){
+            summary->gaps++;
+            summary->missing_blocks += (uint32_t)(block->sequence - *next_sequence);
+        }
+        *next_sequence = block->sequence + 1;
+
+        if(block->crc_errors == AUDIO_CRC_UNLOCKED){
+            crc_unlocked = true;
+            summary->crc_unlocked++;
+        }
+        else{
+            crc_errors += block->crc_errors;
+        }
+        summary->blocks++;
+        summary->frames += frame_bytes ? (header->block_size / frame_bytes) : 0;
+        summary->raw_bytes += header->block_size;
+    }
+    summary->audio_bytes += header->payload_len;
+    summary->dropped_blocks = header->dropped_blocks;
+    if(header->flags & AUDIO_FILE_FLAG_ADC_CRC){
+        summary->crc_errors += crc_errors;
+    }
+
+    if(verbose){
+        printf("%zu,%lu,%u,%lu,0x%02X,%lu,%ld\n", offset,
+                (unsigned long)(header->block_count ? header->blocks[0].sequence : 0), header->block_count,
+                (unsigned long)header->payload_len, header->flags, (unsigned long)header->dropped_blocks,
+                (!(header->flags & AUDIO_FILE_FLAG_ADC_CRC) || crc_unlocked) ? -1L : (long)crc_errors);
+    }
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+int main(int argc, char **argv){
+    const char *extract_path = NULL;
+    bool verbose = false;
+    int opt;
+
+    while((opt = getopt(argc, argv, "vx:")) != -1){
+        switch(opt){
+            case 'v': verbose = true; break;
+            case 'x': extract_path = optarg; break;
+            default: __usage(argv[0]);
+        }
+    }
+    if(optind != (argc - 1)){
+        __usage(argv[0]);
+    }
+
+    const char *path = argv[optind];
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if((fd < 0) || (fstat(fd, &st) != 0)){
+        perror(path);
+        return 1;
+    }
+
+    //an empty file can't be mapped, it reads as no records
+    const uint8_t *data = NULL;
+    size_t len = (size_t)st.st_size;
+    if(len != 0){
+        data = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED){
+            perror(path);
+            return 1;
+        }
+        madvise((void *)data, len, MADV_SEQUENTIAL);
+    }
+
+    FILE *out = NULL;
+    if(extract_path != NULL){
+        out = fopen(extract_path, "wb");
+        if(out == NULL){
+            perror(extract_path);
+            return 1;
+        }
+    }
+
+    AudioFileReader reader;
+    AudioFileHeader header;
+    AudioFileHeader first = {0};
+    const uint8_t *payload;
+    AudioFileStatus status;
+    ReadSummary summary = {0};
+    uint32_t next_sequence = 0;
+
+    if(verbose){
+        printf("offset,sequence,blocks,payload_bytes,flags,dropped_blocks,crc_errors\n");
+    }
+    audio_file_reader_init(&reader, data, len);
+    while((status = audio_file_reader_next(&reader, &header, &payload)) != AUDIO_FILE_END){
+        size_t offset = reader.offset;
+
+        if(status == AUDIO_FILE_OK){
+            if(!(header.flags & AUDIO_FILE_FLAG_PADDING) && (first.sample_rate == 0)){
+                first = header;
+            }
+            __record(&header, offset - AUDIO_FILE_HEADER_SIZE - header.payload_len, verbose, &summary, &next_sequence);
+            if((out != NULL) && !(header.flags & AUDIO_FILE_FLAG_PADDING)){
+                __extract(out, &header, payload, &summary);
+            }
+            continue;
+        }
+
+        //A cut short last record has nothing valid after it, anything else is damage to skip
+        bool resynced = audio_file_reader_resync(&reader);
+        bool truncated = (status == AUDIO_FILE_TRUNCATED) && !resynced;
+        if(truncated){
+            summary.truncated_bytes = reader.offset - offset;
+        }
+        else{
+            summary.damaged++;
+            summary.damaged_bytes += reader.offset - offset;
+        }
+        fprintf(stderr, "%s: %s at offset %zu, %zu bytes skipped\n", path,
+                truncated ? "last record cut short" : "damaged record", offset, reader.offset - offset);
+        if(!resynced){
+            break;
+        }
+    }
+
+    fprintf(stderr, "%s: %lu records (%lu padding), %llu blocks, %llu bytes of audio (%.3f of raw)\n", path,
+            (unsigned long)summary.records, (unsigned long)summary.padding_records, (unsigned long long)summary.blocks,
+            (unsigned long long)summary.audio_bytes, summary.raw_bytes ? (double)summary.audio_bytes / summary.raw_bytes : 0.0);
+    if(first.sample_rate != 0){
+        fprintf(stderr, "%s: %u Hz, channels 0x%02X, %u-bit%s%s%s, %.1f s\n", path, (unsigned)first.sample_rate,
+                first.channel_mask, first.sample_bytes * 8, (first.flags & AUDIO_FILE_FLAG_COMPRESSED) ? ", compressed" : "",
+                (first.flags & AUDIO_FILE_FLAG_TRIGGERED) ? ", triggered" : "", (first.flags & AUDIO_FILE_FLAG_DITHERED) ? ", dithered" : "",
+                (double)summary.frames / first.sample_rate);
+    }
+    //Gaps are drops, skipped quiet periods (triggered) or blocks lost in damaged spans, the tag's own count tells drops apart
+    fprintf(stderr, "%s: %lu sequence gaps (%llu blocks missing, %lu dropped by the tag), %llu ADC CRC errors (%llu blocks unchecked)\n",
+            path, (unsigned long)summary.gaps, (unsigned long long)summary.missing_blocks, (unsigned long)summary.dropped_blocks,
+            (unsigned long long)summary.crc_errors, (unsigned long long)summary.crc_unlocked);
+    fprintf(stderr, "%s: %lu damaged spans (%llu bytes), %llu bytes cut short at the end\n", path, (unsigned long)summary.damaged,
+            (unsigned long long)summary.damaged_bytes, (unsigned long long)summary.truncated_bytes);
+
+    if(out != NULL){
+        fclose(out);
+        if(summary.decode_errors){
+            fprintf(stderr, "%s: %llu blocks didn't decode and were left out\n", extract_path, (unsigned long long)summary.decode_errors);
+        }
+    }
+    if(data != NULL){
+        munmap((void *)data, len);
+    }
+    close(fd);
+    return (summary.damaged || summary.truncated_bytes || summary.decode_errors) ? 1 : 0;
+}
@@ -0,0 +1,589 @@
+/*
+ * audio_sim.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Runs the firmware's audio pipeline (Sensor Src/audio.c with the storage thread, extent files, the config reader,
+ *    the ADC driver and FileX itself) on a Linux host, against a simulated SD card, to see how the write path copes
+ *    with card latency before a tag goes in the water.
+ *
+ *    The platform is stood in for by sim/: ThreadX on pthreads, the HAL calls audio.c makes, and a disk image with
+ *    injected latency as the card (sim/sim_disk.h). The image is formatted with 32kB clusters like an SD card (FAT32 from
+ *    about 2GB up, the default is 8GB, sparse) and config.txt copied onto it if one is given.
+ *
+ *    The DMA is a thread filling the temp buffer blocks in place, in the layout the SAI captures, a slice at a time over
+ *    each block period and raising the receive complete callback at its end, at the cadence the configured sample rate
+ *    gives. Blocks come from a WAV recording or a synthetic signal (bench_signal). The CRC of every block is kept.
+ *
+ *    After the run the audio thread is stopped the way the state machine stops it, and the image is opened again and
+ *    every audio file read back: every record has to be valid, every block captured has to be in a file exactly once
+ *    and match what was captured, or be counted as dropped by the pipeline. Write statistics (the pipeline's own,
+ *    from audio_stats) and the card's are printed.
+ *
+ *    The M33's own time isn't modelled: compression, repacking and the click detector run at host speed, so the
+ *    numbers are for the card and the buffering, not for CPU load. What is measured is how much of the CPU the audio
+ *    and storage threads hold at all (their thread CPU clocks): a writer that sleeps while the card is busy holds it for
+ *    a small part of its write time, one that spins for the card would hold it for all of it.
+ *
+ *    usage: audio_sim [-c config.txt] [-d seconds] [-x speed] [-i image] [-m image_mb]
+ *                     [-r request_us] [-w write_mb_s] [-b busy_ms] [-p busy_percent] [-s seed] [-n] [recording.wav]
+ *           -x runs the simulated clock that many times faster than real time
+ *           -n fails the run if any block was dropped
+ *           (a synthetic signal for 60s without a recording)
+ */
+
+#include "bench.h"
+#include "wav.h"
+#include "sim.h"
+#include "sim_disk.h"
+#include "audio.h"
+#include "Lib Inc/threads.h"
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#define SIM_DEFAULT_SECONDS 60
+#define SIM_DEFAULT_IMAGE "audio_sim.img"
+#define SIM_DEFAULT_IMAGE_MB 8192
+
+//Card defaults, a decent class 10 card that never stalls
+#define SIM_DEFAULT_REQUEST_US 300
+#define SIM_DEFAULT_WRITE_MB_S 20
+#define SIM_DEFAULT_READ_MB_S 40
+
+//FAT32 geometry of the image, as an SD card formatter would lay it out
+#define SIM_SECTOR_SIZE 512
+#define SIM_SECTORS_PER_CLUSTER 64
+
+//Slices the DMA fills each block in
+#define SIM_DMA_SLICES 8
+
+//Longest name FileX hands back from a directory search
+#define SIM_NAME_LEN (FX_MAX_LONG_NAME_LEN + 1)
+
+/*********************
+ * FIRMWARE GLOBALS  *
+ *********************/
+
+//What main.c, app_filex.c and app_threadx.c define on the tag
+SPI_HandleTypeDef hspi1;
+SD_HandleTypeDef hsd1;
+RTC_HandleTypeDef hrtc;
+AudioManager audio;
+FX_MEDIA sdio_disk;
+Thread_HandleTypeDef threads[NUM_THREADS];
+
+static SAI_Block_TypeDef sim_sai_block;
+static DMA_HandleTypeDef sim_sai_dma;
+SAI_HandleTypeDef hsai_BlockB1 = {
+    .Instance = &sim_sai_block,
+    .hdmarx = &sim_sai_dma,
+};
+
+extern TX_EVENT_FLAGS_GROUP audio_event_flags_group;
+
+static uint32_t sim_media_memory[FX_SD_MEDIA_CACHE_SIZE / sizeof(uint32_t)];
+
+/*********************
+ * PRIVATE VARIABLES *
+ *********************/
+
+//CPU the pipeline's threads held, sampled just before the audio thread is stopped
+typedef struct {
+    double audio_seconds;       //host CPU seconds
+    double storage_seconds;
+    double host_seconds;        //host wall clock seconds of the run
+    double write_seconds;       //host wall clock seconds the pipeline spent in writes
+} SimCpu;
+
+//The DMA thread and the signal it captures
+typedef struct {
+    pthread_t thread;
+    volatile bool running;
+    volatile bool done;         //source ran out or the duration is up, no more blocks
+    SAI_HandleTypeDef *hsai;
+
+    WavFile wav;
+    bool synthetic;
+    uint64_t synthetic_frame;
+    double seconds;
+
+    uint32_t blocks;            //blocks completed (callbacks raised)
+    uint32_t late_slices;       //slices the host wrote more than a slice late
+    uint32_t *block_crc;        //CRC-32 of every completed block, by sequence
+    uint32_t block_crc_capacity;
+} SimDma;
+
+static SimDma sim_dma;
+static int32_t sim_samples[BENCH_BLOCK_SIZE];
+static int32_t sim_wav_samples[BENCH_BLOCK_SIZE * 4];
+static uint8_t sim_block[AUDIO_CIRCULAR_BUFFER_SIZE];
+static uint8_t sim_decoded[AUDIO_CIRCULAR_BUFFER_SIZE];
+
+//Read back results
+typedef struct {
+    uint32_t files;
+    uint32_t leftover_files;    //temporary files still there after the stop
+    uint32_t records;
+    uint32_t bad_records;
+    uint32_t blocks;
+    uint32_t duplicates;
+    uint32_t corrupt;           //payload doesn't match what was captured
+    uint32_t unchecked;         //payload not compared (dithered)
+    uint32_t out_of_range;      //sequence never captured
+    uint8_t *seen;
+} SimCheck;
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static void __usage(const char *name){
+    fprintf(stderr, "usage: %s [-c config.txt] [-d seconds] [-x speed] [-i image] [-m image_mb]\n"
+                    "          [-r request_us] [-w write_mb_s] [-b busy_ms] [-p busy_percent] [-s seed] [-n] [recording.wav]\n", name);
+}
+
+/* next block of the signal in the captured layout, false once it runs out */
+static bool __source_block(SimDma *self, const AudioCodecFormat *fmt, uint32_t frames, uint32_t sample_rate){
+    uint16_t bits = 24;
+
+    if((double)(self->blocks + 1) * frames / sample_rate > self->seconds){
+        return false;
+    }
+    if(self->synthetic){
+        self->synthetic_frame = bench_signal(sim_samples, frames, fmt->channel_count, bits, sample_rate, sample_rate / 2,
+                                             self->synthetic_frame);
+    }
+    else{
+        //Recorded channels are taken in order, repeated if the recording has fewer. Only whole blocks are replayed.
+        if(wav_read(&self->wav, sim_wav_samples, frames) != frames){
+            return false;
+        }
+        for(uint32_t i = 0; i < frames; i++){
+            for(uint8_t ch = 0; ch < fmt->channel_count; ch++){
+                sim_samples[i * fmt->channel_count + ch] = sim_wav_samples[i * self->wav.channels + (ch % self->wav.channels)];
+            }
+        }
+        bits = self->wav.bits;
+    }
+    wav_to_block(fmt, sim_samples, bits, frames, sim_block);
+    return true;
+}
+
+static void __keep_crc(SimDma *self, uint32_t sequence, uint32_t crc){
+    if(sequence >= self->block_crc_capacity){
+        self->block_crc_capacity = self->block_crc_capacity ? self->block_crc_capacity * 2 : 1024;
+        self->block_crc = realloc(self->block_crc, self->block_crc_capacity * sizeof(uint32_t));
+        if(self->block_crc == NULL){
+            perror("audio_sim");
+            exit(1);
+        }
+    }
+    self->block_crc[sequence] = crc;
+}
+
+/* the GPDMA: fill the ring's blocks in order, each over one block period, and raise the callback at the end of each */
+static void *__dma_thread(void *arg){
+    SimDma *self = arg;
+    const AudioCodecFormat *fmt = &audio.capture_format;
+    uint32_t frames = audio.frames_per_block;
+    uint32_t sample_rate = audio.record.sample_rate;
+    double period = (double)frames / sample_rate;
+    size_t slice = AUDIO_CIRCULAR_BUFFER_SIZE / SIM_DMA_SLICES;
+    double start = sim_now();
+
+    while(self->running){
+        if(!__source_block(self, fmt, frames, sample_rate)){
+            self->done = true;
+            break;
+        }
+        __keep_crc(self, self->blocks, audio_file_crc32(0, sim_block, AUDIO_CIRCULAR_BUFFER_SIZE));
+
+        uint8_t *dst = audio.temp_buffer[self->blocks % TEMP_BUF_BLOCK_LENGTH];
+        for(int i = 0; (i < SIM_DMA_SLICES) && self->running; i++){
+            double wait = start + (self->blocks + (double)(i + 1) / SIM_DMA_SLICES) * period - sim_now();
+            if(wait > 0.0){
+                sim_sleep(wait);
+            }
+            else if(wait < -period / SIM_DMA_SLICES){
+                //a whole slice behind, the host's scheduling is showing through
+                self->late_slices++;
+            }
+            memcpy(&dst[i * slice], &sim_block[i * slice], (i == SIM_DMA_SLICES - 1) ? AUDIO_CIRCULAR_BUFFER_SIZE - i * slice : slice);
+        }
+        if(!self->running){
+            break;
+        }
+
+        self->blocks++;
+        if(self->hsai->RxCpltCallback != NULL){
+            self->hsai->RxCpltCallback(self->hsai);
+        }
+    }
+    return NULL;
+}
+
+/* the linked list audio_dma_link built has to be one node per temp buffer block, in order, in a circle */
+static bool __dma_list_check(const DMA_QListTypeDef *list){
+    const DMA_NodeTypeDef *node = list->Head;
+
+    if(!list->circular || (list->NodeNumber != TEMP_BUF_BLOCK_LENGTH)){
+        return false;
+    }
+    for(uint32_t i = 0; i < TEMP_BUF_BLOCK_LENGTH; i++){
+        if((node == NULL) || (node->DstAddress != (uint32_t)(uintptr_t)audio.temp_buffer[i])
+                || (node->DataSize != AUDIO_CIRCULAR_BUFFER_SIZE)){
+            return false;
+        }
+        node = node->next;
+    }
+    return node == list->Head;
+}
+
+/* format the image and put config.txt on it */
+static bool __format(const char *image, uint64_t image_mb, const char *config_path){
+    ULONG sectors = (ULONG)((image_mb * 1024 * 1024) / SIM_SECTOR_SIZE);
+    FX_FILE file;
+    UINT fx_result;
+
+    if(!sim_disk_create(image, image_mb * 1024 * 1024)){
+        return false;
+    }
+    fx_result = fx_media_format(&sdio_disk, sim_disk_driver, NULL, (UCHAR *)sim_media_memory, sizeof(sim_media_memory),
+                                "TAG", 2, 512, 0, sectors, SIM_SECTOR_SIZE, SIM_SECTORS_PER_CLUSTER, 1, 1);
+    if(fx_result == FX_SUCCESS){
+        fx_result = fx_media_open(&sdio_disk, "SD", sim_disk_driver, NULL, sim_media_memory, sizeof(sim_media_memory));
+    }
+    if(fx_result != FX_SUCCESS){
+        fprintf(stderr, "audio_sim: can't format %s (FileX status 0x%02X)\n", image, fx_result);
+        return false;
+    }
+    if(config_path == NULL){
+        return true;
+    }
+
+    char text[4096];
+    size_t len;
+    FILE *config = fopen(config_path, "r");
+    if(config == NULL){
+        perror(config_path);
+        return false;
+    }
+    len = fread(text, 1, sizeof(text), config);
+    fclose(config);
+
+    if((fx_file_create(&sdio_disk, TAG_CONFIG_FILE_NAME) != FX_SUCCESS)
+            || (fx_file_open(&sdio_disk, &file, TAG_CONFIG_FILE_NAME, FX_OPEN_FOR_WRITE) != FX_SUCCESS)
+            || (fx_file_write(&file, text, len) != FX_SUCCESS)
+            || (fx_file_close(&file) != FX_SUCCESS)){
+        fprintf(stderr, "audio_sim: can't copy %s to the image\n", config_path);
+        return false;
+    }
+    fx_media_flush(&sdio_disk);
+    return true;
+}
+
+/* compare the payload of one block with what was captured */
+static void __check_block(SimCheck *check, const AudioFileHeader *header, const AudioFileBlockEntry *entry,
+                          const uint8_t *payload){
+    const uint8_t *block = payload;
+    size_t len = entry->length;
+
+    if(header->flags & AUDIO_FILE_FLAG_DITHERED){
+        check->unchecked++;
+        return;
+    }
+    if(header->flags & AUDIO_FILE_FLAG_COMPRESSED){
+        if(audio_codec_decode(payload, entry->length, sim_decoded, sizeof(sim_decoded), &len) == 0){
+            check->corrupt++;
+            return;
+        }
+        block = sim_decoded;
+    }
+    if((len != AUDIO_CIRCULAR_BUFFER_SIZE) || (audio_file_crc32(0, block, len) != sim_dma.block_crc[entry->sequence])){
+        check->corrupt++;
+    }
+}
+
+/* read every record of one audio file */
+static void __check_file(SimCheck *check, const uint8_t *data, size_t len){
+    AudioFileReader reader;
+    AudioFileHeader header;
+    const uint8_t *payload;
+    AudioFileStatus status;
+
+    audio_file_reader_init(&reader, data, len);
+    while((status = audio_file_reader_next(&reader, &header, &payload)) != AUDIO_FILE_END){
+        if(status != AUDIO_FILE_OK){
+            check->bad_records++;
+            if(!audio_file_reader_resync(&reader)){
+                break;
+            }
+            continue;
+        }
+        check->records++;
+        if(header.flags & AUDIO_FILE_FLAG_PADDING){
+            continue;
+        }
+        for(uint16_t i = 0; i < header.block_count; i++){
+            const AudioFileBlockEntry *entry = &header.blocks[i];
+
+            if(entry->sequence >= sim_dma.blocks){
+                check->out_of_range++;
+            }
+            else if(check->seen[entry->sequence]){
+                check->duplicates++;
+            }
+            else{
+                check->seen[entry->sequence] = 1;
+                check->blocks++;
+                __check_block(check, &header, entry, payload);
+            }
+            payload += entry->length;
+        }
+    }
+}
+
+/* open the image again and read back every audio file */
+static bool __check_image(SimCheck *check){
+    CHAR name[SIM_NAME_LEN];
+    FX_FILE file;
+
+    check->seen = calloc(sim_dma.blocks + 1, 1);
+    if((check->seen == NULL)
+            || (fx_media_open(&sdio_disk, "SD", sim_disk_driver, NULL, sim_media_memory, sizeof(sim_media_memory)) != FX_SUCCESS)){
+        return false;
+    }
+
+    for(UINT fx_result = fx_directory_first_entry_find(&sdio_disk, name); fx_result == FX_SUCCESS;
+            fx_result = fx_directory_next_entry_find(&sdio_disk, name)){
+        size_t len = strlen(name);
+
+        if((strncmp(name, "audio_", 6) != 0) || (len < 4)){
+            continue;
+        }
+        if(strcmp(&name[len - 4], ".tmp") == 0){
+            check->leftover_files++;
+            continue;
+        }
+        if(fx_file_open(&sdio_disk, &file, name, FX_OPEN_FOR_READ) != FX_SUCCESS){
+            return false;
+        }
+
+        ULONG size = (ULONG)file.fx_file_current_file_size;
+        ULONG actual = 0;
+        uint8_t *data = malloc(size ? size : 1);
+        if((data == NULL) || (fx_file_read(&file, data, size, &actual) != FX_SUCCESS) || (actual != size)){
+            free(data);
+            fx_file_close(&file);
+            return false;
+        }
+        fx_file_close(&file);
+
+        //the directory search keeps its place across the reads
+        check->files++;
+        __check_file(check, data, size);
+        free(data);
+    }
+    fx_media_close(&sdio_disk);
+    return true;
+}
+
+/* CPU seconds a running thread has used */
+static double __thread_cpu(const TX_THREAD *thread){
+    clockid_t clock;
+    struct timespec ts;
+
+    if((pthread_getcpuclockid(thread->pthread, &clock) != 0) || (clock_gettime(clock, &ts) != 0)){
+        return 0.0;
+    }
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+static void __report(const SimCheck *check, const SimDiskLatency *card, const SimCpu *cpu, double host_seconds,
+                     double speed){
+    const AudioStats *stats = &audio.stats;
+    const char *layout = audio.compress ? (audio.repack ? "compressed, dithered" : "compressed")
+                                        : (audio.repack ? "dithered" : "raw");
+    double seconds = (double)sim_dma.blocks * audio.frames_per_block / audio.record.sample_rate;
+    double rate = (double)audio.record.sample_rate * audio_codec_frame_bytes(&audio.capture_format);
+    SimDiskStats disk = sim_disk_stats();
+
+    printf("%s: %zuch %u-bit%s %lu Hz, %s, %.1f s simulated in %.1f s (x%.1f)\n",
+           sim_dma.synthetic ? "synthetic" : "recording", audio.channel_count, audio.record.sample_bytes * 8,
+           audio.record.header_bytes ? "+hdr" : "", (unsigned long)audio.record.sample_rate, layout, seconds, host_seconds, speed);
+    printf("card: %.0f us per request, %.1f MB/s writes, %.0f ms busy spells on %.2f%% of writes\n", card->request_us,
+           card->write_mb_s, card->busy_ms, card->busy_chance * 100.0);
+    printf("blocks: %u captured, %u written, %u dropped by the pipeline (%u missing, %u corrupt), queue peak %u of %u\n",
+           sim_dma.blocks, check->blocks, audio.queue.dropped_blocks, sim_dma.blocks - check->blocks, check->corrupt,
+           audio.queue.peak_depth, AUDIO_QUEUE_MAX_DEPTH);
+    printf("writes: %u, %.0f kB average, %.2f ms average, %.2f ms worst, block to disk %.1f ms worst\n", stats->writes,
+           stats->writes ? stats->write_bytes / 1024.0 / stats->writes : 0.0,
+           stats->writes ? stats->write_us / 1000.0 / stats->writes : 0.0, stats->write_max_us / 1000.0,
+           stats->latency_max_us / 1000.0);
+    printf("throughput: %.2f MB/s captured, %.2f MB/s written while writing, writer busy %.0f%% of the time\n", rate / 1e6,
+           stats->write_us ? (double)stats->write_bytes / stats->write_us : 0.0,
+           seconds > 0.0 ? stats->write_us / 1e4 / seconds : 0.0);
+    printf("cpu: audio thread %.1f%%, storage thread %.1f%% of the run, storage thread on the CPU %.1f%% of its write time"
+           " (host speed)\n", cpu->host_seconds > 0.0 ? 100.0 * cpu->audio_seconds / cpu->host_seconds : 0.0,
+           cpu->host_seconds > 0.0 ? 100.0 * cpu->storage_seconds / cpu->host_seconds : 0.0,
+           cpu->write_seconds > 0.0 ? 100.0 * cpu->storage_seconds / cpu->write_seconds : 0.0);
+    printf("write time histogram (us):");
+    for(int i = 0; i < AUDIO_STATS_WRITE_BINS; i++){
+        if(stats->write_hist[i]){
+            printf(" %s%u:%u", (i == AUDIO_STATS_WRITE_BINS - 1) ? ">=" : "<", 1u << (i + AUDIO_STATS_WRITE_BIN_SHIFT),
+                   stats->write_hist[i]);
+        }
+    }
+    printf("\ncard requests: %u writes of %.1f sectors average, %u busy spells, %.1f ms worst; %u reads\n", disk.writes,
+           disk.writes ? (double)disk.write_sectors / disk.writes : 0.0, disk.busy_spells, disk.write_max * 1000.0, disk.reads);
+    printf("files: %u audio files, %u records (%u bad), %u left temporary, %u duplicate and %u unknown blocks",
+           check->files, check->records, check->bad_records, check->leftover_files, check->duplicates, check->out_of_range);
+    if(check->unchecked){
+        printf(", %u dithered blocks not compared", check->unchecked);
+    }
+    printf("\n");
+    if(sim_dma.late_slices){
+        printf("the host fell more than a slice behind the DMA %u times, a lower -x gives truer timing\n", sim_dma.late_slices);
+    }
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+void sim_sai_start(SAI_HandleTypeDef *hsai){
+    if(!__dma_list_check(hsai->hdmarx->LinkedListQueue)){
+        fprintf(stderr, "audio_sim: the DMA linked list doesn't cover the temp buffer\n");
+        exit(1);
+    }
+    sim_dma.hsai = hsai;
+    sim_dma.running = true;
+    if(pthread_create(&sim_dma.thread, NULL, __dma_thread, &sim_dma) != 0){
+        perror("audio_sim");
+        exit(1);
+    }
+}
+
+void sim_sai_stop(SAI_HandleTypeDef *hsai){
+    if(sim_dma.running){
+        sim_dma.running = false;
+        pthread_join(sim_dma.thread, NULL);
+    }
+}
+
+void Error_Handler(void){
+    fprintf(stderr, "audio_sim: Error_Handler called, the tag would have stopped here\n");
+    exit(2);
+}
+
+int main(int argc, char **argv){
+    const char *config_path = NULL;
+    const char *image = SIM_DEFAULT_IMAGE;
+    uint64_t image_mb = SIM_DEFAULT_IMAGE_MB;
+    double seconds = SIM_DEFAULT_SECONDS;
+    bool seconds_set = false;
+    double speed = 1.0;
+    bool no_drops = false;
+    SimDiskLatency card = {
+        .request_us = SIM_DEFAULT_REQUEST_US,
+        .write_mb_s = SIM_DEFAULT_WRITE_MB_S,
+        .read_mb_s = SIM_DEFAULT_READ_MB_S,
+        .seed = 1,
+    };
+    int opt;
+
+    while((opt = getopt(argc, argv, "c:d:x:i:m:r:w:b:p:s:n")) != -1){
+        switch(opt){
+            case 'c': config_path = optarg; break;
+            case 'd': seconds = atof(optarg); seconds_set = true; break;
+            case 'x': speed = atof(optarg); break;
+            case 'i': image = optarg; break;
+            case 'm': image_mb = strtoull(optarg, NULL, 0); break;
+            case 'r': card.request_us = atof(optarg); break;
+            case 'w': card.write_mb_s = atof(optarg); break;
+            case 'b': card.busy_ms = atof(optarg); break;
+            case 'p': card.busy_chance = atof(optarg) / 100.0; break;
+            case 's': card.seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'n': no_drops = true; break;
+            default: __usage(argv[0]); return 1;
+        }
+    }
+
+    sim_dma.synthetic = (optind >= argc);
+    if(!sim_dma.synthetic){
+        if(!wav_open(&sim_dma.wav, argv[optind])){
+            return 1;
+        }
+        if(!seconds_set){
+            seconds = (double)sim_dma.wav.frames / sim_dma.wav.sample_rate;
+        }
+    }
+    sim_dma.seconds = seconds;
+
+    //The card, formatted at full speed
+    fx_system_initialize();
+    sim_disk_latency(NULL);
+    if(!__format(image, image_mb, config_path)){
+        return 1;
+    }
+
+    //The threads the audio pipeline needs, as app_threadx.c starts them. The audio thread reads config.txt & starts recording.
+    sim_clock_start(speed);
+    sim_disk_latency(&card);
+    storage_init();
+    tx_thread_create(&threads[STORAGE_THREAD].thread, "Storage Thread", storage_thread_entry, 0, NULL, 0, 0, 0,
+                     TX_NO_TIME_SLICE, TX_AUTO_START);
+    tx_thread_create(&threads[AUDIO_LTSA_THREAD].thread, "Audio LTSA Thread", audio_ltsa_thread_entry, 0, NULL, 0, 0, 0,
+                     TX_NO_TIME_SLICE, TX_DONT_START);
+    tx_thread_create(&threads[AUDIO_THREAD].thread, "Audio Thread", audio_thread_entry, 0, NULL, 0, 0, 0,
+                     TX_NO_TIME_SLICE, TX_AUTO_START);
+
+    //Record until the signal runs out, then stop the audio thread the way the state machine does
+    double host_start = bench_now();
+    while(!sim_dma.done){
+        usleep(10000);
+    }
+    if(!(sim_dma.hsai->hdmarx->interrupts & DMA_IT_TC) || (sim_dma.hsai->hdmarx->interrupts & DMA_IT_HT)){
+        fprintf(stderr, "audio_sim: the DMA should only interrupt at the end of every block\n");
+        return 1;
+    }
+    SimCpu cpu = {
+        .audio_seconds = __thread_cpu(&threads[AUDIO_THREAD].thread),
+        .storage_seconds = __thread_cpu(&threads[STORAGE_THREAD].thread),
+        .host_seconds = bench_now() - host_start,
+        .write_seconds = audio.stats.write_us * 1e-6 / speed,
+    };
+    tx_event_flags_set(&audio_event_flags_group, AUDIO_STOP_THREAD_FLAG, TX_OR);
+    sim_thread_join(&threads[AUDIO_THREAD].thread);
+    double host_seconds = bench_now() - host_start;
+
+    //Read the card back at full speed, the storage thread is idle now
+    sim_disk_latency(NULL);
+    fx_media_close(&sdio_disk);
+
+    SimCheck check = {};
+    if(!__check_image(&check)){
+        fprintf(stderr, "audio_sim: can't read the audio files back from %s\n", image);
+        return 1;
+    }
+    sim_disk_close();
+    __report(&check, &card, &cpu, host_seconds, speed);
+
+    //Every captured block has to be in a file, or counted as dropped (triggered mode skips blocks on purpose)
+    uint32_t missing = sim_dma.blocks - check.blocks;
+    BENCH_CHECK(check.files > 0);
+    BENCH_CHECK(check.bad_records == 0);
+    BENCH_CHECK(check.leftover_files == 0);
+    BENCH_CHECK(check.duplicates == 0);
+    BENCH_CHECK(check.out_of_range == 0);
+    BENCH_CHECK(audio.trigger.enabled || (missing + check.corrupt <= audio.queue.dropped_blocks));
+    BENCH_CHECK(check.corrupt <= audio.queue.dropped_blocks);
+    if(no_drops){
+        BENCH_CHECK(audio.queue.dropped_blocks == 0);
+    }
+
+    printf("audio_sim: %s (%u failed checks)\n", bench_failures ? "FAIL" : "ok", bench_failures);
+    return bench_failures ? 1 : 0;
+}
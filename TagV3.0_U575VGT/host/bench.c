@@ -0,0 +1,61 @@
+/*
+ * bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Shared bits for the host tests and benchmarks, see bench.h
+ */
+
+#include "bench.h"
+#include <math.h>
+
+unsigned bench_failures = 0;
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/* xorshift, so the noise is the same on every host */
+static uint32_t __random(void){
+    static uint32_t state = 0x2545F491;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+uint64_t bench_signal(int32_t *samples, size_t frame_count, uint8_t channel_count, uint8_t bits, uint32_t sample_rate,
+                      uint32_t click_period, uint64_t start){
+    const double full_scale = (double)(1L << (bits - 1)) - 1.0;
+
+    for(size_t i = 0; i < frame_count; i++){
+        uint64_t n = start + i;
+        double t = (double)n / sample_rate;
+
+        for(uint8_t ch = 0; ch < channel_count; ch++){
+            double v = 0.02 * sin(2.0 * M_PI * 40.0 * t + ch);
+            v += 0.002 * (((double)(__random() & 0xFFFF) / 32768.0) - 1.0);
+
+            if(click_period != 0){
+                //clicks arrive a few frames apart on each channel, as on a hydrophone array
+                uint64_t phase = (n + click_period - (ch * 3)) % click_period;
+                double tc = (double)phase / sample_rate;
+                v += 0.5 * exp(-tc * 4000.0) * sin(2.0 * M_PI * 15000.0 * tc);
+            }
+
+            if(v > 1.0){
+                v = 1.0;
+            }
+            else if(v < -1.0){
+                v = -1.0;
+            }
+            *samples++ = (int32_t)lrint(v * full_scale);
+        }
+    }
+    return start + frame_count;
+}
@@ -0,0 +1,48 @@
+/*
+ * bench.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Shared bits for the host tests and benchmarks: a monotonic clock, test checks and a synthetic hydrophone signal
+ *    for when no recording is given.
+ */
+
+#ifndef HOST_BENCH_H_
+#define HOST_BENCH_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+//One temp buffer block on the tag (AUDIO_CIRCULAR_BUFFER_SIZE in audio.h)
+#define BENCH_BLOCK_SIZE 32256
+
+//Failed checks so far, the tests exit with this
+extern unsigned bench_failures;
+
+#define BENCH_CHECK(expr) do{ \
+        if(!(expr)){ \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+            bench_failures++; \
+        } \
+    }while(0)
+
+/* seconds on a monotonic clock */
+static inline double bench_now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+/*
+ * Desc: fill frame_count frames of channel_count interleaved bits wide samples with a repeatable stand-in for
+ *       hydrophone data: low frequency swell, broadband noise and, if clicks is set, a 15 kHz decaying click every
+ *       click_period frames (as a sperm whale's, at sample_rate). Returns the frame index after the last one written,
+ *       pass it back as start to continue the signal.
+ */
+uint64_t bench_signal(int32_t *samples, size_t frame_count, uint8_t channel_count, uint8_t bits, uint32_t sample_rate,
+                      uint32_t click_period, uint64_t start);
+
+#endif /* HOST_BENCH_H_ */
@@ -0,0 +1,208 @@
+/*
+ * click_replay.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Replays a recording through the click detector (Lib Src/click_detector.c) the way the audio thread runs it, for
+ *    tuning audio_click_threshold offline and timing the detector.
+ *
+ *    The recording is cut into temp buffer blocks in the captured layout (24-bit with the ADC header byte, up to 4
+ *    channels). Every click goes to stdout as CSV: time in seconds, channel, peak in dBFS. The summary (clicks per
+ *    channel, time per block and the margin over real time on this host) goes to stderr.
+ *
+ *    With a label file (CSV, click time in seconds in the first column, other lines are skipped) it also reports how
+ *    many labelled clicks were found on any channel within the tolerance, and how many detections match no label.
+ *
+ *    usage: click_replay [-t threshold_db] [-l labels.csv] [-w tolerance_ms] [recording.wav]
+ *           (a synthetic 4 channel 96kHz signal with a click every 0.5s without a recording)
+ */
+
+#include "bench.h"
+#include "wav.h"
+#include "Lib Inc/click_detector.h"
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#define REPLAY_MAX_EVENTS 64
+#define REPLAY_MAX_LABELS 100000
+#define REPLAY_DEFAULT_THRESHOLD_DB 12
+#define REPLAY_DEFAULT_TOLERANCE_MS 2.0
+
+//Synthetic input when no recording is given
+#define SYNTHETIC_RATE 96000
+#define SYNTHETIC_SECONDS 60
+
+static int32_t samples[BENCH_BLOCK_SIZE * 4];
+static uint8_t block[BENCH_BLOCK_SIZE];
+static double labels[REPLAY_MAX_LABELS];
+static bool label_found[REPLAY_MAX_LABELS];
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static size_t __read_labels(const char *path){
+    char line[256];
+    size_t count = 0;
+    FILE *file = fopen(path, "r");
+
+    if(file == NULL){
+        perror(path);
+        exit(1);
+    }
+    while((count < REPLAY_MAX_LABELS) && (fgets(line, sizeof(line), file) != NULL)){
+        char *end;
+        double t = strtod(line, &end);
+        if(end != line){
+            labels[count++] = t;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+/* mark the label closest to t if it's within tolerance, returns whether there was one */
+static bool __match(double t, size_t label_count, double tolerance){
+    size_t best = label_count;
+    double best_distance = tolerance;
+
+    for(size_t i = 0; i < label_count; i++){
+        double distance = fabs(labels[i] - t);
+        if(distance <= best_distance){
+            best = i;
+            best_distance = distance;
+        }
+    }
+    if(best == label_count){
+        return false;
+    }
+    label_found[best] = true;
+    return true;
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+int main(int argc, char **argv){
+    int threshold_db = REPLAY_DEFAULT_THRESHOLD_DB;
+    double tolerance = REPLAY_DEFAULT_TOLERANCE_MS / 1000.0;
+    const char *label_path = NULL;
+    int opt;
+
+    while((opt = getopt(argc, argv, "t:l:w:")) != -1){
+        if(opt == 't'){
+            threshold_db = atoi(optarg);
+        }
+        else if(opt == 'l'){
+            label_path = optarg;
+        }
+        else if(opt == 'w'){
+            tolerance = atof(optarg) / 1000.0;
+        }
+        else{
+            fprintf(stderr, "usage: %s [-t threshold_db] [-l labels.csv] [-w tolerance_ms] [recording.wav]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    WavFile wav = {0};
+    uint16_t wav_channels = AUDIO_CODEC_MAX_CHANNELS;
+    uint32_t sample_rate = SYNTHETIC_RATE;
+    uint16_t bits = 24;
+    uint64_t synthetic_frame = 0;
+    bool synthetic = (optind >= argc);
+
+    if(!synthetic){
+        if(!wav_open(&wav, argv[optind])){
+            return 1;
+        }
+        wav_channels = wav.channels;
+        sample_rate = wav.sample_rate;
+        bits = wav.bits;
+    }
+
+    AudioCodecFormat fmt = {(wav_channels < AUDIO_CODEC_MAX_CHANNELS) ? wav_channels : AUDIO_CODEC_MAX_CHANNELS, 3, 1};
+    size_t block_frames = BENCH_BLOCK_SIZE / audio_codec_frame_bytes(&fmt);
+    if(block_frames * wav_channels > sizeof(samples) / sizeof(samples[0])){
+        block_frames = (sizeof(samples) / sizeof(samples[0])) / wav_channels;
+    }
+    size_t label_count = label_path ? __read_labels(label_path) : 0;
+    ClickDetector detector;
+    ClickEvent events[REPLAY_MAX_EVENTS];
+    uint32_t detected[AUDIO_CODEC_MAX_CHANNELS] = {0};
+    uint32_t unmatched = 0;
+    uint32_t sequence = 0;
+    uint64_t frames_total = 0;
+    double busy = 0.0;
+    double worst = 0.0;
+    size_t frames;
+
+    click_detector_init(&detector, &fmt, sample_rate, (uint8_t)threshold_db);
+    printf("time_s,channel,peak_dbfs\n");
+
+    while(1){
+        if(synthetic){
+            if(synthetic_frame >= (uint64_t)SYNTHETIC_RATE * SYNTHETIC_SECONDS){
+                break;
+            }
+            frames = block_frames;
+            synthetic_frame = bench_signal(samples, frames, fmt.channel_count, bits, sample_rate, sample_rate / 2, synthetic_frame);
+        }
+        else{
+            frames = wav_read(&wav, samples, block_frames);
+            if(frames == 0){
+                break;
+            }
+            for(size_t i = 0; i < frames; i++){
+                memmove(&samples[i * fmt.channel_count], &samples[i * wav_channels], fmt.channel_count * sizeof(int32_t));
+            }
+        }
+        wav_to_block(&fmt, samples, bits, frames, block);
+
+        double start = bench_now();
+        size_t count = click_detector_process(&detector, block, frames * audio_codec_frame_bytes(&fmt), sequence,
+                                              events, REPLAY_MAX_EVENTS);
+        double elapsed = bench_now() - start;
+        busy += elapsed;
+        if((frames == block_frames) && (elapsed > worst)){
+            worst = elapsed;
+        }
+
+        for(size_t i = 0; i < count; i++){
+            double t = (double)((uint64_t)events[i].sequence * block_frames + events[i].frame) / sample_rate;
+            double peak_db = 20.0 * log10(((double)events[i].amplitude + 1.0) / 2147483648.0);
+            printf("%.6f,%u,%.1f\n", t, events[i].channel, peak_db);
+            detected[events[i].channel]++;
+            if(label_count && !__match(t, label_count, tolerance)){
+                unmatched++;
+            }
+        }
+        frames_total += frames;
+        sequence++;
+    }
+    wav_close(&wav);
+
+    double seconds = (double)frames_total / sample_rate;
+    fprintf(stderr, "%s: %.1f s, %u Hz, %u channels, threshold %d dB\n", synthetic ? "synthetic" : argv[optind], seconds,
+            sample_rate, fmt.channel_count, threshold_db);
+    fprintf(stderr, "clicks per channel:");
+    for(uint8_t ch = 0; ch < fmt.channel_count; ch++){
+        fprintf(stderr, " %u", detected[ch]);
+    }
+    fprintf(stderr, " (%u missed for lack of room)\n", detector.missed_events);
+    fprintf(stderr, "detector time: %.1f us per block average, %.1f us worst, x%.0f realtime on this host\n",
+            sequence ? busy * 1e6 / sequence : 0.0, worst * 1e6, busy > 0.0 ? seconds / busy : 0.0);
+
+    if(label_count){
+        size_t found = 0;
+        for(size_t i = 0; i < label_count; i++){
+            found += label_found[i];
+        }
+        fprintf(stderr, "labels: %zu of %zu found (%.1f%%) within %.1f ms, %u detections match no label\n", found,
+                label_count, 100.0 * found / label_count, tolerance * 1000.0, unmatched);
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * click_test.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Test of the click detector (Lib Src/click_detector.c) on a synthetic signal with clicks at known frames.
+ *
+ *    The signal is fed in temp buffer sized blocks the way the audio thread does it. After the warm-up every click has
+ *    to be reported exactly once per channel, within a millisecond of where it was put, and the same noise without
+ *    clicks must not report anything.
+ */
+
+#include "bench.h"
+#include "wav.h"
+#include "Lib Inc/click_detector.h"
+#include <string.h>
+
+#define TEST_SECONDS 10
+#define TEST_THRESHOLD_DB 12
+#define TEST_MAX_EVENTS 32
+
+//Inter-channel delay bench_signal puts on the clicks, in frames
+#define CLICK_CHANNEL_DELAY 3
+
+static int32_t samples[BENCH_BLOCK_SIZE];
+static uint8_t block[BENCH_BLOCK_SIZE];
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static void __run(const AudioCodecFormat *fmt, uint32_t sample_rate, uint32_t click_period){
+    ClickDetector detector;
+    ClickEvent events[TEST_MAX_EVENTS];
+    size_t block_frames = BENCH_BLOCK_SIZE / audio_codec_frame_bytes(fmt);
+    uint64_t total_frames = (uint64_t)sample_rate * TEST_SECONDS;
+    uint64_t frame = 0;
+    uint32_t tolerance = sample_rate / 1000;
+    uint32_t warmup = (sample_rate / 1000) * CLICK_WARMUP_MS;
+    uint32_t detected[AUDIO_CODEC_MAX_CHANNELS] = {0};
+    uint32_t expected = 0;
+    uint32_t misplaced = 0;
+
+    click_detector_init(&detector, fmt, sample_rate, TEST_THRESHOLD_DB);
+
+    for(uint32_t sequence = 0; frame < total_frames; sequence++){
+        frame = bench_signal(samples, block_frames, fmt->channel_count, fmt->sample_bytes * 8, sample_rate, click_period, frame);
+        wav_to_block(fmt, samples, fmt->sample_bytes * 8, block_frames, block);
+
+        size_t count = click_detector_process(&detector, block, block_frames * audio_codec_frame_bytes(fmt), sequence,
+                                              events, TEST_MAX_EVENTS);
+        for(size_t i = 0; i < count; i++){
+            BENCH_CHECK(events[i].sequence <= sequence);
+            BENCH_CHECK(events[i].channel < fmt->channel_count);
+            detected[events[i].channel]++;
+
+            if(click_period == 0){
+                misplaced++;
+                continue;
+            }
+            uint64_t at = (uint64_t)events[i].sequence * block_frames + events[i].frame;
+            uint64_t offset = (at + click_period - (events[i].channel * CLICK_CHANNEL_DELAY)) % click_period;
+            if((offset > tolerance) && (offset < click_period - tolerance)){
+                misplaced++;
+            }
+        }
+    }
+
+    if(click_period != 0){
+        //clicks that land after the warm-up and have ended by the end of the last block
+        for(uint64_t at = click_period; at + (tolerance * CLICK_MAX_MS) < frame; at += click_period){
+            expected += (at > warmup);
+        }
+    }
+
+    printf("%uch %2u-bit%s %6u Hz %s: expected %u per channel, detected", fmt->channel_count, fmt->sample_bytes * 8,
+           fmt->header_bytes ? "+hdr" : "    ", sample_rate, click_period ? "clicks" : "noise ", expected);
+    for(uint8_t ch = 0; ch < fmt->channel_count; ch++){
+        printf(" %u", detected[ch]);
+        BENCH_CHECK(detected[ch] == expected);
+    }
+    printf(", misplaced %u\n", misplaced);
+    BENCH_CHECK(misplaced == 0);
+    BENCH_CHECK(detector.missed_events == 0);
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+int main(void){
+    AudioCodecFormat captured = {4, 3, 1};
+    AudioCodecFormat mono = {1, 2, 0};
+
+    __run(&captured, 96000, 96000 / 2);
+    __run(&captured, 96000, 0);
+    __run(&captured, 192000, 192000 / 3);
+    __run(&mono, 48000, 48000 / 4);
+    __run(&mono, 48000, 0);
+
+    printf("click_test: %s (%u failed checks)\n", bench_failures ? "FAIL" : "ok", bench_failures);
+    return bench_failures ? 1 : 0;
+}
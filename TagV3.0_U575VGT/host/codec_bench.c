@@ -0,0 +1,170 @@
+/*
+ * codec_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Host benchmark of the audio block codec (Lib Src/audio_codec.c): encode/decode MB/s and compression ratio.
+ *
+ *    Each recording is cut into temp buffer sized blocks in both layouts the tag records (16-bit, and 24-bit with the
+ *    ADC header byte), and every block is encoded and decoded the way the audio thread does it. Throughput is raw bytes
+ *    per second of CPU time on this host; "x realtime" is that over the rate the tag produces the same layout at the
+ *    recording's sample rate. It says nothing about the Cortex-M33, only about relative cost and the ratio.
+ *
+ *    usage: codec_bench [recording.wav ...]   (a synthetic 4 channel 96kHz signal without any)
+ */
+
+#include "bench.h"
+#include "wav.h"
+#include "Lib Inc/audio_codec.h"
+#include <string.h>
+
+//Synthetic input when no recording is given
+#define SYNTHETIC_CHANNELS 4
+#define SYNTHETIC_RATE 96000
+#define SYNTHETIC_SECONDS 20
+
+//Each measurement is repeated until it has run at least this long
+#define MIN_BENCH_SECONDS 0.5
+
+typedef struct {
+    const char *name;
+    int32_t *samples;   //interleaved, channels per frame
+    size_t frames;
+    uint8_t channels;
+    uint8_t bits;
+    uint32_t sample_rate;
+} Recording;
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static bool __load(Recording *self, const char *path){
+    WavFile wav;
+    if(!wav_open(&wav, path)){
+        return false;
+    }
+
+    int32_t *all = malloc((size_t)wav.frames * wav.channels * sizeof(int32_t));
+    *self = (Recording){
+        .name = path,
+        .channels = (wav.channels < AUDIO_CODEC_MAX_CHANNELS) ? wav.channels : AUDIO_CODEC_MAX_CHANNELS,
+        .bits = wav.bits,
+        .sample_rate = wav.sample_rate,
+    };
+    self->frames = wav_read(&wav, all, wav.frames);
+    wav_close(&wav);
+
+    //keep the first channels of every frame
+    self->samples = malloc(self->frames * self->channels * sizeof(int32_t));
+    for(size_t i = 0; i < self->frames; i++){
+        memcpy(&self->samples[i * self->channels], &all[i * wav.channels], self->channels * sizeof(int32_t));
+    }
+    free(all);
+    return true;
+}
+
+static void __synthesize(Recording *self){
+    *self = (Recording){
+        .name = "synthetic",
+        .frames = (size_t)SYNTHETIC_RATE * SYNTHETIC_SECONDS,
+        .channels = SYNTHETIC_CHANNELS,
+        .bits = 24,
+        .sample_rate = SYNTHETIC_RATE,
+    };
+    self->samples = malloc(self->frames * self->channels * sizeof(int32_t));
+    bench_signal(self->samples, self->frames, self->channels, self->bits, self->sample_rate, self->sample_rate / 2, 0);
+}
+
+static void __bench(const Recording *rec, const AudioCodecFormat *fmt){
+    size_t frame_bytes = audio_codec_frame_bytes(fmt);
+    size_t block_frames = BENCH_BLOCK_SIZE / frame_bytes;
+    size_t block_count = (rec->frames + block_frames - 1) / block_frames;
+    size_t raw_len = rec->frames * frame_bytes;
+    uint8_t *raw = malloc(raw_len);
+    uint8_t *encoded = malloc(raw_len + block_count * AUDIO_CODEC_MAX_OVERHEAD);
+    uint8_t *decoded = malloc(BENCH_BLOCK_SIZE);
+    size_t *encoded_lens = malloc(block_count * sizeof(size_t));
+    size_t encoded_total = 0;
+    double start, encode_s, decode_s;
+    unsigned encode_runs = 0;
+    unsigned decode_runs = 0;
+
+    wav_to_block(fmt, rec->samples, rec->bits, rec->frames, raw);
+
+    start = bench_now();
+    do{
+        uint8_t *dst = encoded;
+        encoded_total = 0;
+        for(size_t b = 0; b < block_count; b++){
+            size_t offset = b * block_frames * frame_bytes;
+            size_t len = ((raw_len - offset) < (block_frames * frame_bytes)) ? (raw_len - offset) : (block_frames * frame_bytes);
+            encoded_lens[b] = audio_codec_encode(fmt, &raw[offset], len, dst, len + AUDIO_CODEC_MAX_OVERHEAD);
+            BENCH_CHECK(encoded_lens[b] != 0);
+            dst += encoded_lens[b];
+            encoded_total += encoded_lens[b];
+        }
+        encode_runs++;
+        encode_s = bench_now() - start;
+    }while(encode_s < MIN_BENCH_SECONDS);
+
+    start = bench_now();
+    do{
+        const uint8_t *src = encoded;
+        for(size_t b = 0; b < block_count; b++){
+            size_t offset = b * block_frames * frame_bytes;
+            size_t decoded_len = 0;
+            BENCH_CHECK(audio_codec_decode(src, encoded_lens[b], decoded, BENCH_BLOCK_SIZE, &decoded_len) == encoded_lens[b]);
+            if(decode_runs == 0){
+                BENCH_CHECK(memcmp(decoded, &raw[offset], decoded_len) == 0);
+            }
+            src += encoded_lens[b];
+        }
+        decode_runs++;
+        decode_s = bench_now() - start;
+    }while(decode_s < MIN_BENCH_SECONDS);
+
+    double realtime = (double)rec->sample_rate * frame_bytes;
+    double encode_rate = (double)raw_len * encode_runs / encode_s;
+    double decode_rate = (double)raw_len * decode_runs / decode_s;
+    printf("%-24s %uch %2u-bit%s  ratio %.3f  encode %7.1f MB/s (x%.0f realtime)  decode %7.1f MB/s\n", rec->name,
+           fmt->channel_count, fmt->sample_bytes * 8, fmt->header_bytes ? "+hdr" : "    ", (double)encoded_total / raw_len,
+           encode_rate / 1e6, encode_rate / realtime, decode_rate / 1e6);
+
+    free(encoded_lens);
+    free(decoded);
+    free(encoded);
+    free(raw);
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+int main(int argc, char **argv){
+    int inputs = (argc > 1) ? (argc - 1) : 1;
+
+    for(int i = 0; i < inputs; i++){
+        Recording rec;
+        if(argc > 1){
+            if(!__load(&rec, argv[i + 1])){
+                bench_failures++;
+                continue;
+            }
+        }
+        else{
+            __synthesize(&rec);
+        }
+
+        AudioCodecFormat formats[] = {
+            {rec.channels, 2, 0},
+            {rec.channels, 3, 1},
+        };
+        for(size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++){
+            __bench(&rec, &formats[f]);
+        }
+        free(rec.samples);
+    }
+    return bench_failures ? 1 : 0;
+}
@@ -0,0 +1,220 @@
+/*
+ * codec_test.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Round trip test of the audio block codec (Lib Src/audio_codec.c).
+ *
+ *    Every block layout the tag can record (1-4 channels, 16/24-bit, with and without the ADC header byte) is encoded
+ *    and decoded back with a quiet signal, full scale noise, a full scale tone and digital silence, and has to come back
+ *    bit for bit within AUDIO_CODEC_MAX_OVERHEAD of its raw size. Then the decoder is fed truncated and corrupted
+ *    blocks, and the encoder too small a buffer, which have to fail cleanly.
+ *
+ *    usage: codec_test [recording.wav ...]   (recordings are round tripped as well)
+ */
+
+#include "bench.h"
+#include "wav.h"
+#include "Lib Inc/audio_codec.h"
+#include <string.h>
+#include <math.h>
+
+typedef enum {
+    SIGNAL_QUIET,
+    SIGNAL_NOISE,
+    SIGNAL_TONE,
+    SIGNAL_SILENCE,
+    SIGNAL_COUNT,
+} TestSignal;
+
+static const char *signal_names[SIGNAL_COUNT] = {"quiet", "noise", "tone", "silence"};
+
+static int32_t samples[BENCH_BLOCK_SIZE];
+static uint8_t raw[BENCH_BLOCK_SIZE];
+static uint8_t encoded[2 * (BENCH_BLOCK_SIZE + AUDIO_CODEC_MAX_OVERHEAD)];
+static uint8_t decoded[BENCH_BLOCK_SIZE];
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static void __fill(TestSignal signal, const AudioCodecFormat *fmt, size_t frames){
+    uint8_t bits = fmt->sample_bytes * 8;
+    size_t count = frames * fmt->channel_count;
+
+    if(signal == SIGNAL_QUIET){
+        bench_signal(samples, frames, fmt->channel_count, bits, 96000, 4000, 0);
+    }
+    for(size_t i = 0; i < count; i++){
+        if(signal == SIGNAL_NOISE){
+            samples[i] = (int32_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand()) >> (32 - bits);
+        }
+        else if(signal == SIGNAL_TONE){
+            samples[i] = (int32_t)((double)((1L << (bits - 1)) - 1) * sin((double)i * 0.3));
+        }
+        else if(signal == SIGNAL_SILENCE){
+            samples[i] = 0;
+        }
+    }
+    wav_to_block(fmt, samples, bits, frames, raw);
+
+    //a noisy signal also gets random header bytes, so the per frame header path is covered
+    if((signal == SIGNAL_NOISE) && fmt->header_bytes){
+        size_t slot = fmt->header_bytes + fmt->sample_bytes;
+        for(size_t i = 0; i < frames * fmt->channel_count; i++){
+            raw[i * slot] = (uint8_t)rand();
+        }
+    }
+}
+
+/* encode raw, decode it back and compare. Returns the encoded length */
+static size_t __round_trip(const AudioCodecFormat *fmt, size_t len){
+    size_t encoded_len = audio_codec_encode(fmt, raw, len, encoded, len + AUDIO_CODEC_MAX_OVERHEAD);
+    size_t decoded_len = 0;
+
+    BENCH_CHECK(encoded_len != 0);
+    BENCH_CHECK(encoded_len <= len + AUDIO_CODEC_MAX_OVERHEAD);
+    BENCH_CHECK(audio_codec_decode(encoded, encoded_len, decoded, sizeof(decoded), &decoded_len) == encoded_len);
+    BENCH_CHECK(decoded_len == len);
+    BENCH_CHECK(memcmp(raw, decoded, len) == 0);
+    return encoded_len;
+}
+
+static void __test_layouts(void){
+    for(uint8_t channels = 1; channels <= AUDIO_CODEC_MAX_CHANNELS; channels++){
+        for(uint8_t sample_bytes = 2; sample_bytes <= 3; sample_bytes++){
+            for(uint8_t header_bytes = 0; header_bytes <= 1; header_bytes++){
+                AudioCodecFormat fmt = {channels, sample_bytes, header_bytes};
+                size_t frames = BENCH_BLOCK_SIZE / audio_codec_frame_bytes(&fmt);
+                size_t len = frames * audio_codec_frame_bytes(&fmt);
+
+                for(TestSignal signal = 0; signal < SIGNAL_COUNT; signal++){
+                    unsigned failures = bench_failures;
+                    __fill(signal, &fmt, frames);
+                    size_t encoded_len = __round_trip(&fmt, len);
+                    printf("%uch %2u-bit %s %-7s %6zu -> %6zu (%.3f) %s\n", channels, sample_bytes * 8,
+                           header_bytes ? "hdr" : "   ", signal_names[signal], len, encoded_len,
+                           (double)encoded_len / len, (failures == bench_failures) ? "ok" : "FAIL");
+                }
+            }
+        }
+    }
+}
+
+/* blocks of odd lengths, including a single frame and a partition boundary */
+static void __test_lengths(void){
+    static const size_t frame_counts[] = {1, 2, 5, AUDIO_CODEC_PARTITION_LEN - 1, AUDIO_CODEC_PARTITION_LEN,
+                                          AUDIO_CODEC_PARTITION_LEN + 1, 3 * AUDIO_CODEC_PARTITION_LEN + 7};
+    AudioCodecFormat fmt = {3, 3, 1};
+
+    for(size_t i = 0; i < sizeof(frame_counts) / sizeof(frame_counts[0]); i++){
+        __fill(SIGNAL_QUIET, &fmt, frame_counts[i]);
+        __round_trip(&fmt, frame_counts[i] * audio_codec_frame_bytes(&fmt));
+    }
+}
+
+/* blocks written back to back have to walk with the consumed lengths */
+static void __test_back_to_back(void){
+    AudioCodecFormat fmt = {4, 3, 1};
+    size_t len = (BENCH_BLOCK_SIZE / audio_codec_frame_bytes(&fmt)) * audio_codec_frame_bytes(&fmt);
+    size_t first, second, consumed, decoded_len;
+
+    __fill(SIGNAL_QUIET, &fmt, len / audio_codec_frame_bytes(&fmt));
+    first = audio_codec_encode(&fmt, raw, len, encoded, sizeof(encoded));
+    second = audio_codec_encode(&fmt, raw, len, &encoded[first], sizeof(encoded) - first);
+    BENCH_CHECK((first != 0) && (second != 0));
+
+    consumed = audio_codec_decode(encoded, first + second, decoded, sizeof(decoded), &decoded_len);
+    BENCH_CHECK(consumed == first);
+    consumed = audio_codec_decode(&encoded[consumed], first + second - consumed, decoded, sizeof(decoded), &decoded_len);
+    BENCH_CHECK(consumed == second);
+    BENCH_CHECK(memcmp(raw, decoded, len) == 0);
+}
+
+static void __test_failures(void){
+    AudioCodecFormat fmt = {2, 3, 1};
+    AudioCodecFormat bad = {5, 3, 1};
+    size_t frames = 1000;
+    size_t len = frames * audio_codec_frame_bytes(&fmt);
+    size_t encoded_len, decoded_len;
+    AudioCodecFormat peeked;
+    uint16_t peeked_frames;
+
+    __fill(SIGNAL_QUIET, &fmt, frames);
+    BENCH_CHECK(audio_codec_encode(&bad, raw, len, encoded, sizeof(encoded)) == 0);
+    BENCH_CHECK(audio_codec_encode(&fmt, raw, len - 1, encoded, sizeof(encoded)) == 0);
+    BENCH_CHECK(audio_codec_encode(&fmt, raw, len, encoded, 16) == 0);
+
+    encoded_len = audio_codec_encode(&fmt, raw, len, encoded, sizeof(encoded));
+    BENCH_CHECK(audio_codec_peek(encoded, encoded_len, &peeked, &peeked_frames));
+    BENCH_CHECK((peeked.channel_count == 2) && (peeked.sample_bytes == 3) && (peeked.header_bytes == 1));
+    BENCH_CHECK(peeked_frames == frames);
+
+    //every truncation has to be caught, not read past
+    for(size_t cut = 0; cut < encoded_len; cut += 1 + (cut / 16)){
+        BENCH_CHECK(audio_codec_decode(encoded, cut, decoded, sizeof(decoded), &decoded_len) == 0);
+    }
+    BENCH_CHECK(audio_codec_decode(encoded, encoded_len, decoded, len - 1, &decoded_len) == 0);
+
+    //corruption may decode to garbage, but has to stay inside the buffers
+    for(int i = 0; i < 2000; i++){
+        uint8_t saved;
+        size_t at = AUDIO_CODEC_BLOCK_HEADER_SIZE + ((size_t)rand() % (encoded_len - AUDIO_CODEC_BLOCK_HEADER_SIZE));
+        saved = encoded[at];
+        encoded[at] ^= (uint8_t)(1 + (rand() % 255));
+        size_t consumed = audio_codec_decode(encoded, encoded_len, decoded, sizeof(decoded), &decoded_len);
+        BENCH_CHECK(consumed <= encoded_len);
+        encoded[at] = saved;
+    }
+}
+
+static void __test_recording(const char *path){
+    WavFile wav;
+    size_t frames;
+    size_t total_raw = 0;
+    size_t total_encoded = 0;
+
+    if(!wav_open(&wav, path)){
+        bench_failures++;
+        return;
+    }
+
+    AudioCodecFormat fmt = {(wav.channels < AUDIO_CODEC_MAX_CHANNELS) ? wav.channels : AUDIO_CODEC_MAX_CHANNELS,
+                            wav.bits / 8, (wav.bits == 24) ? 1 : 0};
+    static int32_t wav_samples[BENCH_BLOCK_SIZE * 4];
+    size_t block_frames = BENCH_BLOCK_SIZE / audio_codec_frame_bytes(&fmt);
+    if(block_frames * wav.channels > sizeof(wav_samples) / sizeof(wav_samples[0])){
+        block_frames = (sizeof(wav_samples) / sizeof(wav_samples[0])) / wav.channels;
+    }
+
+    while((frames = wav_read(&wav, wav_samples, block_frames)) > 0){
+        //keep the first channels of every frame
+        for(size_t i = 0; i < frames; i++){
+            memmove(&samples[i * fmt.channel_count], &wav_samples[i * wav.channels], fmt.channel_count * sizeof(int32_t));
+        }
+        wav_to_block(&fmt, samples, wav.bits, frames, raw);
+        total_raw += frames * audio_codec_frame_bytes(&fmt);
+        total_encoded += __round_trip(&fmt, frames * audio_codec_frame_bytes(&fmt));
+    }
+    printf("%s: %zu -> %zu (%.3f)\n", path, total_raw, total_encoded, total_raw ? (double)total_encoded / total_raw : 0.0);
+    wav_close(&wav);
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+int main(int argc, char **argv){
+    srand(1);
+    __test_layouts();
+    __test_lengths();
+    __test_back_to_back();
+    __test_failures();
+    for(int i = 1; i < argc; i++){
+        __test_recording(argv[i]);
+    }
+
+    printf("codec_test: %s (%u failed checks)\n", bench_failures ? "FAIL" : "ok", bench_failures);
+    return bench_failures ? 1 : 0;
+}
@@ -0,0 +1,177 @@
+/*
+ * crc_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Host benchmark of the AD7768 interface CRC checker (Lib Src/audio_crc.c): MB/s of raw blocks checked, against
+ *    the bitwise CRC-8 of crc_ref doing the same work.
+ *
+ *    Each recording is cut into temp buffer sized blocks in the captured layout (24-bit with the ADC header byte) and
+ *    stamped with CRCs every 4 and every 16 samples, and every block is checked the way the audio thread does it.
+ *    Throughput is raw bytes per second of CPU time on this host; "x realtime" is that over the rate the tag produces the
+ *    same layout at the recording's sample rate. It says nothing about the Cortex-M33, only about relative cost.
+ *
+ *    usage: crc_bench [recording.wav ...]   (a synthetic 4 channel 96kHz signal without any)
+ */
+
+#include "bench.h"
+#include "wav.h"
+#include "crc_ref.h"
+#include "Lib Inc/audio_crc.h"
+#include <string.h>
+
+//Synthetic input when no recording is given
+#define SYNTHETIC_CHANNELS 4
+#define SYNTHETIC_RATE 96000
+#define SYNTHETIC_SECONDS 20
+
+//Each measurement is repeated until it has run at least this long
+#define MIN_BENCH_SECONDS 0.5
+
+typedef struct {
+    const char *name;
+    int32_t *samples;   //interleaved, channels per frame
+    size_t frames;
+    uint8_t channels;
+    uint8_t bits;
+    uint32_t sample_rate;
+} Recording;
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static bool __load(Recording *self, const char *path){
+    WavFile wav;
+    if(!wav_open(&wav, path)){
+        return false;
+    }
+
+    int32_t *all = malloc((size_t)wav.frames * wav.channels * sizeof(int32_t));
+    *self = (Recording){
+        .name = path,
+        .channels = (wav.channels < AUDIO_CODEC_MAX_CHANNELS) ? wav.channels : AUDIO_CODEC_MAX_CHANNELS,
+        .bits = wav.bits,
+        .sample_rate = wav.sample_rate,
+    };
+    self->frames = wav_read(&wav, all, wav.frames);
+    wav_close(&wav);
+
+    //keep the first channels of every frame
+    self->samples = malloc(self->frames * self->channels * sizeof(int32_t));
+    for(size_t i = 0; i < self->frames; i++){
+        memcpy(&self->samples[i * self->channels], &all[i * wav.channels], self->channels * sizeof(int32_t));
+    }
+    free(all);
+    return true;
+}
+
+static void __synthesize(Recording *self){
+    *self = (Recording){
+        .name = "synthetic",
+        .frames = (size_t)SYNTHETIC_RATE * SYNTHETIC_SECONDS,
+        .channels = SYNTHETIC_CHANNELS,
+        .bits = 24,
+        .sample_rate = SYNTHETIC_RATE,
+    };
+    self->samples = malloc(self->frames * self->channels * sizeof(int32_t));
+    bench_signal(self->samples, self->frames, self->channels, self->bits, self->sample_rate, self->sample_rate / 2, 0);
+}
+
+/* the reference doing the checker's work: every group's CRC, a bit at a time. Returns the groups that didn't match */
+static uint32_t __reference_check(const AudioCodecFormat *fmt, uint8_t interval, const uint8_t *block, size_t frames){
+    uint32_t errors = 0;
+
+    for(uint8_t ch = 0; ch < fmt->channel_count; ch++){
+        uint8_t crc = AUDIO_CRC_SEED;
+        for(size_t frame = 0; frame < frames; frame++){
+            const uint8_t *slot = &block[(frame * fmt->channel_count + ch) * 4];
+            crc = crc_ref_crc8(crc, &slot[1], 3);
+            if((frame % interval) == (interval - 1u)){
+                errors += (crc != slot[0]);
+                crc = AUDIO_CRC_SEED;
+            }
+        }
+    }
+    return errors;
+}
+
+static void __bench(const Recording *rec, uint8_t interval){
+    AudioCodecFormat fmt = {rec->channels, 3, 1};
+    size_t frame_bytes = audio_codec_frame_bytes(&fmt);
+    size_t block_frames = BENCH_BLOCK_SIZE / frame_bytes;
+    size_t block_count = rec->frames / block_frames;
+    size_t block_len = block_frames * frame_bytes;
+    size_t raw_len = block_count * block_len;
+    uint8_t *raw = malloc(raw_len ? raw_len : 1);
+    CrcRefStream stream;
+    double start, check_s, reference_s;
+    unsigned check_runs = 0;
+    unsigned reference_runs = 0;
+
+    if(block_count == 0){
+        printf("%-24s shorter than a block\n", rec->name);
+        free(raw);
+        return;
+    }
+
+    //Groups start on the first frame, so the reference doesn't have to carry them over blocks
+    wav_to_block(&fmt, rec->samples, rec->bits, block_count * block_frames, raw);
+    crc_ref_init(&stream, interval, 0);
+    crc_ref_stamp(&stream, &fmt, raw, raw_len);
+
+    start = bench_now();
+    do{
+        AudioCrc crc;
+        audio_crc_init(&crc, &fmt, interval);
+        for(size_t b = 0; b < block_count; b++){
+            BENCH_CHECK(audio_crc_check(&crc, &raw[b * block_len], block_len, (uint32_t)b) == 0);
+        }
+        check_runs++;
+        check_s = bench_now() - start;
+    }while(check_s < MIN_BENCH_SECONDS);
+
+    start = bench_now();
+    do{
+        for(size_t b = 0; b < block_count; b++){
+            BENCH_CHECK(__reference_check(&fmt, interval, &raw[b * block_len], block_frames) == 0);
+        }
+        reference_runs++;
+        reference_s = bench_now() - start;
+    }while(reference_s < MIN_BENCH_SECONDS);
+
+    double realtime = (double)rec->sample_rate * frame_bytes;
+    double check_rate = (double)raw_len * check_runs / check_s;
+    double reference_rate = (double)raw_len * reference_runs / reference_s;
+    printf("%-24s %uch CRC every %2u  check %7.1f MB/s (x%.0f realtime)  bitwise %6.1f MB/s (x%.1f slower)\n", rec->name,
+           fmt.channel_count, interval, check_rate / 1e6, check_rate / realtime, reference_rate / 1e6, check_rate / reference_rate);
+
+    free(raw);
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+int main(int argc, char **argv){
+    int inputs = (argc > 1) ? (argc - 1) : 1;
+
+    for(int i = 0; i < inputs; i++){
+        Recording rec;
+        if(argc > 1){
+            if(!__load(&rec, argv[i + 1])){
+                bench_failures++;
+                continue;
+            }
+        }
+        else{
+            __synthesize(&rec);
+        }
+
+        __bench(&rec, 4);
+        __bench(&rec, AUDIO_CRC_INTERVAL_MAX);
+        free(rec.samples);
+    }
+    return bench_failures ? 1 : 0;
+}
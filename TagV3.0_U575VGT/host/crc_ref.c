@@ -0,0 +1,56 @@
+/*
+ * crc_ref.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    AD7768 interface CRC stand-in, see crc_ref.h
+ */
+
+#include "crc_ref.h"
+#include "Lib Inc/audio_crc.h"
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+uint8_t crc_ref_crc8(uint8_t crc, const uint8_t *data, size_t len){
+    for(size_t i = 0; i < len; i++){
+        crc ^= data[i];
+        for(int bit = 0; bit < 8; bit++){
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+void crc_ref_init(CrcRefStream *self, uint8_t interval, uint8_t phase){
+    *self = (CrcRefStream){
+        .interval = interval,
+        .sample = phase,
+    };
+    for(uint8_t ch = 0; ch < AUDIO_CODEC_MAX_CHANNELS; ch++){
+        self->crc[ch] = AUDIO_CRC_SEED;
+    }
+}
+
+void crc_ref_stamp(CrcRefStream *self, const AudioCodecFormat *fmt, uint8_t *block, size_t len){
+    size_t frames = len / audio_codec_frame_bytes(fmt);
+    size_t slot_bytes = fmt->header_bytes + fmt->sample_bytes;
+
+    for(size_t frame = 0; frame < frames; frame++, self->sample++){
+        uint8_t pos = (uint8_t)(self->sample % self->interval);
+
+        for(uint8_t ch = 0; ch < fmt->channel_count; ch++){
+            uint8_t *slot = &block[(frame * fmt->channel_count + ch) * slot_bytes];
+
+            if(pos == 0){
+                self->crc[ch] = AUDIO_CRC_SEED;
+            }
+            self->crc[ch] = crc_ref_crc8(self->crc[ch], &slot[1], 3);
+            if(pos == (self->interval - 1)){
+                slot[0] = self->crc[ch];
+            }
+        }
+    }
+}
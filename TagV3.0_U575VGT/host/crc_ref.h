@@ -0,0 +1,38 @@
+/*
+ * crc_ref.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Stand-in for the AD7768 with CRC_SELECT set, for the CRC checker (Lib Src/audio_crc.c): writes the interface CRCs
+ *    into raw blocks the way the ADC sends them, with a CRC-8 computed a bit at a time. The CRC test holds the checker
+ *    to it and the CRC benchmark feeds the checker blocks from it.
+ */
+
+#ifndef HOST_CRC_REF_H_
+#define HOST_CRC_REF_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Lib Inc/audio_codec.h"
+
+//One ADC's output since its last sync, carried across blocks
+typedef struct {
+    uint8_t interval;                           //samples per CRC, 4 or 16
+    uint64_t sample;                            //samples per channel since the sync
+    uint8_t crc[AUDIO_CODEC_MAX_CHANNELS];      //running CRC of each channel's group
+} CrcRefStream;
+
+/* CRC-8, x^8 + x^2 + x + 1 MSB first, a bit at a time */
+uint8_t crc_ref_crc8(uint8_t crc, const uint8_t *data, size_t len);
+
+/* start a stream, phase samples into its first group */
+void crc_ref_init(CrcRefStream *self, uint8_t interval, uint8_t phase);
+
+/*
+ * Desc: write the CRCs into a raw block of whole frames (24-bit with the header byte, see wav_to_block) that follows the
+ *       last one stamped: the header of the last sample of every group is replaced with the CRC of its group's data.
+ */
+void crc_ref_stamp(CrcRefStream *self, const AudioCodecFormat *fmt, uint8_t *block, size_t len);
+
+#endif /* HOST_CRC_REF_H_ */
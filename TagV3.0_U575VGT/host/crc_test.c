@@ -0,0 +1,159 @@
+/*
+ * crc_test.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Test of the AD7768 interface CRC checker (Lib Src/audio_crc.c) against blocks stamped by crc_ref.
+ *
+ *    The bitwise CRC-8 is checked against the published check value first, so the stand-in ADC is known to be right.
+ *    Then for both group sizes, every channel count and every phase the ADC can start at, the checker has to lock on
+ *    the first block and find no errors in a clean stream. A flipped data or CRC bit has to count exactly one group,
+ *    a dropped block must not count the groups it split, an ADC restarted at another phase has to unlock and lock
+ *    again, and blocks without CRCs must never lock.
+ *
+ *    usage: crc_test
+ */
+
+#include "bench.h"
+#include "wav.h"
+#include "crc_ref.h"
+#include "Lib Inc/audio_crc.h"
+#include <string.h>
+
+#define TEST_RATE 96000
+
+static int32_t samples[BENCH_BLOCK_SIZE];
+static uint8_t block[BENCH_BLOCK_SIZE];
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/* the next block of the signal in the captured layout, with its CRCs. Returns its length */
+static size_t __next_block(const AudioCodecFormat *fmt, CrcRefStream *stream, uint64_t *signal){
+    size_t frames = BENCH_BLOCK_SIZE / audio_codec_frame_bytes(fmt);
+
+    *signal = bench_signal(samples, frames, fmt->channel_count, 24, TEST_RATE, TEST_RATE / 4, *signal);
+    wav_to_block(fmt, samples, 24, frames, block);
+    crc_ref_stamp(stream, fmt, block, frames * audio_codec_frame_bytes(fmt));
+    return frames * audio_codec_frame_bytes(fmt);
+}
+
+static void __test_vectors(void){
+    //CRC-8/SMBUS (same polynomial, zero seed), then the ADC's seed
+    BENCH_CHECK(crc_ref_crc8(0x00, (const uint8_t *)"123456789", 9) == 0xF4);
+    BENCH_CHECK(crc_ref_crc8(0x00, NULL, 0) == 0x00);
+    BENCH_CHECK(crc_ref_crc8(AUDIO_CRC_SEED, (const uint8_t *)"\x00", 1) == 0xF3);
+}
+
+static void __test_clean(void){
+    for(uint8_t interval = 4; interval <= AUDIO_CRC_INTERVAL_MAX; interval *= 4){
+        for(uint8_t channels = 1; channels <= AUDIO_CODEC_MAX_CHANNELS; channels++){
+            for(uint8_t phase = 0; phase < interval; phase++){
+                AudioCodecFormat fmt = {channels, 3, 1};
+                CrcRefStream stream;
+                AudioCrc crc;
+                uint64_t signal = 0;
+
+                crc_ref_init(&stream, interval, phase);
+                BENCH_CHECK(audio_crc_init(&crc, &fmt, interval));
+                for(uint32_t sequence = 0; sequence < 3; sequence++){
+                    size_t len = __next_block(&fmt, &stream, &signal);
+                    BENCH_CHECK(audio_crc_check(&crc, block, len, sequence) == 0);
+                }
+                BENCH_CHECK(crc.locked && (crc.phase == phase));
+                BENCH_CHECK(crc.errors == 0);
+            }
+        }
+    }
+}
+
+static void __test_errors(void){
+    AudioCodecFormat fmt = {4, 3, 1};
+    size_t slot_bytes = fmt.header_bytes + fmt.sample_bytes;
+    CrcRefStream stream;
+    AudioCrc crc;
+    uint64_t signal = 0;
+    uint32_t sequence = 0;
+    size_t len;
+
+    crc_ref_init(&stream, AUDIO_CRC_INTERVAL_MAX, 5);
+    audio_crc_init(&crc, &fmt, AUDIO_CRC_INTERVAL_MAX);
+    len = __next_block(&fmt, &stream, &signal);
+    BENCH_CHECK(audio_crc_check(&crc, block, len, sequence++) == 0);
+
+    //a data bit on channel 2, then a CRC (frame 10 is the last of a group at phase 5) on channel 3
+    len = __next_block(&fmt, &stream, &signal);
+    block[(100 * fmt.channel_count + 2) * slot_bytes + 2] ^= 0x10;
+    BENCH_CHECK(audio_crc_check(&crc, block, len, sequence++) == 1);
+    len = __next_block(&fmt, &stream, &signal);
+    block[(10 * fmt.channel_count + 3) * slot_bytes] ^= 0x01;
+    BENCH_CHECK(audio_crc_check(&crc, block, len, sequence++) == 1);
+
+    //in the last frame, whose group is only finished by the next block
+    len = __next_block(&fmt, &stream, &signal);
+    block[len - 1] ^= 0x80;
+    BENCH_CHECK(audio_crc_check(&crc, block, len, sequence++) == 0);
+    len = __next_block(&fmt, &stream, &signal);
+    BENCH_CHECK(audio_crc_check(&crc, block, len, sequence++) == 1);
+    BENCH_CHECK(crc.errors == 3);
+
+    //a dropped block: the group split at the start of the next one isn't checked, the rest are
+    __next_block(&fmt, &stream, &signal);
+    sequence++;
+    len = __next_block(&fmt, &stream, &signal);
+    BENCH_CHECK(audio_crc_check(&crc, block, len, sequence++) == 0);
+    BENCH_CHECK(crc.locked && (crc.phase == 5));
+
+    //the ADC restarted at another phase: every group fails, the checker unlocks and finds the new phase on the next block
+    crc_ref_init(&stream, AUDIO_CRC_INTERVAL_MAX, 11);
+    len = __next_block(&fmt, &stream, &signal);
+    BENCH_CHECK(audio_crc_check(&crc, block, len, sequence++) > 0);
+    BENCH_CHECK(!crc.locked);
+    len = __next_block(&fmt, &stream, &signal);
+    BENCH_CHECK(audio_crc_check(&crc, block, len, sequence++) == 0);
+    BENCH_CHECK(crc.locked && (crc.phase == 11));
+}
+
+static void __test_no_crc(void){
+    AudioCodecFormat fmt = {4, 3, 1};
+    AudioCodecFormat no_header = {4, 3, 0};
+    AudioCodecFormat short_samples = {4, 2, 1};
+    AudioCrc crc;
+    uint64_t signal = 0;
+
+    BENCH_CHECK(!audio_crc_init(&crc, &no_header, 4));
+    BENCH_CHECK(!audio_crc_init(&crc, &short_samples, 4));
+    BENCH_CHECK(!audio_crc_init(&crc, &fmt, 8));
+
+    //status headers (what the ADC sends without CRC_SELECT) and noise in the headers never lock
+    size_t frames = BENCH_BLOCK_SIZE / audio_codec_frame_bytes(&fmt);
+    size_t len = frames * audio_codec_frame_bytes(&fmt);
+    audio_crc_init(&crc, &fmt, 4);
+    for(uint32_t sequence = 0; sequence < 4; sequence++){
+        signal = bench_signal(samples, frames, fmt.channel_count, 24, TEST_RATE, 0, signal);
+        wav_to_block(&fmt, samples, 24, frames, block);
+        if(sequence & 1){
+            for(size_t i = 0; i < frames * fmt.channel_count; i++){
+                block[i * 4] = (uint8_t)rand();
+            }
+        }
+        BENCH_CHECK(audio_crc_check(&crc, block, len, sequence) == AUDIO_CRC_UNLOCKED);
+    }
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+int main(int argc, char **argv){
+    srand(1);
+    __test_vectors();
+    __test_clean();
+    __test_errors();
+    __test_no_crc();
+
+    printf("crc_test: %s (%u failed checks)\n", bench_failures ? "FAIL" : "ok", bench_failures);
+    return bench_failures ? 1 : 0;
+}
@@ -0,0 +1,190 @@
+/*
+ * ltsa_test.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Test of the long-term spectral average (Lib Src/ltsa.c).
+ *
+ *    A tone centered on a bin has to read its level re full scale in that bin and leave the bins past the Hann main
+ *    lobe near the floor, one between two bins has to stay within the window's scalloping loss, and a channel must
+ *    never see another channel's tone. Segments loaded at any frame of a block, in both block layouts, have to give
+ *    the same spectrum, and taking an average has to report its segment count and start a new one.
+ *
+ *    usage: ltsa_test [-v]   (-v prints the measured levels)
+ */
+
+#include "bench.h"
+#include "wav.h"
+#include "Lib Inc/ltsa.h"
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#define TEST_RATE 96000
+#define TEST_SEGMENTS 8
+#define TEST_FRAMES (LTSA_FFT_SIZE * TEST_SEGMENTS)
+
+//The tone's bin has to read its level to within this (0.01 dB)
+#define TEST_LEVEL_TOLERANCE 5
+
+//A Hann window loses at most 1.42 dB halfway between bins
+#define TEST_SCALLOP_DB 1.5
+
+//Bins this far from the tone hold only leakage and quantization noise
+#define TEST_LEAKAGE_BINS 3
+#define TEST_LEAKAGE_DB -90.0
+
+static int32_t samples[TEST_FRAMES * AUDIO_CODEC_MAX_CHANNELS];
+static uint8_t raw[TEST_FRAMES * AUDIO_CODEC_MAX_CHANNELS * 4];
+static int16_t bins[LTSA_BINS];
+static Ltsa ltsa;
+static bool verbose;
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/* TEST_FRAMES of a tone per channel (bin[ch] in FFT bins, 0 for silence) at amplitude re full scale, random ADC headers */
+static void __tones(const AudioCodecFormat *fmt, const double *bin, double amplitude){
+    uint8_t bits = fmt->sample_bytes * 8;
+    double full_scale = (double)((1L << (bits - 1)) - 1);
+
+    for(size_t i = 0; i < TEST_FRAMES; i++){
+        for(uint8_t ch = 0; ch < fmt->channel_count; ch++){
+            double phase = 2.0 * M_PI * bin[ch] * i / LTSA_FFT_SIZE;
+            samples[i * fmt->channel_count + ch] = (bin[ch] != 0.0) ? (int32_t)lrint(amplitude * full_scale * sin(phase)) : 0;
+        }
+    }
+    wav_to_block(fmt, samples, bits, TEST_FRAMES, raw);
+    if(fmt->header_bytes){
+        for(size_t i = 0; i < TEST_FRAMES * fmt->channel_count; i++){
+            raw[i * (fmt->header_bytes + fmt->sample_bytes)] = (uint8_t)rand();
+        }
+    }
+}
+
+/* average every whole segment of a channel starting at first_frame into bins. Returns the segment count */
+static uint32_t __average(const AudioCodecFormat *fmt, uint8_t channel, size_t first_frame){
+    for(size_t frame = first_frame; (frame + LTSA_FFT_SIZE) <= TEST_FRAMES; frame += LTSA_FFT_SIZE){
+        ltsa_segment_load(&ltsa, raw, frame, channel);
+        ltsa_segment_accumulate(&ltsa, channel);
+    }
+    return ltsa_average_take(&ltsa, channel, bins);
+}
+
+/* highest bin at least TEST_LEAKAGE_BINS away from bin, in dB */
+static double __leakage_db(double bin){
+    int16_t worst = LTSA_DB_FLOOR;
+
+    for(size_t k = 0; k < LTSA_BINS; k++){
+        if(fabs((double)k - bin) >= TEST_LEAKAGE_BINS){
+            worst = (bins[k] > worst) ? bins[k] : worst;
+        }
+    }
+    return worst / 100.0;
+}
+
+static void __test_tones(void){
+    AudioCodecFormat formats[] = {
+        {4, 3, 1},
+        {2, 2, 0},
+    };
+    const double amplitudes[] = {0.5, 0.01};
+
+    for(size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++){
+        for(size_t a = 0; a < sizeof(amplitudes) / sizeof(amplitudes[0]); a++){
+            const double tone_bins[] = {10.0, 64.0, 200.0, 251.0};
+            int16_t level = (int16_t)lrint(2000.0 * log10(amplitudes[a]));
+
+            ltsa_init(&ltsa, &formats[f]);
+            __tones(&formats[f], tone_bins, amplitudes[a]);
+            for(uint8_t ch = 0; ch < formats[f].channel_count; ch++){
+                size_t k = (size_t)tone_bins[ch];
+
+                BENCH_CHECK(__average(&formats[f], ch, 0) == TEST_SEGMENTS);
+                BENCH_CHECK(abs(bins[k] - level) <= TEST_LEVEL_TOLERANCE);
+                BENCH_CHECK(__leakage_db(tone_bins[ch]) < TEST_LEAKAGE_DB);
+
+                //the other channels' tones aren't in this one
+                for(uint8_t other = 0; other < formats[f].channel_count; other++){
+                    if(other != ch){
+                        BENCH_CHECK((bins[(size_t)tone_bins[other]] / 100.0) < TEST_LEAKAGE_DB);
+                    }
+                }
+                if(verbose){
+                    printf("%u-bit %5.2f FS, ch %u bin %3zu: %+.2f dB (expected %+.2f), worst leakage %+.1f dB\n",
+                           formats[f].sample_bytes * 8, amplitudes[a], ch, k, bins[k] / 100.0, level / 100.0,
+                           __leakage_db(tone_bins[ch]));
+                }
+            }
+        }
+    }
+}
+
+/* halfway between two bins the level drops by the scalloping loss, split over the two */
+static void __test_between_bins(void){
+    AudioCodecFormat fmt = {1, 3, 1};
+    const double tone_bins[] = {100.5};
+
+    ltsa_init(&ltsa, &fmt);
+    __tones(&fmt, tone_bins, 0.5);
+    __average(&fmt, 0, 0);
+
+    double level = 20.0 * log10(0.5);
+    double low = bins[100] / 100.0;
+    double high = bins[101] / 100.0;
+    BENCH_CHECK((low > (level - TEST_SCALLOP_DB)) && (low < level));
+    BENCH_CHECK(fabs(low - high) < 0.05);
+    if(verbose){
+        printf("bin 100.5: %+.2f / %+.2f dB (tone %+.2f dB)\n", low, high, level);
+    }
+}
+
+/* segments started anywhere in a block give the same spectrum for a steady tone, and taking restarts the average */
+static void __test_segments(void){
+    AudioCodecFormat fmt = {4, 3, 1};
+    const double tone_bins[] = {32.0, 32.0, 32.0, 32.0};
+    int16_t aligned[LTSA_BINS];
+
+    ltsa_init(&ltsa, &fmt);
+    __tones(&fmt, tone_bins, 0.25);
+    BENCH_CHECK(__average(&fmt, 2, 0) == TEST_SEGMENTS);
+    memcpy(aligned, bins, sizeof(bins));
+
+    //a whole number of periods in, then not
+    BENCH_CHECK(__average(&fmt, 2, LTSA_FFT_SIZE / 32) == (TEST_SEGMENTS - 1));
+    BENCH_CHECK(abs(bins[32] - aligned[32]) <= 1);
+    BENCH_CHECK(__average(&fmt, 2, 333) == (TEST_SEGMENTS - 1));
+    BENCH_CHECK(abs(bins[32] - aligned[32]) <= 1);
+
+    //nothing since the last take
+    BENCH_CHECK(ltsa_average_take(&ltsa, 2, bins) == 0);
+    for(size_t k = 0; k < LTSA_BINS; k++){
+        BENCH_CHECK(bins[k] == LTSA_DB_FLOOR);
+    }
+
+    //silence reads as the floor, not as a huge negative number
+    const double silent[] = {0.0};
+    AudioCodecFormat mono = {1, 2, 0};
+    ltsa_init(&ltsa, &mono);
+    __tones(&mono, silent, 0.0);
+    BENCH_CHECK(__average(&mono, 0, 0) == TEST_SEGMENTS);
+    BENCH_CHECK((bins[0] == LTSA_DB_FLOOR) && (bins[LTSA_BINS - 1] == LTSA_DB_FLOOR));
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+int main(int argc, char **argv){
+    verbose = (getopt(argc, argv, "v") == 'v');
+    srand(1);
+
+    __test_tones();
+    __test_between_bins();
+    __test_segments();
+
+    printf("ltsa_test: %s (%u failed checks)\n", bench_failures ? "FAIL" : "ok", bench_failures);
+    return bench_failures ? 1 : 0;
+}
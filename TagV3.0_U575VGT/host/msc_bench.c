@@ -0,0 +1,261 @@
+/*
+ * msc_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Host benchmark of USB mass storage offload (USBX/App/ux_device_msc.c) against the simulated SD card (sim/sim_disk.h):
+ *    MB/s a host copying a file off the tag gets, with the read cache and without it.
+ *
+ *    A file is written to a freshly formatted image at full speed, then its sectors are read the way the USBX storage class
+ *    serves a host's READ(10) commands: each command is split into calls of the class's buffer size (-b blocks, 1 with
+ *    the tag's 512 byte UX_SLAVE_REQUEST_DATA_MAX_LENGTH), and every call's data goes over USB before the next call.
+ *      - direct: every call goes straight to the card (msc_sd_transfer, what USBD_STORAGE_Read did before the read cache)
+ *      - cached: through USBD_STORAGE_Read as it is now
+ *    Everything read is checked against the image.
+ *
+ *    The card time is the injected latency of its commands, USB time is the bytes over -u MB/s (full speed bulk tops out
+ *    around 1 MB/s), both simulated, so the numbers don't depend on this host. The card and USB don't overlap, on the tag
+ *    either: the gain shown is from the card commands saved.
+ *
+ *    ux_device_msc.c is included rather than linked so the direct case can call its msc_sd_transfer.
+ *
+ *    usage: msc_bench [-m MB] [-b blocks per call] [-u usb_mb_s] [-r request_us] [-R read_mb_s] [-i image]
+ *           (recordings given to make bench are ignored)
+ */
+
+#include "ux_device_msc.c"
+
+#include "bench.h"
+#include "sim.h"
+#include "sim_disk.h"
+#include "Lib Inc/extent_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define MSC_BENCH_DEFAULT_MB 16
+#define MSC_BENCH_DEFAULT_IMAGE "msc_bench.img"
+#define MSC_BENCH_IMAGE_MB 8192
+
+//The same card audio_sim defaults to
+#define MSC_BENCH_DEFAULT_REQUEST_US 300
+#define MSC_BENCH_DEFAULT_READ_MB_S 40
+#define MSC_BENCH_DEFAULT_USB_MB_S 1.0
+
+//FAT32 geometry of the image, as an SD card formatter would lay it out
+#define MSC_BENCH_SECTORS_PER_CLUSTER 64
+
+//The class's buffer, UX_SLAVE_REQUEST_DATA_MAX_LENGTH in USBX/App/ux_user.h
+#define MSC_BENCH_CLASS_BUFFER 512
+
+//Blocks in a host READ(10), 64kB like most hosts ask for
+#define MSC_BENCH_HOST_READ_BLOCKS 128
+
+//Simulated time runs this much faster, the numbers come from the injected latency
+#define MSC_BENCH_SPEED 1000.0
+
+typedef struct {
+    double card_seconds;
+    double usb_seconds;
+    uint32_t commands;
+    bool match;
+} MscBenchResult;
+
+/*********************
+ * FIRMWARE GLOBALS  *
+ *********************/
+
+//What main.c, app_filex.c, the FileX driver glue and the state machine define on the tag
+SD_HandleTypeDef hsd1;
+FX_MEDIA sdio_disk;
+TX_SEMAPHORE sd_rx_semaphore;
+TX_SEMAPHORE sd_tx_semaphore;
+TX_EVENT_FLAGS_GROUP state_machine_event_flags_group;
+
+/*********************
+ * PRIVATE VARIABLES *
+ *********************/
+
+static uint32_t msc_bench_media_memory[FX_SD_MEDIA_CACHE_SIZE / sizeof(uint32_t)];
+
+//The class's buffer and what the image holds, for the check
+static ALIGN_32BYTES (UCHAR msc_bench_usb[MSC_BENCH_HOST_READ_BLOCKS * STORAGE_BLK_SIZE]);
+static ALIGN_32BYTES (UCHAR msc_bench_expected[MSC_BENCH_HOST_READ_BLOCKS * STORAGE_BLK_SIZE]);
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static void __usage(const char *name){
+    fprintf(stderr, "usage: %s [-m MB] [-b blocks per call] [-u usb_mb_s] [-r request_us] [-R read_mb_s] [-i image]\n", name);
+}
+
+/* format the image, write a file of bytes on it and return its first sector (a fresh volume keeps it contiguous) */
+static bool __prepare(const char *image, uint64_t bytes, ULONG *first_sector){
+    ULONG sectors = (ULONG)(((uint64_t)MSC_BENCH_IMAGE_MB * 1024 * 1024) / STORAGE_BLK_SIZE);
+    FX_FILE file;
+    UINT fx_result;
+
+    if(!sim_disk_create(image, (uint64_t)MSC_BENCH_IMAGE_MB * 1024 * 1024)){
+        return false;
+    }
+    fx_result = fx_media_format(&sdio_disk, sim_disk_driver, NULL, (UCHAR *)msc_bench_media_memory,
+                                sizeof(msc_bench_media_memory), "TAG", 2, 512, 0, sectors, STORAGE_BLK_SIZE,
+                                MSC_BENCH_SECTORS_PER_CLUSTER, 1, 1);
+    if(fx_result == FX_SUCCESS){
+        fx_result = fx_media_open(&sdio_disk, "SD", sim_disk_driver, NULL, msc_bench_media_memory,
+                                  sizeof(msc_bench_media_memory));
+    }
+    if(fx_result == FX_SUCCESS){
+        fx_result = fx_file_create(&sdio_disk, "audio_00001.bin");
+    }
+    if(fx_result == FX_SUCCESS){
+        fx_result = fx_file_open(&sdio_disk, &file, "audio_00001.bin", FX_OPEN_FOR_WRITE);
+    }
+    for(uint64_t written = 0; (fx_result == FX_SUCCESS) && (written < bytes); written += sizeof(msc_bench_usb)){
+        for(size_t i = 0; i < sizeof(msc_bench_usb); i++){
+            msc_bench_usb[i] = (UCHAR)((written + i) * 2654435761u >> 24);
+        }
+        fx_result = fx_file_write(&file, msc_bench_usb, sizeof(msc_bench_usb));
+    }
+    //The direct case reads the file's sectors straight off the card
+    if((fx_result == FX_SUCCESS) && !extent_file_contiguous(&sdio_disk, &file, first_sector)){
+        fx_result = FX_SECTOR_INVALID;
+    }
+    if(fx_result == FX_SUCCESS){
+        fx_result = fx_file_close(&file);
+    }
+    if(fx_result == FX_SUCCESS){
+        fx_result = fx_media_flush(&sdio_disk);
+    }
+    if(fx_result != FX_SUCCESS){
+        fprintf(stderr, "msc_bench: can't prepare %s (FileX status 0x%02X)\n", image, fx_result);
+        return false;
+    }
+
+    hsd1.SdCard.LogBlockNbr = (uint32_t)sim_disk_size();
+    hsd1.SdCard.LogBlockSize = STORAGE_BLK_SIZE;
+    return true;
+}
+
+/* read blocks from first_sector on as the storage class does, either way */
+static bool __run(bool cached, ULONG first_sector, ULONG blocks, ULONG blocks_per_call, const SimDiskLatency *card,
+                  double usb_mb_s, MscBenchResult *result){
+    *result = (MscBenchResult){.match = true};
+
+    //Nothing left over from the last run
+    msc_read_cache_invalidate(0, USBD_STORAGE_GetMediaLastLba() + 1);
+    msc_read_next_lba = 0;
+
+    for(ULONG done = 0; done < blocks; done += MSC_BENCH_HOST_READ_BLOCKS){
+        ULONG lba = first_sector + done;
+        ULONG command_blocks = ((blocks - done) < MSC_BENCH_HOST_READ_BLOCKS) ? (blocks - done) : MSC_BENCH_HOST_READ_BLOCKS;
+
+        sim_disk_latency(card);
+        SimDiskStats start = sim_disk_stats();
+        for(ULONG call = 0; call < command_blocks; call += blocks_per_call){
+            ULONG n = ((command_blocks - call) < blocks_per_call) ? (command_blocks - call) : blocks_per_call;
+            UCHAR *data = &msc_bench_usb[call * STORAGE_BLK_SIZE];
+            ULONG media_status = 0;
+            UINT status = cached ? USBD_STORAGE_Read(NULL, 0, data, n, lba + call, &media_status)
+                                     : msc_sd_transfer(data, n, lba + call, false);
+            if(status != UX_SUCCESS){
+                fprintf(stderr, "msc_bench: read of %lu blocks at %lu failed\n", (unsigned long)n, (unsigned long)(lba + call));
+                return false;
+            }
+            result->usb_seconds += (double)n * STORAGE_BLK_SIZE / (usb_mb_s * 1e6);
+        }
+
+        SimDiskStats end = sim_disk_stats();
+        result->card_seconds += end.read_seconds - start.read_seconds;
+        result->commands += end.reads - start.reads;
+
+        //Checked against the image without any latency
+        sim_disk_latency(NULL);
+        if((sim_disk_command(lba, command_blocks, msc_bench_expected, false) != FX_SUCCESS)
+                || (memcmp(msc_bench_usb, msc_bench_expected, command_blocks * STORAGE_BLK_SIZE) != 0)){
+            result->match = false;
+        }
+    }
+    return true;
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+//The FileX driver glue's callbacks on the tag
+void HAL_SD_RxCpltCallback(SD_HandleTypeDef *hsd){
+    tx_semaphore_put(&sd_rx_semaphore);
+}
+
+void HAL_SD_TxCpltCallback(SD_HandleTypeDef *hsd){
+    tx_semaphore_put(&sd_tx_semaphore);
+}
+
+int main(int argc, char **argv){
+    const char *image = MSC_BENCH_DEFAULT_IMAGE;
+    uint64_t mb = MSC_BENCH_DEFAULT_MB;
+    ULONG blocks_per_call = MSC_BENCH_CLASS_BUFFER / STORAGE_BLK_SIZE;
+    double usb_mb_s = MSC_BENCH_DEFAULT_USB_MB_S;
+    SimDiskLatency card = {
+        .request_us = MSC_BENCH_DEFAULT_REQUEST_US,
+        .read_mb_s = MSC_BENCH_DEFAULT_READ_MB_S,
+        .seed = 1,
+    };
+    MscBenchResult results[2];
+    ULONG first_sector = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "m:b:u:r:R:i:")) != -1){
+        switch(opt){
+            case 'm': mb = strtoull(optarg, NULL, 0); break;
+            case 'b': blocks_per_call = strtoul(optarg, NULL, 0); break;
+            case 'u': usb_mb_s = atof(optarg); break;
+            case 'r': card.request_us = atof(optarg); break;
+            case 'R': card.read_mb_s = atof(optarg); break;
+            case 'i': image = optarg; break;
+            default: __usage(argv[0]); return 1;
+        }
+    }
+    if((blocks_per_call == 0) || (blocks_per_call > MSC_BENCH_HOST_READ_BLOCKS) || (usb_mb_s <= 0.0)){
+        __usage(argv[0]);
+        return 1;
+    }
+
+    fx_system_initialize();
+    sim_clock_start(MSC_BENCH_SPEED);
+    tx_semaphore_create(&sd_rx_semaphore, "sd rx transfer semaphore", 0);
+    tx_semaphore_create(&sd_tx_semaphore, "sd tx transfer semaphore", 0);
+    if(!__prepare(image, mb * 1024 * 1024, &first_sector)){
+        return 1;
+    }
+
+    ULONG blocks = (ULONG)(mb * 1024 * 1024 / STORAGE_BLK_SIZE);
+    printf("card: %.0f us per request, %.1f MB/s reads; USB %.2f MB/s; %lu MB in %u block reads, %lu block%s per call\n",
+           card.request_us, card.read_mb_s, usb_mb_s, (unsigned long)mb, MSC_BENCH_HOST_READ_BLOCKS,
+           (unsigned long)blocks_per_call, (blocks_per_call == 1) ? "" : "s");
+    printf("%-11s %9s %9s %9s %9s %7s\n", "reads", "card s", "USB s", "MB/s", "commands", "data");
+    for(int i = 0; i < 2; i++){
+        MscBenchResult *r = &results[i];
+        if(!__run(i == 1, first_sector, blocks, blocks_per_call, &card, usb_mb_s, r)){
+            return 1;
+        }
+        printf("%-11s %9.2f %9.2f %9.2f %9u %7s\n", (i == 1) ? "cached" : "direct", r->card_seconds, r->usb_seconds,
+               mb * 1024.0 * 1024.0 / 1e6 / (r->card_seconds + r->usb_seconds), r->commands, r->match ? "ok" : "BAD");
+        BENCH_CHECK(r->match);
+    }
+    fx_media_close(&sdio_disk);
+    sim_disk_close();
+    unlink(image);
+
+    double before = results[0].card_seconds + results[0].usb_seconds;
+    double after = results[1].card_seconds + results[1].usb_seconds;
+    printf("before -> after: %.2f -> %.2f MB/s (x%.2f)\n", mb * 1.048576 / before, mb * 1.048576 / after, before / after);
+    //Never slower than going straight to the card (to within the one extra command a run can end on)
+    BENCH_CHECK(after <= before * 1.01);
+
+    printf("msc_bench: %s (%u failed checks)\n", bench_failures ? "FAIL" : "ok", bench_failures);
+    return bench_failures ? 1 : 0;
+}
@@ -0,0 +1,341 @@
+/*
+ * offload_host.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Host end of the bulk offload protocol, see offload_host.h
+ */
+
+#include "offload_host.h"
+#include "Lib Inc/audio_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/* next frame header and its payload */
+static OffloadClientStatus __receive_frame(OffloadClient *self, OffloadFrame *frame){
+    const OffloadTransport *transport = self->transport;
+
+    if(!transport->receive(transport->context, self->header, OFFLOAD_FRAME_HEADER_SIZE)){
+        return OFFLOAD_CLIENT_LINK;
+    }
+    if(!offload_frame_unpack(frame, self->header) || (frame->length > sizeof(self->payload))){
+        return OFFLOAD_CLIENT_PROTOCOL;
+    }
+    if((frame->length != 0) && !transport->receive(transport->context, self->payload, frame->length)){
+        return OFFLOAD_CLIENT_LINK;
+    }
+    self->wire_bytes += OFFLOAD_FRAME_HEADER_SIZE + frame->length;
+    return OFFLOAD_CLIENT_OK;
+}
+
+static OffloadClientStatus __send_request(OffloadClient *self, uint8_t command, uint8_t flags, uint64_t offset,
+                                          const char *name){
+    const OffloadTransport *transport = self->transport;
+    OffloadRequest request = {
+        .command = command,
+        .flags = flags,
+        .offset = offset,
+    };
+    uint8_t buf[OFFLOAD_REQUEST_SIZE];
+
+    if(name != NULL){
+        if(strlen(name) > OFFLOAD_NAME_LEN){
+            self->error = OFFLOAD_ERROR_NOT_FOUND;
+            return OFFLOAD_CLIENT_REFUSED;
+        }
+        strncpy(request.name, name, OFFLOAD_NAME_LEN);
+    }
+    offload_request_pack(&request, buf);
+    return transport->send(transport->context, buf, sizeof(buf)) ? OFFLOAD_CLIENT_OK : OFFLOAD_CLIENT_LINK;
+}
+
+/* the raw bytes of a DATA frame, checked against its CRC */
+static bool __unpack_data(OffloadClient *self, const OffloadFrame *frame){
+    size_t len = frame->length;
+
+    if(frame->raw_length > OFFLOAD_CHUNK_SIZE){
+        return false;
+    }
+    if(frame->flags & OFFLOAD_FLAG_COMPRESSED){
+        len = lz_block_decompress(self->payload, frame->length, self->raw, sizeof(self->raw));
+        self->compressed_frames++;
+    }
+    else if(len <= sizeof(self->raw)){
+        memcpy(self->raw, self->payload, len);
+    }
+    return (len == frame->raw_length) && (audio_file_crc32(0, self->raw, len) == frame->crc);
+}
+
+//Directory file source
+static bool __dir_next_entry(void *context, bool first, char *name, size_t name_len, uint64_t *size){
+    OffloadDirFiles *self = context;
+    char path[4096];
+    struct dirent *entry;
+    struct stat st;
+
+    if(first){
+        if(self->dir != NULL){
+            closedir(self->dir);
+        }
+        self->dir = opendir(self->path);
+    }
+    if(self->dir == NULL){
+        return false;
+    }
+    while((entry = readdir(self->dir)) != NULL){
+        snprintf(path, sizeof(path), "%s/%s", self->path, entry->d_name);
+        if((stat(path, &st) == 0) && S_ISREG(st.st_mode)){
+            snprintf(name, name_len, "%s", entry->d_name);
+            *size = (uint64_t)st.st_size;
+            return true;
+        }
+    }
+    closedir(self->dir);
+    self->dir = NULL;
+    return false;
+}
+
+static bool __dir_open(void *context, const char *name, uint64_t *size){
+    OffloadDirFiles *self = context;
+    char path[4096];
+    struct stat st;
+
+    //Only the directory's own files
+    if((name[0] == '\0') || (strchr(name, '/') != NULL) || (strcmp(name, ".") == 0) || (strcmp(name, "..") == 0)){
+        return false;
+    }
+    snprintf(path, sizeof(path), "%s/%s", self->path, name);
+    self->fd = open(path, O_RDONLY);
+    if(self->fd < 0){
+        return false;
+    }
+    if((fstat(self->fd, &st) != 0) || !S_ISREG(st.st_mode)){
+        close(self->fd);
+        self->fd = -1;
+        return false;
+    }
+    *size = (uint64_t)st.st_size;
+    return true;
+}
+
+static int32_t __dir_read(void *context, uint64_t offset, uint8_t *data, uint32_t len){
+    OffloadDirFiles *self = context;
+
+    return (int32_t)pread(self->fd, data, len, (off_t)offset);
+}
+
+static void __dir_close(void *context){
+    OffloadDirFiles *self = context;
+
+    if(self->fd >= 0){
+        close(self->fd);
+        self->fd = -1;
+    }
+}
+
+//Loopback link
+static bool __loopback_client_send(void *context, const uint8_t *data, uint32_t len){
+    OffloadLoopback *self = context;
+
+    if(len != OFFLOAD_REQUEST_SIZE){
+        return false;
+    }
+
+    //A new request starts on a clean link, like a reopened port
+    memcpy(self->request, data, len);
+    self->request_ready = true;
+    self->frames_len = 0;
+    self->frames_read = 0;
+    offload_serve(self->session);
+    return true;
+}
+
+static bool __loopback_client_receive(void *context, uint8_t *data, uint32_t len){
+    OffloadLoopback *self = context;
+
+    if(self->frames_len - self->frames_read < len){
+        return false;
+    }
+    memcpy(data, &self->frames[self->frames_read], len);
+    self->frames_read += len;
+    return true;
+}
+
+static bool __loopback_tag_receive(void *context, uint8_t *data, uint32_t len){
+    OffloadLoopback *self = context;
+
+    if(!self->request_ready || (len != OFFLOAD_REQUEST_SIZE)){
+        return false;
+    }
+    memcpy(data, self->request, len);
+    self->request_ready = false;
+    return true;
+}
+
+static bool __loopback_tag_send(void *context, const uint8_t *data, uint32_t len){
+    OffloadLoopback *self = context;
+
+    if(self->cut_after < len){
+        self->cut_after = 0;
+        return false;
+    }
+    self->cut_after -= len;
+
+    if(self->frames_len + len > self->frames_capacity){
+        size_t capacity = self->frames_capacity ? self->frames_capacity : (1 << 20);
+        while(self->frames_len + len > capacity){
+            capacity *= 2;
+        }
+        uint8_t *frames = realloc(self->frames, capacity);
+        if(frames == NULL){
+            return false;
+        }
+        self->frames = frames;
+        self->frames_capacity = capacity;
+    }
+    memcpy(&self->frames[self->frames_len], data, len);
+    self->frames_len += len;
+    return true;
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+void offload_client_init(OffloadClient *self, const OffloadTransport *transport){
+    memset(self, 0, sizeof(*self));
+    self->transport = transport;
+}
+
+OffloadClientStatus offload_client_list(OffloadClient *self, OffloadEntrySink sink, void *context, uint64_t *count){
+    OffloadClientStatus status = __send_request(self, OFFLOAD_COMMAND_LIST, 0, 0, NULL);
+    OffloadFrame frame;
+
+    while(status == OFFLOAD_CLIENT_OK){
+        status = __receive_frame(self, &frame);
+        if(status != OFFLOAD_CLIENT_OK){
+            break;
+        }
+        switch(frame.type){
+            case OFFLOAD_FRAME_ENTRY:
+                if((frame.length >= sizeof(self->raw))
+                        || (audio_file_crc32(0, self->payload, frame.length) != frame.crc)){
+                    return OFFLOAD_CLIENT_PROTOCOL;
+                }
+                memcpy(self->raw, self->payload, frame.length);
+                self->raw[frame.length] = '\0';
+                if((sink != NULL) && !sink(context, (const char *)self->raw, frame.offset)){
+                    return OFFLOAD_CLIENT_SINK;
+                }
+                break;
+
+            case OFFLOAD_FRAME_END:
+                *count = frame.offset;
+                return OFFLOAD_CLIENT_OK;
+
+            case OFFLOAD_FRAME_ERROR:
+                self->error = frame.raw_length;
+                return OFFLOAD_CLIENT_REFUSED;
+
+            default:
+                return OFFLOAD_CLIENT_PROTOCOL;
+        }
+    }
+    return status;
+}
+
+OffloadClientStatus offload_client_read(OffloadClient *self, const char *name, bool compress, uint64_t *offset,
+                                        uint64_t *size, OffloadDataSink sink, void *context){
+    OffloadClientStatus status = __send_request(self, OFFLOAD_COMMAND_READ, compress ? OFFLOAD_FLAG_COMPRESS : 0,
+                                                *offset, name);
+    OffloadFrame frame;
+
+    while(status == OFFLOAD_CLIENT_OK){
+        status = __receive_frame(self, &frame);
+        if(status != OFFLOAD_CLIENT_OK){
+            break;
+        }
+        switch(frame.type){
+            case OFFLOAD_FRAME_DATA:
+                if((frame.offset != *offset) || !__unpack_data(self, &frame)){
+                    return OFFLOAD_CLIENT_PROTOCOL;
+                }
+                if(!sink(context, frame.offset, self->raw, frame.raw_length)){
+                    return OFFLOAD_CLIENT_SINK;
+                }
+                *offset += frame.raw_length;
+                self->data_bytes += frame.raw_length;
+                break;
+
+            case OFFLOAD_FRAME_END:
+                *size = frame.offset;
+                return (*offset == frame.offset) ? OFFLOAD_CLIENT_OK : OFFLOAD_CLIENT_PROTOCOL;
+
+            case OFFLOAD_FRAME_ERROR:
+                self->error = frame.raw_length;
+                return OFFLOAD_CLIENT_REFUSED;
+
+            default:
+                return OFFLOAD_CLIENT_PROTOCOL;
+        }
+    }
+    return status;
+}
+
+const char *offload_client_status_str(OffloadClientStatus status){
+    switch(status){
+        case OFFLOAD_CLIENT_OK: return "ok";
+        case OFFLOAD_CLIENT_LINK: return "link down";
+        case OFFLOAD_CLIENT_PROTOCOL: return "bad frame";
+        case OFFLOAD_CLIENT_REFUSED: return "refused by the tag";
+        case OFFLOAD_CLIENT_SINK: return "can't store the data";
+        default: return "?";
+    }
+}
+
+void offload_dir_files_init(OffloadDirFiles *self, const char *path){
+    *self = (OffloadDirFiles){
+        .files = {
+            .context = self,
+            .next_entry = __dir_next_entry,
+            .open = __dir_open,
+            .read = __dir_read,
+            .close = __dir_close,
+        },
+        .path = path,
+        .fd = -1,
+    };
+}
+
+void offload_loopback_init(OffloadLoopback *self, OffloadSession *session){
+    *self = (OffloadLoopback){
+        .client = {
+            .context = self,
+            .receive = __loopback_client_receive,
+            .send = __loopback_client_send,
+        },
+        .tag = {
+            .context = self,
+            .receive = __loopback_tag_receive,
+            .send = __loopback_tag_send,
+        },
+        .session = session,
+        .cut_after = UINT64_MAX,
+    };
+}
+
+void offload_loopback_free(OffloadLoopback *self){
+    free(self->frames);
+    self->frames = NULL;
+    self->frames_capacity = 0;
+}
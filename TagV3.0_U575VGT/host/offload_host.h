@@ -0,0 +1,88 @@
+/*
+ * offload_host.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Host end of the bulk offload protocol (Lib Inc/offload.h), shared by offload_recv and offload_test:
+ *      - the client: sends requests and checks every frame that comes back (magic, CRC, offsets, decompression)
+ *      - a file source serving the plain files of a directory, so the tag's engine can run on the host
+ *      - a loopback link between a client and an engine in the same process, which can be cut after a number of bytes
+ *
+ *    A read is resumable: the client reports the offset up to which the file checked out, asking again from there picks
+ *    up where the link went down.
+ */
+
+#ifndef HOST_OFFLOAD_HOST_H_
+#define HOST_OFFLOAD_HOST_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "Lib Inc/offload.h"
+
+typedef enum {
+    OFFLOAD_CLIENT_OK,
+    OFFLOAD_CLIENT_LINK,        //the link went down (or stalled), ask again from the returned offset
+    OFFLOAD_CLIENT_PROTOCOL,    //a frame didn't check out, the link is out of step and has to be reopened
+    OFFLOAD_CLIENT_REFUSED,     //the tag answered with an ERROR frame (OffloadClient.error)
+    OFFLOAD_CLIENT_SINK,        //the caller's sink failed
+} OffloadClientStatus;
+
+typedef struct {
+    const OffloadTransport *transport;
+    OffloadError error;             //of the last ERROR frame
+    uint64_t wire_bytes;            //bytes received, frame headers included
+    uint64_t data_bytes;            //file bytes received & checked
+    uint32_t compressed_frames;
+    uint8_t header[OFFLOAD_FRAME_HEADER_SIZE];
+    uint8_t payload[LZ_BLOCK_BOUND(OFFLOAD_CHUNK_SIZE)];
+    uint8_t raw[OFFLOAD_CHUNK_SIZE];
+} OffloadClient;
+
+//Called for every file a LIST returns, and every checked chunk a READ returns (in order, no gaps)
+typedef bool (*OffloadEntrySink)(void *context, const char *name, uint64_t size);
+typedef bool (*OffloadDataSink)(void *context, uint64_t offset, const uint8_t *data, uint32_t len);
+
+void offload_client_init(OffloadClient *self, const OffloadTransport *transport);
+
+/* list the tag's files, count is the number the tag said it sent */
+OffloadClientStatus offload_client_list(OffloadClient *self, OffloadEntrySink sink, void *context, uint64_t *count);
+
+/*
+ * Desc: read name from *offset to the end. *offset follows the data that checked out, and size is the file's size once
+ *       the END frame arrives (OFFLOAD_CLIENT_OK).
+ */
+OffloadClientStatus offload_client_read(OffloadClient *self, const char *name, bool compress, uint64_t *offset,
+                                        uint64_t *size, OffloadDataSink sink, void *context);
+
+const char *offload_client_status_str(OffloadClientStatus status);
+
+//Plain files of one directory as an offload file source
+typedef struct {
+    OffloadFiles files;     //hand this to offload_init
+    const char *path;
+    void *dir;
+    int fd;
+} OffloadDirFiles;
+
+void offload_dir_files_init(OffloadDirFiles *self, const char *path);
+
+//Loopback link: the client's request is served by the engine straight away and its frames queued for the client
+typedef struct {
+    OffloadTransport client;    //hand this to offload_client_init
+    OffloadTransport tag;       //hand this to offload_init
+    OffloadSession *session;
+    uint8_t request[OFFLOAD_REQUEST_SIZE];
+    bool request_ready;
+    uint8_t *frames;
+    size_t frames_len;
+    size_t frames_capacity;
+    size_t frames_read;
+    uint64_t cut_after;         //bytes the tag can still send before the link drops, UINT64_MAX = never
+} OffloadLoopback;
+
+void offload_loopback_init(OffloadLoopback *self, OffloadSession *session);
+void offload_loopback_free(OffloadLoopback *self);
+
+#endif /* HOST_OFFLOAD_HOST_H_ */
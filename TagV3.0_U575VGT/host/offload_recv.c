@@ -0,0 +1,361 @@
+/*
+ * offload_recv.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Host receiver for the bulk offload protocol (Lib Inc/offload.h): lists the tag's files or downloads them over a
+ *    serial port, which is how the tag's USB CDC port will show up once it has one (see offload.h). Until then -L is the
+ *    only end it talks to.
+ *
+ *    A download picks up from the size of the local copy, so running it again after the link dropped (or the tag was
+ *    undocked) only fetches what is missing. A dropped link is reopened and the read resumed, up to -r times in a row.
+ *
+ *    usage: offload_recv [-b baud] [-z] [-a] [-o dir] [-r retries] device [file...]
+ *           offload_recv -L dir [-z] [-a] [-o dir] [file...]
+ *           without files it lists what the tag has, -a downloads all of it
+ *           -z asks the tag to compress (worth it for the IMU/ECG logs, audio is already compressed)
+ *           -L serves dir with the tag's own engine over a loopback link instead of a port, to try the tool out
+ */
+
+#include "offload_host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define RECV_DEFAULT_BAUD 921600
+#define RECV_DEFAULT_RETRIES 5
+
+//Longest silence in the middle of a frame before the link is taken as down
+#define RECV_TIMEOUT_MS 3000
+
+#define RECV_MAX_FILES 1024
+
+typedef struct {
+    const char *device;
+    int fd;
+    speed_t speed;
+} SerialLink;
+
+typedef struct {
+    char name[OFFLOAD_NAME_LEN + 1];
+    uint64_t size;
+} RecvEntry;
+
+typedef struct {
+    RecvEntry entries[RECV_MAX_FILES];
+    size_t count;
+} RecvList;
+
+/*********************
+ * PRIVATE VARIABLES *
+ *********************/
+
+static OffloadClient client;
+static RecvList listing;
+
+//Loopback (-L)
+static OffloadSession loopback_session;
+static OffloadLoopback loopback;
+static OffloadDirFiles loopback_files;
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static void __usage(const char *name){
+    fprintf(stderr, "usage: %s [-b baud] [-z] [-a] [-o dir] [-r retries] device [file...]\n"
+                    "       %s -L dir [-z] [-a] [-o dir] [file...]\n", name, name);
+}
+
+static double __now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+static bool __baud(long baud, speed_t *speed){
+    static const struct { long baud; speed_t speed; } rates[] = {
+        {9600, B9600}, {19200, B19200}, {38400, B38400}, {57600, B57600}, {115200, B115200},
+        {230400, B230400}, {460800, B460800}, {921600, B921600},
+    };
+
+    for(size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++){
+        if(rates[i].baud == baud){
+            *speed = rates[i].speed;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void __serial_close(SerialLink *self){
+    if(self->fd >= 0){
+        close(self->fd);
+        self->fd = -1;
+    }
+}
+
+/* open the port raw, dropping anything left over from before */
+static bool __serial_open(SerialLink *self){
+    struct termios tio;
+
+    __serial_close(self);
+    self->fd = open(self->device, O_RDWR | O_NOCTTY);
+    if(self->fd < 0){
+        perror(self->device);
+        return false;
+    }
+    if(tcgetattr(self->fd, &tio) == 0){
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, self->speed);
+        cfsetospeed(&tio, self->speed);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(self->fd, TCSANOW, &tio);
+    }
+    tcflush(self->fd, TCIOFLUSH);
+    return true;
+}
+
+static bool __serial_receive(void *context, uint8_t *data, uint32_t len){
+    SerialLink *self = context;
+    struct pollfd pfd = {.fd = self->fd, .events = POLLIN};
+
+    while(len > 0){
+        int ready = poll(&pfd, 1, RECV_TIMEOUT_MS);
+        if((ready < 0) && (errno == EINTR)){
+            continue;
+        }
+        if(ready <= 0){
+            return false;
+        }
+        ssize_t got = read(self->fd, data, len);
+        if(got <= 0){
+            return false;
+        }
+        data += got;
+        len -= (uint32_t)got;
+    }
+    return true;
+}
+
+static bool __serial_send(void *context, const uint8_t *data, uint32_t len){
+    SerialLink *self = context;
+
+    //Anything still coming in belongs to a request that was given up on
+    tcflush(self->fd, TCIFLUSH);
+    while(len > 0){
+        ssize_t sent = write(self->fd, data, len);
+        if(sent < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            return false;
+        }
+        data += sent;
+        len -= (uint32_t)sent;
+    }
+    return tcdrain(self->fd) == 0;
+}
+
+static bool __list_sink(void *context, const char *name, uint64_t size){
+    RecvList *list = context;
+
+    if((list->count >= RECV_MAX_FILES) || (strlen(name) > OFFLOAD_NAME_LEN)){
+        fprintf(stderr, "offload_recv: skipping %s\n", name);
+        return true;
+    }
+    snprintf(list->entries[list->count].name, sizeof(list->entries[0].name), "%s", name);
+    list->entries[list->count].size = size;
+    list->count++;
+    return true;
+}
+
+static bool __file_sink(void *context, uint64_t offset, const uint8_t *data, uint32_t len){
+    int fd = *(int *)context;
+
+    return pwrite(fd, data, len, (off_t)offset) == (ssize_t)len;
+}
+
+/* (re)open the link, a serial port or the loopback */
+static bool __reopen(SerialLink *serial){
+    return (serial == NULL) || __serial_open(serial);
+}
+
+/* download one file into dir, resuming from the local copy */
+static bool __fetch(SerialLink *serial, const char *dir, const char *name, bool compress, int retries){
+    char path[4096];
+    struct stat st;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    OffloadClientStatus status;
+    int failures = 0;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    int fd = open(path, O_WRONLY | O_CREAT, 0644);
+    if((fd < 0) || (fstat(fd, &st) != 0)){
+        perror(path);
+        return false;
+    }
+    offset = (uint64_t)st.st_size;
+
+    uint64_t start = offset;
+    uint64_t wire_start = client.wire_bytes;
+    uint32_t compressed_start = client.compressed_frames;
+    double t0 = __now();
+    for(;;){
+        uint64_t before = offset;
+
+        status = offload_client_read(&client, name, compress, &offset, &size, __file_sink, &fd);
+
+        //A local copy longer than the tag's is out of date, start it again
+        if((status == OFFLOAD_CLIENT_REFUSED) && (client.error == OFFLOAD_ERROR_OFFSET) && (offset != 0)){
+            if(ftruncate(fd, 0) != 0){
+                break;
+            }
+            offset = start = 0;
+            continue;
+        }
+        if((status != OFFLOAD_CLIENT_LINK) && (status != OFFLOAD_CLIENT_PROTOCOL)){
+            break;
+        }
+
+        //Progress resets the retries, the link only has to stay up long enough for some of it each time
+        failures = (offset > before) ? 1 : failures + 1;
+        if(failures > retries){
+            break;
+        }
+        fprintf(stderr, "%s: %s at %lu, retrying\n", name, offload_client_status_str(status), (unsigned long)offset);
+        sleep(1);
+        if(!__reopen(serial)){
+            break;
+        }
+    }
+    double seconds = __now() - t0;
+
+    if((status == OFFLOAD_CLIENT_OK) && (ftruncate(fd, (off_t)size) != 0)){
+        status = OFFLOAD_CLIENT_SINK;
+    }
+    close(fd);
+
+    if(status != OFFLOAD_CLIENT_OK){
+        fprintf(stderr, "%s: %s at %lu", name, offload_client_status_str(status), (unsigned long)offset);
+        if(status == OFFLOAD_CLIENT_REFUSED){
+            fprintf(stderr, " (error %d)", client.error);
+        }
+        fprintf(stderr, "\n");
+        return false;
+    }
+
+    uint64_t fetched = offset - start;
+    uint64_t wire = client.wire_bytes - wire_start;
+    printf("%s: %lu bytes", name, (unsigned long)size);
+    if(start != 0){
+        printf(" (resumed at %lu)", (unsigned long)start);
+    }
+    printf(", %lu fetched in %.1f s, %.1f kB/s", (unsigned long)fetched, seconds,
+           (seconds > 0.0) ? fetched / 1024.0 / seconds : 0.0);
+    if(compress && fetched){
+        printf(", %.0f%% on the wire (%u compressed chunks)", 100.0 * wire / fetched, client.compressed_frames - compressed_start);
+    }
+    printf("\n");
+    return true;
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+int main(int argc, char **argv){
+    SerialLink serial = {.fd = -1};
+    SerialLink *link = NULL;
+    const char *loopback_dir = NULL;
+    const char *out_dir = ".";
+    long baud = RECV_DEFAULT_BAUD;
+    int retries = RECV_DEFAULT_RETRIES;
+    bool compress = false;
+    bool all = false;
+    OffloadTransport transport;
+    int opt;
+
+    while((opt = getopt(argc, argv, "b:zao:r:L:")) != -1){
+        switch(opt){
+            case 'b': baud = strtol(optarg, NULL, 0); break;
+            case 'z': compress = true; break;
+            case 'a': all = true; break;
+            case 'o': out_dir = optarg; break;
+            case 'r': retries = atoi(optarg); break;
+            case 'L': loopback_dir = optarg; break;
+            default: __usage(argv[0]); return 1;
+        }
+    }
+
+    if(loopback_dir != NULL){
+        offload_dir_files_init(&loopback_files, loopback_dir);
+        offload_loopback_init(&loopback, &loopback_session);
+        offload_init(&loopback_session, &loopback.tag, &loopback_files.files);
+        transport = loopback.client;
+    }
+    else{
+        if(optind >= argc){
+            __usage(argv[0]);
+            return 1;
+        }
+        serial.device = argv[optind++];
+        if(!__baud(baud, &serial.speed)){
+            fprintf(stderr, "offload_recv: unsupported baud rate %ld\n", baud);
+            return 1;
+        }
+        if(!__serial_open(&serial)){
+            return 1;
+        }
+        link = &serial;
+        transport = (OffloadTransport){
+            .context = &serial,
+            .receive = __serial_receive,
+            .send = __serial_send,
+        };
+    }
+    offload_client_init(&client, &transport);
+
+    int failed = 0;
+    if((optind < argc) && !all){
+        for(int i = optind; i < argc; i++){
+            failed += !__fetch(link, out_dir, argv[i], compress, retries);
+        }
+    }
+    else{
+        uint64_t count = 0;
+        OffloadClientStatus status = offload_client_list(&client, __list_sink, &listing, &count);
+        if(status != OFFLOAD_CLIENT_OK){
+            fprintf(stderr, "offload_recv: list failed, %s\n", offload_client_status_str(status));
+            return 1;
+        }
+        for(size_t i = 0; i < listing.count; i++){
+            if(all){
+                failed += !__fetch(link, out_dir, listing.entries[i].name, compress, retries);
+            }
+            else{
+                printf("%12lu  %s\n", (unsigned long)listing.entries[i].size, listing.entries[i].name);
+            }
+        }
+        if(!all){
+            printf("%lu files\n", (unsigned long)count);
+        }
+    }
+
+    __serial_close(&serial);
+    if(loopback_dir != NULL){
+        offload_loopback_free(&loopback);
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,304 @@
+/*
+ * offload_test.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Test of the bulk offload protocol (Lib Src/offload.c) and its LZ block codec (Lib Src/lz_block.c), against the host
+ *    client over a loopback link (offload_host.h), serving a directory of plain files.
+ *
+ *    The codec has to give back every block it compressed, fail cleanly when the output doesn't fit, and never write past
+ *    the output when decompressing garbage. Every file has to come back whole, raw and compressed, including after the
+ *    link is cut again and again and the read resumed from the last offset that checked out. Bad requests, missing files
+ *    and offsets past the end have to be refused with the right error.
+ */
+
+#include "bench.h"
+#include "offload_host.h"
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define TEST_CUT_BYTES 20000
+#define TEST_MAX_ATTEMPTS 100
+#define TEST_CODEC_TRIALS 2000
+
+typedef struct {
+    const char *name;
+    size_t size;
+    bool compressible;
+    uint8_t *data;
+} TestFile;
+
+static TestFile test_files[] = {
+    {"imu_0001.bin", 100000, true, NULL},
+    {"ecg_0001.bin", 54321, false, NULL},
+    {"empty.csv", 0, false, NULL},
+    {"exact.bin", 2 * OFFLOAD_CHUNK_SIZE, true, NULL},
+};
+#define TEST_FILE_COUNT (sizeof(test_files) / sizeof(test_files[0]))
+
+static char test_dir[] = "/tmp/offload_test.XXXXXX";
+static OffloadSession session;
+static OffloadClient client;
+static LzBlockTable lz_table;
+
+//Received file
+typedef struct {
+    uint8_t *data;
+    size_t capacity;
+} TestImage;
+
+static uint8_t codec_src[LZ_BLOCK_MAX_INPUT];
+static uint8_t codec_dst[LZ_BLOCK_BOUND(LZ_BLOCK_MAX_INPUT)];
+static uint8_t codec_back[LZ_BLOCK_MAX_INPUT + 64];
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/* fixed size records with slowly moving fields, like the IMU log, or noise */
+static void __fill(uint8_t *data, size_t len, bool compressible){
+    for(size_t i = 0; i < len; i++){
+        if(compressible){
+            data[i] = ((i % 24) < 16) ? (uint8_t)(i / 24 / 64) : (uint8_t)(rand() & 0x03);
+        }
+        else{
+            data[i] = (uint8_t)rand();
+        }
+    }
+}
+
+static void __make_files(void){
+    char path[256];
+
+    BENCH_CHECK(mkdtemp(test_dir) != NULL);
+    for(size_t i = 0; i < TEST_FILE_COUNT; i++){
+        TestFile *file = &test_files[i];
+
+        file->data = malloc(file->size + 1);
+        __fill(file->data, file->size, file->compressible);
+
+        snprintf(path, sizeof(path), "%s/%s", test_dir, file->name);
+        FILE *out = fopen(path, "wb");
+        BENCH_CHECK((out != NULL) && (fwrite(file->data, 1, file->size, out) == file->size));
+        fclose(out);
+    }
+
+    //Directories aren't offered
+    snprintf(path, sizeof(path), "%s/subdir", test_dir);
+    mkdir(path, 0755);
+}
+
+static void __remove_files(void){
+    char path[256];
+
+    for(size_t i = 0; i < TEST_FILE_COUNT; i++){
+        snprintf(path, sizeof(path), "%s/%s", test_dir, test_files[i].name);
+        unlink(path);
+        free(test_files[i].data);
+    }
+    snprintf(path, sizeof(path), "%s/subdir", test_dir);
+    rmdir(path);
+    rmdir(test_dir);
+}
+
+static void __test_codec(void){
+    uint32_t failures = bench_failures;
+
+    for(int trial = 0; trial < TEST_CODEC_TRIALS; trial++){
+        size_t len = (trial < 64) ? (size_t)trial : (size_t)(rand() % (LZ_BLOCK_MAX_INPUT + 1));
+
+        //noise, records, zeros, and noisy copies of what came just before
+        for(size_t i = 0; i < len; i++){
+            switch(trial % 4){
+                case 0: codec_src[i] = (uint8_t)rand(); break;
+                case 1: codec_src[i] = ((i % 11) < 6) ? (uint8_t)(i / 11) : (uint8_t)(rand() & 0x03); break;
+                case 2: codec_src[i] = 0; break;
+                default: codec_src[i] = ((rand() % 8) == 0) || (i < 20) ? (uint8_t)rand() : codec_src[i - 11 - (rand() % 3)]; break;
+            }
+        }
+
+        size_t packed = lz_block_compress(&lz_table, codec_src, len, codec_dst, sizeof(codec_dst));
+        BENCH_CHECK((packed != 0) || (len == 0));
+        BENCH_CHECK(packed <= LZ_BLOCK_BOUND(len));
+        if(len != 0){
+            size_t unpacked = lz_block_decompress(codec_dst, packed, codec_back, LZ_BLOCK_MAX_INPUT);
+            BENCH_CHECK((unpacked == len) && (memcmp(codec_src, codec_back, len) == 0));
+        }
+    }
+
+    //Output that doesn't fit is refused, not overrun
+    __fill(codec_src, 1000, false);
+    for(size_t capacity = 0; capacity < 200; capacity++){
+        BENCH_CHECK(lz_block_compress(&lz_table, codec_src, 1000, codec_dst, capacity) == 0);
+    }
+
+    //Garbage never writes past the output
+    for(int trial = 0; trial < TEST_CODEC_TRIALS; trial++){
+        size_t len = 1 + (rand() % 512);
+        size_t capacity = rand() % 4096;
+
+        __fill(codec_dst, len, false);
+        memset(codec_back, 0xA5, sizeof(codec_back));
+        size_t unpacked = lz_block_decompress(codec_dst, len, codec_back, capacity);
+        BENCH_CHECK(unpacked <= capacity);
+        BENCH_CHECK((codec_back[capacity] == 0xA5) && (codec_back[capacity + 63] == 0xA5));
+    }
+
+    printf("lz block codec: %d blocks round tripped, %s\n", TEST_CODEC_TRIALS, (bench_failures == failures) ? "ok" : "FAIL");
+}
+
+static bool __entry_sink(void *context, const char *name, uint64_t size){
+    uint32_t *found = context;
+
+    for(size_t i = 0; i < TEST_FILE_COUNT; i++){
+        if(strcmp(name, test_files[i].name) == 0){
+            BENCH_CHECK(size == test_files[i].size);
+            *found |= 1u << i;
+            return true;
+        }
+    }
+    printf("unexpected entry %s\n", name);
+    bench_failures++;
+    return true;
+}
+
+static bool __data_sink(void *context, uint64_t offset, const uint8_t *data, uint32_t len){
+    TestImage *image = context;
+
+    if(offset + len > image->capacity){
+        return false;
+    }
+    memcpy(&image->data[offset], data, len);
+    return true;
+}
+
+static void __test_list(void){
+    uint32_t found = 0;
+    uint64_t count = 0;
+
+    BENCH_CHECK(offload_client_list(&client, __entry_sink, &found, &count) == OFFLOAD_CLIENT_OK);
+    BENCH_CHECK(count == TEST_FILE_COUNT);
+    BENCH_CHECK(found == (1u << TEST_FILE_COUNT) - 1);
+    printf("list: %lu files\n", (unsigned long)count);
+}
+
+/* read one file, from start, cutting the link after cut bytes every attempt (0 = never) */
+static void __test_read(OffloadLoopback *link, const TestFile *file, bool compress, uint64_t start, uint64_t cut){
+    TestImage image = {calloc(file->size + 1, 1), file->size};
+    OffloadClientStatus status;
+    uint64_t offset = start;
+    uint64_t size = 0;
+    int attempts = 0;
+
+    client.wire_bytes = 0;
+    client.compressed_frames = 0;
+    do{
+        link->cut_after = cut ? cut : UINT64_MAX;
+        status = offload_client_read(&client, file->name, compress, &offset, &size, __data_sink, &image);
+        attempts++;
+    }while((status == OFFLOAD_CLIENT_LINK) && (attempts < TEST_MAX_ATTEMPTS));
+    link->cut_after = UINT64_MAX;
+
+    BENCH_CHECK(status == OFFLOAD_CLIENT_OK);
+    BENCH_CHECK((offset == file->size) && (size == file->size));
+    BENCH_CHECK(memcmp(&image.data[start], &file->data[start], file->size - start) == 0);
+    if(cut && (file->size - start > cut)){
+        BENCH_CHECK(attempts > 1);
+    }
+    if(compress && file->compressible){
+        BENCH_CHECK(client.compressed_frames > 0);
+        BENCH_CHECK(client.wire_bytes < file->size);
+    }
+    if(!file->compressible){
+        BENCH_CHECK(client.compressed_frames == 0);
+    }
+
+    printf("read %-12s %s from %6lu: %6zu bytes in %7lu on the wire, %2d attempt(s)\n", file->name,
+           compress ? "compressed" : "raw       ", (unsigned long)start, file->size, (unsigned long)client.wire_bytes, attempts);
+    free(image.data);
+}
+
+static void __test_refused(OffloadLoopback *link){
+    TestImage image = {NULL, 0};
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    OffloadFrame frame;
+    uint8_t buf[OFFLOAD_REQUEST_SIZE];
+    OffloadRequest request = {.command = OFFLOAD_COMMAND_LIST};
+
+    BENCH_CHECK(offload_client_read(&client, "missing.bin", false, &offset, &size, __data_sink, &image) == OFFLOAD_CLIENT_REFUSED);
+    BENCH_CHECK(client.error == OFFLOAD_ERROR_NOT_FOUND);
+
+    BENCH_CHECK(offload_client_read(&client, "../offload_test", false, &offset, &size, __data_sink, &image) == OFFLOAD_CLIENT_REFUSED);
+    BENCH_CHECK(client.error == OFFLOAD_ERROR_NOT_FOUND);
+
+    offset = test_files[1].size + 1;
+    BENCH_CHECK(offload_client_read(&client, test_files[1].name, false, &offset, &size, __data_sink, &image) == OFFLOAD_CLIENT_REFUSED);
+    BENCH_CHECK(client.error == OFFLOAD_ERROR_OFFSET);
+
+    //A corrupted request, then an unknown command, straight down the link
+    offload_request_pack(&request, buf);
+    buf[5] ^= 0x01;
+    BENCH_CHECK(link->client.send(link, buf, sizeof(buf)));
+    BENCH_CHECK(link->client.receive(link, client.header, OFFLOAD_FRAME_HEADER_SIZE));
+    BENCH_CHECK(offload_frame_unpack(&frame, client.header));
+    BENCH_CHECK((frame.type == OFFLOAD_FRAME_ERROR) && (frame.raw_length == OFFLOAD_ERROR_REQUEST));
+
+    request.command = 0x7F;
+    offload_request_pack(&request, buf);
+    BENCH_CHECK(link->client.send(link, buf, sizeof(buf)));
+    BENCH_CHECK(link->client.receive(link, client.header, OFFLOAD_FRAME_HEADER_SIZE));
+    BENCH_CHECK(offload_frame_unpack(&frame, client.header));
+    BENCH_CHECK((frame.type == OFFLOAD_FRAME_ERROR) && (frame.raw_length == OFFLOAD_ERROR_REQUEST));
+
+    //Requests survive packing
+    OffloadRequest back;
+    request = (OffloadRequest){.command = OFFLOAD_COMMAND_READ, .flags = OFFLOAD_FLAG_COMPRESS, .offset = 0x123456789AULL};
+    strcpy(request.name, "audio_20261017_120000_0001.bin");
+    offload_request_pack(&request, buf);
+    BENCH_CHECK(offload_request_unpack(&back, buf));
+    BENCH_CHECK((back.command == request.command) && (back.flags == request.flags) && (back.offset == request.offset));
+    BENCH_CHECK(strcmp(back.name, request.name) == 0);
+
+    printf("refused: missing file, outside the directory, offset past the end, bad request, unknown command\n");
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+int main(void){
+    OffloadDirFiles files;
+    OffloadLoopback link;
+
+    srand(3);
+    __test_codec();
+    __make_files();
+
+    offload_dir_files_init(&files, test_dir);
+    offload_loopback_init(&link, &session);
+    offload_init(&session, &link.tag, &files.files);
+    offload_client_init(&client, &link.client);
+
+    __test_list();
+    for(size_t i = 0; i < TEST_FILE_COUNT; i++){
+        __test_read(&link, &test_files[i], false, 0, 0);
+        __test_read(&link, &test_files[i], true, 0, 0);
+    }
+
+    //Resumed after the link drops, and from the middle of a file
+    __test_read(&link, &test_files[0], true, 0, TEST_CUT_BYTES);
+    __test_read(&link, &test_files[1], false, 0, TEST_CUT_BYTES);
+    __test_read(&link, &test_files[1], true, 12345, 0);
+    __test_read(&link, &test_files[3], false, test_files[3].size, 0);
+
+    __test_refused(&link);
+
+    offload_loopback_free(&link);
+    __remove_files();
+
+    printf("offload_test: %s (%u failed checks)\n", bench_failures ? "FAIL" : "ok", bench_failures);
+    return bench_failures ? 1 : 0;
+}
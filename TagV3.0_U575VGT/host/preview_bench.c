@@ -0,0 +1,170 @@
+/*
+ * preview_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Benchmark of the preview decimator (Lib Src/preview.c): milliseconds of CPU per second of input, on this host and
+ *    estimated for the tag's Cortex-M33.
+ *
+ *    Each recording is cut into temp buffer sized blocks in the captured layout (24-bit with the ADC header byte) and
+ *    run through the decimator a block at a time, the way the audio thread does it. The host figure is CPU time on this
+ *    machine. The M33 figure is a cycle count of the same work from the model below (there is no target here to time it
+ *    on): taps, input samples and output samples per second of input, each at what its loop costs on an M33 at
+ *    BENCH_M33_HZ. It is an estimate for sizing, a DWT cycle count on a tag is what to trust.
+ *
+ *    usage: preview_bench [recording.wav ...]   (a synthetic 4 channel signal at every tag rate without any)
+ */
+
+#include "bench.h"
+#include "wav.h"
+#include "Lib Inc/preview.h"
+#include <string.h>
+
+//Synthetic input when no recording is given
+#define SYNTHETIC_CHANNELS 4
+#define SYNTHETIC_SECONDS 20
+
+//Each measurement is repeated until it has run at least this long
+#define MIN_BENCH_SECONDS 0.5
+
+//Core clock the tag runs at (SystemClock_Config)
+#define BENCH_M33_HZ 160000000.0
+
+//M33 cycle model of preview_process built with -O2 for FPv5 single precision, from the M33's instruction timings:
+//  per tap: two VLDR (back to back, 1 cycle each), VFMA (3, it waits on the last one's sum), loop count and branch (1)
+#define BENCH_M33_CYCLES_PER_TAP 6
+//  per input sample: 3 byte loads and the shifts to Q31, VCVT and VMUL to float, 2 VSTR to the history, wrap and countdown
+#define BENCH_M33_CYCLES_PER_INPUT 15
+//  per output sample: loop setup, lrintf (a newlib call), the clamp and the store
+#define BENCH_M33_CYCLES_PER_OUTPUT 30
+
+static const uint32_t synthetic_rates[] = {12000, 24000, 48000, 96000, 192000};
+
+typedef struct {
+    const char *name;
+    int32_t *samples;   //interleaved, channels per frame
+    size_t frames;
+    uint8_t channels;
+    uint8_t bits;
+    uint32_t sample_rate;
+} Recording;
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static bool __load(Recording *self, const char *path){
+    WavFile wav;
+    if(!wav_open(&wav, path)){
+        return false;
+    }
+
+    int32_t *all = malloc((size_t)wav.frames * wav.channels * sizeof(int32_t));
+    *self = (Recording){
+        .name = path,
+        .channels = (wav.channels < AUDIO_CODEC_MAX_CHANNELS) ? wav.channels : AUDIO_CODEC_MAX_CHANNELS,
+        .bits = wav.bits,
+        .sample_rate = wav.sample_rate,
+    };
+    self->frames = wav_read(&wav, all, wav.frames);
+    wav_close(&wav);
+
+    //keep the first channels of every frame
+    self->samples = malloc(self->frames * self->channels * sizeof(int32_t));
+    for(size_t i = 0; i < self->frames; i++){
+        memcpy(&self->samples[i * self->channels], &all[i * wav.channels], self->channels * sizeof(int32_t));
+    }
+    free(all);
+    return true;
+}
+
+static void __synthesize(Recording *self, uint32_t sample_rate){
+    *self = (Recording){
+        .name = "synthetic",
+        .frames = (size_t)sample_rate * SYNTHETIC_SECONDS,
+        .channels = SYNTHETIC_CHANNELS,
+        .bits = 24,
+        .sample_rate = sample_rate,
+    };
+    self->samples = malloc(self->frames * self->channels * sizeof(int32_t));
+    bench_signal(self->samples, self->frames, self->channels, self->bits, self->sample_rate, self->sample_rate / 2, 0);
+}
+
+static void __bench(const Recording *rec){
+    AudioCodecFormat fmt = {rec->channels, 3, 1};
+    size_t frame_bytes = audio_codec_frame_bytes(&fmt);
+    size_t block_frames = BENCH_BLOCK_SIZE / frame_bytes;
+    size_t raw_len = rec->frames * frame_bytes;
+    uint8_t *raw = malloc(raw_len);
+    PreviewDecimator *preview = malloc(sizeof(PreviewDecimator));
+    int16_t *out = malloc((block_frames + 1) * sizeof(int16_t));  //preview_output_max at the lowest decimation
+    size_t out_count = 0;
+    unsigned runs = 0;
+    double start, seconds;
+
+    if(!preview_init(preview, &fmt, 0, rec->sample_rate)){
+        printf("%-24s %6u Hz isn't a preview rate\n", rec->name, (unsigned)rec->sample_rate);
+        free(out);
+        free(preview);
+        free(raw);
+        return;
+    }
+    wav_to_block(&fmt, rec->samples, rec->bits, rec->frames, raw);
+
+    start = bench_now();
+    do{
+        preview_init(preview, &fmt, 0, rec->sample_rate);
+        out_count = 0;
+        for(size_t frame = 0; frame < rec->frames; frame += block_frames){
+            size_t frames = ((rec->frames - frame) < block_frames) ? (rec->frames - frame) : block_frames;
+            out_count += preview_process(preview, &raw[frame * frame_bytes], frames, out);
+        }
+        runs++;
+        seconds = bench_now() - start;
+    }while(seconds < MIN_BENCH_SECONDS);
+    BENCH_CHECK(out_count == (rec->frames / preview->decimation));
+
+    //Per second of input
+    double input_seconds = (double)rec->frames / rec->sample_rate;
+    double host_ms = 1000.0 * seconds / (runs * input_seconds);
+    double outputs = (double)PREVIEW_RATE_HZ;
+    double taps = outputs * preview->tap_count;
+    double m33_cycles = (taps * BENCH_M33_CYCLES_PER_TAP) + ((double)rec->sample_rate * BENCH_M33_CYCLES_PER_INPUT)
+                      + (outputs * BENCH_M33_CYCLES_PER_OUTPUT);
+
+    printf("%-24s %6u Hz  %3u taps  %5.2fM MAC/s  host %5.2f ms/s  M33 ~%5.1f ms/s (%4.1f%% at %.0f MHz)\n", rec->name,
+           (unsigned)rec->sample_rate, (unsigned)preview->tap_count, taps / 1e6, host_ms, 1000.0 * m33_cycles / BENCH_M33_HZ,
+           100.0 * m33_cycles / BENCH_M33_HZ, BENCH_M33_HZ / 1e6);
+
+    free(out);
+    free(preview);
+    free(raw);
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+int main(int argc, char **argv){
+    if(argc > 1){
+        for(int i = 1; i < argc; i++){
+            Recording rec;
+            if(!__load(&rec, argv[i])){
+                bench_failures++;
+                continue;
+            }
+            __bench(&rec);
+            free(rec.samples);
+        }
+    }
+    else{
+        for(size_t r = 0; r < sizeof(synthetic_rates) / sizeof(synthetic_rates[0]); r++){
+            Recording rec;
+            __synthesize(&rec, synthetic_rates[r]);
+            __bench(&rec);
+            free(rec.samples);
+        }
+    }
+    return bench_failures ? 1 : 0;
+}
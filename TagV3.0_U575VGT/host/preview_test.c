@@ -0,0 +1,195 @@
+/*
+ * preview_test.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Test of the preview decimator (Lib Src/preview.c).
+ *
+ *    Tones are run through it at every recording rate the tag has, in both block layouts, and the gain is measured on
+ *    the 12 kHz output once the filter has settled: flat through the passband, and anything from the stopband that would
+ *    alias into the output held down. Then the output has to be the same however the input is split into blocks, clip
+ *    rather than wrap at full scale, and the WAV header has to describe the samples behind it.
+ *
+ *    usage: preview_test [-v]   (-v prints the measured response)
+ */
+
+#include "bench.h"
+#include "wav.h"
+#include "Lib Inc/preview.h"
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+//Input tone amplitude, as a fraction of full scale
+#define TEST_AMPLITUDE 0.5
+
+#define TEST_SECONDS 0.5
+
+//Flat to within this up to TEST_PASSBAND_HZ
+#define TEST_PASSBAND_HZ 3000.0
+#define TEST_PASSBAND_RIPPLE_DB 0.2
+
+//Still this close at the top of the preview's useful band
+#define TEST_EDGE_HZ 4000.0
+#define TEST_EDGE_DB -2.0
+
+//Tones from here up (they alias to 5 kHz and below) have to be at least this far down
+#define TEST_STOPBAND_HZ 7000.0
+#define TEST_STOPBAND_DB -60.0
+
+static const uint32_t test_rates[] = {12000, 24000, 48000, 96000, 192000};
+
+//TEST_SECONDS at the highest rate
+#define TEST_FRAMES_MAX 96000
+
+static int32_t samples[TEST_FRAMES_MAX * AUDIO_CODEC_MAX_CHANNELS];
+static uint8_t raw[TEST_FRAMES_MAX * AUDIO_CODEC_MAX_CHANNELS * 4];
+static int16_t out[2][12000];
+static bool verbose;
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/* TEST_SECONDS of frames at rate: a tone at freq on the previewed channel (1) and its negative on the others */
+static size_t __tone(const AudioCodecFormat *fmt, uint32_t rate, double freq, double amplitude){
+    size_t frames = (size_t)(rate * TEST_SECONDS);
+    uint8_t bits = fmt->sample_bytes * 8;
+    double full_scale = (double)((1L << (bits - 1)) - 1);
+
+    for(size_t i = 0; i < frames; i++){
+        int32_t value = (int32_t)lrint(amplitude * full_scale * sin(2.0 * M_PI * freq * i / rate));
+        for(uint8_t ch = 0; ch < fmt->channel_count; ch++){
+            samples[i * fmt->channel_count + ch] = (ch == 1) ? value : -value;
+        }
+    }
+    wav_to_block(fmt, samples, bits, frames, raw);
+    return frames;
+}
+
+/* gain of the decimator at freq in dB, on the output's RMS after the filter has filled */
+static double __gain_db(const AudioCodecFormat *fmt, uint32_t rate, double freq){
+    PreviewDecimator preview;
+    size_t frames = __tone(fmt, rate, freq, TEST_AMPLITUDE);
+
+    BENCH_CHECK(preview_init(&preview, fmt, 1, rate));
+    size_t count = preview_process(&preview, raw, frames, out[0]);
+    size_t settled = PREVIEW_TAPS_PER_PHASE;
+    double sum = 0.0;
+
+    for(size_t i = settled; i < count; i++){
+        sum += (double)out[0][i] * out[0][i];
+    }
+    double rms = sqrt(sum / (count - settled));
+    return 20.0 * log10(rms / (TEST_AMPLITUDE * 32767.0 / sqrt(2.0)));
+}
+
+static void __test_response(void){
+    AudioCodecFormat formats[] = {
+        {4, 3, 1},
+        {2, 2, 0},
+    };
+
+    for(size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++){
+        for(size_t r = 0; r < sizeof(test_rates) / sizeof(test_rates[0]); r++){
+            uint32_t rate = test_rates[r];
+            double worst_stop = -INFINITY;
+
+            for(double freq = 250.0; freq <= TEST_PASSBAND_HZ; freq += 250.0){
+                double gain = __gain_db(&formats[f], rate, freq);
+                BENCH_CHECK(fabs(gain) < TEST_PASSBAND_RIPPLE_DB);
+            }
+            double edge = __gain_db(&formats[f], rate, TEST_EDGE_HZ);
+            BENCH_CHECK(edge > TEST_EDGE_DB);
+
+            for(double freq = TEST_STOPBAND_HZ; freq < (rate / 2.0); freq += 500.0){
+                double gain = __gain_db(&formats[f], rate, freq);
+                worst_stop = (gain > worst_stop) ? gain : worst_stop;
+            }
+            BENCH_CHECK(worst_stop < TEST_STOPBAND_DB);
+
+            if(verbose){
+                printf("%6u Hz %u-bit: 1 kHz %+.2f dB, 4 kHz %+.2f dB, 5 kHz %+.2f dB, worst above 7 kHz %+.1f dB\n", rate,
+                       formats[f].sample_bytes * 8, __gain_db(&formats[f], rate, 1000.0), edge,
+                       __gain_db(&formats[f], rate, 5000.0), worst_stop);
+            }
+        }
+    }
+}
+
+/* the same input split into blocks of odd sizes gives the same samples as one call */
+static void __test_blocks(void){
+    AudioCodecFormat fmt = {4, 3, 1};
+    PreviewDecimator whole;
+    PreviewDecimator split;
+    size_t frames = __tone(&fmt, 96000, 1234.0, TEST_AMPLITUDE);
+    size_t frame_bytes = audio_codec_frame_bytes(&fmt);
+    size_t whole_count;
+    size_t split_count = 0;
+
+    preview_init(&whole, &fmt, 1, 96000);
+    preview_init(&split, &fmt, 1, 96000);
+    whole_count = preview_process(&whole, raw, frames, out[0]);
+    BENCH_CHECK(whole_count == frames / 8);
+
+    for(size_t done = 0, len = 1; done < frames; done += len, len = (len * 7 + 3) % 997){
+        len = ((frames - done) < len) ? (frames - done) : len;
+        BENCH_CHECK((split_count + preview_output_max(&split, len)) <= (sizeof(out[1]) / sizeof(out[1][0])));
+        split_count += preview_process(&split, &raw[done * frame_bytes], len, &out[1][split_count]);
+    }
+    BENCH_CHECK(split_count == whole_count);
+    BENCH_CHECK(memcmp(out[0], out[1], whole_count * sizeof(int16_t)) == 0);
+}
+
+static void __test_limits(void){
+    AudioCodecFormat fmt = {4, 3, 1};
+    PreviewDecimator preview;
+
+    //unsupported rates and channels
+    BENCH_CHECK(!preview_init(&preview, &fmt, 1, 44100));
+    BENCH_CHECK(!preview_init(&preview, &fmt, 1, 6000));
+    BENCH_CHECK(!preview_init(&preview, &fmt, 1, 384000));
+    BENCH_CHECK(!preview_init(&preview, &fmt, 4, 96000));
+
+    //a full scale square overshoots in the filter, it has to clip at the 16-bit limits rather than wrap
+    size_t frames = __tone(&fmt, 96000, 500.0, 1.0);
+    for(size_t i = 0; i < frames * fmt.channel_count; i++){
+        samples[i] = (samples[i] >= 0) ? ((1 << 23) - 1) : -(1 << 23);
+    }
+    wav_to_block(&fmt, samples, 24, frames, raw);
+    preview_init(&preview, &fmt, 1, 96000);
+    size_t count = preview_process(&preview, raw, frames, out[0]);
+    int16_t high = 0;
+    int16_t low = 0;
+    for(size_t i = PREVIEW_TAPS_PER_PHASE; i < count; i++){
+        high = (out[0][i] > high) ? out[0][i] : high;
+        low = (out[0][i] < low) ? out[0][i] : low;
+    }
+    BENCH_CHECK((high == INT16_MAX) && (low == INT16_MIN));
+
+    //the header
+    uint8_t header[PREVIEW_WAV_HEADER_SIZE];
+    preview_wav_header(header, 24000);
+    BENCH_CHECK(memcmp(&header[0], "RIFF", 4) == 0);
+    BENCH_CHECK((header[4] | (header[5] << 8) | (header[6] << 16)) == (PREVIEW_WAV_HEADER_SIZE - 8 + 24000));
+    BENCH_CHECK(memcmp(&header[8], "WAVEfmt ", 8) == 0);
+    BENCH_CHECK((header[24] | (header[25] << 8)) == PREVIEW_RATE_HZ);
+    BENCH_CHECK(memcmp(&header[PREVIEW_WAV_HEADER_SIZE - 8], "data", 4) == 0);
+    BENCH_CHECK((header[PREVIEW_WAV_HEADER_SIZE - 4] | (header[PREVIEW_WAV_HEADER_SIZE - 3] << 8)) == 24000);
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+int main(int argc, char **argv){
+    verbose = (getopt(argc, argv, "v") == 'v');
+
+    __test_response();
+    __test_blocks();
+    __test_limits();
+
+    printf("preview_test: %s (%u failed checks)\n", bench_failures ? "FAIL" : "ok", bench_failures);
+    return bench_failures ? 1 : 0;
+}
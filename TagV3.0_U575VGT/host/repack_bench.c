@@ -0,0 +1,98 @@
+/*
+ * repack_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Host benchmark of audio_repack (Lib Src/audio_repack.c): MB/s of captured data through the plain C path, next to
+ *    the sample at a time reference (repack_ref.c) and a memcpy of the same block as the floor.
+ *
+ *    Blocks are temp buffer sized, 4 channels of 24-bit samples with the ADC header byte as the tag captures them for a
+ *    dithered 16-bit recording. The DSP extension path is only checked for equivalence on a host (repack_test), timing
+ *    its emulated intrinsics here would say nothing about the M33.
+ */
+
+#include "bench.h"
+#include "wav.h"
+#include "repack_ref.h"
+#include "Lib Inc/audio_repack.h"
+#include <string.h>
+
+//Each measurement is repeated until it has run at least this long
+#define MIN_BENCH_SECONDS 0.5
+
+static int32_t samples[BENCH_BLOCK_SIZE];
+static uint8_t src[BENCH_BLOCK_SIZE];
+static uint8_t dst[BENCH_BLOCK_SIZE];
+
+typedef enum {
+    RUN_MEMCPY,
+    RUN_REFERENCE,
+    RUN_REPACK,
+} BenchRun;
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static double __bench(BenchRun run, const AudioCodecFormat *in, const AudioCodecFormat *out, bool dither){
+    size_t len = (BENCH_BLOCK_SIZE / audio_codec_frame_bytes(in)) * audio_codec_frame_bytes(in);
+    AudioRepack repacker;
+    uint32_t seed = AUDIO_REPACK_SEED;
+    unsigned blocks = 0;
+    double start = bench_now();
+    double elapsed;
+
+    audio_repack_init(&repacker, in, out, dither);
+    do{
+        for(int i = 0; i < 100; i++){
+            if(run == RUN_MEMCPY){
+                memcpy(dst, src, len);
+            }
+            else if(run == RUN_REFERENCE){
+                repack_reference(in, out, repacker.dither, &seed, src, len, dst);
+            }
+            else{
+                audio_repack(&repacker, src, len, dst);
+            }
+            //keep the copies from being optimised out
+            __asm__ volatile("" : : "r"(dst) : "memory");
+        }
+        blocks += 100;
+        elapsed = bench_now() - start;
+    }while(elapsed < MIN_BENCH_SECONDS);
+
+    return (double)len * blocks / elapsed;
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+int main(void){
+    static const struct {
+        const char *name;
+        AudioCodecFormat out;
+        bool dither;
+    } cases[] = {
+        {"24+hdr -> 16 dithered", {4, 2, 0}, true},
+        {"24+hdr -> 16 rounded",  {4, 2, 0}, false},
+        {"24+hdr -> 16+hdr",      {4, 2, 1}, true},
+        {"24+hdr -> 24",          {4, 3, 0}, false},
+    };
+    AudioCodecFormat in = {4, 3, 1};
+    size_t frames = BENCH_BLOCK_SIZE / audio_codec_frame_bytes(&in);
+
+    bench_signal(samples, frames, in.channel_count, 24, 96000, 48000, 0);
+    wav_to_block(&in, samples, 24, frames, src);
+
+    double copy = __bench(RUN_MEMCPY, &in, &in, false);
+    printf("%-24s %8.1f MB/s\n", "memcpy", copy / 1e6);
+    for(size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++){
+        double reference = __bench(RUN_REFERENCE, &in, &cases[i].out, cases[i].dither);
+        double repack = __bench(RUN_REPACK, &in, &cases[i].out, cases[i].dither);
+        printf("%-24s %8.1f MB/s  (reference %7.1f MB/s, x%.1f)\n", cases[i].name, repack / 1e6, reference / 1e6,
+               repack / reference);
+    }
+    return 0;
+}
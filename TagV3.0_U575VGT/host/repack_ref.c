@@ -0,0 +1,59 @@
+/*
+ * repack_ref.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Reference for audio_repack, see repack_ref.h
+ */
+
+#include "repack_ref.h"
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+size_t repack_reference(const AudioCodecFormat *in, const AudioCodecFormat *out, bool dither, uint32_t *seed,
+                        const uint8_t *src, size_t src_len, uint8_t *dst){
+    size_t frames = src_len / audio_codec_frame_bytes(in);
+    uint8_t *start = dst;
+
+    for(size_t i = 0; i < frames * in->channel_count; i++){
+        uint8_t header = in->header_bytes ? *src++ : 0;
+        int64_t sample = (int8_t)*src++;
+
+        for(uint8_t b = 1; b < in->sample_bytes; b++){
+            sample = (sample * 256) + *src++;
+        }
+
+        if(out->sample_bytes < in->sample_bytes){
+            //work in 1/65536ths of an output LSB: a 24-bit LSB is 256 of them, the dither spans +-65535
+            int64_t noise = 0;
+            if(dither){
+                uint32_t x = *seed;
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                *seed = x;
+                noise = (int64_t)(x & 0xFFFF) + (int64_t)(x >> 16) - 0xFFFF;
+            }
+
+            int64_t scaled = (sample * 256) + noise + 32768;
+            if(scaled > INT32_MAX){
+                scaled = INT32_MAX;
+            }
+            else if(scaled < INT32_MIN){
+                scaled = INT32_MIN;
+            }
+            sample = (scaled - (((scaled % 65536) + 65536) % 65536)) / 65536;
+        }
+
+        if(out->header_bytes){
+            *dst++ = header;
+        }
+        for(int b = out->sample_bytes - 1; b >= 0; b--){
+            *dst++ = (uint8_t)(((uint64_t)sample >> (8 * b)) & 0xFF);
+        }
+    }
+    return (size_t)(dst - start);
+}
@@ -0,0 +1,28 @@
+/*
+ * repack_ref.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Reference for audio_repack (Lib Src/audio_repack.c): the same conversion written out one sample at a time with
+ *    64-bit arithmetic, the way it would be done without any care for speed. The repack test holds both of the
+ *    firmware's paths to it bit for bit, and the repack benchmark times them against it.
+ */
+
+#ifndef HOST_REPACK_REF_H_
+#define HOST_REPACK_REF_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "Lib Inc/audio_codec.h"
+
+/*
+ * Desc: repack src (whole frames of in) into dst as out. When 24-bit samples go to 16 bits they are rounded to nearest,
+ *       with TPDF dither from the xorshift32 generator in seed if dither is set (one value per sample, in order).
+ *       Returns the number of bytes written, dst must not overlap src.
+ */
+size_t repack_reference(const AudioCodecFormat *in, const AudioCodecFormat *out, bool dither, uint32_t *seed,
+                        const uint8_t *src, size_t src_len, uint8_t *dst);
+
+#endif /* HOST_REPACK_REF_H_ */
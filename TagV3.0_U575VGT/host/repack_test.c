@@ -0,0 +1,158 @@
+/*
+ * repack_test.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Bit-exact equivalence test of audio_repack (Lib Src/audio_repack.c) against the sample at a time reference
+ *    (repack_ref.c).
+ *
+ *    audio_repack.c is linked twice: once as the plain C path the host builds by default, and once with
+ *    __ARM_FEATURE_DSP set and the intrinsics emulated (arm/cmsis_compiler.h), renamed to audio_repack_dsp*. For every
+ *    layout pair the repacker accepts, with and without dither, both have to match the reference byte for byte on
+ *    random data (which saturates now and then), over runs of blocks (so the dither state carries over), with odd
+ *    sample counts, and in place.
+ */
+
+#include "bench.h"
+#include "repack_ref.h"
+#include "Lib Inc/audio_repack.h"
+#include <string.h>
+
+//audio_repack.c built with the DSP path (see the Makefile)
+bool audio_repack_dsp_init(AudioRepack *self, const AudioCodecFormat *in, const AudioCodecFormat *out, bool dither);
+size_t audio_repack_dsp_len(const AudioRepack *self, size_t src_len);
+size_t audio_repack_dsp(AudioRepack *self, const uint8_t *src, size_t src_len, uint8_t *dst);
+
+#define TEST_BLOCKS 8
+
+typedef struct {
+    const char *name;
+    bool (*init)(AudioRepack *self, const AudioCodecFormat *in, const AudioCodecFormat *out, bool dither);
+    size_t (*len)(const AudioRepack *self, size_t src_len);
+    size_t (*repack)(AudioRepack *self, const uint8_t *src, size_t src_len, uint8_t *dst);
+} RepackPath;
+
+static const RepackPath paths[] = {
+    {"c",   audio_repack_init,     audio_repack_len,     audio_repack},
+    {"dsp", audio_repack_dsp_init, audio_repack_dsp_len, audio_repack_dsp},
+};
+
+static uint8_t src[BENCH_BLOCK_SIZE];
+static uint8_t expected[BENCH_BLOCK_SIZE];
+static uint8_t actual[BENCH_BLOCK_SIZE];
+static uint8_t in_place[BENCH_BLOCK_SIZE];
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+/* random samples, a quarter of them pushed to the edge of full scale so rounding saturates */
+static void __fill(size_t len){
+    for(size_t i = 0; i < len; i++){
+        src[i] = (uint8_t)rand();
+    }
+    for(size_t i = 0; i + 3 < len; i += 4){
+        if((rand() & 3) == 0){
+            src[i] = (rand() & 1) ? 0x7F : 0x80;
+            src[i + 1] = (src[i] == 0x7F) ? 0xFF : 0x00;
+        }
+    }
+}
+
+static void __test_pair(const AudioCodecFormat *in, const AudioCodecFormat *out, bool dither, size_t frames){
+    size_t len = frames * audio_codec_frame_bytes(in);
+
+    for(size_t p = 0; p < sizeof(paths) / sizeof(paths[0]); p++){
+        AudioRepack repacker;
+        AudioRepack in_place_repacker;
+        uint32_t seed = AUDIO_REPACK_SEED;
+        unsigned failures = bench_failures;
+
+        BENCH_CHECK(paths[p].init(&repacker, in, out, dither));
+        in_place_repacker = repacker;
+        srand(frames);
+
+        for(int block = 0; block < TEST_BLOCKS; block++){
+            size_t expected_len;
+
+            __fill(len);
+            //dither only applies when samples are cut to 16 bits
+            expected_len = repack_reference(in, out, dither && (out->sample_bytes < in->sample_bytes), &seed, src, len, expected);
+
+            BENCH_CHECK(paths[p].len(&repacker, len) == expected_len);
+            BENCH_CHECK(paths[p].repack(&repacker, src, len, actual) == expected_len);
+            BENCH_CHECK(memcmp(actual, expected, expected_len) == 0);
+
+            memcpy(in_place, src, len);
+            BENCH_CHECK(paths[p].repack(&in_place_repacker, in_place, len, in_place) == expected_len);
+            BENCH_CHECK(memcmp(in_place, expected, expected_len) == 0);
+        }
+
+        if(failures != bench_failures){
+            printf("%s: %uch %u+%u -> %u+%u%s, %zu frames: FAIL\n", paths[p].name, in->channel_count, in->header_bytes,
+                   in->sample_bytes, out->header_bytes, out->sample_bytes, dither ? " dither" : "", frames);
+        }
+    }
+}
+
+static void __test_layouts(void){
+    static const size_t frame_counts[] = {1, 2, 3, 7, 1001};
+    unsigned pairs = 0;
+
+    for(uint8_t channels = 1; channels <= AUDIO_CODEC_MAX_CHANNELS; channels++){
+        for(uint8_t in_sample = 2; in_sample <= 3; in_sample++){
+            for(uint8_t in_header = 0; in_header <= 1; in_header++){
+                for(uint8_t out_sample = 2; out_sample <= in_sample; out_sample++){
+                    for(uint8_t out_header = 0; out_header <= in_header; out_header++){
+                        AudioCodecFormat in = {channels, in_sample, in_header};
+                        AudioCodecFormat out = {channels, out_sample, out_header};
+
+                        for(int dither = 0; dither <= 1; dither++){
+                            for(size_t f = 0; f < sizeof(frame_counts) / sizeof(frame_counts[0]); f++){
+                                __test_pair(&in, &out, dither, frame_counts[f]);
+                            }
+                            //a whole temp buffer block
+                            __test_pair(&in, &out, dither, BENCH_BLOCK_SIZE / audio_codec_frame_bytes(&in));
+                            pairs++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    printf("%u layout/dither combinations, %zu paths\n", pairs, sizeof(paths) / sizeof(paths[0]));
+}
+
+static void __test_invalid(void){
+    AudioRepack repacker;
+    AudioCodecFormat in = {2, 3, 1};
+    AudioCodecFormat more_channels = {3, 2, 0};
+    AudioCodecFormat wider = {2, 3, 1};
+    AudioCodecFormat narrow_in = {2, 2, 0};
+    AudioCodecFormat header_out = {2, 2, 1};
+    AudioCodecFormat too_many = {5, 3, 1};
+
+    for(size_t p = 0; p < sizeof(paths) / sizeof(paths[0]); p++){
+        BENCH_CHECK(!paths[p].init(&repacker, &in, &more_channels, false));
+        BENCH_CHECK(!paths[p].init(&repacker, &narrow_in, &wider, false));
+        BENCH_CHECK(!paths[p].init(&repacker, &narrow_in, &header_out, false));
+        BENCH_CHECK(!paths[p].init(&repacker, &too_many, &too_many, false));
+
+        //dither is dropped when nothing is cut
+        BENCH_CHECK(paths[p].init(&repacker, &in, &in, true));
+        BENCH_CHECK(!repacker.dither);
+    }
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+int main(void){
+    __test_layouts();
+    __test_invalid();
+
+    printf("repack_test: %s (%u failed checks)\n", bench_failures ? "FAIL" : "ok", bench_failures);
+    return bench_failures ? 1 : 0;
+}
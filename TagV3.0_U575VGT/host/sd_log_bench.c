@@ -0,0 +1,274 @@
+/*
+ * sd_log_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Host benchmark of small-record logging (the IMU and ECG streams) through FileX against the simulated SD card
+ *    (sim/sim_disk.h): how much card time a MB of records costs, with and without the multi-sector media cache and the
+ *    aligned, sector-multiple batches (FX_SD_MEDIA_CACHE_SECTORS, IMU_SD_BATCH_SIZE/ECG_SD_BATCH_SIZE).
+ *
+ *    Both streams write their half buffers in turn to their own file through the storage thread (Lib Src/storage.c), as
+ *    BNO08x_SD.c and ECG_SD.c do. Every combination of the two changes is run on a freshly formatted image:
+ *      - media cache of 1 sector (what app_filex.c had) or FX_SD_MEDIA_CACHE_SECTORS
+ *      - half buffers written straight through from the sensor arrays (11 and 3 byte records, so FileX writes the
+ *        partial sectors through its cache and the whole ones from an unaligned address, a sector at a time), copied
+ *        into batches at any address (as before FX_SD_BUFFER_ALIGN), or into the streams' aligned batches
+ *    Before the aligned cache change the tag ran the 1 sector cache with unaligned batches, after it the last row.
+ *
+ *    The card time is the injected latency the requests added up to (simulated, so it doesn't depend on this host),
+ *    throughput is the records' bytes over that. Card requests and sectors read are what FileX's read-modify-write and
+ *    FAT/directory traffic cost.
+ *
+ *    usage: sd_log_bench [-m MB per stream] [-r request_us] [-w write_mb_s] [-i image]
+ *           (recordings given to make bench are ignored, the records are synthetic)
+ */
+
+#include "bench.h"
+#include "sim.h"
+#include "sim_disk.h"
+#include "Lib Inc/storage.h"
+#include <string.h>
+#include <unistd.h>
+
+#define LOG_DEFAULT_MB 4
+#define LOG_DEFAULT_IMAGE "sd_log_bench.img"
+#define LOG_IMAGE_MB 8192
+
+//The same card audio_sim defaults to
+#define LOG_DEFAULT_REQUEST_US 300
+#define LOG_DEFAULT_WRITE_MB_S 20
+#define LOG_DEFAULT_READ_MB_S 40
+
+//FAT32 geometry of the image, as an SD card formatter would lay it out
+#define LOG_SECTOR_SIZE 512
+#define LOG_SECTORS_PER_CLUSTER 64
+
+//Simulated time runs this much faster, the numbers come from the injected latency
+#define LOG_SPEED 1000.0
+
+//The sensor headers need the MCU's, so their layouts are repeated here: IMU_Data and ECG_Data records, the half
+//buffers (IMU_HALF_BUFFER_SIZE, ECG_HALF_BUFFER_SIZE) and the batches (IMU_SD_BATCH_SIZE, ECG_SD_BATCH_SIZE)
+#define LOG_IMU_RECORD_SIZE 11
+#define LOG_ECG_RECORD_SIZE 3
+#define LOG_IMU_HALF_RECORDS 125
+#define LOG_ECG_HALF_RECORDS 500
+#define LOG_IMU_BATCH_SIZE (8 * 1024)
+#define LOG_ECG_BATCH_SIZE (8 * 1024)
+
+#define LOG_IMU_HALF_SIZE (LOG_IMU_RECORD_SIZE * LOG_IMU_HALF_RECORDS)
+#define LOG_ECG_HALF_SIZE (LOG_ECG_RECORD_SIZE * LOG_ECG_HALF_RECORDS)
+
+typedef enum {
+    LOG_DIRECT,
+    LOG_BATCHED_UNALIGNED,
+    LOG_BATCHED,
+} LogWrites;
+
+typedef struct {
+    ULONG cache_sectors;
+    LogWrites writes;
+} LogCase;
+
+typedef struct {
+    double card_seconds;
+    double host_seconds;
+    uint64_t bytes;
+    SimDiskStats disk;
+} LogResult;
+
+/*********************
+ * PRIVATE VARIABLES *
+ *********************/
+
+static FX_MEDIA log_media;
+static uint32_t log_media_memory[FX_SD_MEDIA_CACHE_SECTORS * LOG_SECTOR_SIZE / sizeof(uint32_t)];
+
+//The sensors' double buffers, as BNO08x.c and ECG.c declare them
+static uint8_t log_imu_data[2][LOG_IMU_HALF_SIZE];
+static uint8_t log_ecg_data[2][LOG_ECG_HALF_SIZE];
+
+//One byte longer, to be used from an odd address too
+static uint8_t log_imu_batch[LOG_IMU_BATCH_SIZE + 1] __attribute__((aligned(FX_SD_BUFFER_ALIGN)));
+static uint8_t log_ecg_batch[LOG_ECG_BATCH_SIZE + 1] __attribute__((aligned(FX_SD_BUFFER_ALIGN)));
+
+static const char *log_writes_names[] = {"direct", "odd batch", "batched"};
+
+static TX_THREAD log_storage_thread;
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static void __usage(const char *name){
+    fprintf(stderr, "usage: %s [-m MB per stream] [-r request_us] [-w write_mb_s] [-i image]\n", name);
+}
+
+/* format the image and open it with a media cache of cache_sectors */
+static bool __mount(const char *image, ULONG cache_sectors){
+    ULONG sectors = (ULONG)(((uint64_t)LOG_IMAGE_MB * 1024 * 1024) / LOG_SECTOR_SIZE);
+    UINT fx_result;
+
+    sim_disk_latency(NULL);
+    if(!sim_disk_create(image, (uint64_t)LOG_IMAGE_MB * 1024 * 1024)){
+        return false;
+    }
+    fx_result = fx_media_format(&log_media, sim_disk_driver, NULL, (UCHAR *)log_media_memory, sizeof(log_media_memory),
+                                "TAG", 2, 512, 0, sectors, LOG_SECTOR_SIZE, LOG_SECTORS_PER_CLUSTER, 1, 1);
+    if(fx_result == FX_SUCCESS){
+        fx_result = fx_media_open(&log_media, "SD", sim_disk_driver, NULL, log_media_memory, cache_sectors * LOG_SECTOR_SIZE);
+    }
+    if(fx_result != FX_SUCCESS){
+        fprintf(stderr, "sd_log_bench: can't format %s (FileX status 0x%02X)\n", image, fx_result);
+        return false;
+    }
+    return true;
+}
+
+static bool __open(FX_FILE *file, CHAR *name){
+    return (fx_file_create(&log_media, name) == FX_SUCCESS)
+            && (fx_file_open(&log_media, file, name, FX_OPEN_FOR_WRITE) == FX_SUCCESS);
+}
+
+/* log bytes_per_stream of each stream the way the sensor SD threads do, timing the card */
+static bool __run(const LogCase *test, const char *image, const SimDiskLatency *card, uint64_t bytes_per_stream,
+                  LogResult *result){
+    StorageStream imu_storage, ecg_storage;
+    FX_FILE imu_file, ecg_file;
+    uint64_t imu_bytes = 0, ecg_bytes = 0;
+    int half = 0;
+
+    if(!__mount(image, test->cache_sectors)){
+        return false;
+    }
+    size_t skew = (test->writes == LOG_BATCHED_UNALIGNED) ? 1 : 0;
+    bool batched = (test->writes != LOG_DIRECT);
+
+    storage_stream_init(&imu_storage, "IMU Storage", batched ? &log_imu_batch[skew] : NULL, LOG_IMU_BATCH_SIZE, false);
+    storage_stream_init(&ecg_storage, "ECG Storage", batched ? &log_ecg_batch[skew] : NULL, LOG_ECG_BATCH_SIZE, false);
+
+    //Files created at full speed, only the logging is timed
+    if(!__open(&imu_file, "imu_test.bin") || !__open(&ecg_file, "ecg_test.bin")){
+        return false;
+    }
+    sim_disk_latency(card);
+    sim_disk_stats_reset();
+    double t0 = bench_now();
+
+    //The ECG fills its half buffers faster, whichever is behind writes next
+    while((imu_bytes < bytes_per_stream) || (ecg_bytes < bytes_per_stream)){
+        UINT status;
+        if((imu_bytes <= ecg_bytes) && (imu_bytes < bytes_per_stream)){
+            status = storage_write(&imu_storage, &imu_file, log_imu_data[half], LOG_IMU_HALF_SIZE);
+            imu_bytes += LOG_IMU_HALF_SIZE;
+        }
+        else{
+            status = storage_write(&ecg_storage, &ecg_file, log_ecg_data[half], LOG_ECG_HALF_SIZE);
+            ecg_bytes += LOG_ECG_HALF_SIZE;
+        }
+        if(status != FX_SUCCESS){
+            fprintf(stderr, "sd_log_bench: write failed (FileX status 0x%02X)\n", status);
+            return false;
+        }
+        half ^= 1;
+    }
+    if((storage_flush(&imu_storage, &imu_file) != FX_SUCCESS) || (storage_flush(&ecg_storage, &ecg_file) != FX_SUCCESS)
+            || (fx_file_close(&imu_file) != FX_SUCCESS) || (fx_file_close(&ecg_file) != FX_SUCCESS)
+            || (fx_media_flush(&log_media) != FX_SUCCESS)){
+        fprintf(stderr, "sd_log_bench: can't close the files\n");
+        return false;
+    }
+
+    result->host_seconds = bench_now() - t0;
+    result->disk = sim_disk_stats();
+    result->card_seconds = result->disk.read_seconds + result->disk.write_seconds;
+    result->bytes = imu_bytes + ecg_bytes;
+
+    sim_disk_latency(NULL);
+    fx_media_close(&log_media);
+    sim_disk_close();
+    storage_stream_delete(&imu_storage);
+    storage_stream_delete(&ecg_storage);
+    return true;
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+void Error_Handler(void){
+    fprintf(stderr, "sd_log_bench: Error_Handler called\n");
+    exit(2);
+}
+
+int main(int argc, char **argv){
+    const char *image = LOG_DEFAULT_IMAGE;
+    uint64_t mb = LOG_DEFAULT_MB;
+    SimDiskLatency card = {
+        .request_us = LOG_DEFAULT_REQUEST_US,
+        .write_mb_s = LOG_DEFAULT_WRITE_MB_S,
+        .read_mb_s = LOG_DEFAULT_READ_MB_S,
+        .seed = 1,
+    };
+    static const LogCase cases[] = {
+        {1, LOG_DIRECT},
+        {FX_SD_MEDIA_CACHE_SECTORS, LOG_DIRECT},
+        {1, LOG_BATCHED_UNALIGNED},
+        {FX_SD_MEDIA_CACHE_SECTORS, LOG_BATCHED_UNALIGNED},
+        {1, LOG_BATCHED},
+        {FX_SD_MEDIA_CACHE_SECTORS, LOG_BATCHED},
+    };
+    LogResult results[sizeof(cases) / sizeof(cases[0])];
+    int opt;
+
+    while((opt = getopt(argc, argv, "m:r:w:i:")) != -1){
+        switch(opt){
+            case 'm': mb = strtoull(optarg, NULL, 0); break;
+            case 'r': card.request_us = atof(optarg); break;
+            case 'w': card.write_mb_s = atof(optarg); break;
+            case 'i': image = optarg; break;
+            default: __usage(argv[0]); return 1;
+        }
+    }
+
+    //Something to write, the card doesn't care what
+    for(size_t i = 0; i < sizeof(log_imu_data); i++){
+        log_imu_data[i / LOG_IMU_HALF_SIZE][i % LOG_IMU_HALF_SIZE] = (uint8_t)(i * 7);
+    }
+    for(size_t i = 0; i < sizeof(log_ecg_data); i++){
+        log_ecg_data[i / LOG_ECG_HALF_SIZE][i % LOG_ECG_HALF_SIZE] = (uint8_t)(i * 13);
+    }
+
+    fx_system_initialize();
+    sim_clock_start(LOG_SPEED);
+    storage_init();
+    tx_thread_create(&log_storage_thread, "Storage Thread", storage_thread_entry, 0, NULL, 0, 0, 0, TX_NO_TIME_SLICE,
+                     TX_AUTO_START);
+
+    printf("card: %.0f us per request, %.1f MB/s writes, %.1f MB/s reads; %lu MB per stream, IMU %d B and ECG %d B half buffers\n",
+           card.request_us, card.write_mb_s, card.read_mb_s, (unsigned long)mb, LOG_IMU_HALF_SIZE, LOG_ECG_HALF_SIZE);
+    printf("%-6s %-10s %10s %10s %9s %9s %9s %10s\n", "cache", "writes", "card s", "kB/s", "requests", "reads", "scratch",
+           "sectors w");
+    for(size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++){
+        LogResult *r = &results[i];
+        if(!__run(&cases[i], image, &card, mb * 1024 * 1024, r)){
+            return 1;
+        }
+        printf("%-6lu %-10s %10.2f %10.1f %9u %9lu %9lu %10lu\n", (unsigned long)cases[i].cache_sectors,
+               log_writes_names[cases[i].writes], r->card_seconds,
+               r->card_seconds > 0.0 ? r->bytes / 1024.0 / r->card_seconds : 0.0, r->disk.reads + r->disk.writes,
+               (unsigned long)r->disk.read_sectors, (unsigned long)r->disk.scratch_sectors,
+               (unsigned long)r->disk.write_sectors);
+    }
+    unlink(image);
+
+    const LogResult *before = &results[2];
+    const LogResult *after = &results[sizeof(results) / sizeof(results[0]) - 1];
+    printf("before -> after: %.1f -> %.1f kB/s of records for the card's time (x%.1f)\n",
+           before->bytes / 1024.0 / before->card_seconds, after->bytes / 1024.0 / after->card_seconds,
+           before->card_seconds / after->card_seconds);
+    BENCH_CHECK(after->card_seconds < before->card_seconds);
+
+    printf("sd_log_bench: %s (%u failed checks)\n", bench_failures ? "FAIL" : "ok", bench_failures);
+    return bench_failures ? 1 : 0;
+}
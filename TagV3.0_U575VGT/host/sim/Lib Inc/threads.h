@@ -0,0 +1,39 @@
+/*
+ * threads.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Host stand-in for Lib Inc/threads.h. The real one pulls in every sensor's header to fill its config table, the audio
+ *    pipeline only needs the thread list and the handles. Keep the list in step with the real one.
+ */
+
+#ifndef INC_LIB_INC_THREADS_H_
+#define INC_LIB_INC_THREADS_H_
+
+#include "tx_api.h"
+
+typedef enum __TX_THREAD_LIST {
+	STATE_MACHINE_THREAD,
+	AUDIO_THREAD,
+	IMU_THREAD,
+	IMU_SD_THREAD,
+	ECG_THREAD,
+	ECG_SD_THREAD,
+	GPS_THREAD,
+	APRS_THREAD,
+	BURNWIRE_THREAD,
+	AUDIO_LTSA_THREAD,
+	STORAGE_THREAD,
+	NUM_THREADS //DO NOT ADD THREAD ENUMS BELOW THIS
+}Thread;
+
+typedef struct __TX_THREAD_TypeDef {
+
+	TX_THREAD thread;
+
+}Thread_HandleTypeDef;
+
+extern Thread_HandleTypeDef threads[NUM_THREADS];
+
+#endif /* INC_LIB_INC_THREADS_H_ */
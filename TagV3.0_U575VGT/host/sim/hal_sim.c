@@ -0,0 +1,204 @@
+/*
+ * hal_sim.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    HAL stand-ins on the simulated clock, see stm32u5xx_hal.h.
+ */
+
+#include "sim.h"
+#include <time.h>
+
+uint32_t SystemCoreClock = 160000000;
+CoreDebug_Type sim_core_debug;
+GPIO_TypeDef sim_gpio[8];
+uint8_t sim_adc_regs[128] = {
+    [0x0A] = 0x06, //AD7768_REG_REV_ID
+};
+
+/*********************
+ * PRIVATE VARIABLES *
+ *********************/
+
+static DWT_Type sim_dwt_regs;
+
+//Register a read command addressed, returned by the next transfer
+static uint8_t sim_adc_read_reg;
+
+//RTC time at simulated clock 0, seconds since the epoch (UTC, the RTC keeps no zone)
+static time_t sim_rtc_base = 1792238400; //2026-10-17 12:00:00
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static void __rtc_now(struct tm *now){
+    time_t t = sim_rtc_base + (time_t)sim_now();
+    gmtime_r(&t, now);
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+DWT_Type *sim_dwt(void){
+    //Free running at the core clock like the real counter, writes to it are lost on the next read
+    sim_dwt_regs.CYCCNT = (uint32_t)(uint64_t)(sim_now() * SystemCoreClock);
+    return &sim_dwt_regs;
+}
+
+void HAL_Delay(uint32_t delay){
+    sim_sleep(delay / 1000.0);
+}
+
+uint32_t HAL_GetTick(void){
+    return (uint32_t)(sim_now() * 1000.0);
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state){
+    if(state == GPIO_PIN_SET){
+        port->ODR |= pin;
+    }
+    else{
+        port->ODR &= ~(uint32_t)pin;
+    }
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *data, uint16_t size, uint32_t timeout){
+    //AD7768 frames are 16 bits: R/W bit and register address, then data
+    if(size != 2){
+        return HAL_ERROR;
+    }
+    if(data[0] & 0x80){
+        sim_adc_read_reg = data[0] & 0x7F;
+    }
+    else{
+        sim_adc_regs[data[0] & 0x7F] = data[1];
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef *hspi, uint8_t *tx, uint8_t *rx, uint16_t size, uint32_t timeout){
+    if(size != 2){
+        return HAL_ERROR;
+    }
+    rx[0] = 0;
+    rx[1] = sim_adc_regs[sim_adc_read_reg];
+    return HAL_SPI_Transmit(hspi, tx, size, timeout);
+}
+
+void sim_rtc_set(const RTC_DateTypeDef *date, const RTC_TimeTypeDef *time){
+    struct tm base = {
+        .tm_year = date->Year + 100,
+        .tm_mon = date->Month - 1,
+        .tm_mday = date->Date,
+        .tm_hour = time->Hours,
+        .tm_min = time->Minutes,
+        .tm_sec = time->Seconds,
+    };
+    sim_rtc_base = timegm(&base);
+}
+
+HAL_StatusTypeDef HAL_RTC_GetTime(RTC_HandleTypeDef *hrtc, RTC_TimeTypeDef *time, uint32_t format){
+    struct tm now;
+
+    __rtc_now(&now);
+    *time = (RTC_TimeTypeDef){
+        .Hours = now.tm_hour,
+        .Minutes = now.tm_min,
+        .Seconds = now.tm_sec,
+    };
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RTC_GetDate(RTC_HandleTypeDef *hrtc, RTC_DateTypeDef *date, uint32_t format){
+    struct tm now;
+
+    __rtc_now(&now);
+    *date = (RTC_DateTypeDef){
+        .WeekDay = (now.tm_wday == 0) ? 7 : now.tm_wday,
+        .Month = now.tm_mon + 1,
+        .Date = now.tm_mday,
+        .Year = now.tm_year - 100,
+    };
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_UnLinkQ(DMA_HandleTypeDef *hdma){
+    hdma->LinkedListQueue = NULL;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_ResetQ(DMA_QListTypeDef *queue){
+    *queue = (DMA_QListTypeDef){};
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_BuildNode(DMA_NodeConfTypeDef *config, DMA_NodeTypeDef *node){
+    *node = (DMA_NodeTypeDef){
+        .DstAddress = config->DstAddress,
+        .DataSize = config->DataSize,
+    };
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_InsertNode_Tail(DMA_QListTypeDef *queue, DMA_NodeTypeDef *node){
+    DMA_NodeTypeDef **tail = &queue->Head;
+
+    if(queue->circular){
+        return HAL_ERROR;
+    }
+    while(*tail != NULL){
+        tail = &(*tail)->next;
+    }
+    *tail = node;
+    node->next = NULL;
+    queue->NodeNumber++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_SetCircularMode(DMA_QListTypeDef *queue){
+    DMA_NodeTypeDef *node = queue->Head;
+
+    if(node == NULL){
+        return HAL_ERROR;
+    }
+    while(node->next != NULL){
+        node = node->next;
+    }
+    node->next = queue->Head;
+    queue->circular = true;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMAEx_List_LinkQ(DMA_HandleTypeDef *hdma, DMA_QListTypeDef *queue){
+    hdma->LinkedListQueue = queue;
+    hdma->interrupts = DMA_IT_TC | DMA_IT_HT;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SAI_Init(SAI_HandleTypeDef *hsai){
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SAI_RegisterCallback(SAI_HandleTypeDef *hsai, HAL_SAI_CallbackIDTypeDef id, pSAI_CallbackTypeDef callback){
+    if(id != HAL_SAI_RX_COMPLETE_CB_ID){
+        return HAL_ERROR;
+    }
+    hsai->RxCpltCallback = callback;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SAI_Receive_DMA(SAI_HandleTypeDef *hsai, uint8_t *data, uint16_t size){
+    if((hsai->hdmarx == NULL) || (hsai->hdmarx->LinkedListQueue == NULL)){
+        return HAL_ERROR;
+    }
+    sim_sai_start(hsai);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SAI_DMAPause(SAI_HandleTypeDef *hsai){
+    sim_sai_stop(hsai);
+    return HAL_OK;
+}
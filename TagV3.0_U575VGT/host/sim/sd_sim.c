@@ -0,0 +1,49 @@
+/*
+ * sd_sim.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    The HAL's SD calls against the simulated card (sim_disk.h). A "DMA" transfer runs to the end, latency and all,
+ *    before it raises its completion callback from the calling thread, so the caller's wait for it returns at once.
+ */
+
+#include "stm32u5xx_hal.h"
+#include "sim_disk.h"
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+HAL_SD_CardStateTypeDef HAL_SD_GetCardState(SD_HandleTypeDef *hsd){
+    return HAL_SD_CARD_TRANSFER;
+}
+
+HAL_StatusTypeDef HAL_SD_ReadBlocks(SD_HandleTypeDef *hsd, uint8_t *data, uint32_t block, uint32_t blocks, uint32_t timeout){
+    return (sim_disk_command(block, blocks, data, false) == FX_SUCCESS) ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_SD_WriteBlocks(SD_HandleTypeDef *hsd, const uint8_t *data, uint32_t block, uint32_t blocks, uint32_t timeout){
+    return (sim_disk_command(block, blocks, (UCHAR *)data, true) == FX_SUCCESS) ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_SD_ReadBlocks_DMA(SD_HandleTypeDef *hsd, uint8_t *data, uint32_t block, uint32_t blocks){
+    //The SDMMC's internal DMA only takes word aligned buffers
+    if(((uintptr_t)data & 0x3) || (sim_disk_command(block, blocks, data, false) != FX_SUCCESS)){
+        return HAL_ERROR;
+    }
+    HAL_SD_RxCpltCallback(hsd);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SD_WriteBlocks_DMA(SD_HandleTypeDef *hsd, const uint8_t *data, uint32_t block, uint32_t blocks){
+    if(((uintptr_t)data & 0x3) || (sim_disk_command(block, blocks, (UCHAR *)data, true) != FX_SUCCESS)){
+        return HAL_ERROR;
+    }
+    HAL_SD_TxCpltCallback(hsd);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SD_Abort(SD_HandleTypeDef *hsd){
+    return HAL_OK;
+}
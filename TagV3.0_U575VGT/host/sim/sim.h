@@ -0,0 +1,42 @@
+/*
+ * sim.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Simulated clock and the hooks between the platform stand-ins (tx_sim.c, hal_sim.c) and the host harness
+ *    running the audio pipeline (audio_sim.c).
+ *
+ *    Simulated time runs speed times faster than the host's monotonic clock. ThreadX ticks, the DWT cycle counter, the
+ *    RTC, the DMA cadence and the injected SD card latency all follow it, so a run can be sped up as a whole as long as
+ *    the host keeps up.
+ */
+
+#ifndef SIM_SIM_H_
+#define SIM_SIM_H_
+
+#include <stdbool.h>
+#include <time.h>
+#include "tx_api.h"
+#include "stm32u5xx_hal.h"
+
+/* start the simulated clock at 0, speed > 1 runs it faster than real time */
+void sim_clock_start(double speed);
+
+/* simulated seconds since sim_clock_start */
+double sim_now(void);
+
+/* host clock time a span of simulated seconds from now ends at (for timed waits) */
+struct timespec sim_deadline(double seconds);
+
+/* sleep for a span of simulated seconds */
+void sim_sleep(double seconds);
+
+/* wait for a thread to leave (terminate itself or be terminated) */
+void sim_thread_join(TX_THREAD *thread);
+
+/* called by HAL_SAI_Receive_DMA / HAL_SAI_DMAPause, the harness starts and stops feeding blocks */
+void sim_sai_start(SAI_HandleTypeDef *hsai);
+void sim_sai_stop(SAI_HandleTypeDef *hsai);
+
+#endif /* SIM_SIM_H_ */
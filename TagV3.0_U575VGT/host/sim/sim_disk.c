@@ -0,0 +1,190 @@
+/*
+ * sim_disk.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Disk image FileX driver with injected latency, see sim_disk.h.
+ */
+
+#include "sim_disk.h"
+#include "sim.h"
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define SIM_DISK_SECTOR_SIZE 512
+
+/*********************
+ * PRIVATE VARIABLES *
+ *********************/
+
+static int sim_disk_fd = -1;
+static uint64_t sim_disk_sectors;
+static SimDiskLatency sim_disk_model;
+static SimDiskStats sim_disk_counters;
+static uint32_t sim_disk_rng;
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static uint32_t __random(void){
+    //xorshift32, the run is repeatable for a seed
+    sim_disk_rng ^= sim_disk_rng << 13;
+    sim_disk_rng ^= sim_disk_rng >> 17;
+    sim_disk_rng ^= sim_disk_rng << 5;
+    return sim_disk_rng;
+}
+
+/* simulated time a request of sectors takes */
+static double __request_time(ULONG sectors, bool write){
+    double mb_s = write ? sim_disk_model.write_mb_s : sim_disk_model.read_mb_s;
+    double seconds = sim_disk_model.request_us * 1e-6;
+
+    if(mb_s > 0.0){
+        seconds += (double)sectors * SIM_DISK_SECTOR_SIZE / (mb_s * 1e6);
+    }
+    if(write && (sim_disk_model.busy_chance > 0.0) && (__random() < sim_disk_model.busy_chance * 4294967296.0)){
+        seconds += sim_disk_model.busy_ms * 1e-3;
+        sim_disk_counters.busy_spells++;
+    }
+    return seconds;
+}
+
+static UINT __transfer(ULONG sector, ULONG sectors, UCHAR *buffer, bool write){
+    size_t len = (size_t)sectors * SIM_DISK_SECTOR_SIZE;
+    off_t offset = (off_t)sector * SIM_DISK_SECTOR_SIZE;
+    double seconds = __request_time(sectors, write);
+    ssize_t done;
+
+    if((sim_disk_fd < 0) || ((uint64_t)sector + sectors > sim_disk_sectors)){
+        return FX_IO_ERROR;
+    }
+    done = write ? pwrite(sim_disk_fd, buffer, len, offset) : pread(sim_disk_fd, buffer, len, offset);
+    if(done != (ssize_t)len){
+        return FX_IO_ERROR;
+    }
+    if(seconds > 0.0){
+        sim_sleep(seconds);
+    }
+
+    if(write){
+        sim_disk_counters.writes++;
+        sim_disk_counters.write_sectors += sectors;
+        sim_disk_counters.write_seconds += seconds;
+        if(seconds > sim_disk_counters.write_max){
+            sim_disk_counters.write_max = seconds;
+        }
+    }
+    else{
+        sim_disk_counters.reads++;
+        sim_disk_counters.read_sectors += sectors;
+        sim_disk_counters.read_seconds += seconds;
+    }
+    return FX_SUCCESS;
+}
+
+/* a driver request, split into single sector ones through the scratch buffer when it can't be DMA'd from in place */
+static UINT __request(ULONG sector, ULONG sectors, UCHAR *buffer, bool write){
+    UINT status = FX_SUCCESS;
+
+    if(((uintptr_t)buffer & 0x3) == 0){
+        return __transfer(sector, sectors, buffer, write);
+    }
+    for(ULONG i = 0; (i < sectors) && (status == FX_SUCCESS); i++){
+        status = __transfer(sector + i, 1, &buffer[i * SIM_DISK_SECTOR_SIZE], write);
+        sim_disk_counters.scratch_sectors++;
+    }
+    return status;
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+bool sim_disk_create(const char *path, uint64_t bytes){
+    sim_disk_close();
+    sim_disk_fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(sim_disk_fd < 0){
+        perror(path);
+        return false;
+    }
+
+    //Sparse, only what gets written takes space
+    sim_disk_sectors = bytes / SIM_DISK_SECTOR_SIZE;
+    if(ftruncate(sim_disk_fd, (off_t)(sim_disk_sectors * SIM_DISK_SECTOR_SIZE)) != 0){
+        perror(path);
+        sim_disk_close();
+        return false;
+    }
+    return true;
+}
+
+UINT sim_disk_command(ULONG sector, ULONG sectors, UCHAR *buffer, bool write){
+    return __transfer(sector, sectors, buffer, write);
+}
+
+uint64_t sim_disk_size(void){
+    return sim_disk_sectors;
+}
+
+void sim_disk_close(void){
+    if(sim_disk_fd >= 0){
+        close(sim_disk_fd);
+        sim_disk_fd = -1;
+    }
+}
+
+void sim_disk_latency(const SimDiskLatency *latency){
+    sim_disk_model = latency ? *latency : (SimDiskLatency){};
+    sim_disk_rng = sim_disk_model.seed ? sim_disk_model.seed : 1;
+}
+
+SimDiskStats sim_disk_stats(void){
+    return sim_disk_counters;
+}
+
+void sim_disk_stats_reset(void){
+    sim_disk_counters = (SimDiskStats){};
+}
+
+VOID sim_disk_driver(FX_MEDIA *media_ptr){
+    ULONG sector = media_ptr->fx_media_driver_logical_sector + media_ptr->fx_media_hidden_sectors;
+
+    switch(media_ptr->fx_media_driver_request){
+        case FX_DRIVER_READ:
+            media_ptr->fx_media_driver_status = __request(sector, media_ptr->fx_media_driver_sectors,
+                                                          media_ptr->fx_media_driver_buffer, false);
+            break;
+
+        case FX_DRIVER_WRITE:
+            media_ptr->fx_media_driver_status = __request(sector, media_ptr->fx_media_driver_sectors,
+                                                          media_ptr->fx_media_driver_buffer, true);
+            break;
+
+        //The volume starts at sector 0, no partition table
+        case FX_DRIVER_BOOT_READ:
+            media_ptr->fx_media_driver_status = __transfer(0, 1, media_ptr->fx_media_driver_buffer, false);
+            break;
+
+        case FX_DRIVER_BOOT_WRITE:
+            media_ptr->fx_media_driver_status = __transfer(0, 1, media_ptr->fx_media_driver_buffer, true);
+            break;
+
+        case FX_DRIVER_INIT:
+            media_ptr->fx_media_driver_status = (sim_disk_fd >= 0) ? FX_SUCCESS : FX_IO_ERROR;
+            break;
+
+        case FX_DRIVER_FLUSH:
+        case FX_DRIVER_ABORT:
+        case FX_DRIVER_RELEASE_SECTORS:
+        case FX_DRIVER_UNINIT:
+            media_ptr->fx_media_driver_status = FX_SUCCESS;
+            break;
+
+        default:
+            media_ptr->fx_media_driver_status = FX_IO_ERROR;
+            break;
+    }
+}
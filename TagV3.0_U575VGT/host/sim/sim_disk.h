@@ -0,0 +1,68 @@
+/*
+ * sim_disk.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    FileX media driver over a disk image file, standing in for the SD card (fx_stm32_sd_driver.c) with injected latency.
+ *
+ *    Every request sleeps (in simulated time) for a fixed cost plus its size at the card's sustained speed, and a write
+ *    now and then hits a busy spell, the way a card stalls for its own garbage collection. The sleep is taken inside
+ *    the driver, with FileX's media mutex held, exactly where the SDMMC transfer waits on the tag. Like the tag's driver
+ *    (fx_stm32_sd_driver.c with the DMA API), a buffer that isn't 4-byte aligned goes through one sector at a time, as
+ *    that many requests.
+ *
+ *    The image is a sparse file holding an unpartitioned volume, it can be opened with anything that reads FAT.
+ */
+
+#ifndef SIM_SIM_DISK_H_
+#define SIM_SIM_DISK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fx_api.h"
+
+typedef struct {
+    double request_us;      //fixed cost of every request
+    double write_mb_s;      //sustained speeds, 0 = no size dependent cost
+    double read_mb_s;
+    double busy_ms;         //length of a busy spell
+    double busy_chance;     //chance a write request runs into one
+    uint32_t seed;
+} SimDiskLatency;
+
+typedef struct {
+    uint32_t reads;
+    uint32_t writes;
+    uint64_t read_sectors;
+    uint64_t write_sectors;
+    uint32_t busy_spells;
+    uint64_t scratch_sectors;   //sectors that went one at a time, from unaligned buffers
+    double read_seconds;    //simulated time spent in read requests
+    double write_seconds;   //simulated time spent in write requests
+    double write_max;       //longest write request
+} SimDiskStats;
+
+/* create (or truncate) the image file with room for a volume of bytes */
+bool sim_disk_create(const char *path, uint64_t bytes);
+
+/* close the image file */
+void sim_disk_close(void);
+
+/* latency of the requests from now on, NULL for none */
+void sim_disk_latency(const SimDiskLatency *latency);
+
+/* counters since the last reset */
+SimDiskStats sim_disk_stats(void);
+void sim_disk_stats_reset(void);
+
+/* one card command of sectors at sector, with its latency, the way the SDMMC sees it (no scratch copies) */
+UINT sim_disk_command(ULONG sector, ULONG sectors, UCHAR *buffer, bool write);
+
+/* sectors in the image */
+uint64_t sim_disk_size(void);
+
+/* the FileX driver entry */
+VOID sim_disk_driver(FX_MEDIA *media_ptr);
+
+#endif /* SIM_SIM_DISK_H_ */
@@ -0,0 +1,276 @@
+/*
+ * stm32u5xx_hal.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Stand-in for the STM32U5 HAL on a Linux host (hal_sim.c): the handle types, constants and calls the audio
+ *    pipeline and the headers it includes touch, nothing more.
+ *
+ *    SPI transfers go to a register file standing in for the AD7768, so the real driver (ad7768.c) runs on it.
+ *    The SAI and GPDMA calls only record what they are given. The SD calls (sd_sim.c) are commands to the simulated card. HAL_SAI_Receive_DMA and HAL_SAI_DMAPause hand over to
+ *    the harness (sim.h), which fills the temp buffer blocks and raises the receive complete callback. The DWT cycle
+ *    counter and the RTC follow the simulated clock.
+ */
+
+#ifndef SIM_STM32U5XX_HAL_H_
+#define SIM_STM32U5XX_HAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum {
+    HAL_OK = 0x00,
+    HAL_ERROR = 0x01,
+    HAL_BUSY = 0x02,
+    HAL_TIMEOUT = 0x03,
+} HAL_StatusTypeDef;
+
+#define __DMB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __NOP() __asm__ volatile("")
+
+/* core */
+extern uint32_t SystemCoreClock;
+
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+DWT_Type *sim_dwt(void);
+extern CoreDebug_Type sim_core_debug;
+
+#define DWT (sim_dwt())
+#define CoreDebug (&sim_core_debug)
+#define DWT_CTRL_CYCCNTENA_Msk 0x1UL
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+
+void HAL_Delay(uint32_t delay);
+uint32_t HAL_GetTick(void);
+
+/* GPIO */
+typedef struct {
+    uint32_t ODR;
+} GPIO_TypeDef;
+
+extern GPIO_TypeDef sim_gpio[8];
+#define GPIOA (&sim_gpio[0])
+#define GPIOB (&sim_gpio[1])
+#define GPIOC (&sim_gpio[2])
+#define GPIOD (&sim_gpio[3])
+#define GPIOE (&sim_gpio[4])
+
+#define GPIO_PIN_0  ((uint16_t)0x0001)
+#define GPIO_PIN_1  ((uint16_t)0x0002)
+#define GPIO_PIN_2  ((uint16_t)0x0004)
+#define GPIO_PIN_3  ((uint16_t)0x0008)
+#define GPIO_PIN_4  ((uint16_t)0x0010)
+#define GPIO_PIN_5  ((uint16_t)0x0020)
+#define GPIO_PIN_6  ((uint16_t)0x0040)
+#define GPIO_PIN_7  ((uint16_t)0x0080)
+#define GPIO_PIN_8  ((uint16_t)0x0100)
+#define GPIO_PIN_9  ((uint16_t)0x0200)
+#define GPIO_PIN_10 ((uint16_t)0x0400)
+#define GPIO_PIN_11 ((uint16_t)0x0800)
+#define GPIO_PIN_12 ((uint16_t)0x1000)
+#define GPIO_PIN_13 ((uint16_t)0x2000)
+#define GPIO_PIN_14 ((uint16_t)0x4000)
+#define GPIO_PIN_15 ((uint16_t)0x8000)
+
+typedef enum {
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET,
+} GPIO_PinState;
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state);
+
+/* SPI, every handle talks to the ADC register file model (hal_sim.c) */
+typedef struct {
+    uint32_t id;
+} SPI_HandleTypeDef;
+
+//ADC registers as the model holds them, the revision ID reads 0x06 and the status 0 like a healthy AD7768
+extern uint8_t sim_adc_regs[128];
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef *hspi, uint8_t *tx, uint8_t *rx, uint16_t size, uint32_t timeout);
+
+/* peripherals the pipeline only passes around */
+typedef struct {
+    uint32_t id;
+} I2C_HandleTypeDef;
+
+/* SD card, the calls the USB mass storage layer makes go to the simulated card (sd_sim.c) */
+typedef struct {
+    uint32_t LogBlockNbr;
+    uint32_t LogBlockSize;
+} HAL_SD_CardInfoTypeDef;
+
+typedef struct {
+    uint32_t id;
+    HAL_SD_CardInfoTypeDef SdCard;
+} SD_HandleTypeDef;
+
+typedef uint32_t HAL_SD_CardStateTypeDef;
+#define HAL_SD_CARD_TRANSFER 0x00000004U
+
+#define ALIGN_32BYTES(buf) buf __attribute__((aligned(32)))
+
+/* the polled fallback masks interrupts, nothing to mask on the host */
+#define __disable_irq()
+#define __enable_irq()
+
+HAL_SD_CardStateTypeDef HAL_SD_GetCardState(SD_HandleTypeDef *hsd);
+HAL_StatusTypeDef HAL_SD_ReadBlocks(SD_HandleTypeDef *hsd, uint8_t *data, uint32_t block, uint32_t blocks, uint32_t timeout);
+HAL_StatusTypeDef HAL_SD_WriteBlocks(SD_HandleTypeDef *hsd, const uint8_t *data, uint32_t block, uint32_t blocks, uint32_t timeout);
+HAL_StatusTypeDef HAL_SD_ReadBlocks_DMA(SD_HandleTypeDef *hsd, uint8_t *data, uint32_t block, uint32_t blocks);
+HAL_StatusTypeDef HAL_SD_WriteBlocks_DMA(SD_HandleTypeDef *hsd, const uint8_t *data, uint32_t block, uint32_t blocks);
+HAL_StatusTypeDef HAL_SD_Abort(SD_HandleTypeDef *hsd);
+
+/* raised by the DMA calls once the transfer is done, the FileX driver glue's on the tag */
+void HAL_SD_RxCpltCallback(SD_HandleTypeDef *hsd);
+void HAL_SD_TxCpltCallback(SD_HandleTypeDef *hsd);
+
+/* RTC */
+typedef struct {
+    uint32_t id;
+} RTC_HandleTypeDef;
+
+typedef struct {
+    uint8_t Hours;
+    uint8_t Minutes;
+    uint8_t Seconds;
+    uint8_t TimeFormat;
+    uint32_t SubSeconds;
+    uint32_t SecondFraction;
+} RTC_TimeTypeDef;
+
+typedef struct {
+    uint8_t WeekDay;
+    uint8_t Month;
+    uint8_t Date;
+    uint8_t Year;
+} RTC_DateTypeDef;
+
+#define RTC_FORMAT_BIN 0x00000000U
+
+/* the RTC runs from this time (local, 2000 based year) at simulated clock 0 */
+void sim_rtc_set(const RTC_DateTypeDef *date, const RTC_TimeTypeDef *time);
+
+HAL_StatusTypeDef HAL_RTC_GetTime(RTC_HandleTypeDef *hrtc, RTC_TimeTypeDef *time, uint32_t format);
+HAL_StatusTypeDef HAL_RTC_GetDate(RTC_HandleTypeDef *hrtc, RTC_DateTypeDef *date, uint32_t format);
+
+/* GPDMA linked lists */
+#define DMA_GPDMA_LINEAR_NODE           0x01U
+#define GPDMA1_REQUEST_SAI1_B           0x28U
+#define DMA_BREQ_SINGLE_BURST           0x00U
+#define DMA_PERIPH_TO_MEMORY            0x00U
+#define DMA_SINC_FIXED                  0x00U
+#define DMA_DINC_INCREMENTED            0x01U
+#define DMA_SRC_DATAWIDTH_BYTE          0x00U
+#define DMA_DEST_DATAWIDTH_BYTE         0x00U
+#define DMA_SRC_ALLOCATED_PORT0         0x00U
+#define DMA_DEST_ALLOCATED_PORT0        0x00U
+#define DMA_TCEM_BLOCK_TRANSFER         0x00U
+#define DMA_NORMAL                      0x00U
+#define DMA_TRIG_POLARITY_MASKED        0x00U
+#define DMA_EXCHANGE_NONE               0x00U
+#define DMA_DATA_RIGHTALIGN_ZEROPADDED  0x00U
+#define DMA_IT_TC                       0x0100U
+#define DMA_IT_HT                       0x0200U
+
+typedef struct {
+    uint32_t Request;
+    uint32_t BlkHWRequest;
+    uint32_t Direction;
+    uint32_t SrcInc;
+    uint32_t DestInc;
+    uint32_t SrcDataWidth;
+    uint32_t DestDataWidth;
+    uint32_t Priority;
+    uint32_t SrcBurstLength;
+    uint32_t DestBurstLength;
+    uint32_t TransferAllocatedPort;
+    uint32_t TransferEventMode;
+    uint32_t Mode;
+} DMA_InitTypeDef;
+
+typedef struct {
+    uint32_t NodeType;
+    DMA_InitTypeDef Init;
+    struct {
+        uint32_t TriggerMode;
+        uint32_t TriggerPolarity;
+        uint32_t TriggerSelection;
+    } TriggerConfig;
+    struct {
+        uint32_t DataExchange;
+        uint32_t DataAlignment;
+    } DataHandlingConfig;
+    uint32_t SrcAddress;
+    uint32_t DstAddress;
+    uint32_t DataSize;
+} DMA_NodeConfTypeDef;
+
+typedef struct dma_node_s {
+    uint32_t DstAddress;    //only the low 32 bits of the destination on a 64-bit host
+    uint32_t DataSize;
+    struct dma_node_s *next;
+} DMA_NodeTypeDef;
+
+typedef struct {
+    DMA_NodeTypeDef *Head;
+    uint32_t NodeNumber;
+    bool circular;
+} DMA_QListTypeDef;
+
+typedef struct {
+    DMA_QListTypeDef *LinkedListQueue;
+    uint32_t interrupts;
+} DMA_HandleTypeDef;
+
+#define __HAL_DMA_DISABLE_IT(handle, it) ((handle)->interrupts &= ~(uint32_t)(it))
+
+HAL_StatusTypeDef HAL_DMAEx_List_UnLinkQ(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMAEx_List_ResetQ(DMA_QListTypeDef *queue);
+HAL_StatusTypeDef HAL_DMAEx_List_BuildNode(DMA_NodeConfTypeDef *config, DMA_NodeTypeDef *node);
+HAL_StatusTypeDef HAL_DMAEx_List_InsertNode_Tail(DMA_QListTypeDef *queue, DMA_NodeTypeDef *node);
+HAL_StatusTypeDef HAL_DMAEx_List_SetCircularMode(DMA_QListTypeDef *queue);
+HAL_StatusTypeDef HAL_DMAEx_List_LinkQ(DMA_HandleTypeDef *hdma, DMA_QListTypeDef *queue);
+
+/* SAI */
+typedef struct {
+    volatile uint32_t DR;
+} SAI_Block_TypeDef;
+
+typedef struct {
+    uint32_t FirstBitOffset;
+    uint32_t SlotSize;
+    uint32_t SlotNumber;
+    uint32_t SlotActive;
+} SAI_SlotInitTypeDef;
+
+typedef enum {
+    HAL_SAI_RX_COMPLETE_CB_ID = 0x02U,
+} HAL_SAI_CallbackIDTypeDef;
+
+typedef struct sai_handle_s {
+    SAI_Block_TypeDef *Instance;
+    SAI_SlotInitTypeDef SlotInit;
+    DMA_HandleTypeDef *hdmarx;
+    void (*RxCpltCallback)(struct sai_handle_s *hsai);
+} SAI_HandleTypeDef;
+
+typedef void (*pSAI_CallbackTypeDef)(SAI_HandleTypeDef *hsai);
+
+HAL_StatusTypeDef HAL_SAI_Init(SAI_HandleTypeDef *hsai);
+HAL_StatusTypeDef HAL_SAI_RegisterCallback(SAI_HandleTypeDef *hsai, HAL_SAI_CallbackIDTypeDef id, pSAI_CallbackTypeDef callback);
+HAL_StatusTypeDef HAL_SAI_Receive_DMA(SAI_HandleTypeDef *hsai, uint8_t *data, uint16_t size);
+HAL_StatusTypeDef HAL_SAI_DMAPause(SAI_HandleTypeDef *hsai);
+
+#endif /* SIM_STM32U5XX_HAL_H_ */
@@ -0,0 +1,15 @@
+/*
+ * stm32u5xx_hal_sd.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Stand-in for the HAL's SD header, the SD calls are declared with the rest of the HAL stand-in.
+ */
+
+#ifndef SIM_STM32U5XX_HAL_SD_H_
+#define SIM_STM32U5XX_HAL_SD_H_
+
+#include "stm32u5xx_hal.h"
+
+#endif /* SIM_STM32U5XX_HAL_SD_H_ */
@@ -0,0 +1,159 @@
+/*
+ * tx_api.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Stand-in for the ThreadX API on a Linux host (tx_sim.c), just the services the audio pipeline, the storage thread
+ *    and FileX use. Threads are pthreads, the rest is built on pthread mutexes and condition variables.
+ *
+ *    Unlike ThreadX there are no priorities and threads really run in parallel, so this only models the SD card and
+ *    the DMA cadence, not how the M33's time is shared. Mutexes are recursive like ThreadX's, timers never fire and
+ *    interrupt control is one global lock.
+ *
+ *    Time is simulated: tx_time_get() counts TX_TIMER_TICKS_PER_SECOND ticks from sim_clock_start(), sped up by its
+ *    factor, and every wait and sleep is scaled the same way (see sim.h).
+ *
+ *    ULONG is pointer sized (as in the ThreadX 64-bit Linux port), storage.c passes stream pointers as 1 ULONG messages.
+ */
+
+#ifndef SIM_TX_API_H_
+#define SIM_TX_API_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "tx_user.h"
+
+#define VOID void
+typedef char CHAR;
+typedef unsigned char UCHAR;
+typedef int INT;
+typedef unsigned int UINT;
+typedef long LONG;
+typedef unsigned long ULONG;
+typedef short SHORT;
+typedef unsigned short USHORT;
+typedef unsigned long long ULONG64;
+#define ALIGN_TYPE_DEFINED
+#define ALIGN_TYPE ULONG
+
+#define TX_NO_WAIT                  ((ULONG)0)
+#define TX_WAIT_FOREVER             ((ULONG)0xFFFFFFFFUL)
+#define TX_AND                      ((UINT)2)
+#define TX_AND_CLEAR                ((UINT)3)
+#define TX_OR                       ((UINT)0)
+#define TX_OR_CLEAR                 ((UINT)1)
+#define TX_1_ULONG                  ((UINT)1)
+#define TX_NO_TIME_SLICE            ((ULONG)0)
+#define TX_AUTO_START               ((UINT)1)
+#define TX_DONT_START               ((UINT)0)
+#define TX_AUTO_ACTIVATE            ((UINT)1)
+#define TX_NO_ACTIVATE              ((UINT)0)
+#define TX_TRUE                     ((UINT)1)
+#define TX_FALSE                    ((UINT)0)
+#define TX_NULL                     ((void *)0)
+#define TX_INHERIT                  ((UINT)1)
+#define TX_NO_INHERIT               ((UINT)0)
+#define TX_INT_ENABLE               ((UINT)0)
+#define TX_INT_DISABLE              ((UINT)1)
+
+#define TX_SUCCESS                  ((UINT)0x00)
+#define TX_DELETED                  ((UINT)0x01)
+#define TX_NO_EVENTS                ((UINT)0x07)
+#define TX_QUEUE_EMPTY              ((UINT)0x0A)
+#define TX_QUEUE_FULL               ((UINT)0x0B)
+#define TX_NO_INSTANCE              ((UINT)0x0D)
+#define TX_THREAD_ERROR             ((UINT)0x0E)
+#define TX_RESUME_ERROR             ((UINT)0x12)
+#define TX_NOT_AVAILABLE            ((UINT)0x1D)
+#define TX_NOT_OWNED                ((UINT)0x1E)
+#define TX_NOT_DONE                 ((UINT)0x20)
+
+//FileX reads this in its caller checks, nothing here runs in an ISR context
+#define TX_THREAD_GET_SYSTEM_STATE() 0
+
+typedef struct tx_thread_s {
+    const CHAR *name;
+    VOID (*entry)(ULONG);
+    ULONG input;
+    pthread_t pthread;
+    volatile int running;       //pthread started and not yet joined
+    volatile int terminating;   //the thread leaves at its next ThreadX call
+} TX_THREAD;
+
+typedef struct tx_mutex_s {
+    pthread_mutex_t lock;
+} TX_MUTEX;
+
+typedef struct tx_semaphore_s {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    ULONG count;
+    int deleted;
+} TX_SEMAPHORE;
+
+typedef struct tx_event_flags_group_s {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    ULONG flags;
+    int deleted;
+} TX_EVENT_FLAGS_GROUP;
+
+typedef struct tx_queue_s {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    UINT message_size;  //in ULONGs
+    ULONG *start;
+    ULONG capacity;     //messages
+    ULONG first;
+    ULONG count;
+} TX_QUEUE;
+
+typedef struct tx_timer_s {
+    const CHAR *name;
+} TX_TIMER;
+
+UINT tx_thread_create(TX_THREAD *thread, CHAR *name, VOID (*entry)(ULONG), ULONG input, VOID *stack, ULONG stack_size,
+                      UINT priority, UINT preempt_threshold, ULONG time_slice, UINT auto_start);
+UINT tx_thread_resume(TX_THREAD *thread);
+UINT tx_thread_reset(TX_THREAD *thread);
+UINT tx_thread_terminate(TX_THREAD *thread);
+UINT tx_thread_sleep(ULONG ticks);
+TX_THREAD *tx_thread_identify(VOID);
+
+UINT tx_mutex_create(TX_MUTEX *mutex, CHAR *name, UINT inherit);
+UINT tx_mutex_delete(TX_MUTEX *mutex);
+UINT tx_mutex_get(TX_MUTEX *mutex, ULONG wait_option);
+UINT tx_mutex_put(TX_MUTEX *mutex);
+
+UINT tx_semaphore_create(TX_SEMAPHORE *semaphore, CHAR *name, ULONG initial_count);
+UINT tx_semaphore_delete(TX_SEMAPHORE *semaphore);
+UINT tx_semaphore_get(TX_SEMAPHORE *semaphore, ULONG wait_option);
+UINT tx_semaphore_put(TX_SEMAPHORE *semaphore);
+
+UINT tx_event_flags_create(TX_EVENT_FLAGS_GROUP *group, CHAR *name);
+UINT tx_event_flags_delete(TX_EVENT_FLAGS_GROUP *group);
+UINT tx_event_flags_get(TX_EVENT_FLAGS_GROUP *group, ULONG requested, UINT option, ULONG *actual, ULONG wait_option);
+UINT tx_event_flags_set(TX_EVENT_FLAGS_GROUP *group, ULONG flags, UINT option);
+
+UINT tx_queue_create(TX_QUEUE *queue, CHAR *name, UINT message_size, VOID *start, ULONG size);
+UINT tx_queue_delete(TX_QUEUE *queue);
+UINT tx_queue_send(TX_QUEUE *queue, VOID *source, ULONG wait_option);
+UINT tx_queue_front_send(TX_QUEUE *queue, VOID *source, ULONG wait_option);
+UINT tx_queue_receive(TX_QUEUE *queue, VOID *destination, ULONG wait_option);
+
+UINT tx_timer_create(TX_TIMER *timer, CHAR *name, VOID (*expiration)(ULONG), ULONG input, ULONG initial_ticks,
+                     ULONG reschedule_ticks, UINT auto_activate);
+UINT tx_timer_delete(TX_TIMER *timer);
+
+UINT tx_interrupt_control(UINT new_posture);
+
+//FileX's (and the firmware's) short critical sections
+#define TX_INTERRUPT_SAVE_AREA      UINT interrupt_save;
+#define TX_DISABLE                  interrupt_save = tx_interrupt_control(TX_INT_DISABLE);
+#define TX_RESTORE                  tx_interrupt_control(interrupt_save);
+
+ULONG tx_time_get(VOID);
+
+#endif /* SIM_TX_API_H_ */
@@ -0,0 +1,430 @@
+/*
+ * tx_sim.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    ThreadX services on pthreads and the simulated clock, see tx_api.h and sim.h.
+ *
+ *    Blocking calls wait in short slices of host time, so a thread terminated by another one (the audio thread stopping
+ *    the LTSA thread) leaves at its next wait, the way a suspended ThreadX thread never runs again. tx_thread_terminate
+ *    on another thread returns once it has left.
+ */
+
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+//Longest a blocked thread waits before checking whether it was terminated (host time)
+#define SIM_WAIT_SLICE_NS 2000000L
+
+/*********************
+ * PRIVATE VARIABLES *
+ *********************/
+
+static double sim_speed = 1.0;
+static struct timespec sim_start;
+
+//Thread the caller runs in, NULL outside of tx_thread_create'd threads
+static __thread TX_THREAD *sim_self;
+
+//"Interrupts disabled" is this lock being held, depth counts the disables of the thread holding it
+static pthread_mutex_t sim_interrupt_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread UINT sim_interrupt_depth;
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static double __host_now(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - sim_start.tv_sec) + (now.tv_nsec - sim_start.tv_nsec) * 1e-9;
+}
+
+static struct timespec __host_after(long ns){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    t.tv_nsec += ns % 1000000000L;
+    t.tv_sec += ns / 1000000000L + t.tv_nsec / 1000000000L;
+    t.tv_nsec %= 1000000000L;
+    return t;
+}
+
+static bool __before(const struct timespec *a, const struct timespec *b){
+    return (a->tv_sec < b->tv_sec) || ((a->tv_sec == b->tv_sec) && (a->tv_nsec < b->tv_nsec));
+}
+
+static void __cond_init(pthread_mutex_t *lock, pthread_cond_t *cond){
+    pthread_condattr_t attr;
+
+    pthread_mutex_init(lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/* leave the calling thread if it was terminated, with lock released */
+static void __check_terminated(pthread_mutex_t *lock){
+    if((sim_self != NULL) && sim_self->terminating){
+        if(lock != NULL){
+            pthread_mutex_unlock(lock);
+        }
+        pthread_exit(NULL);
+    }
+}
+
+/* ThreadX wait option to a host clock deadline */
+static struct timespec __deadline(ULONG wait_option){
+    return sim_deadline((double)wait_option / TX_TIMER_TICKS_PER_SECOND);
+}
+
+/*
+ * Desc: wait for cond for one slice (lock held). Returns false once the wait option has run out.
+ *       A terminated caller leaves from here.
+ */
+static bool __wait(pthread_mutex_t *lock, pthread_cond_t *cond, ULONG wait_option, const struct timespec *deadline){
+    struct timespec until = __host_after(SIM_WAIT_SLICE_NS);
+
+    if(wait_option == TX_NO_WAIT){
+        return false;
+    }
+    if((wait_option != TX_WAIT_FOREVER) && __before(deadline, &until)){
+        until = *deadline;
+    }
+    pthread_cond_timedwait(cond, lock, &until);
+    __check_terminated(lock);
+
+    if(wait_option == TX_WAIT_FOREVER){
+        return true;
+    }
+    struct timespec now = __host_after(0);
+    return __before(&now, deadline);
+}
+
+static void *__thread_main(void *arg){
+    TX_THREAD *thread = arg;
+
+    sim_self = thread;
+    thread->entry(thread->input);
+    return NULL;
+}
+
+static bool __flags_match(ULONG flags, ULONG requested, UINT option){
+    if((option == TX_AND) || (option == TX_AND_CLEAR)){
+        return (flags & requested) == requested;
+    }
+    return (flags & requested) != 0;
+}
+
+static void __queue_copy(ULONG *dst, const ULONG *src, UINT size){
+    memcpy(dst, src, size * sizeof(ULONG));
+}
+
+static UINT __queue_put(TX_QUEUE *queue, VOID *source, ULONG wait_option, bool front){
+    struct timespec deadline = __deadline(wait_option);
+    ULONG slot;
+
+    pthread_mutex_lock(&queue->lock);
+    while(queue->count == queue->capacity){
+        if(!__wait(&queue->lock, &queue->cond, wait_option, &deadline)){
+            pthread_mutex_unlock(&queue->lock);
+            return TX_QUEUE_FULL;
+        }
+    }
+    if(front){
+        queue->first = (queue->first + queue->capacity - 1) % queue->capacity;
+        slot = queue->first;
+    }
+    else{
+        slot = (queue->first + queue->count) % queue->capacity;
+    }
+    __queue_copy(&queue->start[slot * queue->message_size], source, queue->message_size);
+    queue->count++;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+    return TX_SUCCESS;
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+void sim_clock_start(double speed){
+    sim_speed = (speed > 0.0) ? speed : 1.0;
+    clock_gettime(CLOCK_MONOTONIC, &sim_start);
+}
+
+double sim_now(void){
+    return __host_now() * sim_speed;
+}
+
+struct timespec sim_deadline(double seconds){
+    double ns = seconds * 1e9 / sim_speed;
+    return __host_after((ns > 4e18) ? (long)4e18 : (long)ns);
+}
+
+void sim_sleep(double seconds){
+    struct timespec until = sim_deadline(seconds);
+
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR){
+    }
+}
+
+void sim_thread_join(TX_THREAD *thread){
+    if(thread->running && (thread != sim_self)){
+        pthread_join(thread->pthread, NULL);
+        thread->running = 0;
+    }
+}
+
+UINT tx_thread_create(TX_THREAD *thread, CHAR *name, VOID (*entry)(ULONG), ULONG input, VOID *stack, ULONG stack_size,
+                      UINT priority, UINT preempt_threshold, ULONG time_slice, UINT auto_start){
+    *thread = (TX_THREAD){
+        .name = name,
+        .entry = entry,
+        .input = input,
+    };
+    return (auto_start == TX_AUTO_START) ? tx_thread_resume(thread) : TX_SUCCESS;
+}
+
+UINT tx_thread_resume(TX_THREAD *thread){
+    if(thread->running){
+        return TX_RESUME_ERROR;
+    }
+    thread->terminating = 0;
+    thread->running = 1;
+    if(pthread_create(&thread->pthread, NULL, __thread_main, thread) != 0){
+        thread->running = 0;
+        return TX_THREAD_ERROR;
+    }
+    return TX_SUCCESS;
+}
+
+UINT tx_thread_reset(TX_THREAD *thread){
+    //Only a thread that has left can be reset
+    if(thread->running && !thread->terminating){
+        return TX_NOT_DONE;
+    }
+    sim_thread_join(thread);
+    thread->terminating = 0;
+    return TX_SUCCESS;
+}
+
+UINT tx_thread_terminate(TX_THREAD *thread){
+    thread->terminating = 1;
+    if(thread == sim_self){
+        pthread_exit(NULL);
+    }
+    sim_thread_join(thread);
+    return TX_SUCCESS;
+}
+
+UINT tx_thread_sleep(ULONG ticks){
+    __check_terminated(NULL);
+    sim_sleep((double)ticks / TX_TIMER_TICKS_PER_SECOND);
+    __check_terminated(NULL);
+    return TX_SUCCESS;
+}
+
+TX_THREAD *tx_thread_identify(VOID){
+    return sim_self;
+}
+
+UINT tx_mutex_create(TX_MUTEX *mutex, CHAR *name, UINT inherit){
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mutex->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return TX_SUCCESS;
+}
+
+UINT tx_mutex_delete(TX_MUTEX *mutex){
+    pthread_mutex_destroy(&mutex->lock);
+    return TX_SUCCESS;
+}
+
+UINT tx_mutex_get(TX_MUTEX *mutex, ULONG wait_option){
+    //Timed waits aren't used on mutexes here, anything but TX_NO_WAIT waits forever
+    if(wait_option == TX_NO_WAIT){
+        return (pthread_mutex_trylock(&mutex->lock) == 0) ? TX_SUCCESS : TX_NOT_AVAILABLE;
+    }
+    return (pthread_mutex_lock(&mutex->lock) == 0) ? TX_SUCCESS : TX_NOT_AVAILABLE;
+}
+
+UINT tx_mutex_put(TX_MUTEX *mutex){
+    return (pthread_mutex_unlock(&mutex->lock) == 0) ? TX_SUCCESS : TX_NOT_OWNED;
+}
+
+UINT tx_semaphore_create(TX_SEMAPHORE *semaphore, CHAR *name, ULONG initial_count){
+    __cond_init(&semaphore->lock, &semaphore->cond);
+    semaphore->count = initial_count;
+    semaphore->deleted = 0;
+    return TX_SUCCESS;
+}
+
+UINT tx_semaphore_delete(TX_SEMAPHORE *semaphore){
+    pthread_mutex_lock(&semaphore->lock);
+    semaphore->deleted = 1;
+    pthread_cond_broadcast(&semaphore->cond);
+    pthread_mutex_unlock(&semaphore->lock);
+    return TX_SUCCESS;
+}
+
+UINT tx_semaphore_get(TX_SEMAPHORE *semaphore, ULONG wait_option){
+    struct timespec deadline = __deadline(wait_option);
+    UINT status = TX_SUCCESS;
+
+    pthread_mutex_lock(&semaphore->lock);
+    while((semaphore->count == 0) && !semaphore->deleted){
+        if(!__wait(&semaphore->lock, &semaphore->cond, wait_option, &deadline)){
+            break;
+        }
+    }
+    if(semaphore->deleted){
+        status = TX_DELETED;
+    }
+    else if(semaphore->count == 0){
+        status = TX_NO_INSTANCE;
+    }
+    else{
+        semaphore->count--;
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return status;
+}
+
+UINT tx_semaphore_put(TX_SEMAPHORE *semaphore){
+    pthread_mutex_lock(&semaphore->lock);
+    semaphore->count++;
+    pthread_cond_broadcast(&semaphore->cond);
+    pthread_mutex_unlock(&semaphore->lock);
+    return TX_SUCCESS;
+}
+
+UINT tx_event_flags_create(TX_EVENT_FLAGS_GROUP *group, CHAR *name){
+    __cond_init(&group->lock, &group->cond);
+    group->flags = 0;
+    group->deleted = 0;
+    return TX_SUCCESS;
+}
+
+UINT tx_event_flags_delete(TX_EVENT_FLAGS_GROUP *group){
+    pthread_mutex_lock(&group->lock);
+    group->deleted = 1;
+    pthread_cond_broadcast(&group->cond);
+    pthread_mutex_unlock(&group->lock);
+    return TX_SUCCESS;
+}
+
+UINT tx_event_flags_get(TX_EVENT_FLAGS_GROUP *group, ULONG requested, UINT option, ULONG *actual, ULONG wait_option){
+    struct timespec deadline = __deadline(wait_option);
+    UINT status = TX_SUCCESS;
+
+    pthread_mutex_lock(&group->lock);
+    while(!__flags_match(group->flags, requested, option) && !group->deleted){
+        if(!__wait(&group->lock, &group->cond, wait_option, &deadline)){
+            break;
+        }
+    }
+    *actual = group->flags;
+    if(group->deleted){
+        status = TX_DELETED;
+    }
+    else if(!__flags_match(group->flags, requested, option)){
+        status = TX_NO_EVENTS;
+    }
+    else if((option == TX_OR_CLEAR) || (option == TX_AND_CLEAR)){
+        group->flags &= ~requested;
+    }
+    pthread_mutex_unlock(&group->lock);
+    return status;
+}
+
+UINT tx_event_flags_set(TX_EVENT_FLAGS_GROUP *group, ULONG flags, UINT option){
+    pthread_mutex_lock(&group->lock);
+    if(option == TX_AND){
+        group->flags &= flags;
+    }
+    else{
+        group->flags |= flags;
+    }
+    pthread_cond_broadcast(&group->cond);
+    pthread_mutex_unlock(&group->lock);
+    return TX_SUCCESS;
+}
+
+UINT tx_queue_create(TX_QUEUE *queue, CHAR *name, UINT message_size, VOID *start, ULONG size){
+    __cond_init(&queue->lock, &queue->cond);
+    queue->message_size = message_size;
+    queue->start = start;
+    queue->capacity = size / (message_size * sizeof(ULONG));
+    queue->first = 0;
+    queue->count = 0;
+    return TX_SUCCESS;
+}
+
+UINT tx_queue_delete(TX_QUEUE *queue){
+    return TX_SUCCESS;
+}
+
+UINT tx_queue_send(TX_QUEUE *queue, VOID *source, ULONG wait_option){
+    return __queue_put(queue, source, wait_option, false);
+}
+
+UINT tx_queue_front_send(TX_QUEUE *queue, VOID *source, ULONG wait_option){
+    return __queue_put(queue, source, wait_option, true);
+}
+
+UINT tx_queue_receive(TX_QUEUE *queue, VOID *destination, ULONG wait_option){
+    struct timespec deadline = __deadline(wait_option);
+
+    pthread_mutex_lock(&queue->lock);
+    while(queue->count == 0){
+        if(!__wait(&queue->lock, &queue->cond, wait_option, &deadline)){
+            pthread_mutex_unlock(&queue->lock);
+            return TX_QUEUE_EMPTY;
+        }
+    }
+    __queue_copy(destination, &queue->start[queue->first * queue->message_size], queue->message_size);
+    queue->first = (queue->first + 1) % queue->capacity;
+    queue->count--;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+    return TX_SUCCESS;
+}
+
+UINT tx_timer_create(TX_TIMER *timer, CHAR *name, VOID (*expiration)(ULONG), ULONG input, ULONG initial_ticks,
+                     ULONG reschedule_ticks, UINT auto_activate){
+    //Timers never fire (FileX only uses one to advance its file timestamps)
+    timer->name = name;
+    return TX_SUCCESS;
+}
+
+UINT tx_timer_delete(TX_TIMER *timer){
+    return TX_SUCCESS;
+}
+
+UINT tx_interrupt_control(UINT new_posture){
+    UINT old_posture = (sim_interrupt_depth > 0) ? TX_INT_DISABLE : TX_INT_ENABLE;
+
+    if(new_posture == TX_INT_DISABLE){
+        if(sim_interrupt_depth++ == 0){
+            pthread_mutex_lock(&sim_interrupt_lock);
+        }
+    }
+    else if(sim_interrupt_depth > 0){
+        sim_interrupt_depth = 0;
+        pthread_mutex_unlock(&sim_interrupt_lock);
+    }
+    return old_posture;
+}
+
+ULONG tx_time_get(VOID){
+    return (ULONG)(sim_now() * TX_TIMER_TICKS_PER_SECOND);
+}
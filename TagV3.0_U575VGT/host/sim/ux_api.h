@@ -0,0 +1,23 @@
+/*
+ * ux_api.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Stand-in for USBX's API header, the types and constants the mass storage callbacks (USBX/App/ux_device_msc.c) use.
+ *    The class itself isn't built, the harness calls the callbacks the way it does.
+ */
+
+#ifndef SIM_UX_API_H_
+#define SIM_UX_API_H_
+
+#include "tx_api.h"
+
+#define UX_SUCCESS 0x00
+#define UX_ERROR 0xff
+#define UX_FALSE 0
+#define UX_TRUE 1
+
+#define UX_PARAMETER_NOT_USED(parameter) ((void)(parameter))
+
+#endif /* SIM_UX_API_H_ */
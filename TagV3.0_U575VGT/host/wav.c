@@ -0,0 +1,167 @@
+/*
+ * wav.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Minimal PCM WAV reader for the host tools, see wav.h
+ */
+
+#include "wav.h"
+#include <string.h>
+
+/*********************
+ * PRIVATE FUNCTIONS *
+ *********************/
+
+static uint32_t __le32(const uint8_t *p){
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t __le16(const uint8_t *p){
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/* sign extend a bits wide value */
+static int32_t __sign_extend(uint32_t value, uint8_t bits){
+    uint32_t sign = 1UL << (bits - 1);
+    value &= (sign << 1) - 1;
+    return (int32_t)((value ^ sign) - sign);
+}
+
+/********************
+ * PUBLIC FUNCTIONS *
+ ********************/
+
+bool wav_open(WavFile *self, const char *path){
+    uint8_t riff[12];
+    uint8_t chunk[8];
+    uint8_t fmt[40];
+    bool have_fmt = false;
+
+    *self = (WavFile){0};
+    self->file = fopen(path, "rb");
+    if(self->file == NULL){
+        perror(path);
+        return false;
+    }
+
+    if((fread(riff, 1, sizeof(riff), self->file) != sizeof(riff)) || memcmp(riff, "RIFF", 4) || memcmp(&riff[8], "WAVE", 4)){
+        fprintf(stderr, "%s: not a WAV file\n", path);
+        wav_close(self);
+        return false;
+    }
+
+    while(fread(chunk, 1, sizeof(chunk), self->file) == sizeof(chunk)){
+        uint32_t len = __le32(&chunk[4]);
+
+        if(!memcmp(chunk, "fmt ", 4)){
+            size_t fmt_len = (len < sizeof(fmt)) ? len : sizeof(fmt);
+            if((fmt_len < 16) || (fread(fmt, 1, fmt_len, self->file) != fmt_len)){
+                break;
+            }
+            fseek(self->file, (long)(len - fmt_len + (len & 1)), SEEK_CUR);
+
+            uint16_t tag = __le16(&fmt[0]);
+            if((tag == 0xFFFE) && (fmt_len >= 26)){
+                tag = __le16(&fmt[24]); //WAVE_FORMAT_EXTENSIBLE, first two bytes of the subformat GUID
+            }
+            self->channels = __le16(&fmt[2]);
+            self->sample_rate = __le32(&fmt[4]);
+            self->bits = __le16(&fmt[14]);
+            if((tag != 1) || ((self->bits != 16) && (self->bits != 24)) || (self->channels == 0)){
+                fprintf(stderr, "%s: only 16/24-bit integer PCM is supported\n", path);
+                wav_close(self);
+                return false;
+            }
+            have_fmt = true;
+        }
+        else if(!memcmp(chunk, "data", 4) && have_fmt){
+            self->frames = len / (self->channels * (self->bits / 8));
+            self->frames_left = self->frames;
+            return true;
+        }
+        else{
+            fseek(self->file, (long)(len + (len & 1)), SEEK_CUR);
+        }
+    }
+
+    fprintf(stderr, "%s: no fmt/data chunk\n", path);
+    wav_close(self);
+    return false;
+}
+
+size_t wav_read(WavFile *self, int32_t *samples, size_t frame_count){
+    uint8_t raw[4096];
+    size_t sample_bytes = self->bits / 8;
+    size_t frame_bytes = self->channels * sample_bytes;
+    size_t done = 0;
+
+    if(frame_count > self->frames_left){
+        frame_count = self->frames_left;
+    }
+
+    while(done < frame_count){
+        size_t n = sizeof(raw) / frame_bytes;
+        if(n > frame_count - done){
+            n = frame_count - done;
+        }
+        n = fread(raw, frame_bytes, n, self->file);
+        if(n == 0){
+            self->frames_left = 0;
+            break;
+        }
+
+        for(size_t i = 0; i < n * self->channels; i++){
+            const uint8_t *p = &raw[i * sample_bytes];
+            uint32_t value = (sample_bytes == 2) ? __le16(p) : (p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16));
+            samples[done * self->channels + i] = __sign_extend(value, self->bits);
+        }
+        done += n;
+        self->frames_left -= n;
+    }
+    return done;
+}
+
+void wav_rewind(WavFile *self){
+    fseek(self->file, -(long)((self->frames - self->frames_left) * self->channels * (self->bits / 8)), SEEK_CUR);
+    self->frames_left = self->frames;
+}
+
+void wav_close(WavFile *self){
+    if(self->file != NULL){
+        fclose(self->file);
+        self->file = NULL;
+    }
+}
+
+void wav_to_block(const AudioCodecFormat *fmt, const int32_t *samples, uint16_t bits, size_t frame_count, uint8_t *dst){
+    int shift = (fmt->sample_bytes * 8) - bits;
+
+    for(size_t i = 0; i < frame_count; i++){
+        for(uint8_t ch = 0; ch < fmt->channel_count; ch++){
+            int32_t s = *samples++;
+            s = (shift >= 0) ? (int32_t)((uint32_t)s << shift) : (s >> -shift);
+
+            if(fmt->header_bytes){
+                *dst++ = (uint8_t)(ch << 4);
+            }
+            for(int b = fmt->sample_bytes - 1; b >= 0; b--){
+                *dst++ = (uint8_t)(s >> (8 * b));
+            }
+        }
+    }
+}
+
+void wav_from_block(const AudioCodecFormat *fmt, const uint8_t *src, size_t frame_count, uint8_t ch, int32_t *samples){
+    size_t frame_bytes = audio_codec_frame_bytes(fmt);
+    const uint8_t *p = src + ch * (fmt->header_bytes + fmt->sample_bytes) + fmt->header_bytes;
+
+    for(size_t i = 0; i < frame_count; i++, p += frame_bytes){
+        uint32_t value = 0;
+        for(uint8_t b = 0; b < fmt->sample_bytes; b++){
+            value = (value << 8) | p[b];
+        }
+        samples[i] = __sign_extend(value, fmt->sample_bytes * 8);
+    }
+}
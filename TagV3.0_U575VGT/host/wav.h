@@ -0,0 +1,52 @@
+/*
+ * wav.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Description:
+ *    Minimal PCM WAV reader for the host tools, plus conversion of its samples to and from the raw block layout
+ *    the SAI writes on the tag (see audio_codec.h), so recordings can be fed to the firmware's audio code.
+ *
+ *    Only 16 and 24-bit integer PCM (WAVE_FORMAT_PCM or WAVE_FORMAT_EXTENSIBLE) is supported.
+ */
+
+#ifndef HOST_WAV_H_
+#define HOST_WAV_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "Lib Inc/audio_codec.h"
+
+typedef struct {
+    FILE *file;
+    uint16_t channels;
+    uint16_t bits;          //16 or 24
+    uint32_t sample_rate;
+    uint32_t frames;        //frames in the data chunk
+    uint32_t frames_left;
+} WavFile;
+
+/* open a WAV file and read its header, prints the reason and returns false if it can't be used */
+bool wav_open(WavFile *self, const char *path);
+
+/* read up to frame_count frames of interleaved samples, sign extended to 32 bits. Returns frames read */
+size_t wav_read(WavFile *self, int32_t *samples, size_t frame_count);
+
+/* start over from the first frame */
+void wav_rewind(WavFile *self);
+
+void wav_close(WavFile *self);
+
+/*
+ * Desc: write frame_count frames of interleaved samples (channels = fmt->channel_count) in the raw block layout.
+ *       Samples are taken as bits wide and scaled to the layout's sample width. Header bytes are set to the
+ *       AD7768 channel ID (bits 4-6), the way the ADC sends them with no errors and no CRC.
+ */
+void wav_to_block(const AudioCodecFormat *fmt, const int32_t *samples, uint16_t bits, size_t frame_count, uint8_t *dst);
+
+/* read channel ch of every frame of a raw block back as sign extended samples */
+void wav_from_block(const AudioCodecFormat *fmt, const uint8_t *src, size_t frame_count, uint8_t ch, int32_t *samples);
+
+#endif /* HOST_WAV_H_ */